@@ -0,0 +1,179 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 TU Wien, ACIN, Vision 4 Robotics (V4R) group
+** Contact: v4r.acin.tuwien.ac.at
+**
+** This file is part of V4R
+**
+** V4R is distributed under dual licenses - GPLv3 or closed source.
+**
+** GNU General Public License Usage
+** V4R is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published
+** by the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** V4R is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** Please review the following information to ensure the GNU General Public
+** License requirements will be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+**
+** Commercial License Usage
+** If GPL is not suitable for your project, you must purchase a commercial
+** license to use V4R. Licensees holding valid commercial V4R licenses may
+** use this file in accordance with the commercial license agreement
+** provided with the Software or, alternatively, in accordance with the
+** terms contained in a written agreement between you and TU Wien, ACIN, V4R.
+** For licensing terms and conditions please contact office<at>acin.tuwien.ac.at.
+**
+**
+** The copyright holder additionally grants the author(s) of the file the right
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or
+** sell copies of their contributions without any restrictions.
+**
+****************************************************************************/
+
+/**
+ * @file segmentBenchmark.cpp
+ * @brief Runs the segmentation of segment.cpp over a recorded sequence (directory of point clouds) and reports the
+ * run time of the single stages per frame and on average.
+ */
+
+#include <glog/logging.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <v4r/io/filesystem.h>
+
+#include "v4r/attention_segmentation/PCLPreprocessingXYZRC.h"
+#include "v4r/attention_segmentation/PCLUtils.h"
+#include "v4r/attention_segmentation/segmentation.h"
+
+namespace po = boost::program_options;
+namespace bf = boost::filesystem;
+
+namespace {
+double toMs(unsigned long long ns) {
+  return ns / 1e6;
+}
+
+struct StageTimes {
+  double surfaces_ms = 0.;   ///< normals, patches, neighbours and surface modelling
+  double relations_ms = 0.;  ///< relation pre-computation and computation
+  double graph_ms = 0.;      ///< SVM prediction and graph cut
+  double total_ms = 0.;
+  size_t num_surfaces = 0;
+
+  void add(const StageTimes &t) {
+    surfaces_ms += t.surfaces_ms;
+    relations_ms += t.relations_ms;
+    graph_ms += t.graph_ms;
+    total_ms += t.total_ms;
+    num_surfaces += t.num_surfaces;
+  }
+};
+
+StageTimes segmentFrame(const pcl::PointCloud<pcl::PointXYZRGB>::Ptr &cloud, const std::string &model_file_name,
+                        const std::string &scaling_params_name) {
+  v4r::Segmenter segmenter;
+  segmenter.setPointCloud(cloud);
+  segmenter.setModelFilename(model_file_name);
+  segmenter.setScaling(scaling_params_name);
+  segmenter.segment();
+
+  const v4r::TimeEstimates tEst = segmenter.getTimeEstimates();
+  StageTimes t;
+  t.surfaces_ms = toMs(tEst.time_normalsCalculation + tEst.time_patchesCalculation + tEst.time_patchImageCalculation +
+                       tEst.time_neighborsCalculation + tEst.time_borderCalculation + tEst.time_initModelSurfaces +
+                       tEst.times_surfaceModelling.at(0));
+  t.relations_ms = toMs(tEst.time_relationsPreComputation + tEst.times_relationsComputation.at(0));
+  t.graph_ms = toMs(tEst.times_graphBasedSegmentation.at(0));
+  t.total_ms = toMs(tEst.time_total);
+  t.num_surfaces = segmenter.getSurfaces().size();
+  return t;
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+  bf::path sequence_dir;
+  std::string model_file_name, scaling_params_name;
+  int repetitions = 1;
+
+  po::options_description desc(
+      "Benchmark of the object segmentation (segment) over a recorded sequence\n"
+      "======================================\n**Allowed options");
+  desc.add_options()("help,h", "produce help message");
+  desc.add_options()("sequence,d", po::value<bf::path>(&sequence_dir)->required(),
+                     "directory with the point clouds (.pcd) of the sequence");
+  desc.add_options()("model,m", po::value<std::string>(&model_file_name)->required()->value_name("FILEPATH"),
+                     "svm model file");
+  desc.add_options()("scale,s", po::value<std::string>(&scaling_params_name)->required()->value_name("FILEPATH"),
+                     "svm scaling file");
+  desc.add_options()("repetitions,r", po::value<int>(&repetitions)->default_value(repetitions),
+                     "number of segmentation runs per frame (minimum time is reported)");
+
+  po::variables_map vm;
+  po::parsed_options parsed = po::command_line_parser(argc, argv).options(desc).allow_unregistered().run();
+  po::store(parsed, vm);
+  if (vm.count("help")) {
+    std::cout << desc << std::endl;
+    return 0;
+  }
+  try {
+    po::notify(vm);
+  } catch (std::exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl << std::endl << desc << std::endl;
+    return 1;
+  }
+  google::InitGoogleLogging(argv[0]);
+
+  const std::vector<std::string> frames = v4r::io::getFilesInDirectory(sequence_dir, ".*.pcd", false);
+  if (frames.empty()) {
+    LOG(ERROR) << "No point clouds found in " << sequence_dir.string();
+    return 1;
+  }
+
+  StageTimes sum;
+  size_t num_frames = 0;
+  for (const std::string &frame : frames) {
+    pcl::PointCloud<pcl::PointXYZRGB>::Ptr cloud(new pcl::PointCloud<pcl::PointXYZRGB>);
+    if (!pclAddOns::readPointCloud<pcl::PointXYZRGB>((sequence_dir / frame).string(), cloud)) {
+      LOG(WARNING) << "Could not read " << frame << ". Skipping.";
+      continue;
+    }
+    v4r::ClipDepthImage(cloud);
+
+    StageTimes best;
+    try {
+      for (int rep = 0; rep < std::max(1, repetitions); rep++) {
+        // every run segments its own copy of the frame
+        pcl::PointCloud<pcl::PointXYZRGB>::Ptr cloud_copy(new pcl::PointCloud<pcl::PointXYZRGB>(*cloud));
+        const StageTimes t = segmentFrame(cloud_copy, model_file_name, scaling_params_name);
+        if (rep == 0 || t.total_ms < best.total_ms)
+          best = t;
+      }
+    } catch (std::exception &e) {
+      LOG(ERROR) << "Error while segmenting " << frame << ": " << e.what();
+      continue;
+    }
+
+    std::cout << frame << ": " << best.num_surfaces << " surfaces, surfaces " << best.surfaces_ms << " ms, relations "
+              << best.relations_ms << " ms, graph segmentation " << best.graph_ms << " ms, total " << best.total_ms
+              << " ms" << std::endl;
+    sum.add(best);
+    num_frames++;
+  }
+
+  if (num_frames) {
+    std::cout << "Average over " << num_frames << " frames (" << sum.num_surfaces / num_frames
+              << " surfaces): surfaces " << sum.surfaces_ms / num_frames << " ms, relations "
+              << sum.relations_ms / num_frames << " ms, graph segmentation " << sum.graph_ms / num_frames
+              << " ms, total " << sum.total_ms / num_frames << " ms" << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,235 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 TU Wien, ACIN, Vision 4 Robotics (V4R) group
+** Contact: v4r.acin.tuwien.ac.at
+**
+** This file is part of V4R
+**
+** V4R is distributed under dual licenses - GPLv3 or closed source.
+**
+** GNU General Public License Usage
+** V4R is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published
+** by the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** V4R is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** Please review the following information to ensure the GNU General Public
+** License requirements will be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+**
+** Commercial License Usage
+** If GPL is not suitable for your project, you must purchase a commercial
+** license to use V4R. Licensees holding valid commercial V4R licenses may
+** use this file in accordance with the commercial license agreement
+** provided with the Software or, alternatively, in accordance with the
+** terms contained in a written agreement between you and TU Wien, ACIN, V4R.
+** For licensing terms and conditions please contact office<at>acin.tuwien.ac.at.
+**
+**
+** The copyright holder additionally grants the author(s) of the file the right
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or
+** sell copies of their contributions without any restrictions.
+**
+****************************************************************************/
+
+/**
+ * @file main.cpp
+ * @brief Compares the numeric-diff and the analytic point-to-plane multi-view ICP (MvLMIcp) on a recorded RTMT
+ * session (views folder with cloud_*.pcd, pose_*.txt and optional object_indices_*.txt files).
+ *
+ */
+
+#include <glog/logging.h>
+#include <pcl/common/io.h>
+#include <pcl/common/time.h>
+#include <pcl/common/transforms.h>
+#include <pcl/features/normal_3d_omp.h>
+#include <pcl/filters/voxel_grid.h>
+#include <pcl/io/pcd_io.h>
+#include <pcl/kdtree/kdtree_flann.h>
+#include <boost/algorithm/string/replace.hpp>
+#include <boost/program_options.hpp>
+
+#include <v4r/io/filesystem.h>
+#include <v4r/keypoints/impl/PoseIO.hpp>
+#include <v4r/registration/MvLMIcp.h>
+
+namespace po = boost::program_options;
+namespace bf = boost::filesystem;
+
+namespace {
+typedef pcl::PointXYZRGB PT;
+typedef std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f>> PoseVector;
+
+/**
+ * @brief alignmentError computes the root mean square distance of all points to their closest point in the other
+ * views (only distances below max_dist are considered)
+ */
+float alignmentError(const std::vector<pcl::PointCloud<PT>::Ptr> &clouds, const PoseVector &poses, float max_dist,
+                     size_t &num_inliers) {
+  std::vector<pcl::PointCloud<PT>::Ptr> clouds_aligned(clouds.size());
+  std::vector<pcl::KdTreeFLANN<PT>> kdtrees(clouds.size());
+  for (size_t i = 0; i < clouds.size(); i++) {
+    clouds_aligned[i].reset(new pcl::PointCloud<PT>);
+    pcl::transformPointCloud(*clouds[i], *clouds_aligned[i], poses[i]);
+    kdtrees[i].setInputCloud(clouds_aligned[i]);
+  }
+
+  double sum_sqr_dist = 0.;
+  num_inliers = 0;
+  std::vector<int> nn_indices;
+  std::vector<float> nn_sqr_dists;
+  for (size_t i = 0; i < clouds.size(); i++) {
+    for (size_t j = i + 1; j < clouds.size(); j++) {
+      for (const PT &p : clouds_aligned[j]->points) {
+        if (kdtrees[i].nearestKSearch(p, 1, nn_indices, nn_sqr_dists) > 0 && nn_sqr_dists[0] < max_dist * max_dist) {
+          sum_sqr_dist += nn_sqr_dists[0];
+          num_inliers++;
+        }
+      }
+    }
+  }
+  return num_inliers ? std::sqrt(sum_sqr_dist / num_inliers) : 0.f;
+}
+
+PoseVector runRegistration(const std::vector<pcl::PointCloud<PT>::Ptr> &clouds,
+                           const std::vector<pcl::PointCloud<pcl::Normal>::Ptr> &normals, const PoseVector &poses,
+                           int diff_type, float max_dist, int max_iterations, double &time_ms) {
+  std::vector<pcl::PointCloud<PT>::Ptr> clouds_tmp = clouds;
+  std::vector<pcl::PointCloud<pcl::Normal>::Ptr> normals_tmp = normals;
+  PoseVector poses_tmp = poses;
+
+  pcl::StopWatch t;
+  v4r::Registration::MvLMIcp<PT> nl_icp;
+  nl_icp.setInputClouds(clouds_tmp);
+  nl_icp.setPoses(poses_tmp);
+  if (!normals_tmp.empty())
+    nl_icp.setNormals(normals_tmp);
+  nl_icp.setMaxCorrespondenceDistance(max_dist);
+  nl_icp.setMaxIterations(max_iterations);
+  nl_icp.setDiffType(diff_type);
+  nl_icp.compute();
+  time_ms = t.getTime();
+  return nl_icp.getFinalPoses();
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+  bf::path views_dir;
+  float vx_size = 0.005f;
+  float max_dist = 0.01f;
+  int max_iterations = 10;
+  bool use_normals = false;
+
+  po::options_description desc(
+      "Benchmark for the multi-view ICP refinement (numeric diff vs. analytic point-to-plane)\n"
+      "======================================\n**Allowed options");
+  desc.add_options()("help,h", "produce help message");
+  desc.add_options()("views_dir,v", po::value<bf::path>(&views_dir)->required(),
+                     "Views folder of a recorded session (cloud_*.pcd, pose_*.txt and optionally "
+                     "object_indices_*.txt as stored by RTMT)");
+  desc.add_options()("vx_size", po::value<float>(&vx_size)->default_value(vx_size),
+                     "voxel size used for downsampling the views");
+  desc.add_options()("max_dist", po::value<float>(&max_dist)->default_value(max_dist),
+                     "maximum correspondence distance");
+  desc.add_options()("max_iterations", po::value<int>(&max_iterations)->default_value(max_iterations),
+                     "maximum number of iterations");
+  desc.add_options()("use_normals", po::bool_switch(&use_normals), "use surface normals for the registration");
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, desc), vm);
+  if (vm.count("help")) {
+    std::cout << desc << std::endl;
+    return 0;
+  }
+  try {
+    po::notify(vm);
+  } catch (std::exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl << std::endl << desc << std::endl;
+    return -1;
+  }
+  google::InitGoogleLogging(argv[0]);
+
+  std::vector<pcl::PointCloud<PT>::Ptr> clouds;
+  std::vector<pcl::PointCloud<pcl::Normal>::Ptr> normals;
+  PoseVector poses;
+
+  std::vector<std::string> cloud_fns = v4r::io::getFilesInDirectory(views_dir, "cloud_.*.pcd", false);
+  std::sort(cloud_fns.begin(), cloud_fns.end());
+  for (const std::string &cloud_fn : cloud_fns) {
+    std::string pose_fn = cloud_fn, indices_fn = cloud_fn;
+    boost::replace_first(pose_fn, "cloud_", "pose_");
+    boost::replace_last(pose_fn, ".pcd", ".txt");
+    boost::replace_first(indices_fn, "cloud_", "object_indices_");
+    boost::replace_last(indices_fn, ".pcd", ".txt");
+
+    Eigen::Matrix4f pose;
+    if (!v4r::readPose((views_dir / pose_fn).string(), pose)) {
+      LOG(WARNING) << "No pose found for " << cloud_fn << ". Skipping.";
+      continue;
+    }
+
+    pcl::PointCloud<PT>::Ptr cloud(new pcl::PointCloud<PT>);
+    pcl::io::loadPCDFile((views_dir / cloud_fn).string(), *cloud);
+
+    if (v4r::io::existsFile(views_dir / indices_fn)) {
+      std::vector<int> indices;
+      std::ifstream f((views_dir / indices_fn).string().c_str());
+      int idx;
+      while (f >> idx)
+        indices.push_back(idx);
+      pcl::PointCloud<PT>::Ptr cloud_segmented(new pcl::PointCloud<PT>);
+      pcl::copyPointCloud(*cloud, indices, *cloud_segmented);
+      cloud = cloud_segmented;
+    }
+
+    pcl::PointCloud<PT>::Ptr cloud_filtered(new pcl::PointCloud<PT>);
+    pcl::VoxelGrid<PT> filter;
+    filter.setInputCloud(cloud);
+    filter.setDownsampleAllData(true);
+    filter.setLeafSize(vx_size, vx_size, vx_size);
+    filter.filter(*cloud_filtered);
+
+    if (use_normals) {
+      pcl::PointCloud<pcl::Normal>::Ptr cloud_normals(new pcl::PointCloud<pcl::Normal>);
+      pcl::NormalEstimationOMP<PT, pcl::Normal> ne;
+      ne.setInputCloud(cloud_filtered);
+      ne.setRadiusSearch(3.f * vx_size);
+      ne.compute(*cloud_normals);
+      normals.push_back(cloud_normals);
+    }
+
+    clouds.push_back(cloud_filtered);
+    poses.push_back(pose);
+  }
+
+  if (clouds.size() < 2) {
+    LOG(ERROR) << "Need at least two views in " << views_dir.string() << "!";
+    return -1;
+  }
+
+  size_t num_inliers;
+  float error = alignmentError(clouds, poses, max_dist, num_inliers);
+  std::cout << clouds.size() << " views. Initial poses: RMS error " << error << " m (" << num_inliers << " inliers)"
+            << std::endl;
+
+  double time_numeric_ms, time_analytic_ms;
+  const PoseVector poses_numeric =
+      runRegistration(clouds, normals, poses, 0, max_dist, max_iterations, time_numeric_ms);
+  const PoseVector poses_analytic =
+      runRegistration(clouds, normals, poses, 3, max_dist, max_iterations, time_analytic_ms);
+
+  error = alignmentError(clouds, poses_numeric, max_dist, num_inliers);
+  std::cout << "Numeric diff: " << time_numeric_ms << " ms, RMS error " << error << " m (" << num_inliers
+            << " inliers)" << std::endl;
+  error = alignmentError(clouds, poses_analytic, max_dist, num_inliers);
+  std::cout << "Analytic point-to-plane: " << time_analytic_ms << " ms, RMS error " << error << " m (" << num_inliers
+            << " inliers)" << std::endl;
+  std::cout << "Speed-up: " << time_numeric_ms / std::max(time_analytic_ms, 1.) << "x" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,215 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 TU Wien, ACIN, Vision 4 Robotics (V4R) group
+** Contact: v4r.acin.tuwien.ac.at
+**
+** This file is part of V4R
+**
+** V4R is distributed under dual licenses - GPLv3 or closed source.
+**
+** GNU General Public License Usage
+** V4R is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published
+** by the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** V4R is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** Please review the following information to ensure the GNU General Public
+** License requirements will be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+**
+** Commercial License Usage
+** If GPL is not suitable for your project, you must purchase a commercial
+** license to use V4R. Licensees holding valid commercial V4R licenses may
+** use this file in accordance with the commercial license agreement
+** provided with the Software or, alternatively, in accordance with the
+** terms contained in a written agreement between you and TU Wien, ACIN, V4R.
+** For licensing terms and conditions please contact office<at>acin.tuwien.ac.at.
+**
+**
+** The copyright holder additionally grants the author(s) of the file the right
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or
+** sell copies of their contributions without any restrictions.
+**
+****************************************************************************/
+
+/**
+ * @file hv_benchmark.cpp
+ * @brief Compares the local search of the hypotheses verification with full and incremental cost evaluation. The
+ * object hypotheses are read from the results of a previous ObjectRecognizer run (*.generated_hyps_serialized), so
+ * both variants verify exactly the same input.
+ *
+ */
+
+#include <glog/logging.h>
+#include <pcl/io/pcd_io.h>
+#include <boost/algorithm/string/replace.hpp>
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/format.hpp>
+#include <boost/program_options.hpp>
+#include <boost/serialization/vector.hpp>
+
+#include <v4r/common/normals.h>
+#include <v4r/common/pcl_serialization.h>
+#include <v4r/io/filesystem.h>
+#include <v4r/recognition/hypotheses_verification.h>
+#include <v4r/recognition/source.h>
+
+namespace po = boost::program_options;
+namespace bf = boost::filesystem;
+
+namespace {
+typedef pcl::PointXYZRGB PT;
+
+struct BenchmarkResult {
+  float search_time_ms_ = 0.f;
+  float evaluated_solutions_ = 0.f;
+  std::vector<bool> is_verified_;
+};
+
+BenchmarkResult runVerification(const v4r::Intrinsics &cam, const v4r::HV_Parameter &param,
+                                const v4r::Source<PT>::ConstPtr &model_database,
+                                const pcl::PointCloud<PT>::ConstPtr &cloud,
+                                const pcl::PointCloud<pcl::Normal>::ConstPtr &normals,
+                                const bf::path &hypotheses_file) {
+  // read hypotheses for each run separately as verification modifies them
+  std::vector<v4r::ObjectHypothesesGroup> ohgs;
+  std::ifstream f(hypotheses_file.string().c_str());
+  boost::archive::text_iarchive ia(f);
+  ia >> ohgs;
+  f.close();
+
+  for (v4r::ObjectHypothesesGroup &ohg : ohgs) {
+    for (v4r::ObjectHypothesis::Ptr &oh : ohg.ohs_)
+      oh->is_verified_ = false;
+  }
+
+  v4r::HypothesisVerification<PT> hv(cam, param);
+  hv.setModelDatabase(model_database);
+  hv.setSceneCloud(cloud);
+  hv.setNormals(normals);
+  hv.setHypotheses(ohgs);
+  hv.verify();
+
+  BenchmarkResult r;
+  for (const std::pair<std::string, float> &t : hv.getElapsedTimes()) {
+    if (t.first == "local search of hypotheses verification")
+      r.search_time_ms_ = t.second;
+    else if (t.first == "evaluated solutions")
+      r.evaluated_solutions_ = t.second;
+  }
+
+  for (const v4r::ObjectHypothesesGroup &ohg : ohgs) {
+    for (const v4r::ObjectHypothesis::Ptr &oh : ohg.ohs_)
+      r.is_verified_.push_back(oh->is_verified_);
+  }
+  return r;
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+  bf::path test_dir, hypotheses_dir, models_dir, camera_calibration_file;
+  v4r::HV_Parameter hv_param;
+  v4r::NormalEstimatorType normal_method = v4r::NormalEstimatorType::PCL_INTEGRAL_NORMAL;
+  int repetitions = 3;
+
+  po::options_description desc(
+      "Benchmark for the local search of the hypotheses verification (full vs. incremental cost "
+      "evaluation)\n======================================\n**Allowed options");
+  desc.add_options()("help,h", "produce help message");
+  desc.add_options()("test_dir,t", po::value<bf::path>(&test_dir)->required(),
+                     "Directory with test scenes stored as point clouds (.pcd)");
+  desc.add_options()("hypotheses_dir", po::value<bf::path>(&hypotheses_dir)->required(),
+                     "Output directory of a previous ObjectRecognizer run containing the serialized generated "
+                     "hypotheses (*.generated_hyps_serialized) for each test scene");
+  desc.add_options()("models_dir,m", po::value<bf::path>(&models_dir)->required(), "Object model database");
+  desc.add_options()("camera_calibration_file", po::value<bf::path>(&camera_calibration_file),
+                     "Camera calibration file (if not given, uses PrimeSense default intrinsics)");
+  desc.add_options()("normal_method", po::value<v4r::NormalEstimatorType>(&normal_method)->default_value(normal_method),
+                     "normal computation method for the scene");
+  desc.add_options()("repetitions", po::value<int>(&repetitions)->default_value(repetitions),
+                     "number of verification runs per scene and evaluation method (minimum time is reported)");
+  hv_param.init(desc, "hv");
+  po::variables_map vm;
+  po::parsed_options parsed = po::command_line_parser(argc, argv).options(desc).allow_unregistered().run();
+  std::vector<std::string> to_pass_further = po::collect_unrecognized(parsed.options, po::include_positional);
+  po::store(parsed, vm);
+  if (vm.count("help")) {
+    std::cout << desc << std::endl;
+    return 0;
+  }
+  try {
+    po::notify(vm);
+  } catch (std::exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl << std::endl << desc << std::endl;
+    return -1;
+  }
+  google::InitGoogleLogging(argv[0]);
+
+  v4r::Intrinsics cam = v4r::Intrinsics::PrimeSense();
+  if (!camera_calibration_file.empty())
+    cam = v4r::Intrinsics::load(camera_calibration_file.string());
+
+  v4r::Source<PT>::Ptr model_database(new v4r::Source<PT>);
+  model_database->init(models_dir);
+
+  v4r::NormalEstimator<PT>::Ptr normal_estimator = v4r::initNormalEstimator<PT>(normal_method, to_pass_further);
+
+  v4r::HV_Parameter param_full = hv_param, param_incremental = hv_param;
+  param_full.incremental_evaluation_ = false;
+  param_incremental.incremental_evaluation_ = true;
+
+  double total_full_ms = 0., total_incremental_ms = 0.;
+  size_t num_scenes = 0, num_mismatches = 0;
+
+  const std::vector<std::string> views = v4r::io::getFilesInDirectory(test_dir, ".*.pcd", true);
+  for (const std::string &view : views) {
+    std::string hypotheses_fn = view;
+    boost::replace_last(hypotheses_fn, ".pcd", ".generated_hyps_serialized");
+    const bf::path hypotheses_file = hypotheses_dir / hypotheses_fn;
+    if (!v4r::io::existsFile(hypotheses_file)) {
+      LOG(WARNING) << "No generated hypotheses found for " << view << " (" << hypotheses_file.string()
+                   << "). Skipping.";
+      continue;
+    }
+
+    pcl::PointCloud<PT>::Ptr cloud(new pcl::PointCloud<PT>);
+    pcl::io::loadPCDFile((test_dir / view).string(), *cloud);
+    normal_estimator->setInputCloud(cloud);
+    pcl::PointCloud<pcl::Normal>::Ptr normals = normal_estimator->compute();
+
+    BenchmarkResult full, incremental;
+    float min_full_ms = std::numeric_limits<float>::max(), min_incremental_ms = std::numeric_limits<float>::max();
+    for (int rep = 0; rep < repetitions; rep++) {
+      full = runVerification(cam, param_full, model_database, cloud, normals, hypotheses_file);
+      incremental = runVerification(cam, param_incremental, model_database, cloud, normals, hypotheses_file);
+      min_full_ms = std::min(min_full_ms, full.search_time_ms_);
+      min_incremental_ms = std::min(min_incremental_ms, incremental.search_time_ms_);
+    }
+
+    const bool same_solution = full.is_verified_ == incremental.is_verified_;
+    if (!same_solution)
+      num_mismatches++;
+
+    total_full_ms += min_full_ms;
+    total_incremental_ms += min_incremental_ms;
+    num_scenes++;
+
+    std::cout << view << ": " << full.is_verified_.size() << " hypotheses, " << full.evaluated_solutions_
+              << " evaluations, full: " << min_full_ms << " ms, incremental: " << min_incremental_ms << " ms"
+              << (same_solution ? "" : " -- SOLUTIONS DIFFER!") << std::endl;
+  }
+
+  if (num_scenes) {
+    std::cout << "Local search over " << num_scenes << " scenes took " << total_full_ms << " ms (full) and "
+              << total_incremental_ms << " ms (incremental). Speed-up: "
+              << boost::str(boost::format("%.2f") % (total_full_ms / std::max(total_incremental_ms, 1.))) << "x. "
+              << num_mismatches << " scene(s) with different solution." << std::endl;
+  }
+
+  return num_mismatches ? 1 : 0;
+}
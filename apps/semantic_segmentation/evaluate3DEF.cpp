@@ -62,6 +62,8 @@
 #include <omp.h>
 #else
 #define omp_get_thread_num() 0
+#define omp_get_max_threads() 1
+#define omp_set_num_threads(n)
 #endif
 
 #include <v4r/semantic_segmentation/entangled_data.h>
@@ -84,6 +86,8 @@ bool filtered;
 
 std::map<int, std::array<int, 3>> colorCode;
 bool savePointclouds;
+bool parallelTrees;
+bool reportScaling;
 
 static bool parseArgs(int argc, char** argv) {
   po::options_description general("General options");
@@ -98,7 +102,11 @@ static bool parseArgs(int argc, char** argv) {
       "Color code file for result pointclouds")("output,o",
                                                 po::value<std::string>(&outputdir)->default_value("evaluation"),
                                                 "Output directory for evaluation data")(
-      "savepc,s", po::value<bool>(&savePointclouds)->default_value(false), "Store result pointclouds");
+      "savepc,s", po::value<bool>(&savePointclouds)->default_value(false), "Store result pointclouds")(
+      "parallel-trees,p", po::value<bool>(&parallelTrees)->default_value(false),
+      "Classify trees concurrently instead of parallelizing the tree levels")(
+      "scaling", po::value<bool>(&reportScaling)->default_value(false),
+      "Report classification times of both inference modes for 1 to max. number of threads");
 
   po::options_description all("");
   all.add(general);
@@ -198,6 +206,31 @@ static void EvaluateResult(v4r::EntangledForestData* data, string filename, std:
   }
 }
 
+static void ReportScaling(v4r::EntangledForest& f, v4r::EntangledForestData* data) {
+  const int maxThreads = omp_get_max_threads();
+  const bool parallelTreesBackup = f.GetParallelTreeInference();
+  std::vector<int> result;
+
+  for (int threads = 1; threads <= maxThreads; ++threads) {
+    omp_set_num_threads(threads);
+    std::cout << "  " << threads << " thread(s):";
+
+    for (int mode = 0; mode < 2; ++mode) {
+      f.SetParallelTreeInference(mode == 1);
+      ptime time_start(microsec_clock::local_time());
+      f.Classify(data, result, maxDepth, nTrees);
+      ptime time_end(microsec_clock::local_time());
+      std::cout << (mode == 1 ? " parallel trees " : " parallel levels ")
+                << (time_end - time_start).total_microseconds() / 1000.0 << " ms";
+    }
+
+    std::cout << std::endl;
+  }
+
+  omp_set_num_threads(maxThreads);
+  f.SetParallelTreeInference(parallelTreesBackup);
+}
+
 static void ConvertPCLCloud2Image(const pcl::PointCloud<pcl::PointXYZRGB>::Ptr& pcl_cloud, cv::Mat_<cv::Vec3b>& image) {
   unsigned pcWidth = pcl_cloud->width;
   unsigned pcHeight = pcl_cloud->height;
@@ -233,6 +266,7 @@ int main(int argc, char** argv) {
 
   v4r::EntangledForest f;
   v4r::EntangledForest::LoadFromBinaryFile(forestfile, f);
+  f.SetParallelTreeInference(parallelTrees);
 
   std::vector<string> filenames;
   string filename;
@@ -265,6 +299,11 @@ int main(int argc, char** argv) {
       continue;
     }
 
+    if (reportScaling) {
+      cout << "Thread scaling:" << endl;
+      ReportScaling(f, &d);
+    }
+
     // classify
     std::vector<int> result;
 
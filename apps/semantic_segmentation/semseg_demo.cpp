@@ -73,6 +73,7 @@
 
 #include <v4r/semantic_segmentation/entangled_feature_extraction.h>
 #include <v4r/semantic_segmentation/entangled_forest.h>
+#include <v4r/semantic_segmentation/entangled_forest_inference.h>
 #include <v4r/semantic_segmentation/supervoxel_segmentation.h>
 
 namespace po = boost::program_options;
@@ -294,16 +295,21 @@ int main(int argc, char** argv) {
   feat.extract();
 
   // load classifier and run classification
-  std::vector<int> result(0);  // storage for result (labelID per segment)
-  v4r::EntangledForest f;      // forest object
-  v4r::EntangledForestData d;  // data container
+  std::vector<int> result(0);         // storage for result (labelID per segment)
+  v4r::EntangledForestInference ef;  // flat forest used for classification
+  v4r::EntangledForestData d;        // data container
 
   std::cout << "Load classifier..." << std::endl;
-  v4r::EntangledForest::LoadFromBinaryFile(forestfile, f);  // load forest
-  feat.prepareClassification(&d);                           // init data container with unary features
+  if (!v4r::EntangledForestInference::LoadFromBinaryFile(forestfile, ef)) {
+    // not a flat forest file, load trained forest and compile it
+    v4r::EntangledForest f;
+    v4r::EntangledForest::LoadFromBinaryFile(forestfile, f);
+    ef = v4r::EntangledForestInference(f);
+  }
+  feat.prepareClassification(&d);  // init data container with unary features
 
   std::cout << "Classify..." << std::endl;
-  f.Classify(&d, result, maxDepth, ntrees);  // classify
+  ef.Classify(&d, result, maxDepth, ntrees);  // classify
 
   // generate results point cloud and save it
   pcl::PointCloud<pcl::PointXYZRGBL>::Ptr resultCloud(new pcl::PointCloud<pcl::PointXYZRGBL>);
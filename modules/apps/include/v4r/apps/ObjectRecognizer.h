@@ -57,6 +57,7 @@
 #include <v4r/recognition/hypotheses_verification.h>
 #include <v4r/recognition/local_recognition_pipeline.h>
 #include <v4r/recognition/multi_pipeline_recognizer.h>
+#include <v4r/registration/incremental_noise_model_based_cloud_integration.h>
 #include <boost/serialization/vector.hpp>
 
 namespace bf = boost::filesystem;
@@ -108,9 +109,13 @@ class V4R_EXPORTS ObjectRecognizer {
     pcl::PointCloud<pcl::Normal>::Ptr cloud_normals_;
     std::vector<std::vector<float>> pt_properties_;
     Eigen::Matrix4f camera_pose_;
+    size_t integration_id_;  ///< id of this view in the noise model based cloud integration
   };
   std::vector<View> views_;  ///< all views in sequence
 
+  typename IncrementalNMBasedCloudIntegration<PointT>::Ptr
+      nm_integration_;  ///< integrates the views of the sliding multi-view window into registered_scene_cloud_
+
 #if HAVE_V4R_CHANGE_DETECTION
   /**
    * @brief detectChanges detect changes in multi-view sequence (e.g. objects removed or added to the scene within
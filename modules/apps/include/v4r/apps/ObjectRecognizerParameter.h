@@ -186,8 +186,14 @@ struct V4R_EXPORTS ObjectRecognizerParameter {
       3;  ///< maximum number of views used for multi-view recognition (if more views are available,
   /// information from oldest views will be ignored)
 
+  bool store_model_lods_ = false;  ///< if true, stores voxelized versions of the object models next to the models, so
+                                   ///< they are only computed once across runs
+
   size_t icp_iterations_ =
       0;  ///< ICP iterations. Only used if hypotheses are not verified. Otherwise ICP is done inside HV
+  bool icp_projective_lookup_ =
+      false;  ///< if true and the scene is organized, ICP (without verification) finds correspondences by projecting
+              ///< the model points into the image plane instead of searching a kd-tree of the scene
 
   bool skip_verification_ = false;     ///< if true, will only generate hypotheses but not verify them
   bool visualize_hv_go_cues_ = false;  ///< If set, visualizes cues computed at the hypothesis verification stage such
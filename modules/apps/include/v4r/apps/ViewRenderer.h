@@ -68,8 +68,10 @@ struct V4R_EXPORTS ViewRendererParameter {
   size_t subdivisions;
   float radius;
   bool overwrite;
+  bool software;  //< if true, renders with the multi-threaded CPU rasterizer (no display or GPU required)
 
-  ViewRendererParameter() : upperHemisphere(false), autoscale(false), subdivisions(0), radius(3.f), overwrite(false) {}
+  ViewRendererParameter()
+  : upperHemisphere(false), autoscale(false), subdivisions(0), radius(3.f), overwrite(false), software(false) {}
 
   /**
    * @brief init parameters
@@ -90,6 +92,8 @@ struct V4R_EXPORTS ViewRendererParameter {
                        "defines the radius used for rendering");
     desc.add_options()((section_name + ".overwrite").c_str(), po::bool_switch(&overwrite),
                        "overwrites existing files in output path");
+    desc.add_options()((section_name + ".software").c_str(), po::bool_switch(&software),
+                       "renders the views in parallel on the CPU instead of using OpenGL (for headless machines)");
   }
 };
 
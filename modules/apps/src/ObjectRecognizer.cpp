@@ -53,7 +53,6 @@
 #include <pcl/features/integral_image_normal.h>
 #include <pcl/filters/passthrough.h>
 #include <pcl/recognition/cg/geometric_consistency.h>
-#include <pcl/registration/icp.h>
 #include <boost/format.hpp>
 #include <boost/program_options.hpp>
 
@@ -77,6 +76,7 @@
 #include <v4r/keypoints/all_headers.h>
 #include <v4r/ml/all_headers.h>
 #include <v4r/recognition/global_recognition_pipeline.h>
+#include <v4r/recognition/icp_pose_refiner.h>
 #include <v4r/recognition/multiview_recognizer.h>
 #include <v4r/registration/noise_model_based_cloud_integration.h>
 #include <v4r/segmentation/plane_utils.h>
@@ -250,6 +250,8 @@ void ObjectRecognizer<PointT>::initialize(std::vector<std::string> &command_line
   SourceParameter source_param;
   if (render_training_views_from_mesh_model)
     source_param.view_folder_name_ = "rendered_views";
+  if (param_.store_model_lods_)
+    source_param.lod_folder_name_ = "lod";
   model_database_.reset(new Source<PointT>(source_param));
   model_database_->init(models_dir_, object_models);
 
@@ -499,10 +501,13 @@ std::vector<ObjectHypothesesGroup> ObjectRecognizer<PointT>::recognize(
   //    }
 
   if (param_.skip_verification_ && param_.icp_iterations_) {
-    for (size_t ohg_id = 0; ohg_id < generated_object_hypotheses.size(); ohg_id++) {
-      for (size_t oh_id = 0; oh_id < generated_object_hypotheses[ohg_id].ohs_.size(); oh_id++) {
-        ObjectHypothesis::Ptr &oh = generated_object_hypotheses[ohg_id].ohs_[oh_id];
+    pcl::StopWatch t;
+    const std::string time_desc("Pose refinement");
 
+    std::vector<ObjectHypothesis::Ptr> ohs;
+    std::vector<typename pcl::PointCloud<PointT>::ConstPtr> model_clouds_aligned;
+    for (ObjectHypothesesGroup &ohg : generated_object_hypotheses) {
+      for (ObjectHypothesis::Ptr &oh : ohg.ohs_) {
         bool found_model_foo;
         typename Model<PointT>::ConstPtr m = model_database_->getModelById("", oh->model_id_, found_model_foo);
         typename pcl::PointCloud<PointT>::ConstPtr model_cloud =
@@ -512,26 +517,31 @@ std::vector<ObjectHypothesesGroup> ObjectRecognizer<PointT>::recognize(
         typename pcl::PointCloud<PointT>::Ptr model_cloud_aligned(new pcl::PointCloud<PointT>);
         pcl::transformPointCloud(*model_cloud, *model_cloud_aligned, hyp_tf_2_global);
 
-        typename pcl::search::KdTree<PointT>::Ptr kdtree_scene(new pcl::search::KdTree<PointT>);
-        kdtree_scene->setInputCloud(processed_cloud);
-        pcl::IterativeClosestPoint<PointT, PointT> icp;
-        icp.setInputSource(model_cloud_aligned);
-        icp.setInputTarget(processed_cloud);
-        icp.setTransformationEpsilon(1e-6);
-        icp.setMaximumIterations(static_cast<int>(param_.icp_iterations_));
-        icp.setMaxCorrespondenceDistance(0.02);
-        icp.setSearchMethodTarget(kdtree_scene, true);
-        pcl::PointCloud<PointT> aligned_visible_model;
-        icp.align(aligned_visible_model);
-
-        Eigen::Matrix4f pose_refinement;
-        if (icp.hasConverged()) {
-          pose_refinement = icp.getFinalTransformation();
-          oh->pose_refinement_ = pose_refinement * oh->pose_refinement_;
-        } else
-          LOG(WARNING) << "ICP did not converge" << std::endl;
+        ohs.push_back(oh);
+        model_clouds_aligned.push_back(model_cloud_aligned);
       }
     }
+
+    // the scene search structure is set up once and shared by all hypotheses
+    IcpPoseRefiner<PointT> pose_refiner(static_cast<int>(param_.icp_iterations_), 0.02, 1e-6);
+    if (param_.icp_projective_lookup_ && processed_cloud->isOrganized())
+      pose_refiner.setOrganizedScene(processed_cloud, param_.cam_);
+    else
+      pose_refiner.setScene(processed_cloud);
+
+    std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f>> pose_refinements;
+    const std::vector<bool> converged = pose_refiner.refine(model_clouds_aligned, pose_refinements);
+
+    for (size_t i = 0; i < ohs.size(); i++) {
+      if (converged[i])
+        ohs[i]->pose_refinement_ = pose_refinements[i] * ohs[i]->pose_refinement_;
+      else
+        LOG(WARNING) << "ICP did not converge" << std::endl;
+    }
+
+    double time = t.getTime();
+    VLOG(1) << time_desc << " of " << ohs.size() << " hypotheses took " << time << " ms.";
+    elapsed_time_.push_back(std::pair<std::string, float>(time_desc, time));
   }
 
   if (!param_.skip_verification_) {
@@ -566,6 +576,9 @@ std::vector<ObjectHypothesesGroup> ObjectRecognizer<PointT>::recognize(
       size_t num_views = std::min<size_t>(param_.multiview_max_views_, views_.size() + 1);
       LOG(INFO) << "Running multi-view recognition over " << num_views;
 
+      if (!nm_integration_)
+        nm_integration_.reset(new IncrementalNMBasedCloudIntegration<PointT>(nm_int_param));
+
 #if HAVE_V4R_CHANGE_DETECTION
       if (param_.use_change_detection_ && !views_.empty()) {
         pcl::StopWatch t;
@@ -611,6 +624,11 @@ std::vector<ObjectHypothesesGroup> ObjectRecognizer<PointT>::recognize(
                 p.x = p.y = p.z = std::numeric_limits<float>::quiet_NaN();
               }
             }
+
+            // re-integrate the view without the removed points (if it is still part of the sliding window). The
+            // view keeps its position such that the oldest view still leaves the sliding window first
+            nm_integration_->replaceView(vv.integration_id_, *vv.processed_cloud_, *vv.cloud_normals_,
+                                         vv.pt_properties_, vv.camera_pose_);
             LOG(INFO) << "Points removed in view " << v_id
                       << " by change detection: " << vv.processed_cloud_->points.size() - preserved_indices.size()
                       << ".";
@@ -630,37 +648,26 @@ std::vector<ObjectHypothesesGroup> ObjectRecognizer<PointT>::recognize(
       views_.push_back(v);
 
       std::vector<typename pcl::PointCloud<PointT>::ConstPtr> views(num_views);  ///< all views in multi-view sequence
-      std::vector<typename pcl::PointCloud<PointT>::ConstPtr> processed_views(
-          num_views);  ///< all processed views in multi-view sequence
       std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f>> camera_poses(
           num_views);  ///< all absolute camera poses in multi-view sequence
-      std::vector<pcl::PointCloud<pcl::Normal>::ConstPtr> views_normals(
-          num_views);  ///< all view normals in multi-view sequence
-      std::vector<std::vector<std::vector<float>>> views_pt_properties(
-          num_views);  ///< all Nguyens noise model point properties in multi-view sequence
 
       size_t tmp_id = 0;
       for (size_t v_id = views_.size() - num_views; v_id < views_.size(); v_id++) {
         const View &vv = views_[v_id];
         views[tmp_id] = vv.cloud_;
-        processed_views[tmp_id] = vv.processed_cloud_;
         camera_poses[tmp_id] = vv.camera_pose_;  // take the current view as the new common reference frame
-        views_normals[tmp_id] = vv.cloud_normals_;
-        views_pt_properties[tmp_id] = vv.pt_properties_;
         tmp_id++;
       }
 
       {
         pcl::StopWatch t;
         const std::string time_desc("Noise model based cloud integration");
-        registered_scene_cloud_.reset(new pcl::PointCloud<PointT>);
-        NMBasedCloudIntegration<PointT> nmIntegration(nm_int_param);
-        nmIntegration.setInputClouds(processed_views);
-        nmIntegration.setPointProperties(views_pt_properties);
-        nmIntegration.setTransformations(camera_poses);
-        nmIntegration.setInputNormals(views_normals);
-        nmIntegration.compute(registered_scene_cloud_);  // is in global reference frame
-        nmIntegration.getOutputNormals(normals);
+        // only the new view is integrated, views leaving the sliding window are removed again
+        views_.back().integration_id_ =
+            nm_integration_->addView(*v.processed_cloud_, *v.cloud_normals_, v.pt_properties_, v.camera_pose_);
+        while (nm_integration_->getNumViews() > num_views)
+          nm_integration_->removeOldestView();
+        nm_integration_->compute(registered_scene_cloud_, normals);  // is in global reference frame
 
         double time = t.getTime();
         VLOG(1) << time_desc << " took " << time << " ms.";
@@ -810,6 +817,9 @@ void ObjectRecognizer<PointT>::resetMultiView() {
   if (param_.use_multiview_) {
     views_.clear();
 
+    if (nm_integration_)
+      nm_integration_->clear();
+
     typename v4r::MultiviewRecognizer<PointT>::Ptr mv_rec =
         std::dynamic_pointer_cast<v4r::MultiviewRecognizer<PointT>>(mrec_);
     if (mrec_)
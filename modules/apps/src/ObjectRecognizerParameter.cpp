@@ -82,9 +82,17 @@ void ObjectRecognizerParameter::init(boost::program_options::options_description
       po::value<bool>(&remove_non_upright_objects_)->default_value(remove_non_upright_objects_),
       "remove all hypotheses that are not standing upright on a support plane (support plane extraction must be "
       "enabled)");
+  desc.add_options()((section_name + ".store_model_lods").c_str(),
+                     po::value<bool>(&store_model_lods_)->default_value(store_model_lods_),
+                     "if true, stores voxelized versions of the object models next to the models, so they are only "
+                     "computed once across runs");
   desc.add_options()((section_name + ".icp_iterations").c_str(),
                      po::value<size_t>(&icp_iterations_)->default_value(icp_iterations_),
                      "ICP iterations. Only used if hypotheses are not verified. Otherwise ICP is done inside HV");
+  desc.add_options()((section_name + ".icp_projective_lookup").c_str(),
+                     po::value<bool>(&icp_projective_lookup_)->default_value(icp_projective_lookup_),
+                     "if true and the scene is organized, ICP (without verification) finds correspondences by "
+                     "projecting the model points into the image plane instead of searching a kd-tree of the scene");
   desc.add_options()("skip_verification", po::bool_switch(&skip_verification_),
                      "if true, skips verification (only hypotheses generation)");
   desc.add_options()("visualization.hv_vis_cues", po::bool_switch(&visualize_hv_go_cues_),
@@ -68,7 +68,9 @@ void ViewRenderer::render(const bf::path &input_path, const bf::path &out_path)
     }
   }
 
-  v4r::DepthmapRenderer renderer(static_cast<int>(cam_.w), static_cast<int>(cam_.h));
+  v4r::DepthmapRenderer renderer(
+      static_cast<int>(cam_.w), static_cast<int>(cam_.h),
+      param_.software ? v4r::DepthmapRenderer::Backend::SOFTWARE : v4r::DepthmapRenderer::Backend::OPENGL);
   renderer.setIntrinsics(cam_.fx, cam_.fy, cam_.cx, cam_.cy);
 
   v4r::DepthmapRendererModel model(input_path.string(), "", param_.autoscale);
@@ -96,13 +98,13 @@ void ViewRenderer::render(const bf::path &input_path, const bf::path &out_path)
   if (!sphere.empty())
     v4r::io::createDirIfNotExist(out_path);
 
+  // the software rasterizer is thread-safe, so views are rendered in parallel
+#pragma omp parallel for schedule(dynamic) if (param_.software)
   for (size_t i = 0; i < sphere.size(); i++) {
     // get point from list
     const Eigen::Vector3f &point = sphere[i];
     // get a camera pose looking at the center:
-    const Eigen::Matrix4f &orientation = renderer.getPoseLookingToCenterFrom(point);
-
-    renderer.setCamPose(orientation);
+    const Eigen::Matrix4f orientation = renderer.getPoseLookingToCenterFrom(point);
 
     float visible;
     cv::Mat color;
@@ -115,7 +117,7 @@ void ViewRenderer::render(const bf::path &input_path, const bf::path &out_path)
 
     bf::path output_fn = out_path / ss.str();
     if (model.hasColor() || model.hasTexture()) {
-      const pcl::PointCloud<pcl::PointXYZRGB> cloud = renderer.renderPointcloudColor(visible);
+      const pcl::PointCloud<pcl::PointXYZRGB> cloud = renderer.renderPointcloudColor(orientation, visible);
 
       pcl::io::savePCDFileBinaryCompressed(output_fn.string(), cloud);
 
@@ -132,7 +134,7 @@ void ViewRenderer::render(const bf::path &input_path, const bf::path &out_path)
       indices_f.close();
 
     } else {
-      const pcl::PointCloud<pcl::PointXYZ> cloud = renderer.renderPointcloud(visible);
+      const pcl::PointCloud<pcl::PointXYZ> cloud = renderer.renderPointcloud(orientation, visible);
       pcl::io::savePCDFileBinaryCompressed(output_fn.string(), cloud);
 
       cam_pose = v4r::RotTrans2Mat4f(cloud.sensor_orientation_, cloud.sensor_origin_);
@@ -52,6 +52,7 @@
 #include <stdio.h>
 #include <algorithm>
 #include <cstdlib>
+#include <memory>
 #include <set>
 #include <vector>
 
@@ -91,8 +92,8 @@ class GraphCut {
   bool have_relations;
   std::vector<v4r::Relation> relations;
 
-  gc::Edge *edges;  ///< Edges between the nodes, representing a probability
-  universe *u;      ///< universe to cut graph
+  std::vector<gc::Edge> edges;  ///< Edges between the nodes, representing a probability
+  std::unique_ptr<universe> u;  ///< universe to cut graph
 
   std::string ClassName;
 
@@ -105,6 +106,9 @@ class GraphCut {
 
   /** Process graph cut **/
   void process();
+
+  /** Process graph cut directly on the relations: merged patches average their relations to common neighbours.
+   *  Universes are kept in a union-find structure and the relations of each patch in a CSR graph built once. **/
   void process2();
 
   /** Print the results of the graph cut **/
@@ -55,9 +55,12 @@
 #include <fstream>
 #include <iostream>
 #include <ostream>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include <v4r/common/dense_svm_predictor.h>
+
 #include "v4r/attention_segmentation//SurfaceModel.h"
 #include "v4r/attention_segmentation/svm.h"
 
@@ -77,6 +80,7 @@ class SVMPredictorSingle {
   bool have_type;
 
   struct svm_model *model;  ///< SVM model
+  std::shared_ptr<v4r::DenseSVMPredictor<svm_model>> dense_model;  ///< model for batched classification of relations
 
   bool predict_probability;  ///< Predict with probability values
   std::vector<v4r::Relation> relations;
@@ -16,7 +16,7 @@ along with this program; if not, write to the Free Software
 Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
 */
 
-// disjoint-set forests using union-by-rank and path compression (sort of).
+// disjoint-set forests using union-by-rank and path compression.
 
 #ifndef GC_DISJOINT_SET
 #define GC_DISJOINT_SET
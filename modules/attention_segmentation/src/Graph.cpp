@@ -47,6 +47,7 @@
 
 #include "v4r/attention_segmentation/Graph.h"
 #include <cmath>
+#include <unordered_set>
 
 #ifndef GC_DEBUG
 #define GC_DEBUG true
@@ -108,25 +109,25 @@ void Graph::BuildFromSVM(std::vector<gc::Edge> &e, unsigned &num_edges, std::vec
 
   // Connectivity check for graph
   //@ep: create connected graph?
-  bool find_sink = false;
   int sink = 0;
   for (unsigned i = 0; i < surfaces.size(); i++) {
-    if (!(surfaces.at(i)->selected))
-      continue;
-
-    if (!find_sink) {
+    if (surfaces.at(i)->selected) {
       sink = i;
-      find_sink = true;
+      break;
     }
+  }
 
-    bool node_found = false;
-    for (unsigned j = 0; j < relations.size(); j++) {
-      if (relations[j].id_0 == sink && relations[j].id_1 == ((int)i)) {
-        node_found = true;
-      }
-    }
+  std::unordered_set<int> connected_to_sink;
+  for (unsigned j = 0; j < relations.size(); j++) {
+    if (relations[j].id_0 == sink)
+      connected_to_sink.insert(relations[j].id_1);
+  }
+
+  for (unsigned i = 0; i < surfaces.size(); i++) {
+    if (!(surfaces.at(i)->selected))
+      continue;
 
-    if (!node_found) {
+    if (connected_to_sink.find(i) == connected_to_sink.end()) {
       if (GC_DEBUG)
         printf("[Graph::BuildFromSVM] Warning: Node without relation: Add relation: %u-%u.\n", 0, i);
 
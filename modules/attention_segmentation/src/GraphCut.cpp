@@ -47,6 +47,12 @@
 
 #include "v4r/attention_segmentation/GraphCut.h"
 
+#include <deque>
+#include <iterator>
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
+
 #ifndef GC_DEBUG
 #define GC_DEBUG false
 #endif
@@ -56,6 +62,17 @@ namespace gc {
 bool smallerEdge(const gc::Edge &, const gc::Edge &);
 bool smallerRelations(const v4r::Relation &, const v4r::Relation &);
 
+namespace {
+/**
+ * @brief Hash key of an (unordered) pair of surface ids.
+ */
+inline unsigned long long relationKey(int a, int b) {
+  if (a > b)
+    std::swap(a, b);
+  return (static_cast<unsigned long long>(static_cast<unsigned>(a)) << 32) | static_cast<unsigned>(b);
+}
+}  // namespace
+
 /**
  * @brief Constructor of GraphCut
  */
@@ -98,22 +115,17 @@ bool GraphCut::init() {
 
   if (createAllRelations) {
     int maxID = 0;
+    std::unordered_set<unsigned long long> existing_relations(2 * relations.size());
     for (unsigned int i = 0; i < relations.size(); i++) {
       if (relations.at(i).id_0 > maxID)
         maxID = relations.at(i).id_0;
       if (relations.at(i).id_1 > maxID)
         maxID = relations.at(i).id_1;
+      existing_relations.insert(relationKey(relations.at(i).id_0, relations.at(i).id_1));
     }
     for (int i = 0; i < maxID; i++) {
       for (int j = i + 1; j <= maxID; j++) {
-        bool foundRelation = false;
-        for (int k = 0; k < (int)relations.size(); k++) {
-          if ((relations.at(k).id_0 == i && relations.at(k).id_1 == j) ||
-              (relations.at(k).id_1 == i && relations.at(k).id_0 == j)) {
-            foundRelation = true;
-          }
-        }
-        if (!foundRelation) {
+        if (existing_relations.find(relationKey(i, j)) == existing_relations.end()) {
           v4r::Relation r;
           r.id_0 = i;
           r.id_1 = j;
@@ -127,19 +139,15 @@ bool GraphCut::init() {
     }
   }
 
-  std::vector<gc::Edge> e;
   Graph graph(surfaces, relations);
 
-  graph.BuildFromSVM(e, num_edges, surfaces_reindex2);
-  edges = new gc::Edge[num_edges];
-  for (unsigned i = 0; i < num_edges; i++)
-    edges[i] = e[i];
+  graph.BuildFromSVM(edges, num_edges, surfaces_reindex2);
 
   if (num_edges == 0) {
     initialized = false;
     return false;
   } else {
-    u = new universe(num_edges);
+    u.reset(new universe(num_edges));
     initialized = true;
     if (GC_DEBUG)
       printf("[GraphCut::Initialize] num_edges: %u\n", num_edges);
@@ -173,12 +181,10 @@ void GraphCut::process() {
     printf("[GraphCut::process] Start processing.\n");
 
   // sort edges by weight
-  std::sort(edges, edges + num_edges, smallerEdge);
+  std::sort(edges.begin(), edges.end(), smallerEdge);
 
   // init thresholds
-  float *threshold = new float[num_edges];
-  for (unsigned i = 0; i < num_edges; i++)
-    threshold[i] = THRESHOLD(1, THRESHOLD_CONSTANT);
+  std::vector<float> threshold(num_edges, THRESHOLD(1, THRESHOLD_CONSTANT));
 
   if (GC_DEBUG)
     printf("THRESHOLD: %4.3f\n", threshold[0]);
@@ -277,8 +283,8 @@ void GraphCut::process() {
     }
   }
 
-  delete[] threshold;
-  delete[] edges;
+  edges.clear();
+  u.reset();
   initialized = false;
   processed = true;
 }
@@ -304,13 +310,39 @@ void GraphCut::process2() {
     }
   }
 
-  std::vector<std::vector<int>> universe(surfaces.size());
-  std::vector<float> threshold(surfaces.size());
+  const int num_surfaces = static_cast<int>(surfaces.size());
 
-  for (unsigned int i = 0; i < surfaces.size(); ++i) {
-    threshold.at(i) = THRESHOLD_CONSTANT;
-    if (surfaces.at(i)->selected)
-      universe.at(i).push_back(i);
+  // CSR graph: relations of each surface patch in non-decreasing weight order
+  std::vector<int> adjacency_start(num_surfaces + 1, 0);
+  for (const v4r::Relation &r : relations) {
+    adjacency_start.at(r.id_0 + 1)++;
+    if (r.id_1 != r.id_0)
+      adjacency_start.at(r.id_1 + 1)++;
+  }
+  std::partial_sum(adjacency_start.begin(), adjacency_start.end(), adjacency_start.begin());
+  std::vector<int> adjacency(adjacency_start.back());
+  std::vector<int> adjacency_fill(adjacency_start.begin(), adjacency_start.end() - 1);
+  for (unsigned int r_idx = 0; r_idx < relations.size(); r_idx++) {
+    adjacency[adjacency_fill[relations[r_idx].id_0]++] = r_idx;
+    if (relations[r_idx].id_1 != relations[r_idx].id_0)
+      adjacency[adjacency_fill[relations[r_idx].id_1]++] = r_idx;
+  }
+
+  // universes (sets of merged patches) are kept in a union-find structure, all other properties are stored at the
+  // root. The id of a universe is the id of the patch it was first created from (as for the kept universe of a merge).
+  universe universes(num_surfaces);
+  std::vector<int> universe_id(num_surfaces);
+  std::vector<float> threshold(num_surfaces, THRESHOLD_CONSTANT);
+  std::vector<int> universe_size(num_surfaces, 0);  ///< number of (selected) patches
+  std::vector<int> universe_points(num_surfaces, 0);
+  std::vector<std::vector<int>> universe_relations(num_surfaces);  ///< unused relations to other universes
+  for (int i = 0; i < num_surfaces; ++i) {
+    universe_id[i] = i;
+    if (surfaces.at(i)->selected) {
+      universe_size[i] = 1;
+      universe_points[i] = surfaces.at(i)->indices.size();
+    }
+    universe_relations[i].assign(adjacency.begin() + adjacency_start[i], adjacency.begin() + adjacency_start[i + 1]);
   }
 
   // for each edge, in non-decreasing weight order...
@@ -318,167 +350,101 @@ void GraphCut::process2() {
     if (used_relations.at(r_idx))
       continue;
 
-    // if probability that patches are disconnected by relation is lower than constant, than connect paths
-    if (((relations.at(r_idx).rel_probability[0]) <= (threshold.at(relations.at(r_idx).id_0))) &&
-        ((relations.at(r_idx).rel_probability[0]) <= (threshold.at(relations.at(r_idx).id_1)))) {
-      int id_0 = relations.at(r_idx).id_0;
-      int id_1 = relations.at(r_idx).id_1;
-
-      // calculate the size of each universe
-      int uni0_size = 0;
-      for (unsigned int i = 0; i < universe.at(id_0).size(); ++i) {
-        uni0_size += surfaces.at(universe.at(id_0).at(i))->indices.size();
-      }
-      int uni1_size = 0;
-      for (unsigned int i = 0; i < universe.at(id_1).size(); ++i) {
-        uni1_size += surfaces.at(universe.at(id_1).at(i))->indices.size();
-      }
-
-      float w_uni0 = ((float)uni0_size) / ((float)uni0_size + (float)uni1_size);
-      float w_uni1 = ((float)uni1_size) / ((float)uni0_size + (float)uni1_size);
-
-      // add one part of the universe to another
-      if (uni0_size > uni1_size) {
-        // id_1 --> id_0
-        for (unsigned int i = 0; i < universe.at(id_1).size(); ++i) {
-          universe.at(id_0).push_back(universe.at(id_1).at(i));
-        }
-        universe.at(id_1).clear();
-        threshold.at(id_0) =
-            relations.at(r_idx).rel_probability[0] + THRESHOLD(universe.at(id_0).size(), THRESHOLD_CONSTANT);
-        used_relations.at(r_idx) = true;
-
-        for (unsigned int i = 0; i < relations.size(); ++i) {
-          if (used_relations.at(i))
-            continue;
-
-          if ((relations.at(i).id_0 == id_0) && (relations.at(i).id_1 != id_1)) {
-            int new_id = relations.at(i).id_1;
-            for (unsigned int j = 0; j < relations.size(); ++j) {
-              if (used_relations.at(j))
-                continue;
-
-              if (((relations.at(j).id_0 == new_id) && (relations.at(j).id_1 == id_1)) ||
-                  ((relations.at(j).id_0 == id_1) && (relations.at(j).id_1 == new_id))) {
-                //                 relations.at(i).id_1 = id_0;
-                relations.at(i).rel_probability[0] =
-                    w_uni1 * relations.at(j).rel_probability[0] + w_uni0 * relations.at(i).rel_probability[0];
-                relations.at(i).rel_probability[1] = 1 - relations.at(j).rel_probability[0];
-                used_relations.at(j) = true;
-                break;
-              }
-            }
-          } else if ((relations.at(i).id_1 == id_0) && (relations.at(i).id_0 != id_1)) {
-            int new_id = relations.at(i).id_0;
-            for (unsigned int j = 0; j < relations.size(); ++j) {
-              if (used_relations.at(j))
-                continue;
-
-              if (((relations.at(j).id_0 == new_id) && (relations.at(j).id_1 == id_1)) ||
-                  ((relations.at(j).id_0 == id_1) && (relations.at(j).id_1 == new_id))) {
-                //                 relations.at(i).id_1 = id_0;
-                relations.at(i).rel_probability[0] =
-                    w_uni1 * relations.at(j).rel_probability[0] + w_uni0 * relations.at(i).rel_probability[0];
-                relations.at(i).rel_probability[1] = 1 - relations.at(j).rel_probability[0];
-                used_relations.at(j) = true;
-                break;
-              }
-            }
-          }
-        }
-
-        for (unsigned int i = 0; i < relations.size(); ++i) {
-          if (used_relations.at(i))
-            continue;
-
-          if (relations.at(i).id_0 == id_1) {
-            relations.at(i).id_0 = id_0;
-          } else if (relations.at(i).id_1 == id_1) {
-            relations.at(i).id_1 = id_0;
-          }
-        }
+    int root_0 = universes.find(relations.at(r_idx).id_0);
+    int root_1 = universes.find(relations.at(r_idx).id_1);
+    if (root_0 == root_1)
+      continue;
 
-      } else {
-        // id_0 --> id_1
-        for (unsigned int i = 0; i < universe.at(id_0).size(); ++i) {
-          universe.at(id_1).push_back(universe.at(id_0).at(i));
-        }
-        universe.at(id_0).clear();
-        threshold.at(id_1) =
-            relations.at(r_idx).rel_probability[0] + THRESHOLD(universe.at(id_1).size(), THRESHOLD_CONSTANT);
-        used_relations.at(r_idx) = true;
-
-        for (unsigned int i = 0; i < relations.size(); ++i) {
-          if (used_relations.at(i))
-            continue;
-
-          if ((relations.at(i).id_0 == id_1) && (relations.at(i).id_1 != id_0)) {
-            int new_id = relations.at(i).id_1;
-            for (unsigned int j = 0; j < relations.size(); ++j) {
-              if (used_relations.at(j))
-                continue;
-
-              if (((relations.at(j).id_0 == new_id) && (relations.at(j).id_1 == id_0)) ||
-                  ((relations.at(j).id_0 == id_0) && (relations.at(j).id_1 == new_id))) {
-                //                 relations.at(i).id_1 = id_0;
-                relations.at(i).rel_probability[0] =
-                    w_uni1 * relations.at(j).rel_probability[0] + w_uni0 * relations.at(i).rel_probability[0];
-                relations.at(i).rel_probability[1] = 1 - relations.at(j).rel_probability[0];
-                used_relations.at(j) = true;
-                break;
-              }
-            }
-          } else if ((relations.at(i).id_1 == id_1) && (relations.at(i).id_0 != id_0)) {
-            int new_id = relations.at(i).id_0;
-            for (unsigned int j = 0; j < relations.size(); ++j) {
-              if (used_relations.at(j))
-                continue;
-
-              if (((relations.at(j).id_0 == new_id) && (relations.at(j).id_1 == id_0)) ||
-                  ((relations.at(j).id_0 == id_0) && (relations.at(j).id_1 == new_id))) {
-                //                 relations.at(i).id_1 = id_0;
-                relations.at(i).rel_probability[0] =
-                    w_uni1 * relations.at(j).rel_probability[0] + w_uni0 * relations.at(i).rel_probability[0];
-                relations.at(i).rel_probability[1] = 1 - relations.at(j).rel_probability[0];
-                used_relations.at(j) = true;
-                break;
-              }
-            }
-          }
-        }
+    // if probability that patches are disconnected by relation is lower than constant, than connect paths
+    const double p_disconnected = relations.at(r_idx).rel_probability[0];
+    if (!((p_disconnected <= threshold[root_0]) && (p_disconnected <= threshold[root_1])))
+      continue;
 
-        for (unsigned int i = 0; i < relations.size(); ++i) {
-          if (used_relations.at(i))
-            continue;
+    float w_uni0 = ((float)universe_points[root_0]) / ((float)universe_points[root_0] + (float)universe_points[root_1]);
+    float w_uni1 = ((float)universe_points[root_1]) / ((float)universe_points[root_0] + (float)universe_points[root_1]);
+    used_relations.at(r_idx) = true;
+
+    // add the smaller universe to the bigger one
+    const int kept = (universe_points[root_0] > universe_points[root_1]) ? root_0 : root_1;
+    const int merged = (kept == root_0) ? root_1 : root_0;
+
+    // relations of the merged universe to each neighbouring universe, in non-decreasing weight order
+    std::unordered_map<int, std::deque<int>> merged_relations;
+    for (int j : universe_relations[merged]) {
+      if (used_relations.at(j))
+        continue;
+      int ngbr_0 = universes.find(relations.at(j).id_0);
+      int ngbr = (ngbr_0 == merged) ? universes.find(relations.at(j).id_1) : ngbr_0;
+      if (ngbr != merged && ngbr != kept)
+        merged_relations[ngbr].push_back(j);
+    }
 
-          if (relations.at(i).id_0 == id_0) {
-            relations.at(i).id_0 = id_1;
-          } else if (relations.at(i).id_1 == id_0) {
-            relations.at(i).id_1 = id_1;
-          }
-        }
-      }
+    // a relation of the kept universe to a common neighbour is averaged with the relation of the merged universe
+    for (int i : universe_relations[kept]) {
+      if (used_relations.at(i))
+        continue;
+      int ngbr_0 = universes.find(relations.at(i).id_0);
+      int ngbr = (ngbr_0 == kept) ? universes.find(relations.at(i).id_1) : ngbr_0;
+      if (ngbr == kept || ngbr == merged)
+        continue;
+
+      auto it = merged_relations.find(ngbr);
+      if (it == merged_relations.end() || it->second.empty())
+        continue;
+
+      int j = it->second.front();
+      it->second.pop_front();
+      relations.at(i).rel_probability[0] =
+          w_uni1 * relations.at(j).rel_probability[0] + w_uni0 * relations.at(i).rel_probability[0];
+      relations.at(i).rel_probability[1] = 1 - relations.at(j).rel_probability[0];
+      used_relations.at(j) = true;
     }
+
+    const int kept_id = universe_id[kept];
+    const int merged_size = universe_size[kept] + universe_size[merged];
+    const int merged_points = universe_points[kept] + universe_points[merged];
+    std::vector<int> relations_kept, relations_merged;
+    relations_kept.swap(universe_relations[kept]);
+    relations_merged.swap(universe_relations[merged]);
+
+    universes.join(kept, merged);
+    const int root = universes.find(kept);
+    universe_id[root] = kept_id;
+    universe_size[root] = merged_size;
+    universe_points[root] = merged_points;
+    threshold[root] = p_disconnected + THRESHOLD(merged_size, THRESHOLD_CONSTANT);
+
+    // remaining relations of the new universe to other universes (relations in between the two are dropped)
+    std::vector<int> &root_relations = universe_relations[root];
+    root_relations.reserve(relations_kept.size() + relations_merged.size());
+    std::merge(relations_kept.begin(), relations_kept.end(), relations_merged.begin(), relations_merged.end(),
+               std::back_inserter(root_relations));
+    root_relations.erase(std::remove_if(root_relations.begin(), root_relations.end(),
+                                        [&](int i) {
+                                          return used_relations.at(i) || universes.find(relations.at(i).id_0) ==
+                                                                             universes.find(relations.at(i).id_1);
+                                        }),
+                         root_relations.end());
   }
 
-  std::vector<int> universe_number(universe.size(), -1);
+  // number the non-empty universes in the order of their ids
+  std::vector<bool> non_empty_universe(num_surfaces, false);
+  for (int i = 0; i < num_surfaces; ++i) {
+    int root = universes.find(i);
+    if (universe_size[root] > 0)
+      non_empty_universe[universe_id[root]] = true;
+  }
+  std::vector<int> universe_number(num_surfaces, -1);
   int current_uni_number = 0;
-  for (unsigned int i = 0; i < universe.size(); ++i) {
-    if (universe.at(i).size() > 0) {
-      universe_number.at(i) = current_uni_number;
-      current_uni_number++;
-    }
+  for (int i = 0; i < num_surfaces; ++i) {
+    if (non_empty_universe[i])
+      universe_number[i] = current_uni_number++;
   }
 
-  for (unsigned int i = 0; i < surfaces.size(); ++i) {
+  for (int i = 0; i < num_surfaces; ++i) {
     surfaces.at(i)->label = -1;
-  }
-
-  for (unsigned int i = 0; i < universe.size(); ++i) {
-    for (unsigned int j = 0; j < universe.at(i).size(); ++j) {
-      int idx = universe.at(i).at(j);
-      surfaces.at(idx)->label = universe_number.at(i);
-    }
+    if (surfaces.at(i)->selected)
+      surfaces.at(i)->label = universe_number[universe_id[universes.find(i)]];
   }
 }
 }  // namespace gc
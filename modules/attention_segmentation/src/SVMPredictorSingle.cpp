@@ -94,6 +94,7 @@ void SVMPredictorSingle::setModelFilename(std::string _model_filename) {
   }
 
   have_model_filename = true;
+  dense_model.reset(new v4r::DenseSVMPredictor<svm_model>(model, LIBSVM_VERSION));
 
   node = (struct svm_node *)malloc(max_nr_attr * sizeof(struct svm_node));
   if (predict_probability) {
@@ -148,13 +149,40 @@ void SVMPredictorSingle::compute() {
         "to classify.");
   }
 
-  //@ep: reallocate node structure according to the size of the feature vector
-
+  // classify all relations of the requested type in one batch
+  std::vector<unsigned int> batch;
+  size_t num_features = 0;
   for (unsigned int i = 0; i < relations.size(); i++) {
     if (relations.at(i).type == type) {
-      relations.at(i).prediction = predict(relations.at(i).rel_value, relations.at(i).rel_probability);
+      if (scale)
+        scaleValues(relations.at(i).rel_value);
+      batch.push_back(i);
+      num_features = max(num_features, relations.at(i).rel_value.size());
     }
   }
+
+  Eigen::MatrixXd queries = Eigen::MatrixXd::Zero(batch.size(), num_features);
+  for (unsigned int b = 0; b < batch.size(); b++) {
+    const std::vector<double> &val = relations.at(batch[b]).rel_value;
+    for (unsigned int idx = 0; idx < val.size(); idx++)
+      queries(b, idx) = val[idx];
+  }
+
+  int svm_type = svm_get_svm_type(model);
+  Eigen::VectorXd labels;
+  Eigen::MatrixXd probabilities;
+  if (predict_probability && (svm_type == C_SVC || svm_type == NU_SVC))
+    dense_model->predictProbability(queries, labels, probabilities);
+  else
+    dense_model->predict(queries, labels);
+
+  for (unsigned int b = 0; b < batch.size(); b++) {
+    v4r::Relation &relation = relations.at(batch[b]);
+    relation.prediction = labels(b);
+    relation.rel_probability.resize(probabilities.cols());
+    for (int j = 0; j < probabilities.cols(); j++)
+      relation.rel_probability[j] = probabilities(b, j);
+  }
   //@ep: this function seems to be wrong to me
   // checkSmallPatches(30);
 }
@@ -16,7 +16,7 @@ along with this program; if not, write to the Free Software
 Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
 */
 
-// disjoint-set forests using union-by-rank and path compression (sort of).
+// disjoint-set forests using union-by-rank and path compression.
 
 #include "v4r/attention_segmentation/disjoint-set.h"
 
@@ -41,7 +41,12 @@ int universe::find(int x) {
   while (y != elts[y].p) {
     y = elts[y].p;
   }
-  elts[x].p = y;
+  // full path compression: every element on the path points directly to the root
+  while (x != y) {
+    int next = elts[x].p;
+    elts[x].p = y;
+    x = next;
+  }
   return y;
 }
 
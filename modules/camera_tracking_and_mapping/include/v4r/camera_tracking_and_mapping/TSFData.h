@@ -57,6 +57,7 @@
 #include <queue>
 #include <v4r/camera_tracking_and_mapping/Surfel.hh>
 #include <v4r/camera_tracking_and_mapping/TSFFrame.hh>
+#include <v4r/common/worker_mailbox.h>
 #include <v4r/common/impl/DataMatrix2D.hpp>
 
 namespace v4r {
@@ -93,6 +94,10 @@ class V4R_EXPORTS TSFData {
   Eigen::Matrix4f last_pose_map;
   bool lost_track;
 
+  // wake up the worker threads as soon as there is new data for them
+  WorkerMailbox init_mailbox;  /// new frame for the keyframe initialization of the klt tracker
+  WorkerMailbox map_mailbox;   /// new keyframe in map_frames
+
   TSFData();
   ~TSFData();
 
@@ -175,6 +175,16 @@ class V4R_EXPORTS TSFVisualSLAM {
   int getFilteredCloud(pcl::PointCloud<pcl::PointXYZRGB> &cloud, Eigen::Matrix4f &pose, double &timestamp);
   int getSurfelCloud(v4r::DataMatrix2D<Surfel> &cloud, Eigen::Matrix4f &pose, double &timestamp);
 
+  /**
+   * @brief getWorkerStatistics returns queue depth and wait times of the background threads, e.g. to measure the
+   * latency of the tracking pipeline
+   * @param init_tracking keyframe initialization of the klt pose tracker
+   * @param filtering temporal batch filter
+   * @param mapping keyframe mapping
+   */
+  void getWorkerStatistics(WorkerMailbox::Statistics &init_tracking, WorkerMailbox::Statistics &filtering,
+                           WorkerMailbox::Statistics &mapping) const;
+
   /**
    * @brief setCameraParameter
    * @param _intrinsic intrinsic camera parameter provided for tracking the organized point cloud
@@ -22,6 +22,7 @@
 #include <opencv2/core/core.hpp>
 #include <v4r/camera_tracking_and_mapping/Surfel.hh>
 #include <v4r/common/impl/DataMatrix2D.hpp>
+#include <v4r/common/worker_mailbox.h>
 #include "opencv2/imgproc/imgproc.hpp"
 #include "opencv2/video/tracking.hpp"
 
@@ -84,6 +85,7 @@ class V4R_EXPORTS TSFilterCloudsXYZRGB {
   cv::Mat_<cv::Vec3b> image, im_scaled;
 
   bool run, have_thread;
+  WorkerMailbox mailbox;  // wakes up the batch filter thread when a new frame is added
 
   boost::thread th_obectmanagement;
   boost::thread th_init;
@@ -149,6 +151,14 @@ class V4R_EXPORTS TSFilterCloudsXYZRGB {
   }
 
   int getSurfelCloud(v4r::DataMatrix2D<Surfel> &cloud, Eigen::Matrix4f &pose, double &timestamp);
+
+  /**
+   * @brief getMailboxStatistics
+   * @return queue depth and wait times of the batch filter thread
+   */
+  inline WorkerMailbox::Statistics getMailboxStatistics() const {
+    return mailbox.getStatistics();
+  }
   int getFilteredCloudNormals(pcl::PointCloud<pcl::PointXYZRGBNormal> &cloud, Eigen::Matrix4f &pose, double &timestamp);
   int getFilteredCloud(pcl::PointCloud<pcl::PointXYZRGB> &cloud, Eigen::Matrix4f &pose, double &timestamp);
 
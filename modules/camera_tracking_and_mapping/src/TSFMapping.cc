@@ -122,7 +122,7 @@ void TSFMapping::operate() {
     }
 
     if (!have_todo)
-      usleep(10000);
+      data->map_mailbox.wait();
   }
 }
 
@@ -577,6 +577,7 @@ void TSFMapping::start() {
     stop();
 
   run = true;
+  data->map_mailbox.open();
   th_obectmanagement = boost::thread(&TSFMapping::operate, this);
   have_thread = true;
 }
@@ -586,6 +587,8 @@ void TSFMapping::start() {
  */
 void TSFMapping::stop() {
   run = false;
+  if (data != NULL)
+    data->map_mailbox.close();
   th_obectmanagement.join();
   have_thread = false;
 }
@@ -114,7 +114,7 @@ void TSFPoseTrackerKLT::operate() {
     }
 
     if (!have_todo)
-      usleep(10000);
+      data->init_mailbox.wait();
   }
 }
 
@@ -401,6 +401,7 @@ void TSFPoseTrackerKLT::start() {
     stop();
 
   run = true;
+  data->init_mailbox.open();
   th_obectmanagement = boost::thread(&TSFPoseTrackerKLT::operate, this);
   have_thread = true;
 }
@@ -410,6 +411,8 @@ void TSFPoseTrackerKLT::start() {
  */
 void TSFPoseTrackerKLT::stop() {
   run = false;
+  if (data != NULL)
+    data->init_mailbox.close();
   th_obectmanagement.join();
   have_thread = false;
 }
@@ -445,6 +448,8 @@ void TSFPoseTrackerKLT::track(double &conf_ransac_iter, double &conf_tracked_poi
   } else {
     data->need_init = true;
   }
+
+  data->init_mailbox.post();
 }
 
 /**
@@ -219,6 +219,7 @@ bool TSFVisualSLAM::track(const pcl::PointCloud<pcl::PointXYZRGB> &cloud, const
         if (tsFilter.getFiltCloud().data.size() > 0) {
           data.map_frames.push(TSFFrame::Ptr(new TSFFrame(-1, tsFilter.getFiltTimestamp(), tsFilter.getFiltPose(),
                                                           tsFilter.getFiltCloud(), !data.lost_track)));
+          data.map_mailbox.post();
           data.lost_track = false;
           last_pose_map = tsFilter.getFiltPose();
           last_ts_filt = tsFilter.getFiltTimestamp();
@@ -272,6 +273,19 @@ int TSFVisualSLAM::getSurfelCloud(v4r::DataMatrix2D<Surfel> &cloud, Eigen::Matri
   return nb;
 }
 
+/**
+ * @brief TSFVisualSLAM::getWorkerStatistics
+ * @param init_tracking
+ * @param filtering
+ * @param mapping
+ */
+void TSFVisualSLAM::getWorkerStatistics(WorkerMailbox::Statistics &init_tracking, WorkerMailbox::Statistics &filtering,
+                                        WorkerMailbox::Statistics &mapping) const {
+  init_tracking = data.init_mailbox.getStatistics();
+  filtering = tsFilter.getMailboxStatistics();
+  mapping = data.map_mailbox.getStatistics();
+}
+
 /**
  * @brief TSFVisualSLAM::setParameter
  * @param p
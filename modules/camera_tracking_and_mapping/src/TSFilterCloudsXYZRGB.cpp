@@ -129,7 +129,7 @@ void TSFilterCloudsXYZRGB::operate() {
     }
 
     if (!have_todo)
-      usleep(10000);
+      mailbox.wait();
   }
 }
 
@@ -512,6 +512,7 @@ void TSFilterCloudsXYZRGB::start() {
     stop();
 
   run = true;
+  mailbox.open();
   th_obectmanagement = boost::thread(&TSFilterCloudsXYZRGB::operate, this);
   have_thread = true;
 }
@@ -521,6 +522,7 @@ void TSFilterCloudsXYZRGB::start() {
  */
 void TSFilterCloudsXYZRGB::stop() {
   run = false;
+  mailbox.close();
   th_obectmanagement.join();
   have_thread = false;
 }
@@ -553,12 +555,17 @@ void TSFilterCloudsXYZRGB::addCloud(const pcl::PointCloud<pcl::PointXYZRGB> &clo
   if (!have_track)
     frames.clear();
 
+  bool added = false;
   if (frames.size() == 0 || selectFrame(pose, frames.back().pose)) {
     frames.push_back({_timestamp, pose, pcl::PointCloud<pcl::PointXYZRGB>::Ptr(new pcl::PointCloud<pcl::PointXYZRGB>)});
     pcl::copyPointCloud(cloud, *frames.back().cloud);
+    added = true;
   }
 
   mtx_shm.unlock();
+
+  if (added)
+    mailbox.post();
 }
 
 /**
@@ -0,0 +1,460 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 TU Wien, ACIN, Vision 4 Robotics (V4R) group
+** Contact: v4r.acin.tuwien.ac.at
+**
+** This file is part of V4R
+**
+** V4R is distributed under dual licenses - GPLv3 or closed source.
+**
+** GNU General Public License Usage
+** V4R is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published
+** by the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** V4R is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** Please review the following information to ensure the GNU General Public
+** License requirements will be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+**
+** Commercial License Usage
+** If GPL is not suitable for your project, you must purchase a commercial
+** license to use V4R. Licensees holding valid commercial V4R licenses may
+** use this file in accordance with the commercial license agreement
+** provided with the Software or, alternatively, in accordance with the
+** terms contained in a written agreement between you and TU Wien, ACIN, V4R.
+** For licensing terms and conditions please contact office<at>acin.tuwien.ac.at.
+**
+**
+** The copyright holder additionally grants the author(s) of the file the right
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or
+** sell copies of their contributions without any restrictions.
+**
+****************************************************************************/
+
+/**
+ * @file dense_svm_predictor.h
+ * @brief Batched inference of trained libsvm models on dense feature vectors
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <Eigen/Core>
+#include <glog/logging.h>
+
+namespace v4r {
+
+/**
+ * @brief Evaluates a trained libsvm model for a whole batch of dense query vectors.
+ *
+ * The support vectors are copied once into a dense (column-major, aligned) matrix, so the kernel of a block of queries
+ * is computed against all support vectors in tight loops over contiguous memory (one SIMD lane per support vector)
+ * and blocks of queries are distributed over threads. Each kernel value is still accumulated over the features in
+ * ascending order, exactly as libsvm does on its sparse nodes, so decision values, labels and probability estimates are
+ * identical to svm_predict() and svm_predict_probability() (as long as the code is not built with -ffast-math) of the
+ * libsvm version given at construction.
+ * LINEAR, POLY, RBF and SIGMOID kernels are supported.
+ *
+ * @tparam SVMModel libsvm model struct (svm_model of libsvm or of its copy in the attention_segmentation module)
+ */
+template <typename SVMModel>
+class DenseSVMPredictor {
+ private:
+  int svm_type_;
+  int kernel_type_;
+  int degree_;
+  double gamma_;
+  double coef0_;
+
+  int nr_class_;
+  int l_;                    ///< number of support vectors
+  std::vector<int> label_;   ///< label of each class
+  std::vector<int> nSV_;     ///< number of support vectors of each class
+  std::vector<int> start_;   ///< index of the first support vector of each class
+  std::vector<double> rho_;  ///< constants of the decision functions
+  std::vector<double> probA_, probB_;
+  bool two_class_pairwise_prob_;  ///< if true, two-class probabilities are the pairwise probabilities (libsvm >= 3.25)
+  Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> sv_coef_;  ///< (nr_class - 1) x l
+  Eigen::MatrixXd sv_;  ///< support vectors (l x num features, column-major, i.e. each feature is contiguous)
+
+  enum { QUERY_BLOCK_SIZE = 8 };  ///< number of queries whose kernel values are computed together
+
+  enum { C_SVC_, NU_SVC_, ONE_CLASS_, EPSILON_SVR_, NU_SVR_ };  ///< libsvm svm types
+  enum { LINEAR_, POLY_, RBF_, SIGMOID_, PRECOMPUTED_ };        ///< libsvm kernel types
+
+  static double powi(double base, int times) {
+    double tmp = base, ret = 1.0;
+
+    for (int t = times; t > 0; t /= 2) {
+      if (t % 2 == 1)
+        ret *= tmp;
+      tmp = tmp * tmp;
+    }
+    return ret;
+  }
+
+  static double sigmoidPredict(double decision_value, double A, double B) {
+    double fApB = decision_value * A + B;
+    // 1-p used later; avoid catastrophic cancellation
+    if (fApB >= 0)
+      return exp(-fApB) / (1.0 + exp(-fApB));
+    else
+      return 1.0 / (1 + exp(fApB));
+  }
+
+  static void multiclassProbability(int k, const std::vector<double> &r, double *p);
+
+  bool isClassification() const {
+    return svm_type_ == C_SVC_ || svm_type_ == NU_SVC_;
+  }
+
+  /**
+   * @brief computes the kernel values of a block of queries against all support vectors
+   * @param queries query matrix (one query per row)
+   * @param first first query of the block
+   * @param num number of queries in the block (<= QUERY_BLOCK_SIZE)
+   * @param[out] kvalue kernel values (l x num, column-major)
+   */
+  void computeKernel(const Eigen::MatrixXd &queries, int first, int num, Eigen::MatrixXd &kvalue) const;
+
+  /**
+   * @brief computes the decision values of a single query as svm_predict_values() does
+   * @param kvalue kernel values of the query against all support vectors
+   * @param[out] dec_values decision values (nr_class*(nr_class-1)/2 for classification, 1 otherwise)
+   * @return predicted label (or regression value)
+   */
+  double decisionValues(const double *kvalue, double *dec_values) const;
+
+  /**
+   * @brief computes class probabilities of a single query from its decision values as svm_predict_probability() does
+   * @return predicted label
+   */
+  double probabilityEstimates(const double *dec_values, double *prob_estimates) const;
+
+  void predict(const Eigen::MatrixXd &queries, Eigen::VectorXd &labels, Eigen::MatrixXd *probabilities) const;
+
+ public:
+  /**
+   * @brief copies a trained model into the dense representation (the model can be freed afterwards)
+   * @param model libsvm model
+   * @param libsvm_version LIBSVM_VERSION of the libsvm the model struct belongs to (libsvm 3.25 changed how
+   * probabilities of two-class models are computed)
+   */
+  DenseSVMPredictor(const SVMModel *model, int libsvm_version);
+
+  /**
+   * @brief predicts the label (or regression value) of each query as svm_predict() does
+   * @param queries query matrix (one query per row, column i is the feature with libsvm index i+1)
+   * @param[out] labels predicted labels
+   */
+  void predict(const Eigen::MatrixXd &queries, Eigen::VectorXd &labels) const {
+    predict(queries, labels, nullptr);
+  }
+
+  /**
+   * @brief predicts the label and the class probabilities of each query as svm_predict_probability() does
+   * @param queries query matrix (one query per row, column i is the feature with libsvm index i+1)
+   * @param[out] labels predicted labels
+   * @param[out] probabilities class probabilities (one row per query, columns in the order of the model's labels).
+   * Empty if the model has no probability information (labels are then predicted as by predict()).
+   */
+  void predictProbability(const Eigen::MatrixXd &queries, Eigen::VectorXd &labels,
+                          Eigen::MatrixXd &probabilities) const {
+    predict(queries, labels, &probabilities);
+  }
+
+  /**
+   * @return true if the model provides probability estimates
+   */
+  bool hasProbabilityModel() const {
+    return isClassification() && !probA_.empty() && !probB_.empty();
+  }
+
+  int getNumClasses() const {
+    return nr_class_;
+  }
+
+  /**
+   * @return number of features stored per support vector
+   */
+  int getNumFeatures() const {
+    return static_cast<int>(sv_.cols());
+  }
+};
+
+template <typename SVMModel>
+DenseSVMPredictor<SVMModel>::DenseSVMPredictor(const SVMModel *model, int libsvm_version)
+: two_class_pairwise_prob_(libsvm_version >= 325) {
+  CHECK(model) << "No SVM model given!";
+  CHECK(model->param.kernel_type != PRECOMPUTED_) << "Precomputed kernels are not supported!";
+
+  svm_type_ = model->param.svm_type;
+  kernel_type_ = model->param.kernel_type;
+  degree_ = model->param.degree;
+  gamma_ = model->param.gamma;
+  coef0_ = model->param.coef0;
+  nr_class_ = model->nr_class;
+  l_ = model->l;
+
+  const int num_coef = isClassification() ? nr_class_ - 1 : 1;
+  const int num_models = isClassification() ? nr_class_ * (nr_class_ - 1) / 2 : 1;
+  sv_coef_.resize(num_coef, l_);
+  for (int c = 0; c < num_coef; c++)
+    for (int i = 0; i < l_; i++)
+      sv_coef_(c, i) = model->sv_coef[c][i];
+  rho_.assign(model->rho, model->rho + num_models);
+
+  if (isClassification()) {
+    if (model->label)
+      label_.assign(model->label, model->label + nr_class_);
+    if (model->nSV) {
+      nSV_.assign(model->nSV, model->nSV + nr_class_);
+      start_.resize(nr_class_);
+      start_[0] = 0;
+      for (int i = 1; i < nr_class_; i++)
+        start_[i] = start_[i - 1] + nSV_[i - 1];
+    }
+    if (model->probA && model->probB) {
+      probA_.assign(model->probA, model->probA + num_models);
+      probB_.assign(model->probB, model->probB + num_models);
+    }
+  }
+
+  int num_features = 0;
+  for (int i = 0; i < l_; i++)
+    for (const auto *node = model->SV[i]; node->index != -1; ++node)
+      num_features = std::max(num_features, node->index);
+
+  sv_ = Eigen::MatrixXd::Zero(l_, num_features);
+  for (int i = 0; i < l_; i++)
+    for (const auto *node = model->SV[i]; node->index != -1; ++node)
+      sv_(i, node->index - 1) = node->value;
+}
+
+template <typename SVMModel>
+void DenseSVMPredictor<SVMModel>::computeKernel(const Eigen::MatrixXd &queries, int first, int num,
+                                                Eigen::MatrixXd &kvalue) const {
+  kvalue.setZero(l_, num);
+  const int num_features = static_cast<int>(std::max<Eigen::Index>(sv_.cols(), queries.cols()));
+
+  // features are accumulated in ascending order for each (query, support vector) pair as in libsvm; features missing
+  // in either vector are zero and do not change the sums
+  for (int f = 0; f < num_features; f++) {
+    const bool sv_has_feature = f < sv_.cols();
+    const double *sv_f = sv_has_feature ? sv_.col(f).data() : nullptr;
+
+    for (int q = 0; q < num; q++) {
+      const double x = f < queries.cols() ? queries(first + q, f) : 0.;
+      double *k = kvalue.col(q).data();
+
+      if (kernel_type_ == RBF_) {
+        if (sv_has_feature) {
+          for (int i = 0; i < l_; i++) {
+            double d = x - sv_f[i];
+            k[i] += d * d;
+          }
+        } else {
+          for (int i = 0; i < l_; i++)
+            k[i] += x * x;
+        }
+      } else if (sv_has_feature) {
+        for (int i = 0; i < l_; i++)
+          k[i] += x * sv_f[i];
+      }
+    }
+  }
+
+  for (int q = 0; q < num; q++) {
+    double *k = kvalue.col(q).data();
+    switch (kernel_type_) {
+      case LINEAR_:
+        break;
+      case POLY_:
+        for (int i = 0; i < l_; i++)
+          k[i] = powi(gamma_ * k[i] + coef0_, degree_);
+        break;
+      case RBF_:
+        for (int i = 0; i < l_; i++)
+          k[i] = exp(-gamma_ * k[i]);
+        break;
+      case SIGMOID_:
+        for (int i = 0; i < l_; i++)
+          k[i] = tanh(gamma_ * k[i] + coef0_);
+        break;
+    }
+  }
+}
+
+template <typename SVMModel>
+double DenseSVMPredictor<SVMModel>::decisionValues(const double *kvalue, double *dec_values) const {
+  if (!isClassification()) {
+    double sum = 0;
+    for (int i = 0; i < l_; i++)
+      sum += sv_coef_(0, i) * kvalue[i];
+    sum -= rho_[0];
+    *dec_values = sum;
+
+    if (svm_type_ == ONE_CLASS_)
+      return (sum > 0) ? 1 : -1;
+    else
+      return sum;
+  }
+
+  std::vector<int> vote(nr_class_, 0);
+  int p = 0;
+  for (int i = 0; i < nr_class_; i++)
+    for (int j = i + 1; j < nr_class_; j++) {
+      double sum = 0;
+      int si = start_[i];
+      int sj = start_[j];
+      int ci = nSV_[i];
+      int cj = nSV_[j];
+
+      const double *coef1 = sv_coef_.row(j - 1).data();
+      const double *coef2 = sv_coef_.row(i).data();
+      for (int k = 0; k < ci; k++)
+        sum += coef1[si + k] * kvalue[si + k];
+      for (int k = 0; k < cj; k++)
+        sum += coef2[sj + k] * kvalue[sj + k];
+      sum -= rho_[p];
+      dec_values[p] = sum;
+
+      if (dec_values[p] > 0)
+        ++vote[i];
+      else
+        ++vote[j];
+      p++;
+    }
+
+  int vote_max_idx = 0;
+  for (int i = 1; i < nr_class_; i++)
+    if (vote[i] > vote[vote_max_idx])
+      vote_max_idx = i;
+
+  return label_[vote_max_idx];
+}
+
+template <typename SVMModel>
+void DenseSVMPredictor<SVMModel>::multiclassProbability(int k, const std::vector<double> &r, double *p) {
+  // Method 2 from the multiclass_prob paper by Wu, Lin, and Weng (as implemented in libsvm)
+  int t, j;
+  int iter = 0, max_iter = std::max(100, k);
+  std::vector<double> Q(k * k);
+  std::vector<double> Qp(k);
+  double pQp, eps = 0.005 / k;
+
+  for (t = 0; t < k; t++) {
+    p[t] = 1.0 / k;  // Valid if k = 1
+    Q[t * k + t] = 0;
+    for (j = 0; j < t; j++) {
+      Q[t * k + t] += r[j * k + t] * r[j * k + t];
+      Q[t * k + j] = Q[j * k + t];
+    }
+    for (j = t + 1; j < k; j++) {
+      Q[t * k + t] += r[j * k + t] * r[j * k + t];
+      Q[t * k + j] = -r[j * k + t] * r[t * k + j];
+    }
+  }
+  for (iter = 0; iter < max_iter; iter++) {
+    // stopping condition, recalculate QP,pQP for numerical accuracy
+    pQp = 0;
+    for (t = 0; t < k; t++) {
+      Qp[t] = 0;
+      for (j = 0; j < k; j++)
+        Qp[t] += Q[t * k + j] * p[j];
+      pQp += p[t] * Qp[t];
+    }
+    double max_error = 0;
+    for (t = 0; t < k; t++) {
+      double error = fabs(Qp[t] - pQp);
+      if (error > max_error)
+        max_error = error;
+    }
+    if (max_error < eps)
+      break;
+
+    for (t = 0; t < k; t++) {
+      double diff = (-Qp[t] + pQp) / Q[t * k + t];
+      p[t] += diff;
+      pQp = (pQp + diff * (diff * Q[t * k + t] + 2 * Qp[t])) / (1 + diff) / (1 + diff);
+      for (j = 0; j < k; j++) {
+        Qp[j] = (Qp[j] + diff * Q[t * k + j]) / (1 + diff);
+        p[j] /= (1 + diff);
+      }
+    }
+  }
+  if (iter >= max_iter)
+    VLOG(1) << "Exceeds max_iter in multiclass_prob";
+}
+
+template <typename SVMModel>
+double DenseSVMPredictor<SVMModel>::probabilityEstimates(const double *dec_values, double *prob_estimates) const {
+  double min_prob = 1e-7;
+  std::vector<double> pairwise_prob(nr_class_ * nr_class_);
+  int k = 0;
+  for (int i = 0; i < nr_class_; i++)
+    for (int j = i + 1; j < nr_class_; j++) {
+      pairwise_prob[i * nr_class_ + j] =
+          std::min(std::max(sigmoidPredict(dec_values[k], probA_[k], probB_[k]), min_prob), 1 - min_prob);
+      pairwise_prob[j * nr_class_ + i] = 1 - pairwise_prob[i * nr_class_ + j];
+      k++;
+    }
+  if (nr_class_ == 2 && two_class_pairwise_prob_) {
+    prob_estimates[0] = pairwise_prob[1];
+    prob_estimates[1] = pairwise_prob[2];
+  } else
+    multiclassProbability(nr_class_, pairwise_prob, prob_estimates);
+
+  int prob_max_idx = 0;
+  for (int i = 1; i < nr_class_; i++)
+    if (prob_estimates[i] > prob_estimates[prob_max_idx])
+      prob_max_idx = i;
+  return label_[prob_max_idx];
+}
+
+template <typename SVMModel>
+void DenseSVMPredictor<SVMModel>::predict(const Eigen::MatrixXd &queries, Eigen::VectorXd &labels,
+                                          Eigen::MatrixXd *probabilities) const {
+  const int num_queries = static_cast<int>(queries.rows());
+  const bool with_probabilities = probabilities && hasProbabilityModel();
+  const int num_dec_values = isClassification() ? nr_class_ * (nr_class_ - 1) / 2 : 1;
+
+  labels.resize(num_queries);
+  if (probabilities)
+    probabilities->resize(num_queries, with_probabilities ? nr_class_ : 0);
+
+  // row-major buffer so each query writes its probabilities contiguously
+  Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> prob_buffer;
+  if (with_probabilities)
+    prob_buffer.resize(num_queries, nr_class_);
+
+  const int num_blocks = (num_queries + QUERY_BLOCK_SIZE - 1) / QUERY_BLOCK_SIZE;
+#pragma omp parallel for schedule(dynamic)
+  for (int block = 0; block < num_blocks; block++) {
+    const int first = block * QUERY_BLOCK_SIZE;
+    const int num = std::min<int>(QUERY_BLOCK_SIZE, num_queries - first);
+
+    Eigen::MatrixXd kvalue;
+    computeKernel(queries, first, num, kvalue);
+
+    std::vector<double> dec_values(num_dec_values);
+    for (int q = 0; q < num; q++) {
+      const double label = decisionValues(kvalue.col(q).data(), dec_values.data());
+      labels(first + q) =
+          with_probabilities ? probabilityEstimates(dec_values.data(), prob_buffer.row(first + q).data()) : label;
+    }
+  }
+
+  if (with_probabilities)
+    *probabilities = prob_buffer;
+}
+}  // namespace v4r
@@ -46,10 +46,6 @@
 #include <pcl/recognition/cg/correspondence_grouping.h>
 #include <v4r/core/macros.h>
 #include <boost/format.hpp>
-#include <boost/graph/adjacency_list.hpp>
-#include <boost/graph/adjacency_matrix.hpp>
-#include <boost/graph/graph_traits.hpp>
-#include <boost/graph/undirected_graph.hpp>
 #include <boost/program_options.hpp>
 
 namespace po = boost::program_options;
@@ -99,14 +95,6 @@ class V4R_EXPORTS GraphGeometricConsistencyGrouping : public pcl::Correspondence
   pcl::PointCloud<pcl::Normal>::ConstPtr scene_normals_;
   pcl::PointCloud<pcl::Normal>::ConstPtr input_normals_;
 
-  struct edge_component_t {
-    enum { num = 555 };
-    typedef boost::edge_property_tag kind;
-  } edge_component;
-
-  typedef boost::adjacency_matrix<boost::undirectedS, size_t, boost::property<edge_component_t, std::size_t>> GraphGGCG;
-  void cleanGraph(GraphGGCG &g, size_t gc_thres);
-
   /** \brief Transformations found by clusterCorrespondences method. */
   std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f>> found_transformations_;
 
@@ -51,6 +51,7 @@
 #include <pcl/common/common.h>
 #include <v4r/core/macros.h>
 #include <boost/dynamic_bitset.hpp>
+#include <boost/functional/hash.hpp>
 #include <opencv2/opencv.hpp>
 
 namespace v4r {
@@ -168,6 +169,21 @@ V4R_EXPORTS std::vector<T> createIndicesFromMask(const boost::dynamic_bitset<> &
   return out;
 }
 
+/**
+ * @brief hash function for bitsets of arbitrary length (e.g. to use them as keys in std::unordered_set)
+ */
+struct DynamicBitsetHash {
+  size_t operator()(const boost::dynamic_bitset<> &mask) const {
+    std::vector<boost::dynamic_bitset<>::block_type> blocks(mask.num_blocks());
+    boost::to_block_range(mask, blocks.begin());
+
+    size_t seed = mask.size();
+    for (boost::dynamic_bitset<>::block_type block : blocks)
+      boost::hash_combine(seed, block);
+    return seed;
+  }
+};
+
 /**
  * @brief computeMaskFromImageMap
  * @param image_map map indicating which pixel belong to which point of the point cloud.
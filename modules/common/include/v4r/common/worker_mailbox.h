@@ -0,0 +1,133 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 TU Wien, ACIN, Vision 4 Robotics (V4R) group
+** Contact: v4r.acin.tuwien.ac.at
+**
+** This file is part of V4R
+**
+** V4R is distributed under dual licenses - GPLv3 or closed source.
+**
+** GNU General Public License Usage
+** V4R is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published
+** by the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** V4R is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** Please review the following information to ensure the GNU General Public
+** License requirements will be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+**
+** Commercial License Usage
+** If GPL is not suitable for your project, you must purchase a commercial
+** license to use V4R. Licensees holding valid commercial V4R licenses may
+** use this file in accordance with the commercial license agreement
+** provided with the Software or, alternatively, in accordance with the
+** terms contained in a written agreement between you and TU Wien, ACIN, V4R.
+** For licensing terms and conditions please contact office<at>acin.tuwien.ac.at.
+**
+**
+** The copyright holder additionally grants the author(s) of the file the right
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or
+** sell copies of their contributions without any restrictions.
+**
+****************************************************************************/
+
+/**
+ * @file worker_mailbox.h
+ * @brief Event-driven hand-off of new data from a producer to a background worker thread
+ */
+
+#pragma once
+
+#include <v4r/core/macros.h>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <chrono>
+#include <cstddef>
+
+namespace v4r {
+
+/**
+ * @brief Wakes up a background worker thread as soon as its producer has new data for it.
+ *
+ * The data itself stays in the shared memory of the worker, the mailbox only tells the worker that there is something
+ * new ("latest frame wins"): notifications arriving while the worker is busy are coalesced into a single wake-up, so
+ * the worker continues with the most recent frame and never waits for data that has already been posted.
+ *
+ * Typical use in a worker loop:
+ * \code
+ * while (run) {
+ *   // ... check the shared memory and process the data if there is something to do ...
+ *   if (!have_todo)
+ *     mailbox.wait();
+ * }
+ * \endcode
+ * The producer calls post() after writing new data, stop() calls close() before joining the worker thread.
+ */
+class V4R_EXPORTS WorkerMailbox {
+ public:
+  /**
+   * @brief timing and queue statistics of a worker stage
+   */
+  struct Statistics {
+    size_t nb_posted_;         ///< number of notifications posted by the producer
+    size_t nb_received_;       ///< number of times the worker woke up with new data
+    size_t nb_coalesced_;      ///< notifications merged into another wake-up (i.e. frames the worker never saw)
+    size_t max_pending_;       ///< maximum number of notifications pending at a wake-up (queue depth)
+    double wait_time_ms_;      ///< total time the worker spent idle waiting for new data
+    double max_wait_time_ms_;  ///< longest idle time of the worker
+    double latency_ms_;        ///< total time between the oldest pending notification and the wake-up of the worker
+    double max_latency_ms_;    ///< longest time a notification stayed pending
+
+    Statistics()
+    : nb_posted_(0), nb_received_(0), nb_coalesced_(0), max_pending_(0), wait_time_ms_(0.), max_wait_time_ms_(0.),
+      latency_ms_(0.), max_latency_ms_(0.) {}
+  };
+
+  WorkerMailbox() : nb_posted_(0), nb_received_(0), closed_(false) {}
+
+  /**
+   * @brief signals the worker that new data is available (called by the producer after writing the shared memory)
+   */
+  void post();
+
+  /**
+   * @brief blocks until new data has been posted since the last wake-up or until the mailbox gets closed
+   * @return false if the mailbox is closed
+   */
+  bool wait();
+
+  /**
+   * @brief wakes up the worker and makes all further calls to wait() return immediately (e.g. to stop the thread)
+   */
+  void close();
+
+  /**
+   * @brief re-opens the mailbox after close() (e.g. when the worker thread is restarted)
+   */
+  void open();
+
+  /**
+   * @return statistics collected since construction or the last call to resetStatistics()
+   */
+  Statistics getStatistics() const;
+
+  void resetStatistics();
+
+ private:
+  typedef std::chrono::steady_clock Clock;
+
+  mutable boost::mutex mtx_;
+  boost::condition_variable cond_;
+  size_t nb_posted_;    ///< notifications posted so far
+  size_t nb_received_;  ///< notifications picked up by the worker so far
+  bool closed_;
+  Clock::time_point first_pending_;  ///< time of the oldest notification not yet picked up
+  Statistics stats_;
+};
+}  // namespace v4r
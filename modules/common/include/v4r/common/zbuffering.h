@@ -75,10 +75,12 @@ class V4R_EXPORTS ZBuffering {
  private:
   ZBufferingParameter param_;
   std::vector<int> kept_indices_;
-  Intrinsics cam_;             ///< camera parameters
-  Eigen::MatrixXi index_map_;  ///< saves for each pixel which indices of the
+  typedef Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> IndexMap;
+
+  Intrinsics cam_;      ///< camera parameters
+  IndexMap index_map_;  ///< saves for each pixel which indices of the
   ///< input cloud it represents. Non-occupied
-  /// pixels are labelled with index -1.
+  /// pixels are labelled with index -1. Stored row-major like the organized point cloud.
   typename pcl::PointCloud<PointT>::Ptr rendered_view_;
   pcl::PointCloud<pcl::Normal>::ConstPtr cloud_normals_;  ///< surface normals for input cloud
 
@@ -131,6 +133,21 @@ class V4R_EXPORTS ZBuffering {
   void renderPointCloud(const typename pcl::PointCloud<PointT> &cloud, typename pcl::PointCloud<PointT> &rendered_view,
                         size_t subsample = 1);
 
+  /**
+   * @brief renderPointClouds renders several point clouds at once (e.g. an object model transformed into the poses of
+   * several hypotheses), each into its own buffer. The clouds are rendered in parallel with the parameters and camera
+   * intrinsics of this object.
+   * @param clouds input point clouds
+   * @param normals surface normals for each input cloud (only needed if normals are used, otherwise can be empty)
+   * @param rendered_views[out] rendered point cloud for each input cloud
+   * @param index_maps[out] index map for each input cloud (see getIndexMap)
+   * @param subsample subsampling step size n. If greater 1, will only use every n-th point for rendering
+   */
+  void renderPointClouds(const std::vector<typename pcl::PointCloud<PointT>::ConstPtr> &clouds,
+                         const std::vector<pcl::PointCloud<pcl::Normal>::ConstPtr> &normals,
+                         std::vector<typename pcl::PointCloud<PointT>::Ptr> &rendered_views,
+                         std::vector<Eigen::MatrixXi> &index_maps, size_t subsample = 1) const;
+
   std::vector<int> getKeptIndices() const {
     return kept_indices_;
   }
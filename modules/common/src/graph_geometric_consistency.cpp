@@ -4,10 +4,11 @@
 #include <pcl/registration/correspondence_rejection_sample_consensus.h>
 #include <v4r/common/graph_geometric_consistency.h>
 #include <v4r/common/miscellaneous.h>
-#include <boost/graph/biconnected_components.hpp>
-#include <boost/graph/connected_components.hpp>
-#include <boost/graph/copy.hpp>
-#include <boost/graph/prim_minimum_spanning_tree.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
 
 namespace po = boost::program_options;
 
@@ -38,13 +39,335 @@ struct V4R_EXPORTS ViewD {
   }
 };
 
-template <typename Graph>
+namespace {
+typedef std::pair<size_t, size_t> Edge;
+
+/// @brief undirected graph in compressed sparse row (CSR) format. The neighbours of vertex v are stored in ascending
+/// order in adjacency_[offsets_[v]] ... adjacency_[offsets_[v + 1] - 1]
+struct CSRGraph {
+  std::vector<size_t> offsets_;
+  std::vector<size_t> adjacency_;
+
+  size_t numVertices() const {
+    return offsets_.size() - 1;
+  }
+
+  size_t numEdges() const {
+    return adjacency_.size() / 2;
+  }
+
+  size_t degree(size_t v) const {
+    return offsets_[v + 1] - offsets_[v];
+  }
+
+  bool hasEdge(size_t u, size_t v) const {
+    return std::binary_search(adjacency_.begin() + offsets_[u], adjacency_.begin() + offsets_[u + 1], v);
+  }
+};
+
+/// @brief creates a CSR graph with num_vertices vertices from a list of undirected edges
+CSRGraph buildCSRGraph(size_t num_vertices, const std::vector<Edge>& edges) {
+  CSRGraph g;
+  g.offsets_.assign(num_vertices + 1, 0);
+  for (const Edge& e : edges) {
+    g.offsets_[e.first + 1]++;
+    g.offsets_[e.second + 1]++;
+  }
+  std::partial_sum(g.offsets_.begin(), g.offsets_.end(), g.offsets_.begin());
+
+  g.adjacency_.resize(2 * edges.size());
+  std::vector<size_t> fill_pos(g.offsets_.begin(), g.offsets_.end() - 1);
+  for (const Edge& e : edges) {
+    g.adjacency_[fill_pos[e.first]++] = e.second;
+    g.adjacency_[fill_pos[e.second]++] = e.first;
+  }
+  for (size_t v = 0; v < num_vertices; v++)
+    std::sort(g.adjacency_.begin() + g.offsets_[v], g.adjacency_.begin() + g.offsets_[v + 1]);
+  return g;
+}
+
+/// @brief keypoints and normals of the model-scene correspondences in structure-of-arrays layout
+struct CorrespondenceSoA {
+  std::vector<int> scene_index_, model_index_;
+  std::vector<float> scene_x_, scene_y_, scene_z_, model_x_, model_y_, model_z_;
+  std::vector<float> scene_nx_, scene_ny_, scene_nz_, model_nx_, model_ny_, model_nz_;
+
+  explicit CorrespondenceSoA(size_t n = 0)
+  : scene_index_(n), model_index_(n), scene_x_(n), scene_y_(n), scene_z_(n), model_x_(n), model_y_(n), model_z_(n),
+    scene_nx_(n), scene_ny_(n), scene_nz_(n), model_nx_(n), model_ny_(n), model_nz_(n) {}
+
+  size_t size() const {
+    return scene_index_.size();
+  }
+
+  /// @brief copies correspondence src of other to position dst
+  void set(size_t dst, const CorrespondenceSoA& other, size_t src) {
+    scene_index_[dst] = other.scene_index_[src];
+    model_index_[dst] = other.model_index_[src];
+    scene_x_[dst] = other.scene_x_[src];
+    scene_y_[dst] = other.scene_y_[src];
+    scene_z_[dst] = other.scene_z_[src];
+    model_x_[dst] = other.model_x_[src];
+    model_y_[dst] = other.model_y_[src];
+    model_z_[dst] = other.model_z_[src];
+    scene_nx_[dst] = other.scene_nx_[src];
+    scene_ny_[dst] = other.scene_ny_[src];
+    scene_nz_[dst] = other.scene_nz_[src];
+    model_nx_[dst] = other.model_nx_[src];
+    model_ny_[dst] = other.model_ny_[src];
+    model_nz_[dst] = other.model_nz_[src];
+  }
+};
+
+/// @brief checks correspondence k against the correspondences [begin, end) for geometric consistency (same point,
+/// minimum distance, distance and normal consistency constraints). The loop is branch-free so it can be vectorized.
+void checkConsistency(const CorrespondenceSoA& c, size_t k, size_t begin, size_t end, float min_dist,
+                      const v4r::GraphGeometricConsistencyGroupingParameter& param, unsigned char* is_consistent) {
+  const int scene_index = c.scene_index_[k], model_index = c.model_index_[k];
+  const float sx = c.scene_x_[k], sy = c.scene_y_[k], sz = c.scene_z_[k];
+  const float mx = c.model_x_[k], my = c.model_y_[k], mz = c.model_z_[k];
+  const float snx = c.scene_nx_[k], sny = c.scene_ny_[k], snz = c.scene_nz_[k];
+  const float mnx = c.model_nx_[k], mny = c.model_ny_[k], mnz = c.model_nz_[k];
+  const float gc_size = param.gc_size_, thres_dot_distance = param.thres_dot_distance_;
+  const bool check_normals = param.check_normals_orientation_;
+
+  for (size_t j = begin; j < end; j++) {
+    const float dmx = c.model_x_[j] - mx, dmy = c.model_y_[j] - my, dmz = c.model_z_[j] - mz;
+    const float dsx = c.scene_x_[j] - sx, dsy = c.scene_y_[j] - sy, dsz = c.scene_z_[j] - sz;
+    const float dist_model_pts = std::sqrt(dmx * dmx + dmy * dmy + dmz * dmz);
+    const float dist_scene_pts = std::sqrt(dsx * dsx + dsy * dsy + dsz * dsz);
+
+    bool consistent = (c.scene_index_[j] != scene_index) & (c.model_index_[j] != model_index) &
+                      !(dist_model_pts < min_dist) & !(dist_scene_pts < min_dist) &
+                      !(std::fabs(dist_model_pts - dist_scene_pts) > gc_size);
+
+    if (check_normals) {
+      const float dot_scene_pts = snx * c.scene_nx_[j] + sny * c.scene_ny_[j] + snz * c.scene_nz_[j];
+      const float dot_model_pts = mnx * c.model_nx_[j] + mny * c.model_ny_[j] + mnz * c.model_nz_[j];
+      const bool any_nan = std::isnan(dot_scene_pts) | std::isnan(dot_model_pts);
+      const float dot_distance = any_nan ? 0.f : std::fabs(dot_scene_pts - dot_model_pts);
+
+      // Model normals should be consistently oriented! otherwise reject!
+      consistent &= !(dot_model_pts < -0.1f) & !(dot_distance > thres_dot_distance);
+    }
+    is_consistent[j - begin] = consistent;
+  }
+}
+
+/// @brief builds the graph connecting all pairs of geometrically consistent correspondences. Two correspondences can
+/// only be consistent if their scene points are not further apart than the extent of the model keypoints plus the
+/// consensus resolution. The scene keypoints are therefore binned into a uniform grid of this cell size and each
+/// correspondence is only checked against the correspondences in its 27 neighbouring cells. Correspondences with
+/// non-finite keypoints are never connected.
+CSRGraph buildConsistencyGraph(const CorrespondenceSoA& c,
+                               const v4r::GraphGeometricConsistencyGroupingParameter& param) {
+  const size_t n = c.size();
+  const float min_dist = param.gc_size_ * param.dist_for_cluster_factor_;
+
+  Eigen::Array3f model_min = Eigen::Array3f::Constant(std::numeric_limits<float>::max());
+  Eigen::Array3f model_max = Eigen::Array3f::Constant(-std::numeric_limits<float>::max());
+  Eigen::Array3f scene_min = model_min, scene_max = model_max;
+  std::vector<size_t> valid;
+  valid.reserve(n);
+  for (size_t i = 0; i < n; i++) {
+    const Eigen::Array3f s(c.scene_x_[i], c.scene_y_[i], c.scene_z_[i]);
+    const Eigen::Array3f m(c.model_x_[i], c.model_y_[i], c.model_z_[i]);
+    if (!s.allFinite() || !m.allFinite())
+      continue;
+    valid.push_back(i);
+    scene_min = scene_min.min(s);
+    scene_max = scene_max.max(s);
+    model_min = model_min.min(m);
+    model_max = model_max.max(m);
+  }
+
+  CSRGraph g;
+  g.offsets_.assign(n + 1, 0);
+  if (valid.empty())
+    return g;
+
+  // cells are addressed by 21 bits per dimension
+  const int max_cells_per_dim = 1 << 20;
+  const float model_extent = (model_max - model_min).matrix().norm();
+  const float scene_extent = (scene_max - scene_min).maxCoeff();
+  float cell_size = std::max(model_extent + param.gc_size_, scene_extent / max_cells_per_dim);
+  if (!(cell_size > 0.f))
+    cell_size = 1.f;
+
+  std::vector<std::pair<uint64_t, size_t>> keyed(valid.size());
+  std::vector<Eigen::Vector3i> cell_of(n);
+  for (size_t i = 0; i < valid.size(); i++) {
+    const size_t idx = valid[i];
+    const Eigen::Array3f s(c.scene_x_[idx], c.scene_y_[idx], c.scene_z_[idx]);
+    const Eigen::Array3i cell = ((s - scene_min) / cell_size).cast<int>().min(max_cells_per_dim);
+    cell_of[idx] = cell.matrix();
+    keyed[i].first = (uint64_t(cell(0)) << 42) | (uint64_t(cell(1)) << 21) | uint64_t(cell(2));
+    keyed[i].second = idx;
+  }
+  std::sort(keyed.begin(), keyed.end());
+
+  // correspondences sorted by cell so that each cell is a contiguous range
+  CorrespondenceSoA sorted(keyed.size());
+  std::vector<uint64_t> cell_keys;
+  std::vector<size_t> cell_start;
+  for (size_t i = 0; i < keyed.size(); i++) {
+    sorted.set(i, c, keyed[i].second);
+    if (cell_keys.empty() || cell_keys.back() != keyed[i].first) {
+      cell_keys.push_back(keyed[i].first);
+      cell_start.push_back(i);
+    }
+  }
+  cell_start.push_back(keyed.size());
+
+  std::vector<std::vector<size_t>> neighbours(n);
+#pragma omp parallel for schedule(dynamic)
+  for (size_t s = 0; s < keyed.size(); s++) {
+    const size_t k = keyed[s].second;
+    std::vector<size_t>& nn = neighbours[k];
+    const int chunk_size = 256;
+    unsigned char is_consistent[chunk_size];
+
+    for (int dx = -1; dx <= 1; dx++) {
+      for (int dy = -1; dy <= 1; dy++) {
+        for (int dz = -1; dz <= 1; dz++) {
+          const Eigen::Vector3i cell = cell_of[k] + Eigen::Vector3i(dx, dy, dz);
+          if ((cell.array() < 0).any() || (cell.array() > max_cells_per_dim).any())
+            continue;
+
+          const uint64_t key = (uint64_t(cell(0)) << 42) | (uint64_t(cell(1)) << 21) | uint64_t(cell(2));
+          const auto cell_it = std::lower_bound(cell_keys.begin(), cell_keys.end(), key);
+          if (cell_it == cell_keys.end() || *cell_it != key)
+            continue;
+
+          const size_t cell_id = cell_it - cell_keys.begin();
+          for (size_t begin = cell_start[cell_id]; begin < cell_start[cell_id + 1]; begin += chunk_size) {
+            const size_t end = std::min(begin + chunk_size, cell_start[cell_id + 1]);
+            checkConsistency(sorted, s, begin, end, min_dist, param, is_consistent);
+            for (size_t j = begin; j < end; j++) {
+              if (is_consistent[j - begin])
+                nn.push_back(keyed[j].second);
+            }
+          }
+        }
+      }
+    }
+    std::sort(nn.begin(), nn.end());
+  }
+
+  for (size_t v = 0; v < n; v++)
+    g.offsets_[v + 1] = g.offsets_[v] + neighbours[v].size();
+  g.adjacency_.resize(g.offsets_[n]);
+  for (size_t v = 0; v < n; v++)
+    std::copy(neighbours[v].begin(), neighbours[v].end(), g.adjacency_.begin() + g.offsets_[v]);
+  return g;
+}
+
+/// @brief computes the edges of each biconnected component (Hopcroft-Tarjan with an explicit stack). Vertices and
+/// their neighbours are visited in ascending order, so components are numbered in the same order as by
+/// boost::biconnected_components.
+std::vector<std::vector<Edge>> biconnectedComponents(const CSRGraph& g) {
+  const size_t n = g.numVertices();
+  std::vector<size_t> dtm(n, 0), lowpt(n, 0), pred(n, 0), next_arc(n, 0);
+  std::vector<size_t> dfs_stack;
+  std::vector<Edge> edge_stack;
+  std::vector<std::vector<Edge>> components;
+  size_t dfs_time = 0;
+
+  for (size_t root = 0; root < n; root++) {
+    if (dtm[root])
+      continue;
+
+    pred[root] = root;
+    dtm[root] = lowpt[root] = ++dfs_time;
+    next_arc[root] = g.offsets_[root];
+    dfs_stack.push_back(root);
+
+    while (!dfs_stack.empty()) {
+      const size_t u = dfs_stack.back();
+      if (next_arc[u] < g.offsets_[u + 1]) {
+        const size_t w = g.adjacency_[next_arc[u]++];
+        if (!dtm[w]) {  // tree edge
+          edge_stack.push_back(Edge(u, w));
+          pred[w] = u;
+          dtm[w] = lowpt[w] = ++dfs_time;
+          next_arc[w] = g.offsets_[w];
+          dfs_stack.push_back(w);
+        } else if (w != pred[u] && dtm[w] < dtm[u]) {  // back edge
+          edge_stack.push_back(Edge(u, w));
+          lowpt[u] = std::min(lowpt[u], dtm[w]);
+        }
+        continue;
+      }
+
+      dfs_stack.pop_back();
+      const size_t parent = pred[u];
+      if (parent == u)
+        continue;
+
+      lowpt[parent] = std::min(lowpt[parent], lowpt[u]);
+      if (lowpt[u] >= dtm[parent]) {
+        components.push_back(std::vector<Edge>());
+        while (dtm[edge_stack.back().first] >= dtm[u]) {
+          components.back().push_back(edge_stack.back());
+          edge_stack.pop_back();
+        }
+        components.back().push_back(edge_stack.back());  // tree edge (parent, u)
+        edge_stack.pop_back();
+      }
+    }
+  }
+  return components;
+}
+
+/// @brief labels the connected components of the subgraph induced by the active vertices (union-find). Inactive
+/// vertices form a component on their own. Components are numbered in the order of their smallest vertex.
+/// @return number of components
+size_t connectedComponents(const CSRGraph& g, const std::vector<bool>& is_active, std::vector<size_t>& labels) {
+  const size_t n = g.numVertices();
+  std::vector<size_t> parent(n);
+  std::iota(parent.begin(), parent.end(), 0);
+
+  auto find = [&parent](size_t v) {
+    while (parent[v] != v) {
+      parent[v] = parent[parent[v]];
+      v = parent[v];
+    }
+    return v;
+  };
+
+  for (size_t u = 0; u < n; u++) {
+    if (!is_active[u])
+      continue;
+    for (size_t a = g.offsets_[u]; a < g.offsets_[u + 1]; a++) {
+      const size_t w = g.adjacency_[a];
+      if (w > u && is_active[w]) {
+        const size_t ru = find(u), rw = find(w);
+        if (ru != rw)
+          parent[std::max(ru, rw)] = std::min(ru, rw);
+      }
+    }
+  }
+
+  const size_t unlabeled = std::numeric_limits<size_t>::max();
+  std::vector<size_t> root_label(n, unlabeled);
+  labels.resize(n);
+  size_t num_components = 0;
+  for (size_t v = 0; v < n; v++) {
+    const size_t r = find(v);
+    if (root_label[r] == unlabeled)
+      root_label[r] = num_components++;
+    labels[v] = root_label[r];
+  }
+  return num_components;
+}
+}  // namespace
+
 class V4R_EXPORTS Tomita {
-  typedef std::set<typename boost::graph_traits<Graph>::vertex_descriptor> SetType;
-  typedef std::vector<typename boost::graph_traits<Graph>::vertex_descriptor> VectorType;
+  typedef std::set<size_t> SetType;
+  typedef std::vector<size_t> VectorType;
   std::vector<VectorType> cliques_found_;
   size_t min_clique_size_;
-  typedef boost::unordered_map<typename boost::graph_traits<Graph>::vertex_descriptor, size_t> MapType;
+  typedef boost::unordered_map<size_t, size_t> MapType;
   MapType used_ntimes_in_cliques_;
   std::vector<SetType> nnbrs;
   double max_time_allowed_;
@@ -62,7 +385,7 @@ class V4R_EXPORTS Tomita {
   }
 
   void printSet(const SetType& s) {
-    typename SetType::const_iterator vertexIt, vertexEnd;
+    SetType::const_iterator vertexIt, vertexEnd;
 
     vertexIt = s.begin();
     vertexEnd = s.end();
@@ -79,7 +402,7 @@ class V4R_EXPORTS Tomita {
     size_t num_cand = cand.size();
 
     // iterate over done and compute maximum intersection between candidates and the adjacents of done (nnbrs)
-    typename SetType::iterator vertexIt, vertexEnd;
+    SetType::iterator vertexIt, vertexEnd;
     SetType tmp;
 
     vertexIt = done.begin();
@@ -168,7 +491,7 @@ class V4R_EXPORTS Tomita {
     max_time_allowed_ = t;
   }
 
-  void find_cliques(const Graph& G, size_t num_v) {
+  void find_cliques(const CSRGraph& G) {
     SetType cand, done;
     VectorType clique_so_far;
     nnbrs.clear();
@@ -177,20 +500,16 @@ class V4R_EXPORTS Tomita {
     time_elapsed_.reset();
     max_time_reached_ = false;
 
-    typename boost::graph_traits<Graph>::vertex_iterator vertexIt, vertexEnd;
-    boost::tie(vertexIt, vertexEnd) = vertices(G);
+    const size_t num_v = G.numVertices();
     nnbrs.resize(num_v);
 
-    size_t i = 0;
-    for (; vertexIt != vertexEnd; ++vertexIt, ++i) {
-      typename boost::graph_traits<Graph>::adjacency_iterator vi, vi_end;
-      size_t k = 0;
-      for (boost::tie(vi, vi_end) = boost::adjacent_vertices(*vertexIt, G); vi != vi_end; ++vi, ++k) {
-        nnbrs[i].insert(*vi);
-        cand.insert(*vi);
+    for (size_t i = 0; i < num_v; ++i) {
+      for (size_t a = G.offsets_[i]; a < G.offsets_[i + 1]; ++a) {
+        nnbrs[i].insert(G.adjacency_[a]);
+        cand.insert(G.adjacency_[a]);
       }
 
-      used_ntimes_in_cliques_[*vertexIt] = 0;
+      used_ntimes_in_cliques_[i] = 0;
     }
 
     extend(cand, done, clique_so_far);
@@ -214,27 +533,6 @@ bool best_extended_cliques(const ExtendedClique& a, const ExtendedClique& b) {
 
 namespace v4r {
 
-template <typename PointModelT, typename PointSceneT>
-void GraphGeometricConsistencyGrouping<PointModelT, PointSceneT>::cleanGraph(GraphGGCG& g, size_t gc_thres) {
-  typename boost::graph_traits<GraphGGCG>::vertex_iterator vertexIt, vertexEnd;
-  std::vector<typename boost::graph_traits<GraphGGCG>::vertex_descriptor> to_be_removed;
-
-  do {
-    to_be_removed.clear();
-    boost::tie(vertexIt, vertexEnd) = vertices(g);
-    for (; vertexIt != vertexEnd; ++vertexIt) {
-      size_t deg = boost::out_degree(*vertexIt, g);
-
-      if ((deg > 0) && (deg < (gc_thres - 1)))
-        to_be_removed.push_back(*vertexIt);
-    }
-
-    for (size_t i = 0; i < to_be_removed.size(); i++)
-      clear_vertex(to_be_removed[i], g);
-
-  } while (!to_be_removed.empty());
-}
-
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointModelT, typename PointSceneT>
 void GraphGeometricConsistencyGrouping<PointModelT, PointSceneT>::clusterCorrespondences(
@@ -256,66 +554,34 @@ void GraphGeometricConsistencyGrouping<PointModelT, PointSceneT>::clusterCorresp
   PointCloudPtr temp_scene_cloud_ptr(new PointCloud());
   pcl::copyPointCloud<PointSceneT, PointModelT>(*scene_, *temp_scene_cloud_ptr);
 
-  GraphGGCG correspondence_graph(model_scene_corrs_->size());
-  float min_dist_for_cluster = param_.gc_size_ * param_.dist_for_cluster_factor_;
-
-  for (size_t k = 0; k < model_scene_corrs_->size(); k++) {
-    int scene_index_k = model_scene_corrs_->operator[](k).index_match;
-    int model_index_k = model_scene_corrs_->operator[](k).index_query;
-    const auto& scene_point_k = scene_->points[scene_index_k].getVector4fMap();
-    const auto& model_point_k = input_->points[model_index_k].getVector4fMap();
-    const auto& scene_normal_k = scene_normals_->points[scene_index_k].getNormalVector4fMap();
-    const auto& model_normal_k = input_normals_->points[model_index_k].getNormalVector4fMap();
-
-    for (size_t j = (k + 1); j < model_scene_corrs_->size(); ++j) {
-      int scene_index_j = model_scene_corrs_->operator[](j).index_match;
-      int model_index_j = model_scene_corrs_->operator[](j).index_query;
-
-      // same scene or model point constraint
-      if (scene_index_j == scene_index_k || model_index_j == model_index_k)
-        continue;
-
-      const auto& scene_point_j = scene_->points[scene_index_j].getVector4fMap();
-      const auto& model_point_j = input_->points[model_index_j].getVector4fMap();
-      const auto& scene_normal_j = scene_normals_->points[scene_index_j].getNormalVector4fMap();
-      const auto& model_normal_j = input_normals_->points[model_index_j].getNormalVector4fMap();
-
-      float dist_model_pts = (model_point_k - model_point_j).norm();
-      float dist_scene_pts = (scene_point_k - scene_point_j).norm();
-
-      // minimum distance constraint
-      if ((dist_model_pts < min_dist_for_cluster) || (dist_scene_pts < min_dist_for_cluster))
-        continue;
-
-      // check distance consistency
-      float distance = fabs(dist_model_pts - dist_scene_pts);
-      if (distance > param_.gc_size_)
-        continue;
-
-      if (param_.check_normals_orientation_) {
-        // check normal consistency
-        float dot_scene_pts = scene_normal_k.dot(scene_normal_j);
-        float dot_model_pts = model_normal_k.dot(model_normal_j);
-
-        // Model normals should be consistently oriented! otherwise reject!
-        if (dot_model_pts < -0.1f)
-          continue;
-
-        float dot_distance = 0.f;
-        if (!pcl_isnan(dot_scene_pts) && !pcl_isnan(dot_model_pts))
-          dot_distance = fabs(dot_scene_pts - dot_model_pts);
-
-        if ((dot_distance > param_.thres_dot_distance_))
-          continue;
-      }
-
-      boost::add_edge(k, j, correspondence_graph);
-    }
+  const size_t num_corrs = model_scene_corrs_->size();
+  CorrespondenceSoA corrs(num_corrs);
+  for (size_t k = 0; k < num_corrs; k++) {
+    const int scene_index = model_scene_corrs_->operator[](k).index_match;
+    const int model_index = model_scene_corrs_->operator[](k).index_query;
+    const PointSceneT& scene_point = scene_->points[scene_index];
+    const PointModelT& model_point = input_->points[model_index];
+    const pcl::Normal& scene_normal = scene_normals_->points[scene_index];
+    const pcl::Normal& model_normal = input_normals_->points[model_index];
+    corrs.scene_index_[k] = scene_index;
+    corrs.model_index_[k] = model_index;
+    corrs.scene_x_[k] = scene_point.x;
+    corrs.scene_y_[k] = scene_point.y;
+    corrs.scene_z_[k] = scene_point.z;
+    corrs.model_x_[k] = model_point.x;
+    corrs.model_y_[k] = model_point.y;
+    corrs.model_z_[k] = model_point.z;
+    corrs.scene_nx_[k] = scene_normal.normal_x;
+    corrs.scene_ny_[k] = scene_normal.normal_y;
+    corrs.scene_nz_[k] = scene_normal.normal_z;
+    corrs.model_nx_[k] = model_normal.normal_x;
+    corrs.model_ny_[k] = model_normal.normal_y;
+    corrs.model_nz_[k] = model_normal.normal_z;
   }
 
-  typename boost::property_map<GraphGGCG, edge_component_t>::type components =
-      get(edge_component, correspondence_graph);
-  size_t n_cc = biconnected_components(correspondence_graph, components);
+  const CSRGraph correspondence_graph = buildConsistencyGraph(corrs, param_);
+  const std::vector<std::vector<Edge>> biconnected_components = biconnectedComponents(correspondence_graph);
+  size_t n_cc = biconnected_components.size();
 
   if (n_cc < 1)
     return;
@@ -324,12 +590,11 @@ void GraphGeometricConsistencyGrouping<PointModelT, PointSceneT>::clusterCorresp
 
   std::vector<std::set<size_t>> unique_vertices_per_cc(n_cc);
 
-  typename boost::graph_traits<GraphGGCG>::edge_iterator edgeIt, edgeEnd;
-  boost::tie(edgeIt, edgeEnd) = edges(correspondence_graph);
-  for (; edgeIt != edgeEnd; ++edgeIt) {
-    int c = components[*edgeIt];
-    unique_vertices_per_cc[c].insert(boost::source(*edgeIt, correspondence_graph));
-    unique_vertices_per_cc[c].insert(boost::target(*edgeIt, correspondence_graph));
+  for (size_t c = 0; c < n_cc; c++) {
+    for (const Edge& e : biconnected_components[c]) {
+      unique_vertices_per_cc[c].insert(e.first);
+      unique_vertices_per_cc[c].insert(e.second);
+    }
   }
 
   std::vector<size_t> cc_sizes(unique_vertices_per_cc.size(), 0);
@@ -349,18 +614,12 @@ void GraphGeometricConsistencyGrouping<PointModelT, PointSceneT>::clusterCorresp
 
     analyzed_ccs++;
 
-    GraphGGCG connected_graph(correspondence_graph);
-
-    // iterate over edges and remove those not belonging to this biconnected component
-    boost::tie(edgeIt, edgeEnd) = edges(connected_graph);
-    for (; edgeIt != edgeEnd; ++edgeIt) {
-      if (components[*edgeIt] != c)
-        boost::remove_edge(*edgeIt, connected_graph);
-    }
+    // graph with only the edges belonging to this biconnected component
+    const CSRGraph connected_graph = buildCSRGraph(num_corrs, biconnected_components[c]);
 
     //        visualizeGraph(connected_graph, "connected component");
 
-    float arboricity = num_edges(connected_graph) / static_cast<float>(num_v_in_cc - 1);
+    float arboricity = connected_graph.numEdges() / static_cast<float>(num_v_in_cc - 1);
     std::set<size_t> correspondences_used;
 
     std::vector<std::vector<size_t>> correspondence_to_instance;
@@ -371,9 +630,9 @@ void GraphGeometricConsistencyGrouping<PointModelT, PointSceneT>::clusterCorresp
         arboricity < 25 /*&& (num_v_in_cc < 400) && (num_edges (connected_graph) < 8000) && arboricity < 10*/) {
       std::vector<std::vector<size_t>> cliques;
 
-      Tomita<GraphGGCG> tom(param_.gc_threshold_);
+      Tomita tom(param_.gc_threshold_);
       tom.setMaxTimeAllowed(param_.max_time_allowed_cliques_comptutation_);
-      tom.find_cliques(connected_graph, model_scene_corrs_->size());
+      tom.find_cliques(connected_graph);
 
       if (tom.getMaxTimeReached()) {
         LOG(WARNING) << "Max time ( " << std::setprecision(2) << param_.max_time_allowed_cliques_comptutation_
@@ -553,19 +812,9 @@ void GraphGeometricConsistencyGrouping<PointModelT, PointSceneT>::clusterCorresp
       std::vector<size_t> consensus_set(model_scene_corrs_->size());
       std::vector<bool> taken_corresps(model_scene_corrs_->size(), false);
 
-      GraphGGCG connected_graph2(correspondence_graph);
-      // iterate over edges and remove those not belonging to this biconnected component
-      boost::tie(edgeIt, edgeEnd) = edges(connected_graph2);
-      for (; edgeIt != edgeEnd; ++edgeIt) {
-        if (components[*edgeIt] != c)
-          boost::remove_edge(*edgeIt, connected_graph2);
-      }
-
-      typename boost::graph_traits<GraphGGCG>::vertex_iterator vertexIt, vertexEnd;
-      boost::tie(vertexIt, vertexEnd) = vertices(connected_graph2);
-      for (; vertexIt != vertexEnd; ++vertexIt) {
-        if (boost::out_degree(*vertexIt, connected_graph2) < (param_.gc_threshold_ - 1))
-          taken_corresps[*vertexIt] = true;
+      for (size_t v = 0; v < num_corrs; v++) {
+        if (connected_graph.degree(v) < (param_.gc_threshold_ - 1))
+          taken_corresps[v] = true;
       }
 
       for (size_t i = 0; i < model_scene_corrs_->size(); ++i) {
@@ -583,7 +832,7 @@ void GraphGeometricConsistencyGrouping<PointModelT, PointSceneT>::clusterCorresp
             for (size_t k = 0; k < consensus_size; k++) {
               // check if edge (j, consensus_set[k] exists in the graph, if it does not, is_a_good_candidate =
               // false!...
-              if (!(boost::edge(j, consensus_set[k], connected_graph2).second)) {
+              if (!connected_graph.hasEdge(j, consensus_set[k])) {
                 is_a_good_candidate = false;
                 break;
               }
@@ -674,22 +923,13 @@ void GraphGeometricConsistencyGrouping<PointModelT, PointSceneT>::clusterCorresp
 
     if (param_.prune_by_CC_) {
       // pcl::ScopeTime t("final post-processing...");
-      GraphGGCG connected_graph_used_edges(connected_graph);
-      typename boost::graph_traits<GraphGGCG>::vertex_iterator vertexIt, vertexEnd;
-      std::vector<typename boost::graph_traits<GraphGGCG>::vertex_descriptor> to_be_removed;
-      boost::tie(vertexIt, vertexEnd) = vertices(connected_graph_used_edges);
-      for (; vertexIt != vertexEnd; ++vertexIt) {
-        std::set<size_t>::const_iterator it;
-        it = correspondences_used.find(*vertexIt);
-        if (it == correspondences_used.end())
-          to_be_removed.push_back(*vertexIt);
-      }
-
-      for (size_t i = 0; i < to_be_removed.size(); i++)
-        clear_vertex(to_be_removed[i], connected_graph_used_edges);
+      // connected components using only edges between used correspondences
+      std::vector<bool> is_used(num_corrs, false);
+      for (size_t v : correspondences_used)
+        is_used[v] = true;
 
-      boost::vector_property_map<size_t> components2(boost::num_vertices(connected_graph_used_edges));
-      size_t n_cc2 = boost::connected_components(connected_graph_used_edges, &components2[0]);
+      std::vector<size_t> components2;
+      size_t n_cc2 = connectedComponents(connected_graph, is_used, components2);
 
       std::vector<size_t> cc_sizes2(n_cc2, 0);
       for (size_t i = 0; i < model_scene_corrs_->size(); i++)
@@ -713,12 +953,10 @@ void GraphGeometricConsistencyGrouping<PointModelT, PointSceneT>::clusterCorresp
 
         std::set<size_t> instances_for_this_cc;
         {
-          boost::tie(vertexIt, vertexEnd) = vertices(connected_graph_used_edges);
-
-          for (; vertexIt != vertexEnd; ++vertexIt) {
-            if (components2[*vertexIt] == internal_c) {
-              for (size_t k = 0; k < correspondence_to_instance[*vertexIt].size(); k++) {
-                instances_for_this_cc.insert(correspondence_to_instance[*vertexIt][k]);
+          for (size_t v = 0; v < num_corrs; v++) {
+            if (components2[v] == internal_c) {
+              for (size_t k = 0; k < correspondence_to_instance[v].size(); k++) {
+                instances_for_this_cc.insert(correspondence_to_instance[v][k]);
               }
             }
           }
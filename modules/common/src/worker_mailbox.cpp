@@ -0,0 +1,64 @@
+#include <v4r/common/worker_mailbox.h>
+#include <algorithm>
+
+namespace v4r {
+
+void WorkerMailbox::post() {
+  {
+    boost::lock_guard<boost::mutex> lock(mtx_);
+    if (nb_posted_ == nb_received_)
+      first_pending_ = Clock::now();
+    nb_posted_++;
+    stats_.nb_posted_++;
+  }
+  cond_.notify_one();
+}
+
+bool WorkerMailbox::wait() {
+  boost::unique_lock<boost::mutex> lock(mtx_);
+  const Clock::time_point start = Clock::now();
+  while (!closed_ && nb_posted_ == nb_received_)
+    cond_.wait(lock);
+  const Clock::time_point now = Clock::now();
+
+  const double wait_time_ms = std::chrono::duration<double, std::milli>(now - start).count();
+  stats_.wait_time_ms_ += wait_time_ms;
+  stats_.max_wait_time_ms_ = std::max(stats_.max_wait_time_ms_, wait_time_ms);
+
+  if (nb_posted_ == nb_received_)
+    return !closed_;
+
+  const size_t nb_pending = nb_posted_ - nb_received_;
+  const double latency_ms = std::chrono::duration<double, std::milli>(now - first_pending_).count();
+  stats_.nb_received_++;
+  stats_.nb_coalesced_ += nb_pending - 1;
+  stats_.max_pending_ = std::max(stats_.max_pending_, nb_pending);
+  stats_.latency_ms_ += latency_ms;
+  stats_.max_latency_ms_ = std::max(stats_.max_latency_ms_, latency_ms);
+  nb_received_ = nb_posted_;
+  return !closed_;
+}
+
+void WorkerMailbox::close() {
+  {
+    boost::lock_guard<boost::mutex> lock(mtx_);
+    closed_ = true;
+  }
+  cond_.notify_all();
+}
+
+void WorkerMailbox::open() {
+  boost::lock_guard<boost::mutex> lock(mtx_);
+  closed_ = false;
+}
+
+WorkerMailbox::Statistics WorkerMailbox::getStatistics() const {
+  boost::lock_guard<boost::mutex> lock(mtx_);
+  return stats_;
+}
+
+void WorkerMailbox::resetStatistics() {
+  boost::lock_guard<boost::mutex> lock(mtx_);
+  stats_ = Statistics();
+}
+}  // namespace v4r
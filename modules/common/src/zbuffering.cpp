@@ -3,6 +3,8 @@
 #include <v4r/common/zbuffering.h>
 #include <pcl/impl/instantiate.hpp>
 
+#include <numeric>
+
 namespace v4r {
 
 // NOTE: The following template specialization will cause a compiler warning during instantiation
@@ -55,8 +57,13 @@ void ZBuffering<PointT>::depthBuffering(const pcl::PointCloud<PointT> &cloud, si
 
   int width = static_cast<int>(cam_.w);
   int height = static_cast<int>(cam_.h);
+  const size_t num_samples = (cloud.points.size() + subsample - 1) / subsample;
 
-  for (size_t i = 0; i < cloud.points.size(); i += subsample) {
+  // project points into the image (pixel index or -1 if outside image or facing away from camera)
+  std::vector<int> pixel(num_samples, -1);
+#pragma omp parallel for schedule(static)
+  for (size_t s = 0; s < num_samples; s++) {
+    const size_t i = s * subsample;
     const PointT &p = cloud.points[i];
     int u = cam_.fx * p.x / p.z + cam_.cx;
     int v = cam_.fy * p.y / p.z + cam_.cy;
@@ -70,60 +77,123 @@ void ZBuffering<PointT>::depthBuffering(const pcl::PointCloud<PointT> &cloud, si
         continue;
     }
 
-    PointT &r_pt = rendered_view_->at(u, v);
-    if (!pcl_isfinite(r_pt.z) || (p.z < r_pt.z)) {
-      r_pt = p;
-      index_map_(v, u) = i;
+    pixel[s] = v * width + u;
+  }
+
+  // sort points into tiles of image rows (keeping their order) so that each tile can be z-buffered by a single thread
+  // without locking
+  const int tile_rows = 16;
+  const int num_tiles = (height + tile_rows - 1) / tile_rows;
+  std::vector<size_t> tile_begin(num_tiles + 1, 0);
+  for (int px : pixel) {
+    if (px >= 0)
+      tile_begin[px / (width * tile_rows) + 1]++;
+  }
+  std::partial_sum(tile_begin.begin(), tile_begin.end(), tile_begin.begin());
+
+  std::vector<size_t> tile_samples(tile_begin.back());
+  std::vector<size_t> tile_end(tile_begin.begin(), tile_begin.end() - 1);
+  for (size_t s = 0; s < num_samples; s++) {
+    if (pixel[s] >= 0)
+      tile_samples[tile_end[pixel[s] / (width * tile_rows)]++] = s;
+  }
+
+#pragma omp parallel for schedule(dynamic)
+  for (int t = 0; t < num_tiles; t++) {
+    for (size_t k = tile_begin[t]; k < tile_begin[t + 1]; k++) {
+      const size_t s = tile_samples[k];
+      const size_t i = s * subsample;
+      const PointT &p = cloud.points[i];
+      PointT &r_pt = rendered_view_->points[pixel[s]];
+      if (!pcl_isfinite(r_pt.z) || (p.z < r_pt.z)) {
+        r_pt = p;
+        index_map_.data()[pixel[s]] = i;
+      }
     }
   }
 }
 
 template <typename PointT>
 void ZBuffering<PointT>::doSmoothing() {
-  pcl::PointCloud<PointT> rendered_view_unsmooth = *rendered_view_;
+  const int width = rendered_view_->width;
+  const int height = rendered_view_->height;
+  const int radius = param_.smoothing_radius_;
+  if (width <= 2 * radius || height <= 2 * radius)
+    return;
 
-  for (size_t u = param_.smoothing_radius_; u < (rendered_view_->width - param_.smoothing_radius_); u++) {
-    for (size_t v = param_.smoothing_radius_; v < (rendered_view_->height - param_.smoothing_radius_); v++) {
+  const pcl::PointCloud<PointT> rendered_view_unsmooth = *rendered_view_;
+  const IndexMap index_map_unsmooth = index_map_;
+
+  std::vector<float> depth(rendered_view_unsmooth.points.size());
+  for (size_t px = 0; px < depth.size(); px++) {
+    const PointT &p = rendered_view_unsmooth.points[px];
+    depth[px] = pcl::isFinite(p) ? p.z : std::numeric_limits<float>::infinity();
+  }
+
+  // The closest point within the window is found separately along rows and columns. Ties are resolved as if the
+  // window was traversed column by column, i.e. the point with smallest column and then smallest row index wins.
+  std::vector<int> row_min_u(depth.size(), -1);  ///< column of closest point within the horizontal window
+#pragma omp parallel for schedule(static)
+  for (int v = 0; v < height; v++) {
+    const float *depth_row = &depth[v * width];
+    for (int u = radius; u < width - radius; u++) {
       float min = std::numeric_limits<float>::max();
-      int min_uu = u, min_vv = v;
-      for (size_t uu = (u - param_.smoothing_radius_); uu <= (u + param_.smoothing_radius_); uu++) {
-        for (size_t vv = (v - param_.smoothing_radius_); vv <= (v + param_.smoothing_radius_); vv++) {
-          if (uu > rendered_view_->width || vv > rendered_view_->height)  // this shouldn't happen anyway
-            continue;
+      for (int uu = u - radius; uu <= u + radius; uu++) {
+        if (depth_row[uu] < min) {
+          min = depth_row[uu];
+          row_min_u[v * width + u] = uu;
+        }
+      }
+    }
+  }
 
-          const PointT &p = rendered_view_unsmooth.at(uu, vv);
-          if (!pcl_isfinite(min) || (pcl::isFinite(p) && (p.z < min))) {
-            min = p.z;
-            min_uu = uu;
-            min_vv = vv;
-          }
+#pragma omp parallel for schedule(static)
+  for (int v = radius; v < height - radius; v++) {
+    for (int u = radius; u < width - radius; u++) {
+      float min = std::numeric_limits<float>::max();
+      int min_uu = -1, min_vv = -1;
+      for (int vv = v - radius; vv <= v + radius; vv++) {
+        const int uu = row_min_u[vv * width + u];
+        if (uu < 0)
+          continue;
+
+        const float d = depth[vv * width + uu];
+        if (d < min || (d == min && uu < min_uu)) {
+          min = d;
+          min_uu = uu;
+          min_vv = vv;
         }
       }
 
-      rendered_view_->at(u, v) = rendered_view_unsmooth.at(min_uu, min_vv);
-      index_map_(v, u) = index_map_(min_vv,
-                                    min_uu);  /// NOTE: Be careful, this is maybe not what you want to get!
+      if (min_uu >= 0) {
+        rendered_view_->points[v * width + u] = rendered_view_unsmooth.points[min_vv * width + min_uu];
+        index_map_(v, u) = index_map_unsmooth(min_vv, min_uu);
+      }
     }
   }
 }
 
 template <typename PointT>
 void ZBuffering<PointT>::doNoiseFiltering() {
+  const int width = rendered_view_->width;
+  const int height = rendered_view_->height;
+  const int radius = param_.smoothing_radius_;
+  if (width <= 2 * radius || height <= 2 * radius)
+    return;
+
   pcl::PointCloud<PointT> rendered_view_filtered = *rendered_view_;
 
-  for (size_t u = param_.smoothing_radius_; u < ((int)rendered_view_->width - param_.smoothing_radius_); u++) {
-    for (size_t v = param_.smoothing_radius_; v < ((int)rendered_view_->height - param_.smoothing_radius_); v++) {
-      PointT &p = rendered_view_filtered.at(u, v);
+#pragma omp parallel for schedule(static)
+  for (int v = radius; v < height - radius; v++) {
+    for (int u = radius; u < width - radius; u++) {
+      PointT &p = rendered_view_filtered.points[v * width + u];
       bool is_noise = true;
-      for (size_t uu = (u - param_.smoothing_radius_); uu <= (u + param_.smoothing_radius_) && is_noise; uu++) {
-        for (size_t vv = (v - param_.smoothing_radius_); vv <= (v + param_.smoothing_radius_); vv++) {
-          if (uu > rendered_view_->width || vv > rendered_view_->height)  // this shouldn't happen anyway
-            continue;
-
+      for (int vv = v - radius; vv <= v + radius && is_noise; vv++) {
+        for (int uu = u - radius; uu <= u + radius; uu++) {
           if (uu == u && vv == v)
             continue;
 
-          PointT &p_tmp = rendered_view_->at(uu, vv);
+          const PointT &p_tmp = rendered_view_->points[vv * width + uu];
           if (std::abs(p.z - p_tmp.z) < param_.inlier_threshold_) {
             is_noise = false;
             break;
@@ -150,7 +220,7 @@ void ZBuffering<PointT>::renderPointCloud(const pcl::PointCloud<PointT> &cloud,
     rendered_view_->is_dense = false;
   }
 
-  index_map_ = Eigen::MatrixXi::Constant(cam_.h, cam_.w, -1);
+  index_map_.setConstant(cam_.h, cam_.w, -1);
 
   for (PointT &p : rendered_view_->points)  // initialize points to infinity
     p.z = std::numeric_limits<float>::quiet_NaN();
@@ -168,12 +238,9 @@ void ZBuffering<PointT>::renderPointCloud(const pcl::PointCloud<PointT> &cloud,
   if (param_.extract_indices_) {
     boost::dynamic_bitset<> pt_is_kept(cloud.points.size(), 0);
 
-    for (int v = 0; v < index_map_.rows(); v++) {
-      for (int u = 0; u < index_map_.cols(); u++) {
-        if (index_map_(v, u) >= 0) {
-          pt_is_kept.set(index_map_(v, u));
-        }
-      }
+    for (int px = 0; px < index_map_.size(); px++) {
+      if (index_map_.data()[px] >= 0)
+        pt_is_kept.set(index_map_.data()[px]);
     }
 
     kept_indices_ = createIndicesFromMask<int>(pt_is_kept);
@@ -184,6 +251,27 @@ void ZBuffering<PointT>::renderPointCloud(const pcl::PointCloud<PointT> &cloud,
   rendered_view = *rendered_view_;
 }
 
+template <typename PointT>
+void ZBuffering<PointT>::renderPointClouds(const std::vector<typename pcl::PointCloud<PointT>::ConstPtr> &clouds,
+                                           const std::vector<pcl::PointCloud<pcl::Normal>::ConstPtr> &normals,
+                                           std::vector<typename pcl::PointCloud<PointT>::Ptr> &rendered_views,
+                                           std::vector<Eigen::MatrixXi> &index_maps, size_t subsample) const {
+  CHECK(normals.empty() || normals.size() == clouds.size());
+
+  rendered_views.resize(clouds.size());
+  index_maps.resize(clouds.size());
+
+#pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < clouds.size(); i++) {
+    ZBuffering<PointT> zbuf(cam_, param_);
+    if (!normals.empty())
+      zbuf.setCloudNormals(normals[i]);
+    rendered_views[i].reset(new pcl::PointCloud<PointT>);
+    zbuf.renderPointCloud(*clouds[i], *rendered_views[i], subsample);
+    index_maps[i] = zbuf.index_map_;
+  }
+}
+
 #define PCL_INSTANTIATE_ZBuffering(T) template class V4R_EXPORTS ZBuffering<T>;
 PCL_INSTANTIATE(ZBuffering, PCL_XYZ_POINT_TYPES)
 
@@ -57,12 +57,28 @@ namespace io {
 ///
 /// If the directory contains "intrinsics.{txt,yaml,yml,xml}", Intrinsics will be loaded from it and made available
 /// through getCameraIntrinsics(). If the file is not present, default Kinect intrinsics are assumed.
+///
+/// Frames are decoded ahead of time in a background thread into a small pool of reusable color/depth buffers. When
+/// grabFrame() is given cv::Mat outputs, the decoded buffers are swapped into them (no copy) and the previous buffers
+/// of the caller are returned to the pool. Binary PCD files are decoded directly into the images, other PCD formats
+/// go through pcl::PCDReader.
+///
+/// # URI format
+///
+/// \c directory or \c directory#n, where \c n is the number of frames to decode ahead (default 4). Look-ahead 0
+/// disables the background thread and frames are decoded in grabFrame().
 class V4R_EXPORTS PCDGrabber : public Grabber {
  public:
   using Ptr = std::shared_ptr<PCDGrabber>;
 
-  /// Construct a grabber for a given directory.
-  PCDGrabber(const std::string& directory);
+  /// Default number of frames decoded ahead of time.
+  static constexpr unsigned int DEFAULT_LOOKAHEAD = 4;
+
+  /// Construct a grabber for a given URI (directory with optional look-ahead, see the class description).
+  PCDGrabber(const std::string& uri);
+
+  /// Construct a grabber for a given directory which decodes \a lookahead frames ahead of time.
+  PCDGrabber(const std::string& directory, unsigned int lookahead);
 
   ~PCDGrabber() override;
 
@@ -92,6 +108,9 @@ class V4R_EXPORTS PCDGrabber : public Grabber {
 
   bool getRepeatEnabled() const override;
 
+  /// Get the number of frames decoded ahead of time.
+  unsigned int getLookahead() const;
+
  private:
   struct Impl;
   std::unique_ptr<Impl> p;
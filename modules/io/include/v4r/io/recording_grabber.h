@@ -0,0 +1,139 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 TU Wien, ACIN, Vision 4 Robotics (V4R) group
+** Contact: v4r.acin.tuwien.ac.at
+**
+** This file is part of V4R
+**
+** V4R is distributed under dual licenses - GPLv3 or closed source.
+**
+** GNU General Public License Usage
+** V4R is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published
+** by the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** V4R is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** Please review the following information to ensure the GNU General Public
+** License requirements will be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+**
+** Commercial License Usage
+** If GPL is not suitable for your project, you must purchase a commercial
+** license to use V4R. Licensees holding valid commercial V4R licenses may
+** use this file in accordance with the commercial license agreement
+** provided with the Software or, alternatively, in accordance with the
+** terms contained in a written agreement between you and TU Wien, ACIN, V4R.
+** For licensing terms and conditions please contact office<at>acin.tuwien.ac.at.
+**
+**
+** The copyright holder additionally grants the author(s) of the file the right
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or
+** sell copies of their contributions without any restrictions.
+**
+****************************************************************************/
+
+#pragma once
+
+#include <string>
+
+#include <v4r/core/macros.h>
+#include <v4r/io/grabber.h>
+
+namespace v4r {
+namespace io {
+
+/// Grab from an RGB-D recording file written with RecordingWriter.
+///
+/// A recording is a single file with a fixed-size header (resolution, camera intrinsics, stream encodings), one chunk
+/// per frame and a frame index with timestamps at the end. Depth is stored as 16-bit millimeters, color as 8-bit BGR.
+/// Each stream is stored either raw or losslessly compressed (PNG). The file is memory mapped, so seeking is free and
+/// raw streams are decoded without any intermediate copies.
+///
+/// # URI format
+///
+/// Path to the recording file. Files which do not start with the recording signature are rejected, so that
+/// createGrabber() can try other grabbers.
+class V4R_EXPORTS RecordingGrabber : public Grabber {
+ public:
+  using Ptr = std::shared_ptr<RecordingGrabber>;
+
+  /// Construct a grabber for a given recording file.
+  explicit RecordingGrabber(const std::string& filename);
+
+  ~RecordingGrabber() override;
+
+  Timestamp grabFrame(cv::OutputArray color, cv::OutputArray depth) override;
+
+  bool hasMoreFrames() const override;
+
+  int getNumberOfFrames() const override;
+
+  int getCurrentFrameIndex() const override;
+
+  Intrinsics getCameraIntrinsics() const override;
+
+  using Grabber::printInfo;
+
+  void printInfo(std::ostream& os) const override;
+
+  StreamMode getActiveColorStreamMode() const override;
+
+  StreamMode getActiveDepthStreamMode() const override;
+
+  bool isFeatureSupported(Feature feature) const override;
+
+  void seek(unsigned int index) override;
+
+  void setRepeatEnabled(bool state) override;
+
+  bool getRepeatEnabled() const override;
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> p;
+};
+
+/// Write RGB-D frames into a recording file that can be replayed with RecordingGrabber.
+///
+/// Resolution and available streams are determined from the first frame, all following frames have to match. Depth
+/// values are rounded to millimeters, invalid (NaN, non-positive) and out of range values are stored as zero. The file
+/// is only complete after close() (or destruction of the writer).
+class V4R_EXPORTS RecordingWriter {
+ public:
+  /// Encoding of a stream in the recording file.
+  enum class Encoding : uint32_t {
+    NONE = 0,  ///< stream is not available
+    RAW = 1,   ///< uncompressed pixels
+    PNG = 2,   ///< lossless PNG compression
+  };
+
+  /// Open a recording file for writing (an existing file is overwritten).
+  /// \param[in] color_encoding encoding of the color stream (RAW or PNG)
+  /// \param[in] depth_encoding encoding of the depth stream (RAW or PNG)
+  RecordingWriter(const std::string& filename, const Intrinsics& intrinsics, Encoding color_encoding = Encoding::PNG,
+                  Encoding depth_encoding = Encoding::PNG);
+
+  ~RecordingWriter();
+
+  /// Append a frame. Color has to be 8UC3 (BGR), depth 32FC1 (meters). Either of them may be empty if the stream is
+  /// not available, but this has to be consistent for all frames.
+  void write(Grabber::Timestamp timestamp, cv::InputArray color, cv::InputArray depth);
+
+  /// Get the number of frames written so far.
+  size_t getNumberOfFrames() const;
+
+  /// Write frame index and finalize the file. Further calls to write() are not allowed.
+  void close();
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> p;
+};
+
+}  // namespace io
+}  // namespace v4r
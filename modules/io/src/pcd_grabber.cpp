@@ -38,8 +38,16 @@
 ****************************************************************************/
 
 #include <cinttypes>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <thread>
 
 #include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
 #include <boost/throw_exception.hpp>
 
 #include <pcl/io/pcd_io.h>
@@ -51,6 +59,37 @@ namespace fs = boost::filesystem;
 namespace v4r {
 namespace io {
 
+namespace {
+
+/// Split "directory#n" URI into directory and look-ahead. If the URI does not end with "#<number>" or the full URI is
+/// an existing path, it is used as directory as is.
+void parseURI(const std::string& uri, std::string& directory, unsigned int& lookahead) {
+  directory = uri;
+  lookahead = PCDGrabber::DEFAULT_LOOKAHEAD;
+  auto pos = uri.rfind('#');
+  if (pos == std::string::npos || fs::exists(uri))
+    return;
+  try {
+    lookahead = boost::lexical_cast<unsigned int>(uri.substr(pos + 1));
+    directory = uri.substr(0, pos);
+  } catch (boost::bad_lexical_cast&) {
+    lookahead = PCDGrabber::DEFAULT_LOOKAHEAD;
+  }
+}
+
+/// Check if the given matrix can be reused as decoding buffer, i.e. nobody else holds a reference to its data.
+bool isExclusiveBuffer(const cv::Mat& m, cv::Size size, int type) {
+  if (m.empty() || m.size() != size || m.type() != type || !m.isContinuous())
+    return false;
+#if CV_MAJOR_VERSION < 3
+  return m.refcount && *m.refcount == 1;
+#else
+  return m.u && m.u->refcount == 1;
+#endif
+}
+
+}  // namespace
+
 struct PCDGrabber::Impl {
   cv::Size image_resolution = {0, 0};
   size_t image_size = 0;
@@ -64,8 +103,28 @@ struct PCDGrabber::Impl {
   pcl::PCDReader reader;
   pcl::PCLPointCloud2 pcl_cloud;
   pcl::PointCloud<pcl::PointXYZRGB> cloud;
-
-  Impl(const std::string& directory) : path(directory) {
+  std::vector<uint8_t> buffer;  ///< raw point data of binary PCD files
+
+  /// A decoded frame (or the error that occurred while decoding it).
+  struct Frame {
+    Timestamp timestamp = 0;
+    cv::Mat color;
+    cv::Mat depth;
+    std::exception_ptr error;
+  };
+
+  unsigned int lookahead;
+  std::thread worker;
+  std::mutex mutex;                         ///< protects all members below, as well as repeat and current_frame
+  std::condition_variable worker_cv;        ///< signals the worker that there is space in the queue or it should stop
+  std::condition_variable consumer_cv;      ///< signals grabFrame() that a frame was decoded
+  std::deque<Frame> queue;                  ///< decoded frames, the front one corresponds to current_frame
+  std::vector<Frame> pool;                  ///< unused buffers
+  std::list<std::pair<double, fs::path>>::iterator prefetch_frame;  ///< next frame to be decoded by the worker
+  unsigned int generation = 0;  ///< incremented whenever the queue is invalidated (seek, change of repeat state)
+  bool stop = false;
+
+  Impl(const std::string& directory, unsigned int lookahead_frames) : path(directory), lookahead(lookahead_frames) {
     if (!fs::exists(path) || !fs::is_directory(path))
       BOOST_THROW_EXCEPTION(GrabberException("Path does not exist or is not a directory")
                             << GrabberException::Filename(path.string()));
@@ -90,6 +149,22 @@ struct PCDGrabber::Impl {
     current_frame = frames.begin();
 
     loadMetadata(current_frame->second);
+
+    if (lookahead > 0) {
+      prefetch_frame = current_frame;
+      worker = std::thread(&Impl::prefetch, this);
+    }
+  }
+
+  ~Impl() {
+    if (worker.joinable()) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+      }
+      worker_cv.notify_one();
+      worker.join();
+    }
   }
 
   void loadFrames() {
@@ -117,10 +192,7 @@ struct PCDGrabber::Impl {
         has_color = true;
   }
 
-  void loadPCD(const fs::path& p, cv::Mat& color, cv::Mat& depth) {
-    if (reader.read(p.string(), pcl_cloud))
-      BOOST_THROW_EXCEPTION(GrabberException("Failed to read from PCD file") << GrabberException::Filename(p.string()));
-
+  void checkHeader(const fs::path& p) const {
     if (static_cast<int>(pcl_cloud.width) != image_resolution.width ||
         static_cast<int>(pcl_cloud.height) != image_resolution.height)
       BOOST_THROW_EXCEPTION(GrabberException("PCD cloud resolution mismatch")
@@ -133,6 +205,63 @@ struct PCDGrabber::Impl {
     if (has_color && !(available_fields.count("rgb") || available_fields.count("rgba")))
       BOOST_THROW_EXCEPTION(GrabberException("PCD file does not have color field")
                             << GrabberException::Filename(p.string()));
+  }
+
+  /// Decode a binary PCD file directly into color and depth images, without going through a pcl::PointCloud.
+  /// \return false if the file is not binary or its fields have unexpected types (nothing is decoded then)
+  bool loadBinaryPCD(const fs::path& p, cv::Mat& color, cv::Mat& depth) {
+    Eigen::Vector4f origin;
+    Eigen::Quaternionf orientation;
+    int pcd_version, data_type;
+    unsigned int data_idx;
+    if (reader.readHeader(p.string(), pcl_cloud, origin, orientation, pcd_version, data_type, data_idx))
+      BOOST_THROW_EXCEPTION(GrabberException("Failed to read from PCD file") << GrabberException::Filename(p.string()));
+
+    checkHeader(p);
+
+    if (data_type != 1)  // ascii or binary compressed
+      return false;
+
+    int z_offset = -1, rgb_offset = -1;
+    for (const auto& field : pcl_cloud.fields) {
+      if (field.name == "z" && field.datatype == pcl::PCLPointField::FLOAT32 && field.count == 1)
+        z_offset = field.offset;
+      else if ((field.name == "rgb" || field.name == "rgba") && field.count == 1 &&
+               (field.datatype == pcl::PCLPointField::FLOAT32 || field.datatype == pcl::PCLPointField::UINT32))
+        rgb_offset = field.offset;
+    }
+    if (z_offset < 0 || (has_color && rgb_offset < 0))
+      return false;
+
+    const size_t point_step = pcl_cloud.point_step;
+    buffer.resize(point_step * image_resolution.area());
+    std::ifstream file(p.string().c_str(), std::ios::binary);
+    file.seekg(data_idx);
+    if (!file.read(reinterpret_cast<char*>(buffer.data()), buffer.size()))
+      BOOST_THROW_EXCEPTION(GrabberException("Failed to read from PCD file") << GrabberException::Filename(p.string()));
+
+    // rgb is stored as BGRA bytes (little endian packed 0x00RRGGBB), as in pcl::PointXYZRGB
+    const uint8_t* src = buffer.data();
+    for (int i = 0; i < image_resolution.height; ++i) {
+      float* depth_row = depth.ptr<float>(i);
+      cv::Vec3b* color_row = has_color ? color.ptr<cv::Vec3b>(i) : nullptr;
+      for (int j = 0; j < image_resolution.width; ++j, src += point_step) {
+        std::memcpy(&depth_row[j], src + z_offset, sizeof(float));
+        if (color_row)
+          color_row[j] = {src[rgb_offset], src[rgb_offset + 1], src[rgb_offset + 2]};
+      }
+    }
+    return true;
+  }
+
+  void loadPCD(const fs::path& p, cv::Mat& color, cv::Mat& depth) {
+    if (loadBinaryPCD(p, color, depth))
+      return;
+
+    if (reader.read(p.string(), pcl_cloud))
+      BOOST_THROW_EXCEPTION(GrabberException("Failed to read from PCD file") << GrabberException::Filename(p.string()));
+
+    checkHeader(p);
 
     pcl::fromPCLPointCloud2(pcl_cloud, cloud);
 
@@ -154,13 +283,131 @@ struct PCDGrabber::Impl {
     }
     return ts;
   }
+
+  /// Worker thread: decode frames ahead of current_frame until the queue holds lookahead frames.
+  void prefetch() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      worker_cv.wait(lock, [this] { return stop || (queue.size() < lookahead && prefetch_frame != frames.end()); });
+      if (stop)
+        return;
+
+      const auto frame_to_load = prefetch_frame;
+      if (++prefetch_frame == frames.end() && repeat)
+        prefetch_frame = frames.begin();
+      const unsigned int frame_generation = generation;
+
+      Frame frame;
+      if (!pool.empty()) {
+        frame = std::move(pool.back());
+        pool.pop_back();
+      }
+      lock.unlock();
+
+      if (has_color && frame.color.empty())
+        frame.color.create(image_resolution, CV_8UC3);
+      if (frame.depth.empty())
+        frame.depth.create(image_resolution, CV_32FC1);
+      frame.timestamp = frame_to_load->first;
+      try {
+        loadPCD(frame_to_load->second, frame.color, frame.depth);
+      } catch (...) {
+        frame.error = std::current_exception();
+      }
+
+      lock.lock();
+      if (frame_generation != generation) {  // queue was invalidated while decoding
+        frame.error = nullptr;
+        pool.push_back(std::move(frame));
+        continue;
+      }
+      queue.push_back(std::move(frame));
+      consumer_cv.notify_one();
+    }
+  }
+
+  /// Drop all decoded frames and restart decoding at current_frame. Requires the mutex to be locked.
+  void invalidateQueue() {
+    ++generation;
+    for (auto& frame : queue) {
+      frame.error = nullptr;
+      pool.push_back(std::move(frame));
+    }
+    queue.clear();
+    prefetch_frame = current_frame;
+    worker_cv.notify_one();
+  }
+
+  /// Hand a decoded buffer over to the caller. Matrices are swapped, so the previous buffer of the caller ends up in
+  /// \a buffer and is reused for decoding if nobody else refers to it.
+  void deliver(cv::OutputArray output, cv::Mat& buffer, int type) {
+    if (output.kind() == cv::_InputArray::MAT) {
+      cv::swap(output.getMatRef(), buffer);
+      if (!isExclusiveBuffer(buffer, image_resolution, type))
+        buffer.release();
+    } else {
+      buffer.copyTo(output);
+    }
+  }
+
+  Timestamp grabPrefetchedFrame(cv::OutputArray color, cv::OutputArray depth) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (current_frame == frames.end()) {
+      lock.unlock();
+      if (has_color)
+        color.create(image_resolution, CV_8UC3);
+      else
+        color.clear();
+      depth.create(image_resolution, CV_32FC1);
+      return 0;
+    }
+
+    consumer_cv.wait(lock, [this] { return !queue.empty(); });
+    Frame frame = std::move(queue.front());
+    queue.pop_front();
+
+    if (frame.error) {
+      // keep current frame (as when decoding synchronously), so that the next call tries to load it again
+      std::exception_ptr error = frame.error;
+      frame.error = nullptr;
+      pool.push_back(std::move(frame));
+      invalidateQueue();
+      std::rethrow_exception(error);
+    }
+
+    if (++current_frame == frames.end() && repeat)
+      current_frame = frames.begin();
+    worker_cv.notify_one();
+    lock.unlock();
+
+    if (has_color)
+      deliver(color, frame.color, CV_8UC3);
+    else
+      color.clear();
+    deliver(depth, frame.depth, CV_32FC1);
+
+    const Timestamp timestamp = frame.timestamp;
+    lock.lock();
+    pool.push_back(std::move(frame));
+    return timestamp;
+  }
 };
 
-PCDGrabber::PCDGrabber(const std::string& directory) : p(new Impl(directory)) {}
+PCDGrabber::PCDGrabber(const std::string& uri) {
+  std::string directory;
+  unsigned int lookahead;
+  parseURI(uri, directory, lookahead);
+  p.reset(new Impl(directory, lookahead));
+}
+
+PCDGrabber::PCDGrabber(const std::string& directory, unsigned int lookahead) : p(new Impl(directory, lookahead)) {}
 
 PCDGrabber::~PCDGrabber() = default;
 
 Grabber::Timestamp PCDGrabber::grabFrame(cv::OutputArray _color, cv::OutputArray _depth) {
+  if (p->lookahead > 0)
+    return p->grabPrefetchedFrame(_color, _depth);
+
   if (p->has_color)
     _color.create(p->image_resolution.height, p->image_resolution.width, CV_8UC3);
   else
@@ -172,6 +419,7 @@ Grabber::Timestamp PCDGrabber::grabFrame(cv::OutputArray _color, cv::OutputArray
 }
 
 inline bool PCDGrabber::hasMoreFrames() const {
+  std::lock_guard<std::mutex> lock(p->mutex);
   return p->repeat || p->current_frame != p->frames.end();
 }
 
@@ -180,6 +428,7 @@ int PCDGrabber::getNumberOfFrames() const {
 }
 
 int PCDGrabber::getCurrentFrameIndex() const {
+  std::lock_guard<std::mutex> lock(p->mutex);
   return static_cast<int>(std::distance(p->frames.begin(), p->current_frame)) - 1;
 }
 
@@ -190,6 +439,7 @@ Intrinsics PCDGrabber::getCameraIntrinsics() const {
 void PCDGrabber::printInfo(std::ostream& os) const {
   os << "PCDGrabber :: " << p->path.string() << std::endl;
   os << " Number of frames: " << p->frames.size() << std::endl;
+  os << " Look-ahead: " << p->lookahead << std::endl;
   Grabber::printInfo(os);
 }
 
@@ -214,18 +464,31 @@ bool PCDGrabber::isFeatureSupported(Feature feature) const {
 void PCDGrabber::seek(unsigned int index) {
   if (index > p->frames.size())
     BOOST_THROW_EXCEPTION(GrabberException("Seeking to a non-existent index") << GrabberException::Index(index));
+  std::lock_guard<std::mutex> lock(p->mutex);
   p->current_frame = p->frames.begin();
   std::advance(p->current_frame, index);
+  if (p->lookahead > 0)
+    p->invalidateQueue();
 }
 
 void PCDGrabber::setRepeatEnabled(bool state) {
   throwIfNotSupported(Feature::REPEAT);
-  p->repeat = state;
+  std::lock_guard<std::mutex> lock(p->mutex);
+  if (p->repeat != state) {
+    p->repeat = state;
+    // frames after the end of the sequence were decoded with the previous setting
+    if (p->lookahead > 0)
+      p->invalidateQueue();
+  }
 }
 
 bool PCDGrabber::getRepeatEnabled() const {
   return p->repeat;
 }
 
+unsigned int PCDGrabber::getLookahead() const {
+  return p->lookahead;
+}
+
 }  // namespace io
 }  // namespace v4r
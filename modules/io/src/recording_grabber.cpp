@@ -0,0 +1,454 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 TU Wien, ACIN, Vision 4 Robotics (V4R) group
+** Contact: v4r.acin.tuwien.ac.at
+**
+** This file is part of V4R
+**
+** V4R is distributed under dual licenses - GPLv3 or closed source.
+**
+** GNU General Public License Usage
+** V4R is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published
+** by the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** V4R is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** Please review the following information to ensure the GNU General Public
+** License requirements will be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+**
+** Commercial License Usage
+** If GPL is not suitable for your project, you must purchase a commercial
+** license to use V4R. Licensees holding valid commercial V4R licenses may
+** use this file in accordance with the commercial license agreement
+** provided with the Software or, alternatively, in accordance with the
+** terms contained in a written agreement between you and TU Wien, ACIN, V4R.
+** For licensing terms and conditions please contact office<at>acin.tuwien.ac.at.
+**
+**
+** The copyright holder additionally grants the author(s) of the file the right
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or
+** sell copies of their contributions without any restrictions.
+**
+****************************************************************************/
+
+#include <cstring>
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/throw_exception.hpp>
+
+#include <opencv2/highgui/highgui.hpp>
+
+#include <v4r/io/recording_grabber.h>
+
+namespace bip = boost::interprocess;
+namespace fs = boost::filesystem;
+
+namespace v4r {
+namespace io {
+
+namespace {
+
+const char RECORDING_MAGIC[8] = {'V', '4', 'R', 'R', 'G', 'B', 'D', '\0'};
+const uint32_t RECORDING_VERSION = 1;
+
+/// Fixed-size header at the beginning of a recording file (native byte order).
+struct RecordingHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t width;
+  uint32_t height;
+  uint32_t color_encoding;
+  uint32_t depth_encoding;
+  float fx, fy, cx, cy;
+  uint32_t reserved;
+  uint64_t num_frames;
+  uint64_t index_offset;  ///< offset of the frame index (array of RecordingIndexEntry)
+  uint64_t file_size;     ///< written last, so an unfinished recording is detected
+};
+static_assert(sizeof(RecordingHeader) == 72, "Unexpected padding in recording header");
+
+/// Location of the color and depth data of a frame within the recording file.
+struct RecordingIndexEntry {
+  uint64_t timestamp;
+  uint64_t color_offset;
+  uint64_t color_size;
+  uint64_t depth_offset;
+  uint64_t depth_size;
+};
+
+using Encoding = RecordingWriter::Encoding;
+
+const char* toString(uint32_t encoding) {
+  switch (static_cast<Encoding>(encoding)) {
+    case Encoding::NONE:
+      return "none";
+    case Encoding::RAW:
+      return "raw";
+    case Encoding::PNG:
+      return "png";
+  }
+  return "unknown";
+}
+
+/// Decode a PNG image. If the output is a cv::Mat with matching size and type, its memory is reused.
+void decodePNG(const uint8_t* data, size_t size, cv::OutputArray output) {
+  const cv::Mat buffer(1, static_cast<int>(size), CV_8UC1, const_cast<uint8_t*>(data));
+  if (output.kind() == cv::_InputArray::MAT) {
+    cv::imdecode(buffer, cv::IMREAD_UNCHANGED, &output.getMatRef());
+    if (output.getMatRef().empty())
+      BOOST_THROW_EXCEPTION(CodecException("Failed to decode PNG image"));
+  } else {
+    cv::Mat decoded = cv::imdecode(buffer, cv::IMREAD_UNCHANGED);
+    if (decoded.empty())
+      BOOST_THROW_EXCEPTION(CodecException("Failed to decode PNG image"));
+    decoded.copyTo(output);
+  }
+}
+
+}  // namespace
+
+struct RecordingGrabber::Impl {
+  fs::path filename;
+  std::shared_ptr<bip::mapped_region> region;
+  const uint8_t* data = nullptr;
+  RecordingHeader header;
+  std::vector<RecordingIndexEntry> index;
+  Intrinsics intrinsics;
+  cv::Size image_resolution;
+  size_t next_frame = 0;
+  bool repeat = false;
+  cv::Mat depth_mm;  ///< decoded depth in millimeters (reused between frames)
+
+  Impl(const std::string& uri) : filename(uri) {
+    if (uri.empty() || !fs::is_regular_file(filename))
+      BOOST_THROW_EXCEPTION(GrabberException("Recording file does not exist") << GrabberException::Filename(uri));
+
+    try {
+      bip::file_mapping file(uri.c_str(), bip::read_only);
+      region.reset(new bip::mapped_region(file, bip::read_only));
+    } catch (const bip::interprocess_exception& e) {
+      BOOST_THROW_EXCEPTION(GrabberException("Failed to map recording file")
+                            << GrabberException::Filename(uri) << GrabberException::ErrorInfo(e.what()));
+    }
+
+    data = static_cast<const uint8_t*>(region->get_address());
+    const size_t size = region->get_size();
+    if (size < sizeof(header) || std::memcmp(data, RECORDING_MAGIC, sizeof(RECORDING_MAGIC)) != 0)
+      BOOST_THROW_EXCEPTION(GrabberException("Not a recording file") << GrabberException::Filename(uri));
+
+    std::memcpy(&header, data, sizeof(header));
+    if (header.version != RECORDING_VERSION)
+      BOOST_THROW_EXCEPTION(GrabberException("Unsupported recording file version") << GrabberException::Filename(uri));
+    if (header.file_size != size || header.index_offset > size ||
+        header.num_frames > (size - header.index_offset) / sizeof(RecordingIndexEntry))
+      BOOST_THROW_EXCEPTION(GrabberException("Recording file is incomplete or corrupted")
+                            << GrabberException::Filename(uri));
+    if (header.num_frames == 0)
+      BOOST_THROW_EXCEPTION(GrabberException("Recording file does not contain frames")
+                            << GrabberException::Filename(uri));
+
+    index.resize(header.num_frames);
+    std::memcpy(index.data(), data + header.index_offset, index.size() * sizeof(RecordingIndexEntry));
+
+    image_resolution = cv::Size(header.width, header.height);
+    const size_t pixels = static_cast<size_t>(header.width) * header.height;
+    for (const auto& e : index) {
+      if (e.color_offset + e.color_size > header.index_offset || e.depth_offset + e.depth_size > header.index_offset ||
+          (header.color_encoding == static_cast<uint32_t>(Encoding::RAW) && e.color_size != pixels * 3) ||
+          (header.depth_encoding == static_cast<uint32_t>(Encoding::RAW) && e.depth_size != pixels * 2))
+        BOOST_THROW_EXCEPTION(GrabberException("Recording file index is corrupted") << GrabberException::Filename(uri));
+    }
+
+    intrinsics.fx = header.fx;
+    intrinsics.fy = header.fy;
+    intrinsics.cx = header.cx;
+    intrinsics.cy = header.cy;
+    intrinsics.w = header.width;
+    intrinsics.h = header.height;
+  }
+
+  bool hasColor() const {
+    return header.color_encoding != static_cast<uint32_t>(Encoding::NONE);
+  }
+
+  bool hasDepth() const {
+    return header.depth_encoding != static_cast<uint32_t>(Encoding::NONE);
+  }
+
+  void decodeColor(const RecordingIndexEntry& e, cv::OutputArray color) {
+    const uint8_t* chunk = data + e.color_offset;
+    if (header.color_encoding == static_cast<uint32_t>(Encoding::RAW)) {
+      cv::Mat(image_resolution, CV_8UC3, const_cast<uint8_t*>(chunk)).copyTo(color);
+    } else {
+      decodePNG(chunk, e.color_size, color);
+      if (color.size() != image_resolution || color.type() != CV_8UC3)
+        BOOST_THROW_EXCEPTION(GrabberException("Recorded color image has unexpected size or type")
+                              << GrabberException::Filename(filename.string()));
+    }
+  }
+
+  void decodeDepth(const RecordingIndexEntry& e, cv::OutputArray depth) {
+    const uint8_t* chunk = data + e.depth_offset;
+    if (header.depth_encoding == static_cast<uint32_t>(Encoding::RAW)) {
+      // directly convert from the mapped memory
+      cv::Mat(image_resolution, CV_16UC1, const_cast<uint8_t*>(chunk)).convertTo(depth, CV_32FC1, 0.001);
+    } else {
+      decodePNG(chunk, e.depth_size, depth_mm);
+      if (depth_mm.size() != image_resolution || depth_mm.type() != CV_16UC1)
+        BOOST_THROW_EXCEPTION(GrabberException("Recorded depth image has unexpected size or type")
+                              << GrabberException::Filename(filename.string()));
+      depth_mm.convertTo(depth, CV_32FC1, 0.001);
+    }
+  }
+
+  Timestamp grabFrame(cv::OutputArray color, cv::OutputArray depth) {
+    if (next_frame >= index.size())
+      return 0;
+
+    const RecordingIndexEntry& e = index[next_frame];
+    if (hasColor())
+      decodeColor(e, color);
+    else
+      color.clear();
+    if (hasDepth())
+      decodeDepth(e, depth);
+    else
+      depth.clear();
+
+    if (++next_frame == index.size() && repeat)
+      next_frame = 0;
+    return e.timestamp;
+  }
+};
+
+RecordingGrabber::RecordingGrabber(const std::string& filename) : p(new Impl(filename)) {}
+
+RecordingGrabber::~RecordingGrabber() = default;
+
+Grabber::Timestamp RecordingGrabber::grabFrame(cv::OutputArray color, cv::OutputArray depth) {
+  return p->grabFrame(color, depth);
+}
+
+bool RecordingGrabber::hasMoreFrames() const {
+  return p->repeat || p->next_frame < p->index.size();
+}
+
+int RecordingGrabber::getNumberOfFrames() const {
+  return static_cast<int>(p->index.size());
+}
+
+int RecordingGrabber::getCurrentFrameIndex() const {
+  return static_cast<int>(p->next_frame) - 1;
+}
+
+Intrinsics RecordingGrabber::getCameraIntrinsics() const {
+  return p->intrinsics;
+}
+
+void RecordingGrabber::printInfo(std::ostream& os) const {
+  os << "RecordingGrabber :: " << p->filename.string() << std::endl;
+  os << " Number of frames: " << p->index.size() << std::endl;
+  os << " Color encoding: " << toString(p->header.color_encoding) << std::endl;
+  os << " Depth encoding: " << toString(p->header.depth_encoding) << std::endl;
+  Grabber::printInfo(os);
+}
+
+Grabber::StreamMode RecordingGrabber::getActiveColorStreamMode() const {
+  if (!p->hasColor())
+    return {};
+  return {p->image_resolution, 0};
+}
+
+Grabber::StreamMode RecordingGrabber::getActiveDepthStreamMode() const {
+  if (!p->hasDepth())
+    return {};
+  return {p->image_resolution, 0};
+}
+
+bool RecordingGrabber::isFeatureSupported(Feature feature) const {
+  switch (feature) {
+    case Feature::SEEK:
+    case Feature::REPEAT:
+      return true;
+    default:
+      return false;
+  }
+}
+
+void RecordingGrabber::seek(unsigned int index) {
+  if (index > p->index.size())
+    BOOST_THROW_EXCEPTION(GrabberException("Seeking to a non-existent index") << GrabberException::Index(index));
+  p->next_frame = index;
+}
+
+void RecordingGrabber::setRepeatEnabled(bool state) {
+  throwIfNotSupported(Feature::REPEAT);
+  p->repeat = state;
+}
+
+bool RecordingGrabber::getRepeatEnabled() const {
+  return p->repeat;
+}
+
+struct RecordingWriter::Impl {
+  std::string filename;
+  std::ofstream file;
+  RecordingHeader header;
+  std::vector<RecordingIndexEntry> index;
+  Encoding color_encoding;
+  Encoding depth_encoding;
+  bool closed = false;
+  cv::Mat depth_mm;
+  std::vector<uchar> encoded;
+
+  Impl(const std::string& fn, const Intrinsics& intrinsics, Encoding color_enc, Encoding depth_enc)
+  : filename(fn), color_encoding(color_enc), depth_encoding(depth_enc) {
+    if (color_encoding == Encoding::NONE || depth_encoding == Encoding::NONE)
+      BOOST_THROW_EXCEPTION(IOException("Stream encoding has to be RAW or PNG") << IOException::Filename(filename));
+
+    file.open(filename.c_str(), std::ios::binary | std::ios::trunc);
+    if (!file)
+      BOOST_THROW_EXCEPTION(IOException("Failed to open recording file for writing")
+                            << IOException::Filename(filename));
+
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, RECORDING_MAGIC, sizeof(RECORDING_MAGIC));
+    header.version = RECORDING_VERSION;
+    header.fx = intrinsics.fx;
+    header.fy = intrinsics.fy;
+    header.cx = intrinsics.cx;
+    header.cy = intrinsics.cy;
+
+    // placeholder, the final header is written on close
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  }
+
+  void writeChunk(const uchar* chunk, size_t size, uint64_t& offset, uint64_t& chunk_size) {
+    offset = static_cast<uint64_t>(file.tellp());
+    chunk_size = size;
+    file.write(reinterpret_cast<const char*>(chunk), size);
+  }
+
+  void writeImage(const cv::Mat& image, Encoding encoding, uint64_t& offset, uint64_t& size) {
+    if (encoding == Encoding::RAW) {
+      if (image.isContinuous()) {
+        writeChunk(image.data, image.total() * image.elemSize(), offset, size);
+      } else {
+        cv::Mat continuous = image.clone();
+        writeChunk(continuous.data, continuous.total() * continuous.elemSize(), offset, size);
+      }
+    } else {
+      // low compression level, PNG size hardly changes for higher levels but encoding becomes much slower
+      const std::vector<int> params = {cv::IMWRITE_PNG_COMPRESSION, 1};
+      if (!cv::imencode(".png", image, encoded, params))
+        BOOST_THROW_EXCEPTION(CodecException("Failed to encode PNG image") << CodecException::Filename(filename));
+      writeChunk(encoded.data(), encoded.size(), offset, size);
+    }
+  }
+
+  void write(Grabber::Timestamp timestamp, const cv::Mat& color, const cv::Mat& depth) {
+    if (closed)
+      BOOST_THROW_EXCEPTION(IOException("Recording file is already closed") << IOException::Filename(filename));
+
+    if (index.empty()) {
+      // first frame determines the available streams and resolution
+      if (color.empty() && depth.empty())
+        BOOST_THROW_EXCEPTION(IOException("Frame has neither color nor depth") << IOException::Filename(filename));
+      const cv::Size size = depth.empty() ? color.size() : depth.size();
+      header.width = size.width;
+      header.height = size.height;
+      header.color_encoding = static_cast<uint32_t>(color.empty() ? Encoding::NONE : color_encoding);
+      header.depth_encoding = static_cast<uint32_t>(depth.empty() ? Encoding::NONE : depth_encoding);
+    }
+
+    const cv::Size size(header.width, header.height);
+    const bool has_color = header.color_encoding != static_cast<uint32_t>(Encoding::NONE);
+    const bool has_depth = header.depth_encoding != static_cast<uint32_t>(Encoding::NONE);
+    if (has_color != !color.empty() || has_depth != !depth.empty() || (has_color && color.size() != size) ||
+        (has_depth && depth.size() != size) || (has_color && color.type() != CV_8UC3) ||
+        (has_depth && depth.type() != CV_32FC1))
+      BOOST_THROW_EXCEPTION(IOException("Frame does not match the streams of the recording")
+                            << IOException::Filename(filename));
+
+    RecordingIndexEntry e;
+    std::memset(&e, 0, sizeof(e));
+    e.timestamp = timestamp;
+
+    if (has_color)
+      writeImage(color, static_cast<Encoding>(header.color_encoding), e.color_offset, e.color_size);
+
+    if (has_depth) {
+      depth_mm.create(size, CV_16UC1);
+      for (int y = 0; y < size.height; ++y) {
+        const float* src = depth.ptr<float>(y);
+        uint16_t* dst = depth_mm.ptr<uint16_t>(y);
+        for (int x = 0; x < size.width; ++x) {
+          const float mm = src[x] * 1000.f + 0.5f;
+          dst[x] = (mm >= 1.f && mm < 65536.f) ? static_cast<uint16_t>(mm) : 0;  // also catches NaN
+        }
+      }
+      writeImage(depth_mm, static_cast<Encoding>(header.depth_encoding), e.depth_offset, e.depth_size);
+    }
+
+    if (!file)
+      BOOST_THROW_EXCEPTION(IOException("Failed to write to recording file") << IOException::Filename(filename));
+    index.push_back(e);
+  }
+
+  void close() {
+    if (closed)
+      return;
+    closed = true;
+
+    // align index to 8 bytes
+    const uint64_t end = static_cast<uint64_t>(file.tellp());
+    const char padding[8] = {0};
+    file.write(padding, (8 - end % 8) % 8);
+
+    header.index_offset = static_cast<uint64_t>(file.tellp());
+    header.num_frames = index.size();
+    file.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(RecordingIndexEntry));
+    header.file_size = static_cast<uint64_t>(file.tellp());
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.close();
+
+    if (!file)
+      BOOST_THROW_EXCEPTION(IOException("Failed to write to recording file") << IOException::Filename(filename));
+  }
+};
+
+RecordingWriter::RecordingWriter(const std::string& filename, const Intrinsics& intrinsics, Encoding color_encoding,
+                                 Encoding depth_encoding)
+: p(new Impl(filename, intrinsics, color_encoding, depth_encoding)) {}
+
+RecordingWriter::~RecordingWriter() {
+  try {
+    p->close();
+  } catch (...) {
+  }
+}
+
+void RecordingWriter::write(Grabber::Timestamp timestamp, cv::InputArray color, cv::InputArray depth) {
+  p->write(timestamp, color.getMat(), depth.getMat());
+}
+
+size_t RecordingWriter::getNumberOfFrames() const {
+  return p->index.size();
+}
+
+void RecordingWriter::close() {
+  p->close();
+}
+
+}  // namespace io
+}  // namespace v4r
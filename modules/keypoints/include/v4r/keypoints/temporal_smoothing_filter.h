@@ -63,6 +63,7 @@
 #include <opencv2/imgproc/imgproc.hpp>
 #include <opencv2/video/tracking.hpp>
 #include <v4r/common/impl/DataMatrix2D.hpp>
+#include <v4r/common/worker_mailbox.h>
 
 namespace v4r {
 
@@ -169,6 +170,7 @@ class V4R_EXPORTS TemporalSmoothingFilter {
   // ---- end dbg ----
 
   bool run, have_thread;
+  WorkerMailbox mailbox;  // wakes up the keyframe initialization thread for every new frame
 
   boost::thread th_obectmanagement;
   boost::thread th_init;
@@ -230,6 +232,14 @@ class V4R_EXPORTS TemporalSmoothingFilter {
               Eigen::Matrix4f &pose);
 
   void getGlobalCloud(pcl::PointCloud<pcl::PointXYZRGBNormal>::Ptr &_global_cloud);
+
+  /**
+   * @brief getMailboxStatistics
+   * @return queue depth and wait times of the keyframe initialization thread
+   */
+  inline WorkerMailbox::Statistics getMailboxStatistics() const {
+    return mailbox.getStatistics();
+  }
   void setCameraParameter(const cv::Mat &_intrinsic);
   void setParameter(const Parameter &p) {
     param = p;
@@ -118,7 +118,7 @@ void TemporalSmoothingFilter::operate() {
     }
 
     if (!have_todo)
-      usleep(10000);
+      mailbox.wait();
   }
 }
 
@@ -613,6 +613,7 @@ void TemporalSmoothingFilter::start() {
     stop();
 
   run = true;
+  mailbox.open();
   th_obectmanagement = boost::thread(&TemporalSmoothingFilter::operate, this);
   have_thread = true;
 }
@@ -622,6 +623,7 @@ void TemporalSmoothingFilter::start() {
  */
 void TemporalSmoothingFilter::stop() {
   run = false;
+  mailbox.close();
   th_obectmanagement.join();
   have_thread = false;
 }
@@ -721,6 +723,8 @@ void TemporalSmoothingFilter::filter(const pcl::PointCloud<pcl::PointXYZRGB> &cl
 
   shm.unlock();
 
+  mailbox.post();
+
   // filter point cloud
   addCloud(cloud, shm.pose, sf_cloud, sf_pose);
   if (param.compute_normals)
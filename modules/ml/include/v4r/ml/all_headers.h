@@ -50,6 +50,7 @@
 #include <v4r/ml/types.h>
 
 #include <v4r/ml/nearestNeighbor.h>
+#include <v4r/ml/randomForest.h>
 #include <v4r/ml/svmWrapper.h>
 
 namespace v4r {
@@ -69,6 +70,11 @@ Classifier::Ptr initClassifier(ClassifierType method, std::vector<std::string> &
     params = param.init(params);
     svmClassifier::Ptr nn(new svmClassifier(param));
     classifier = std::dynamic_pointer_cast<Classifier>(nn);
+  } else if (method == ClassifierType::RF) {
+    RandomForestClassifierParameter param;
+    params = param.init(params);
+    RandomForestClassifier::Ptr rf(new RandomForestClassifier(param));
+    classifier = std::dynamic_pointer_cast<Classifier>(rf);
   } else {
     LOG(ERROR) << "Classifier method " << method << " is not implemented! ";
   }
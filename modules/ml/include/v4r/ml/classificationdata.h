@@ -34,10 +34,12 @@
 #include <time.h>
 #include <algorithm>
 #include <boost/format.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 #include <boost/random.hpp>
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -68,6 +70,18 @@ class V4R_EXPORTS ClassificationData {
   unsigned int totalPoints;
   boost::mt19937 randomGenerator;
 
+  // feature k of point i is stored at features[i * pointStride + k * featureStride]. Points either live in the
+  // row-major data vector (text files) or in the feature columns of a memory-mapped binary store
+  const float* features;
+  size_t pointStride;
+  size_t featureStride;
+  void UseRowMajorData();
+
+  // memory-mapped binary store (see ConvertDirectoryToBinary), points of each label are stored consecutively
+  std::shared_ptr<boost::interprocess::mapped_region> mappedStore;
+  const float* storeColumns;
+  std::vector<unsigned int> labelRowOffset;  // first point of each available label in the store
+
  public:
   ClassificationData();
   std::vector<unsigned int> NewBag(float baggingRatio);
@@ -82,7 +96,8 @@ class V4R_EXPORTS ClassificationData {
   std::vector<unsigned int>::iterator Partition(std::vector<unsigned int>::iterator startidx,
                                                 std::vector<unsigned int>::iterator stopidx, int dimension,
                                                 float threshold);
-  float GetFeature(int pointIdx, int featureIdx);
+  inline float GetFeature(int pointIdx, int featureIdx);
+  void GetFeatures(int pointIdx, std::vector<float>& point);
   std::vector<float> GetFeatures(int pointIdx);
   float GetInformationGain(std::vector<unsigned int>::const_iterator startidx,
                            std::vector<unsigned int>::const_iterator stopidx,
@@ -92,9 +107,17 @@ class V4R_EXPORTS ClassificationData {
   void LoadDemoSpiral(int nPoints, float noise);
   void SaveToFile(std::string filepath);
   void LoadFromFile(std::string trainingFilePath);
+  void LoadFromMemory(const std::vector<float>& features, const std::vector<int>& labels);
   unsigned int LoadFromDirectory(std::string directory, std::vector<int> labelIDs);
+  unsigned int LoadFromBinary(const std::string& binaryFile);
+  static bool ConvertDirectoryToBinary(const std::string& directory, const std::vector<int>& labelIDs,
+                                       const std::string& binaryFile);
   virtual ~ClassificationData();
 };
+
+inline float ClassificationData::GetFeature(int pointIdx, int featureIdx) {
+  return features[pointIdx * pointStride + featureIdx * featureStride];
+}
 }  // namespace RandomForest
 }  // namespace v4r
 #endif  // CLASSIFICATIONDATA_H
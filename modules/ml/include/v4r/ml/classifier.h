@@ -55,8 +55,35 @@
 #include <vector>
 
 namespace v4r {
+
+/**
+ * @brief Output of a classifier query. Each query produces one row, the columns correspond to the most probable
+ * predictions (sorted - most likely one is on the left). The buffers are owned by the caller and only reallocated if
+ * their size does not match, so they can be reused for subsequent queries.
+ */
+struct V4R_EXPORTS ClassificationResult {
+  Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> labels_;  ///< predicted labels
+  Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      distances_;  ///< distance of the query to the prediction (feature distance to the training sample for nearest
+                   /// neighbor, 1 - probability of the label for classifiers with probability estimates, 0 otherwise)
+  Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      training_sample_ids_;  ///< index of the training sample the prediction is based on (-1 if not available)
+
+  /**
+   * @brief resize all buffers (no reallocation if the size already matches)
+   */
+  void resize(int num_queries, int num_predictions) {
+    labels_.resize(num_queries, num_predictions);
+    distances_.resize(num_queries, num_predictions);
+    training_sample_ids_.resize(num_queries, num_predictions);
+  }
+};
+
 class V4R_EXPORTS Classifier {
  public:
+  /// query data with one feature vector per row. Row-major matrices and maps are viewed without copy
+  typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> QueryMatrix;
+
   Classifier() = default;
 
   virtual ~Classifier() = default;
@@ -69,14 +96,29 @@ class V4R_EXPORTS Classifier {
    */
   virtual void train(const Eigen::MatrixXf &training_data, const Eigen::VectorXi &training_label) = 0;
 
+  /**
+   * @brief classify query features. The classifier is not modified, so several threads can query it concurrently
+   * @param query_data (each query is a row entry, the feature dimensions are equal to the number of columns)
+   * @param result predicted labels, distances and training sample ids for each query
+   */
+  virtual void query(const Eigen::Ref<const QueryMatrix> &query_data, ClassificationResult &result) const = 0;
+
   /**
    * @brief predict the target value of a query feature
    * @param query_data (each query is a row entry, the feature dimensions are equal to the number of columns)
    * @param predicted_label (each query produces a row of predicted labels, the columns of the predicted labels
    * correspond to the most probable predictions. Predictions are sorted - most likely one is on the left)
    */
-  virtual void predict(const Eigen::MatrixXf &query_data, Eigen::MatrixXi &predicted_label) const = 0;
+  virtual void predict(const Eigen::MatrixXf &query_data, Eigen::MatrixXi &predicted_label) const {
+    ClassificationResult result;
+    query(query_data, result);
+    predicted_label = result.labels_;
+  }
 
+  /**
+   * @brief returns training sample ids and distances of the last call to predict()
+   * @deprecated not thread-safe, use query() instead
+   */
   virtual void getTrainingSampleIDSforPredictions(Eigen::MatrixXi &predicted_training_sample_indices,
                                                   Eigen::MatrixXf &distances) const {
     (void)predicted_training_sample_indices;
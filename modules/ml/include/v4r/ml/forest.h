@@ -97,6 +97,7 @@ class V4R_EXPORTS Forest {
   void TrainLarge(ClassificationData& trainingData, bool allNodesStoreLabelDistribution,
                   bool refineWithAllTrainingData = false, int verbosityLevel = 1);
   std::vector<float> SoftClassify(std::vector<float>& point, int depth = -1, int useNTrees = -1);
+  void SoftClassify(const float* point, std::vector<float>& labelDist, int depth = -1, int useNTrees = -1);
   void EraseSplitNodeLabelDistributions();
   int ClassifyPoint(std::vector<float>& point, int depth = -1, int useNTrees = -1);
   void SaveToFile(std::string filename);
@@ -110,8 +110,8 @@ struct V4R_EXPORTS NearestNeighborClassifierParameter {
 class V4R_EXPORTS NearestNeighborClassifier : public Classifier {
  private:
   std::shared_ptr<cv::flann::Index> flann_index;
-  mutable cv::Mat knn_indices_;
-  mutable cv::Mat knn_distances_;
+  mutable ClassificationResult last_result_;  ///< result of the last predict() call (only for
+                                              /// getTrainingSampleIDSforPredictions)
   cv::Mat training_label_;
   NearestNeighborClassifierParameter param_;
   cv::Mat all_training_data;  ///< all signatures from all objects in the database
@@ -120,6 +120,8 @@ class V4R_EXPORTS NearestNeighborClassifier : public Classifier {
   NearestNeighborClassifier(const NearestNeighborClassifierParameter &p = NearestNeighborClassifierParameter())
   : param_(p) {}
 
+  void query(const Eigen::Ref<const QueryMatrix> &query_data, ClassificationResult &result) const override;
+
   void predict(const Eigen::MatrixXf &query_data, Eigen::MatrixXi &predicted_label) const override;
 
   void train(const Eigen::MatrixXf &training_data, const Eigen::VectorXi &training_label) override;
@@ -128,6 +130,7 @@ class V4R_EXPORTS NearestNeighborClassifier : public Classifier {
    * @brief getTrainingSampleIDSforPredictions
    * @param predicted_training_sample_indices
    * @param distances of the training sample to the corresponding query data
+   * @deprecated not thread-safe, use query() instead
    */
   void getTrainingSampleIDSforPredictions(Eigen::MatrixXi &predicted_training_sample_indices,
                                           Eigen::MatrixXf &distances) const override;
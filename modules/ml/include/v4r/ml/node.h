@@ -79,7 +79,8 @@ class V4R_EXPORTS Node {
   inline float GetThreshold();
   inline int GetSplitFeatureIdx();
   inline bool IsSplitNode();
-  inline int EvaluateNode(std::vector<float>& point);
+  inline int EvaluateNode(const std::vector<float>& point);
+  inline int EvaluateNode(float featureValue);
   virtual ~Node();
 };
 
@@ -92,10 +93,15 @@ inline bool Node::IsSplitNode() {
 }
 
 // for testing, does point go left or right?
-inline int Node::EvaluateNode(std::vector<float>& point) {
+inline int Node::EvaluateNode(const std::vector<float>& point) {
   return point[splitOnFeatureIdx_] > threshold_ ? rightChildIdx_ : leftChildIdx_;
 }
 
+// same as above, for the value of the split feature only
+inline int Node::EvaluateNode(float featureValue) {
+  return featureValue > threshold_ ? rightChildIdx_ : leftChildIdx_;
+}
+
 inline int Node::GetLeftChildIdx() {
   return leftChildIdx_;
 }
@@ -0,0 +1,153 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 TU Wien, ACIN, Vision 4 Robotics (V4R) group
+** Contact: v4r.acin.tuwien.ac.at
+**
+** This file is part of V4R
+**
+** V4R is distributed under dual licenses - GPLv3 or closed source.
+**
+** GNU General Public License Usage
+** V4R is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published
+** by the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** V4R is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** Please review the following information to ensure the GNU General Public
+** License requirements will be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+**
+** Commercial License Usage
+** If GPL is not suitable for your project, you must purchase a commercial
+** license to use V4R. Licensees holding valid commercial V4R licenses may
+** use this file in accordance with the commercial license agreement
+** provided with the Software or, alternatively, in accordance with the
+** terms contained in a written agreement between you and TU Wien, ACIN, V4R.
+** For licensing terms and conditions please contact office<at>acin.tuwien.ac.at.
+**
+**
+** The copyright holder additionally grants the author(s) of the file the right
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or
+** sell copies of their contributions without any restrictions.
+**
+****************************************************************************/
+
+/**
+ * @file randomForest.h
+ * @brief Random forest (see RandomForest::Forest) behind the generic classifier interface
+ *
+ */
+#pragma once
+
+#include <v4r/core/macros.h>
+#include <v4r/ml/classifier.h>
+#include <v4r/ml/forest.h>
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+namespace v4r {
+struct V4R_EXPORTS RandomForestClassifierParameter {
+  int num_trees_ = 10;                    ///< number of trees
+  int max_depth_ = 8;                     ///< maximum depth of each tree
+  float bagging_ratio_ = 0.5f;            ///< ratio of the training data each tree is trained with
+  int tested_splitting_functions_ = 100;  ///< number of random splits evaluated at each node
+  float min_information_gain_ = 0.02f;    ///< minimum information gain for a node to be split
+  int min_points_for_split_ = 5;          ///< minimum number of training points for a node to be split
+  int knn_ = 1;                           ///< return the knn most probable classes
+  std::string filename_ = "";  ///< filename from where to load the forest (if path exists, will skip training and use
+                               /// this forest instead)
+
+  /**
+   * @brief init parameters
+   * @param command_line_arguments (according to Boost program options library)
+   * @return unused parameters (given parameters that were not used in this initialization call)
+   */
+  std::vector<std::string> init(int argc, char **argv) {
+    std::vector<std::string> arguments(argv + 1, argv + argc);
+    return init(arguments);
+  }
+
+  /**
+   * @brief init parameters
+   * @param command_line_arguments (according to Boost program options library)
+   * @return unused parameters (given parameters that were not used in this initialization call)
+   */
+  std::vector<std::string> init(const std::vector<std::string> &command_line_arguments) {
+    po::options_description desc("Random Forest Classifier Parameter\n=====================\n");
+    desc.add_options()("help,h", "produce help message");
+    desc.add_options()("rf_num_trees", po::value<int>(&num_trees_)->default_value(num_trees_), "number of trees");
+    desc.add_options()("rf_max_depth", po::value<int>(&max_depth_)->default_value(max_depth_),
+                       "maximum depth of each tree");
+    desc.add_options()("rf_bagging_ratio", po::value<float>(&bagging_ratio_)->default_value(bagging_ratio_),
+                       "ratio of the training data each tree is trained with");
+    desc.add_options()("rf_tested_splitting_functions",
+                       po::value<int>(&tested_splitting_functions_)->default_value(tested_splitting_functions_),
+                       "number of random splits evaluated at each node");
+    desc.add_options()("rf_min_information_gain",
+                       po::value<float>(&min_information_gain_)->default_value(min_information_gain_),
+                       "minimum information gain for a node to be split");
+    desc.add_options()("rf_min_points_for_split",
+                       po::value<int>(&min_points_for_split_)->default_value(min_points_for_split_),
+                       "minimum number of training points for a node to be split");
+    desc.add_options()("rf_knn", po::value<int>(&knn_)->default_value(knn_), "return the knn most probable classes");
+    desc.add_options()(
+        "rf_filename", po::value<std::string>(&filename_)->default_value(filename_),
+        "filename from where to load the forest (if path exists, will skip training and use this forest instead)");
+    po::variables_map vm;
+    po::parsed_options parsed =
+        po::command_line_parser(command_line_arguments).options(desc).allow_unregistered().run();
+    std::vector<std::string> to_pass_further = po::collect_unrecognized(parsed.options, po::include_positional);
+    po::store(parsed, vm);
+    if (vm.count("help")) {
+      std::cout << desc << std::endl;
+      to_pass_further.push_back("-h");
+    }
+    try {
+      po::notify(vm);
+    } catch (std::exception &e) {
+      std::cerr << "Error: " << e.what() << std::endl << std::endl << desc << std::endl;
+    }
+    return to_pass_further;
+  }
+};
+
+class V4R_EXPORTS RandomForestClassifier : public Classifier {
+ private:
+  RandomForestClassifierParameter param_;
+  std::shared_ptr<RandomForest::Forest> forest_;
+  std::vector<int> labels_;  ///< label ID of each output of the forest
+
+ public:
+  RandomForestClassifier(const RandomForestClassifierParameter &p = RandomForestClassifierParameter()) : param_(p) {}
+
+  void query(const Eigen::Ref<const QueryMatrix> &query_data, ClassificationResult &result) const override;
+
+  void train(const Eigen::MatrixXf &training_data, const Eigen::VectorXi &training_label) override;
+
+  /**
+   * @brief saveModel save current forest
+   * @param filename filename to save trained forest
+   */
+  void saveModel(const boost::filesystem::path &filename) const;
+
+  /**
+   * @brief loadModel load a forest from file
+   * @param filename filename to read forest
+   */
+  void loadModel(const boost::filesystem::path &filename);
+
+  ClassifierType getType() const override {
+    return ClassifierType::RF;
+  }
+
+  typedef std::shared_ptr<RandomForestClassifier> Ptr;
+  typedef std::shared_ptr<RandomForestClassifier const> ConstPtr;
+};
+}  // namespace v4r
@@ -47,6 +47,7 @@
 #pragma once
 
 #include <libsvm/svm.h>
+#include <v4r/common/dense_svm_predictor.h>
 #include <v4r/core/macros.h>
 #include <v4r/ml/classifier.h>
 #include <boost/filesystem.hpp>
@@ -183,13 +184,14 @@ class V4R_EXPORTS svmClassifier : public Classifier {
  private:
   SVMParameter param_;
   ::svm_model *svm_mod_;
+  std::shared_ptr<DenseSVMPredictor<::svm_model>> dense_svm_;  ///< dense copy of the model for batched prediction
 
   Eigen::VectorXf scale_;  ///< scale for each attribute (only if scaling is enabled)
   //    Eigen::VectorXf offset_; ///< scale offset for each attribute (only if scaling is enabled)
  public:
   svmClassifier(const SVMParameter &p = SVMParameter()) : param_(p) {}
 
-  void predict(const Eigen::MatrixXf &query_data, Eigen::MatrixXi &predicted_label) const override;
+  void query(const Eigen::Ref<const QueryMatrix> &query_data, ClassificationResult &result) const override;
 
   /**
    * @brief saveModel save current svm model
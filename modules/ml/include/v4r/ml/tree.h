@@ -78,9 +78,14 @@ class V4R_EXPORTS Tree {
   Tree();
   Tree(boost::mt19937* randomGenerator);
   inline Node* GetRootNode();
+  inline void SetRandomGenerator(boost::mt19937* randomGenerator) {
+    this->randomGenerator = randomGenerator;
+  }
   std::vector<float>& Classify(std::vector<float>& point);
   std::vector<float>& Classify(std::vector<float>& point, int depth);
-  int GetResultingLeafNode(std::vector<float> point);
+  std::vector<float>& Classify(const float* point, int depth = -1);
+  int GetResultingLeafNode(const std::vector<float>& point);
+  int GetResultingLeafNode(ClassificationData& data, int pointIdx);
   void ClearLeafNodes();
   void RefineLeafNodes(ClassificationData& data, int nPoints, int labelIdx);
   void UpdateLeafNodes(std::vector<int> labels, std::map<int, unsigned int>& pointsPerLabel);
@@ -53,8 +53,8 @@ namespace v4r {
 enum class ClassifierType {
   KNN,
   SVM,
-  CNN
-  //            RandomForest
+  CNN,
+  RF
 };
 
 V4R_EXPORTS std::istream& operator>>(std::istream& in, ClassifierType& ct);
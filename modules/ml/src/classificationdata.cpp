@@ -26,12 +26,66 @@
 */
 
 #include <v4r/ml/classificationdata.h>
+#include <boost/interprocess/file_mapping.hpp>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 #include "boost/filesystem.hpp"
 
 using namespace boost::filesystem;
 using namespace v4r::RandomForest;
 
-ClassificationData::ClassificationData() {}
+namespace bip = boost::interprocess;
+
+namespace {
+// Layout of the binary training store: header, one index entry per label, and (aligned to 64 bytes) one column of
+// totalPoints floats per feature dimension. The points of each label are stored consecutively.
+const char STORE_MAGIC[8] = {'V', '4', 'R', 'R', 'F', 'D', 'A', 'T'};
+const uint32_t STORE_VERSION = 1;
+
+struct StoreHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t dimensions;
+  uint32_t nLabels;
+  uint32_t reserved;
+  uint64_t totalPoints;
+};
+
+struct StoreLabelEntry {
+  int32_t labelID;
+  uint32_t nPoints;
+  uint64_t firstPoint;
+};
+
+size_t StoreColumnOffset(uint32_t nLabels) {
+  size_t offset = sizeof(StoreHeader) + nLabels * sizeof(StoreLabelEntry);
+  return (offset + 63) / 64 * 64;
+}
+
+// parses whitespace separated floats of a line, returns number of values found
+int ParseLine(const std::string& line, std::vector<float>& values) {
+  values.clear();
+  const char* c = line.c_str();
+  char* end;
+
+  for (float v = strtof(c, &end); end != c; v = strtof(c, &end)) {
+    values.push_back(v);
+    c = end;
+  }
+
+  return (int)values.size();
+}
+}  // namespace
+
+ClassificationData::ClassificationData()
+: features(NULL), pointStride(0), featureStride(1), storeColumns(NULL) {}
+
+void ClassificationData::UseRowMajorData() {
+  features = data.data();
+  pointStride = dimensions;
+  featureStride = 1;
+}
 
 int ClassificationData::GetDimensions() {
   return dimensions;
@@ -62,9 +116,6 @@ std::vector<unsigned int> ClassificationData::NewBag(float baggingRatio) {
   // creates a new "bag" of training data containing the same number of
   // points of each label
 
-  data.clear();
-  trainingLabels.clear();
-
   int nPoints = totalPoints * baggingRatio;
   unsigned int maxPpLabel = nPoints / availableLabels.size();
 
@@ -84,9 +135,28 @@ std::vector<unsigned int> ClassificationData::NewBag(float baggingRatio) {
     labelWeights.push_back(N / n);
   }
 
+  std::vector<unsigned int> indices(nPoints);
+
+  if (mappedStore) {
+    // points are already accessible in the mapped store, just draw the indices of the bag
+    features = storeColumns;
+    unsigned int cnt = 0;
+
+    for (unsigned int i = 0; i < availableLabels.size(); i++) {
+      unsigned int n = std::min(maxPpLabel, pointsPerLabel[availableLabels[i]]);
+      std::vector<unsigned int> linenumbers = generateRandomIndices(n, pointsPerLabel[availableLabels[i]]);
+
+      for (unsigned int j = 0; j < n; j++)
+        indices[cnt++] = labelRowOffset[i] + linenumbers[j];
+    }
+
+    return indices;
+  }
+
+  data.clear();
+  trainingLabels.clear();
   data.assign(nPoints * dimensions, 0.0f);
   trainingLabels.reserve(nPoints);
-  std::vector<unsigned int> indices(nPoints);
 
   float value;
 
@@ -120,17 +190,33 @@ std::vector<unsigned int> ClassificationData::NewBag(float baggingRatio) {
     trainingfile.close();
   }
 
+  UseRowMajorData();
   return indices;
 }
 
 int ClassificationData::LoadChunkForLabel(int labelID, int nPoints) {
+  if (mappedStore) {
+    // no copy needed, let the feature pointer point to the next chunk of points of this label
+    size_t l =
+        std::distance(availableLabels.begin(), std::find(availableLabels.begin(), availableLabels.end(), labelID));
+    if (l == availableLabels.size())
+      return 0;
+
+    long long int pos = trainingDataFilePos[labelID];
+    int n = std::min<long long int>(nPoints, pointsPerLabel[labelID] - pos);
+    features = storeColumns + labelRowOffset[l] + pos;
+    // start from the beginning again once all points of this label have been returned
+    trainingDataFilePos[labelID] = n > 0 ? pos + n : 0;
+    return n;
+  }
+
   data.clear();
 
   std::string filename = str(boost::format("%1$s/%2$04d.data") % directory % labelID);
   std::ifstream trainingfile;
   trainingfile.open(filename.c_str());
 
-  data.reserve(nPoints * dimensions);
+  data.resize(nPoints * dimensions);
 
   trainingfile.seekg(trainingDataFilePos[labelID]);
 
@@ -142,22 +228,28 @@ int ClassificationData::LoadChunkForLabel(int labelID, int nPoints) {
       trainingfile >> value;
       data[i * dimensions + k] = value;
     }
+
+    // end of file reached while reading this point
+    if (trainingfile.fail())
+      break;
   }
 
   trainingDataFilePos[labelID] = trainingfile.tellg();
 
   trainingfile.close();
+  UseRowMajorData();
   return i;
 }
 
 // calculates range of selected data points for given dimension
 std::pair<float, float> ClassificationData::GetMinMax(std::vector<unsigned int>::iterator startidx,
                                                       std::vector<unsigned int>::iterator stopidx, int dimension) {
-  float min = GetFeature(*startidx, dimension);
+  const float* column = features + dimension * featureStride;
+  float min = column[*startidx * pointStride];
   float max = min;
 
   for (std::vector<unsigned int>::iterator i = startidx; i != stopidx; i++) {
-    float f = GetFeature(*i, dimension);
+    float f = column[*i * pointStride];
 
     if (f < min)
       min = f;
@@ -169,11 +261,13 @@ std::pair<float, float> ClassificationData::GetMinMax(std::vector<unsigned int>:
 }
 
 std::pair<float, float> ClassificationData::GetMinMax(int dimension) {
-  float min = data[dimension];
+  const float* column = features + dimension * featureStride;
+  unsigned int nPoints = mappedStore ? totalPoints : data.size() / dimensions;
+  float min = column[0];
   float max = min;
 
-  for (unsigned int i = 0; i < data.size() / dimensions; ++i) {
-    float f = data[i * dimensions + dimension];
+  for (unsigned int i = 0; i < nPoints; ++i) {
+    float f = column[i * pointStride];
 
     if (f < min)
       min = f;
@@ -188,12 +282,16 @@ int ClassificationData::GetCount() {
   return totalPoints;
 }
 
-float ClassificationData::GetFeature(int pointIdx, int featureIdx) {
-  return data[pointIdx * dimensions + featureIdx];
+void ClassificationData::GetFeatures(int pointIdx, std::vector<float>& point) {
+  point.resize(dimensions);
+
+  for (int k = 0; k < dimensions; ++k)
+    point[k] = GetFeature(pointIdx, k);
 }
 
 std::vector<float> ClassificationData::GetFeatures(int pointIdx) {
-  std::vector<float> p(&data[pointIdx * dimensions], &data[(pointIdx + 1) * dimensions]);
+  std::vector<float> p;
+  GetFeatures(pointIdx, p);
   return p;
 }
 
@@ -247,18 +345,21 @@ void ClassificationData::LoadDemoSpiral(int nPoints, float noise) {
 
   labelStatus = LABELED;
   this->dimensions = 2;
+  mappedStore.reset();
+  UseRowMajorData();
 }
 
 // splits selected data points into "left" and "right" according to given threshold and feature dimension
 std::vector<unsigned int>::iterator ClassificationData::Partition(std::vector<unsigned int>::iterator startidx,
                                                                   std::vector<unsigned int>::iterator stopidx,
                                                                   int dimension, float threshold) {
+  const float* column = features + dimension * featureStride;
   std::vector<unsigned int>::iterator i = startidx;
   std::vector<unsigned int>::iterator j = stopidx - 1;
   unsigned int swapidx;
 
   while (i != j) {
-    if (GetFeature(*i, dimension) > threshold) {
+    if (column[*i * pointStride] > threshold) {
       swapidx = *j;
       *j = *i;
       *i = swapidx;
@@ -269,7 +370,7 @@ std::vector<unsigned int>::iterator ClassificationData::Partition(std::vector<un
   }
 
   // return iterator to first element of "right" group to mark the split element
-  return GetFeature(*i, dimension) > threshold ? i : i + 1;
+  return column[*i * pointStride] > threshold ? i : i + 1;
 }
 
 void ClassificationData::ClearHistogram(std::vector<float>& hist) {
@@ -523,6 +624,7 @@ unsigned int ClassificationData::LoadFromDirectory(std::string directory, std::v
   totalPoints = 0;
   this->directory = directory;
   availableLabels = labelIDs;
+  mappedStore.reset();
 
   for (unsigned int i = 0; i < labelIDs.size(); ++i) {
     trainingDataFilePos[labelIDs[i]] = 0;
@@ -562,6 +664,196 @@ unsigned int ClassificationData::LoadFromDirectory(std::string directory, std::v
   return totalPoints;
 }
 
+unsigned int ClassificationData::LoadFromBinary(const std::string& binaryFile) {
+  // maps a binary training store created by ConvertDirectoryToBinary. Features are read directly from the mapped
+  // columns, nothing is parsed or copied
+
+  if (!exists(path(binaryFile))) {
+    std::cout << "Training data file " << binaryFile << " does not exist!" << std::endl;
+    return 0;
+  }
+
+  std::shared_ptr<bip::mapped_region> region;
+  try {
+    bip::file_mapping file(binaryFile.c_str(), bip::read_only);
+    region.reset(new bip::mapped_region(file, bip::read_only));
+  } catch (const bip::interprocess_exception& e) {
+    std::cout << "Could not map training data file " << binaryFile << ": " << e.what() << std::endl;
+    return 0;
+  }
+
+  const char* base = static_cast<const char*>(region->get_address());
+  StoreHeader header;
+
+  if (region->get_size() < sizeof(header) || memcmp(base, STORE_MAGIC, sizeof(STORE_MAGIC)) != 0) {
+    std::cout << "File " << binaryFile << " is not a training data store!" << std::endl;
+    return 0;
+  }
+
+  memcpy(&header, base, sizeof(header));
+
+  if (header.version != STORE_VERSION) {
+    std::cout << "Training data store " << binaryFile << " has unsupported version " << header.version << std::endl;
+    return 0;
+  }
+
+  size_t columnOffset = StoreColumnOffset(header.nLabels);
+
+  if (header.totalPoints > std::numeric_limits<unsigned int>::max() ||
+      region->get_size() < columnOffset + header.dimensions * header.totalPoints * sizeof(float)) {
+    std::cout << "Training data store " << binaryFile << " is truncated or too large!" << std::endl;
+    return 0;
+  }
+
+  const StoreLabelEntry* entries = reinterpret_cast<const StoreLabelEntry*>(base + sizeof(StoreHeader));
+
+  directory = "";
+  data.clear();
+  availableLabels.clear();
+  pointsPerLabel.clear();
+  trainingDataFilePos.clear();
+  labelRowOffset.clear();
+  labelWeights.clear();
+  totalPoints = header.totalPoints;
+  dimensions = header.dimensions;
+  trainingLabels.assign(totalPoints, 0);
+
+  for (unsigned int l = 0; l < header.nLabels; ++l) {
+    const StoreLabelEntry& e = entries[l];
+    availableLabels.push_back(e.labelID);
+    pointsPerLabel[e.labelID] = e.nPoints;
+    trainingDataFilePos[e.labelID] = 0;
+    labelRowOffset.push_back(e.firstPoint);
+
+    // label index of every point and weights for imbalanced datasets (as in NewBag)
+    std::fill(trainingLabels.begin() + e.firstPoint, trainingLabels.begin() + e.firstPoint + e.nPoints, l);
+    labelWeights.push_back(e.nPoints > 0 ? double(totalPoints) / double(e.nPoints) : 0.0);
+  }
+
+  labelStatus = LABELED;
+  mappedStore = region;
+  storeColumns = reinterpret_cast<const float*>(base + columnOffset);
+  features = storeColumns;
+  pointStride = 1;
+  featureStride = totalPoints;
+
+  return totalPoints;
+}
+
+bool ClassificationData::ConvertDirectoryToBinary(const std::string& directory, const std::vector<int>& labelIDs,
+                                                  const std::string& binaryFile) {
+  // converts the text files read by LoadFromDirectory (one feature vector per line) into a binary store for
+  // LoadFromBinary. The store is filled through a writable mapping, so the data never has to fit into memory
+
+  std::vector<StoreLabelEntry> entries(labelIDs.size());
+  std::vector<float> values;
+  std::string line;
+  int dims = -1;
+  uint64_t nTotal = 0;
+
+  // first pass: count points per label and get dimension
+  for (unsigned int l = 0; l < labelIDs.size(); ++l) {
+    std::string filename = str(boost::format("%1$s/%2$04d.data") % directory % labelIDs[l]);
+    std::ifstream inFile(filename.c_str());
+
+    if (!inFile.is_open()) {
+      std::cout << "Could not open training data file " << filename << std::endl;
+      return false;
+    }
+
+    uint32_t nPoints = 0;
+
+    while (std::getline(inFile, line)) {
+      if (line.find_first_not_of(" \t\r") == std::string::npos)
+        continue;
+
+      if (dims < 0)
+        dims = ParseLine(line, values);
+
+      nPoints++;
+    }
+
+    entries[l].labelID = labelIDs[l];
+    entries[l].nPoints = nPoints;
+    entries[l].firstPoint = nTotal;
+    nTotal += nPoints;
+  }
+
+  if (dims <= 0) {
+    std::cout << "No training data found in " << directory << std::endl;
+    return false;
+  }
+
+  StoreHeader header;
+  memcpy(header.magic, STORE_MAGIC, sizeof(STORE_MAGIC));
+  header.version = STORE_VERSION;
+  header.dimensions = dims;
+  header.nLabels = labelIDs.size();
+  header.reserved = 0;
+  header.totalPoints = nTotal;
+
+  size_t columnOffset = StoreColumnOffset(header.nLabels);
+  size_t fileSize = columnOffset + dims * nTotal * sizeof(float);
+
+  {
+    // allocate file
+    std::filebuf fbuf;
+    if (!fbuf.open(binaryFile.c_str(),
+                   std::ios_base::in | std::ios_base::out | std::ios_base::trunc | std::ios_base::binary)) {
+      std::cout << "Could not create training data store " << binaryFile << std::endl;
+      return false;
+    }
+    fbuf.pubseekoff(fileSize - 1, std::ios_base::beg);
+    fbuf.sputc(0);
+  }
+
+  bool success = true;
+
+  try {
+    bip::file_mapping file(binaryFile.c_str(), bip::read_write);
+    bip::mapped_region region(file, bip::read_write);
+    char* base = static_cast<char*>(region.get_address());
+    memcpy(base, &header, sizeof(header));
+    memcpy(base + sizeof(header), entries.data(), entries.size() * sizeof(StoreLabelEntry));
+    float* columns = reinterpret_cast<float*>(base + columnOffset);
+
+    // second pass: parse feature vectors and scatter them into the feature columns
+    for (unsigned int l = 0; l < labelIDs.size() && success; ++l) {
+      std::string filename = str(boost::format("%1$s/%2$04d.data") % directory % labelIDs[l]);
+      std::ifstream inFile(filename.c_str());
+      uint64_t row = entries[l].firstPoint;
+      uint64_t stop = entries[l].firstPoint + entries[l].nPoints;
+
+      while (row < stop && std::getline(inFile, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+          continue;
+
+        if (ParseLine(line, values) != dims) {
+          std::cout << "Feature vector " << row - entries[l].firstPoint << " in " << filename << " does not have "
+                    << dims << " dimensions!" << std::endl;
+          success = false;
+          break;
+        }
+
+        for (int k = 0; k < dims; ++k)
+          columns[k * nTotal + row] = values[k];
+
+        row++;
+      }
+    }
+
+    region.flush();
+  } catch (const bip::interprocess_exception& e) {
+    std::cout << "Could not map training data store " << binaryFile << ": " << e.what() << std::endl;
+    success = false;
+  }
+
+  if (!success)
+    boost::filesystem::remove(path(binaryFile));
+
+  return success;
+}
+
 std::map<int, unsigned int>& ClassificationData::GetCountPerLabel() {
   return pointsPerLabel;
 }
@@ -614,6 +906,40 @@ void ClassificationData::LoadFromFile(std::string trainingFilePath) {
   }
 
   dimensions = data.size() / trainingLabels.size();
+  mappedStore.reset();
+  UseRowMajorData();
+}
+
+void ClassificationData::LoadFromMemory(const std::vector<float>& features, const std::vector<int>& labels) {
+  // takes row-major feature vectors (one per label) which are already in memory, labels can be arbitrary IDs
+
+  directory = "";
+  data = features;
+  dimensions = labels.empty() ? 0 : data.size() / labels.size();
+  totalPoints = labels.size();
+
+  availableLabels = labels;
+  std::sort(availableLabels.begin(), availableLabels.end());
+  availableLabels.erase(std::unique(availableLabels.begin(), availableLabels.end()), availableLabels.end());
+
+  pointsPerLabel.clear();
+  trainingLabels.resize(labels.size());
+
+  for (unsigned int i = 0; i < labels.size(); ++i) {
+    std::vector<int>::iterator label = std::lower_bound(availableLabels.begin(), availableLabels.end(), labels[i]);
+    trainingLabels[i] = std::distance(availableLabels.begin(), label);
+    pointsPerLabel[labels[i]]++;
+  }
+
+  // label weights for imbalanced datasets (as in NewBag)
+  labelWeights.clear();
+
+  for (unsigned int i = 0; i < availableLabels.size(); ++i)
+    labelWeights.push_back(double(totalPoints) / double(pointsPerLabel[availableLabels[i]]));
+
+  labelStatus = LABELED;
+  mappedStore.reset();
+  UseRowMajorData();
 }
 
 ClassificationData::~ClassificationData() {}
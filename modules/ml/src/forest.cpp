@@ -116,6 +116,28 @@ std::vector<float> Forest::SoftClassify(std::vector<float>& point, int depth, in
   return labelDist;
 }
 
+// same as above without allocations and parallelization (trees are evaluated one after another), so many points can
+// be classified in parallel. labelDist is resized to the number of labels
+void Forest::SoftClassify(const float* point, std::vector<float>& labelDist, int depth, int useNTrees) {
+  labelDist.assign(labels.size(), 0.0f);
+
+  if (useNTrees < 0 || (unsigned int)useNTrees > trees.size())
+    useNTrees = trees.size();
+
+  if (depth >= 0 && !splitNodesStoreLabelDistribution)
+    depth = -1;
+
+  for (int i = 0; i < useNTrees; ++i) {
+    const std::vector<float>& treeDist = trees[i].Classify(point, depth);
+
+    for (unsigned int j = 0; j < labelDist.size(); j++)
+      labelDist[j] += treeDist[j];
+  }
+
+  for (unsigned int i = 0; i < labelDist.size(); i++)
+    labelDist[i] /= useNTrees;
+}
+
 int Forest::ClassifyPoint(std::vector<float>& point, int depth, int useNTrees) {
   // take max value of label distribution for hard classification
   std::vector<float> labelDist = SoftClassify(point, depth, useNTrees);
@@ -146,9 +168,13 @@ void Forest::Train(ClassificationData& trainingData, int verbosityLevel) {
     }
   }
 
-  // create trees
-  for (int i = 0; i < nTrees; i++)
-    trees.push_back(Tree(&randomGenerator));
+  // create trees, each with its own random generator as they are trained in parallel
+  std::vector<boost::mt19937> treeGenerators(nTrees);
+  trees.clear();
+  for (int i = 0; i < nTrees; i++) {
+    treeGenerators[i].seed(randomGenerator());
+    trees.push_back(Tree(&treeGenerators[i]));
+  }
 
   // random generator for bagging of training data
   boost::uniform_int<int> intDist(0, trainingData.GetCount() - 1);
@@ -178,12 +204,18 @@ void Forest::Train(ClassificationData& trainingData, int verbosityLevel) {
 
     // randomly select training points for each tree (bagging)
     for (int j = 0; j < nDataPoints; j++)
-      dataPointIndices.push_back(intDist(randomGenerator));
+      dataPointIndices.push_back(intDist(treeGenerators[i]));
 
     trees[i].Train(trainingData, dataPointIndices, maxDepth, testedSplittingFunctions, minInformationGain,
-                   minPointsForSplit, verbosityLevel);
+                   minPointsForSplit, false, verbosityLevel);
   }
 
+  // the per-tree generators are local, so the trees use the forest's generator from now on
+  for (int i = 0; i < nTrees; i++)
+    trees[i].SetRandomGenerator(&randomGenerator);
+
+  splitNodesStoreLabelDistribution = false;
+
   if (verbosityLevel > 0) {
     std::cout << "### TRAINING DONE ###" << std::endl;
   }
@@ -37,25 +37,49 @@ void NearestNeighborClassifier::train(const Eigen::MatrixXf &data, const Eigen::
   }
 }
 
-void NearestNeighborClassifier::predict(const Eigen::MatrixXf &query_data, Eigen::MatrixXi &predicted_label) const {
-  cv::Mat query_data_cv;
-  cv::eigen2cv(query_data, query_data_cv);
-  flann_index->knnSearch(query_data_cv, knn_indices_, knn_distances_, param_.knn_,
+void NearestNeighborClassifier::query(const Eigen::Ref<const QueryMatrix> &query_data,
+                                      ClassificationResult &result) const {
+  CHECK(flann_index) << "Nearest neighbor classifier is not trained!";
+  CHECK(query_data.rows() == 0 || query_data.cols() == all_training_data.cols);
+
+  result.resize(query_data.rows(), param_.knn_);
+  if (query_data.rows() == 0)
+    return;
+
+  // wrap query data and result buffers so that FLANN reads and writes them without copying. FLANN requires continuous
+  // query data, so strided views (e.g. a block of columns) are copied first
+  QueryMatrix query_data_continuous;
+  const float *query_ptr = query_data.data();
+  if (query_data.outerStride() != query_data.cols()) {
+    query_data_continuous = query_data;
+    query_ptr = query_data_continuous.data();
+  }
+  const cv::Mat query_data_cv(query_data.rows(), query_data.cols(), CV_32F, const_cast<float *>(query_ptr));
+  cv::Mat knn_indices(result.training_sample_ids_.rows(), result.training_sample_ids_.cols(), CV_32S,
+                      result.training_sample_ids_.data());
+  cv::Mat knn_distances(result.distances_.rows(), result.distances_.cols(), CV_32F, result.distances_.data());
+  flann_index->knnSearch(query_data_cv, knn_indices, knn_distances, param_.knn_,
                          cv::flann::SearchParams(param_.checks_));
+  CHECK(knn_indices.ptr<int>() == result.training_sample_ids_.data() &&
+        knn_distances.ptr<float>() == result.distances_.data());
 
-  predicted_label.resize(knn_indices_.rows, knn_indices_.cols);
-  for (int row_id = 0; row_id < knn_indices_.rows; row_id++) {
-    for (int col_id = 0; col_id < knn_indices_.cols; col_id++) {
-      int idx = knn_indices_.at<int>(row_id, col_id);
-      predicted_label(row_id, col_id) = training_label_.at<int>(idx);
+  for (int row_id = 0; row_id < result.labels_.rows(); row_id++) {
+    for (int col_id = 0; col_id < result.labels_.cols(); col_id++) {
+      int idx = result.training_sample_ids_(row_id, col_id);
+      result.labels_(row_id, col_id) = training_label_.at<int>(idx);
     }
   }
 }
 
+void NearestNeighborClassifier::predict(const Eigen::MatrixXf &query_data, Eigen::MatrixXi &predicted_label) const {
+  query(query_data, last_result_);
+  predicted_label = last_result_.labels_;
+}
+
 void NearestNeighborClassifier::getTrainingSampleIDSforPredictions(Eigen::MatrixXi &predicted_training_sample_indices,
                                                                    Eigen::MatrixXf &distances) const {
-  cv::cv2eigen(knn_indices_, predicted_training_sample_indices);
-  cv::cv2eigen(knn_distances_, distances);
+  predicted_training_sample_indices = last_result_.training_sample_ids_;
+  distances = last_result_.distances_;
 }
 
 }  // namespace v4r
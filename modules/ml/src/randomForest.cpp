@@ -0,0 +1,84 @@
+#include <glog/logging.h>
+#include <v4r/io/filesystem.h>
+#include <v4r/ml/randomForest.h>
+
+namespace bf = boost::filesystem;
+
+namespace v4r {
+
+void RandomForestClassifier::query(const Eigen::Ref<const QueryMatrix> &query_data,
+                                   ClassificationResult &result) const {
+  CHECK(forest_) << "Random forest is neither trained nor loaded!";
+
+  const int num_labels = labels_.size();
+  const int knn = std::min(param_.knn_, num_labels);
+  result.resize(query_data.rows(), knn);
+  result.training_sample_ids_.setConstant(-1);
+
+#pragma omp parallel
+  {
+    std::vector<float> label_dist;
+    std::vector<int> order(num_labels);
+
+#pragma omp for schedule(dynamic)
+    for (int i = 0; i < query_data.rows(); i++) {
+      // query rows are contiguous, so the forest reads the features directly from the query data
+      forest_->SoftClassify(query_data.row(i).data(), label_dist);
+
+      for (int l = 0; l < num_labels; l++)
+        order[l] = l;
+
+      std::partial_sort(order.begin(), order.begin() + knn, order.end(),
+                        [&label_dist](int a, int b) { return label_dist[a] > label_dist[b]; });
+
+      for (int k = 0; k < knn; k++) {
+        result.labels_(i, k) = labels_[order[k]];
+        result.distances_(i, k) = 1.f - label_dist[order[k]];
+      }
+    }
+  }
+}
+
+void RandomForestClassifier::train(const Eigen::MatrixXf &training_data, const Eigen::VectorXi &training_label) {
+  CHECK(training_data.rows() == training_label.rows());
+
+  if (!param_.filename_.empty() && v4r::io::existsFile(param_.filename_)) {
+    LOG(INFO) << "Loading random forest from " << param_.filename_ << ".";
+    loadModel(param_.filename_);
+    return;
+  }
+
+  // the forest expects row-major feature vectors
+  std::vector<float> features(training_data.size());
+  Eigen::Map<QueryMatrix>(features.data(), training_data.rows(), training_data.cols()) = training_data;
+  std::vector<int> labels(training_label.data(), training_label.data() + training_label.size());
+
+  RandomForest::ClassificationData data;
+  data.LoadFromMemory(features, labels);
+
+  forest_.reset(new RandomForest::Forest(param_.num_trees_, param_.max_depth_, param_.bagging_ratio_,
+                                         param_.tested_splitting_functions_, param_.min_information_gain_,
+                                         param_.min_points_for_split_));
+  forest_->Train(data, 0);
+  labels_ = forest_->GetLabels();
+
+  if (!param_.filename_.empty())
+    saveModel(param_.filename_);
+}
+
+void RandomForestClassifier::saveModel(const bf::path &filename) const {
+  CHECK(forest_) << "Random forest is neither trained nor loaded!";
+  v4r::io::createDirForFileIfNotExist(filename);
+  forest_->SaveToFile(filename.string());
+}
+
+void RandomForestClassifier::loadModel(const bf::path &filename) {
+  if (!v4r::io::existsFile(filename)) {
+    LOG(ERROR) << "Given forest file " << filename.string() << " does not exist!";
+    return;
+  }
+
+  forest_.reset(new RandomForest::Forest(filename.string()));
+  labels_ = forest_->GetLabels();
+}
+}  // namespace v4r
@@ -10,58 +10,48 @@ namespace po = boost::program_options;
 
 namespace v4r {
 
-void svmClassifier::predict(const Eigen::MatrixXf &query_data, Eigen::MatrixXi &predicted_label) const {
+void svmClassifier::query(const Eigen::Ref<const QueryMatrix> &query_data, ClassificationResult &result) const {
+  CHECK(dense_svm_) << "SVM model is neither trained nor loaded!";
   int num_examples = query_data.rows();
-  int num_attributes = query_data.cols();
 
-  if (param_.svm_.probability)
-    predicted_label.resize(num_examples, param_.knn_);
+  // libsvm computes in double precision, so the queries are (scaled and) converted once
+  Eigen::MatrixXd queries;
+
+  if (param_.do_scaling_)
+    queries = (query_data.array().rowwise() * scale_.transpose().array()).matrix().cast<double>();
   else
-    predicted_label.resize(num_examples, 1);
+    queries = query_data.cast<double>();
 
-  Eigen::MatrixXf query_data_scaled = query_data;
+  Eigen::VectorXd labels;
 
-  if (param_.do_scaling_) {
-    for (int row = 0; row < num_examples; row++) {
-      query_data_scaled.row(row).array() *= scale_.array();
-    }
-  }
+  if (param_.svm_.probability) {
+    result.resize(num_examples, param_.knn_);
+    result.training_sample_ids_.setConstant(-1);
 
-  for (int i = 0; i < num_examples; i++) {
-    ::svm_node *svm_n_test = new ::svm_node[num_attributes + 1];
+    Eigen::MatrixXd prob_estimates;
+    dense_svm_->predictProbability(queries, labels, prob_estimates);
+    CHECK(prob_estimates.cols() == svm_mod_->nr_class) << "SVM model does not support probability estimates!";
 
-    for (int kk = 0; kk < num_attributes; kk++) {
-      svm_n_test[kk].value = query_data_scaled(i, kk);
-      svm_n_test[kk].index = kk + 1;
-    }
-    svm_n_test[num_attributes].index = -1;
-
-    if (param_.svm_.probability) {
-      double *prob_estimates = nullptr;
-      try {
-        prob_estimates = new double[svm_mod_->nr_class];
-      } catch (std::bad_alloc &) {
-        LOG(ERROR) << "Error allocating memory!";
-      }
-
-      double bla = svm_predict_probability(svm_mod_, svm_n_test, prob_estimates);
-      (void)bla;
-
-      std::vector<double> probs(svm_mod_->nr_class);
+    std::vector<double> probs(svm_mod_->nr_class);
+    for (int i = 0; i < num_examples; i++) {
       for (int label_id = 0; label_id < svm_mod_->nr_class; label_id++)
-        probs[label_id] = prob_estimates[label_id];
+        probs[label_id] = prob_estimates(i, label_id);
 
       std::vector<size_t> indices = sort_indexes(probs);  // NOTE sorted in ascending order. We want highest values!
 
-      for (int k = 0; k < param_.knn_; k++)
-        predicted_label(i, k) = indices[indices.size() - 1 - k];
-
-      delete[] prob_estimates;
-    } else {
-      predicted_label(i, 0) = (int)::svm_predict(svm_mod_, svm_n_test);
+      for (int k = 0; k < param_.knn_; k++) {
+        result.labels_(i, k) = indices[indices.size() - 1 - k];
+        result.distances_(i, k) = 1.f - probs[indices[indices.size() - 1 - k]];
+      }
     }
+  } else {
+    result.resize(num_examples, 1);
+    result.training_sample_ids_.setConstant(-1);
+    result.distances_.setZero();
 
-    delete[] svm_n_test;
+    dense_svm_->predict(queries, labels);
+    for (int i = 0; i < num_examples; i++)
+      result.labels_(i, 0) = (int)labels(i);
   }
 }
 
@@ -188,6 +178,7 @@ void svmClassifier::train(const Eigen::MatrixXf &training_data, const Eigen::Vec
     ofparam.close();
 
     svm_mod_ = ::svm_train(svm_prob, &param_.svm_);
+    dense_svm_.reset(new DenseSVMPredictor<::svm_model>(svm_mod_, LIBSVM_VERSION));
 
     //    v4r::io::createDirForFileIfNotExist( filename );
     this->saveModel("model.svm");
@@ -214,5 +205,7 @@ void svmClassifier::loadModel(const bf::path &filename) {
                << boost::filesystem::current_path().string() << ".";
 
   svm_mod_ = ::svm_load_model(filename.c_str());
+  if (svm_mod_)
+    dense_svm_.reset(new DenseSVMPredictor<::svm_model>(svm_mod_, LIBSVM_VERSION));
 }
 }  // namespace v4r
@@ -86,7 +86,18 @@ std::vector<float>& Tree::Classify(std::vector<float>& point, int depth) {
   return curNode->GetLabelDistribution();
 }
 
-int Tree::GetResultingLeafNode(std::vector<float> point) {
+// classifies a point given as plain array (with at least as many features as the training data), depth < 0 traverses
+// down to the leaf nodes
+std::vector<float>& Tree::Classify(const float* point, int depth) {
+  Node* curNode = GetRootNode();
+
+  for (int d = 0; (depth < 0 || d <= depth) && curNode->IsSplitNode(); ++d)
+    curNode = &nodes[curNode->EvaluateNode(point[curNode->GetSplitFeatureIdx()])];
+
+  return curNode->GetLabelDistribution();
+}
+
+int Tree::GetResultingLeafNode(const std::vector<float>& point) {
   // get root node and traverse through tree until leaf node is reached
   Node* curNode = GetRootNode();
 
@@ -101,6 +112,20 @@ int Tree::GetResultingLeafNode(std::vector<float> point) {
   return idx;
 }
 
+int Tree::GetResultingLeafNode(ClassificationData& data, int pointIdx) {
+  // same as above, but reads only the split features of the point from the training data
+  Node* curNode = GetRootNode();
+
+  int idx = rootNodeIdx;
+
+  while (curNode->IsSplitNode()) {
+    idx = curNode->EvaluateNode(data.GetFeature(pointIdx, curNode->GetSplitFeatureIdx()));
+    curNode = &nodes[idx];
+  }
+
+  return idx;
+}
+
 void Tree::ClearLeafNodes() {
   // go through all leaf nodes and reset their label distributions
   for (unsigned int i = 0; i < nodes.size(); ++i) {
@@ -113,7 +138,7 @@ void Tree::RefineLeafNodes(ClassificationData& data, int nPoints, int labelIdx)
   // for all available points in data, traverse through tree and add one point to
   // label distribution of resulting leaf node
   for (int i = 0; i < nPoints; ++i) {
-    int idx = GetResultingLeafNode(data.GetFeatures(i));
+    int idx = GetResultingLeafNode(data, i);
     nodes[idx].AddToAbsLabelDistribution(labelIdx);
   }
 }
@@ -14,6 +14,8 @@ std::istream& operator>>(std::istream& in, ClassifierType& cm) {
     cm = ClassifierType::SVM;
   else if (token == "CNN")
     cm = ClassifierType::CNN;
+  else if (token == "RF")
+    cm = ClassifierType::RF;
   else
     in.setstate(std::ios_base::failbit);
   return in;
@@ -30,6 +32,9 @@ std::ostream& operator<<(std::ostream& out, const ClassifierType& cm) {
     case ClassifierType::CNN:
       out << "CNN";
       break;
+    case ClassifierType::RF:
+      out << "RF";
+      break;
     default:
       out.setstate(std::ios_base::failbit);
   }
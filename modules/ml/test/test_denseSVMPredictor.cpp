@@ -0,0 +1,82 @@
+#include "test.h"
+
+#include <libsvm/svm.h>
+#include <v4r/common/dense_svm_predictor.h>
+
+namespace {
+/// libsvm training problem whose nodes point into a dense feature matrix
+struct SVMProblem {
+  std::vector<double> y_;
+  std::vector<std::vector<svm_node>> nodes_;
+  std::vector<svm_node *> x_;
+  svm_problem problem_;
+
+  SVMProblem(const Eigen::MatrixXd &data, const Eigen::VectorXd &labels)
+  : y_(labels.data(), labels.data() + labels.rows()), nodes_(data.rows()), x_(data.rows()) {
+    for (int i = 0; i < data.rows(); i++) {
+      for (int f = 0; f < data.cols(); f++)
+        nodes_[i].push_back({f + 1, data(i, f)});
+      nodes_[i].push_back({-1, 0.});
+      x_[i] = nodes_[i].data();
+    }
+    problem_.l = data.rows();
+    problem_.y = y_.data();
+    problem_.x = x_.data();
+  }
+};
+}  // namespace
+
+/// trains libsvm models with different kernels and numbers of classes and checks that the dense batched predictor
+/// returns exactly the same labels and probability estimates as svm_predict() and svm_predict_probability().
+TEST(DenseSVMPredictor, libsvm_equality) {
+  const int num_dim = 5;
+  const int num_samples_per_class = 40;
+  const std::vector<int> kernel_types = {LINEAR, POLY, RBF, SIGMOID};
+  svm_set_print_string_function([](const char *) {});
+
+  for (int num_classes : {2, 3}) {
+    Eigen::MatrixXd data = Eigen::MatrixXd::Random(num_classes * num_samples_per_class, num_dim);
+    Eigen::VectorXd labels(data.rows());
+    for (int i = 0; i < data.rows(); i++) {
+      labels(i) = i % num_classes;
+      data.row(i).array() += 0.5 * labels(i);
+    }
+    SVMProblem problem(data, labels);
+
+    for (int kernel_type : kernel_types) {
+      svm_parameter param = svm_parameter();
+      param.svm_type = C_SVC;
+      param.kernel_type = kernel_type;
+      param.degree = 3;
+      param.gamma = 1. / num_dim;
+      param.coef0 = 0.;
+      param.C = 1.;
+      param.cache_size = 10.;
+      param.eps = 1e-3;
+      param.shrinking = 1;
+      param.probability = 1;
+      ASSERT_EQ(svm_check_parameter(&problem.problem_, &param), nullptr);
+
+      svm_model *model = svm_train(&problem.problem_, &param);
+      v4r::DenseSVMPredictor<svm_model> predictor(model, LIBSVM_VERSION);
+      ASSERT_TRUE(predictor.hasProbabilityModel());
+      ASSERT_EQ(predictor.getNumClasses(), num_classes);
+
+      Eigen::VectorXd predicted_labels, predicted_labels_prob;
+      Eigen::MatrixXd probabilities;
+      predictor.predict(data, predicted_labels);
+      predictor.predictProbability(data, predicted_labels_prob, probabilities);
+      ASSERT_EQ(probabilities.rows(), data.rows());
+      ASSERT_EQ(probabilities.cols(), num_classes);
+
+      std::vector<double> prob_estimates(num_classes);
+      for (int i = 0; i < data.rows(); i++) {
+        EXPECT_EQ(predicted_labels(i), svm_predict(model, problem.x_[i]));
+        EXPECT_EQ(predicted_labels_prob(i), svm_predict_probability(model, problem.x_[i], prob_estimates.data()));
+        for (int c = 0; c < num_classes; c++)
+          EXPECT_EQ(probabilities(i, c), prob_estimates[c]) << "kernel " << kernel_type << ", class " << c;
+      }
+      svm_free_and_destroy_model(&model);
+    }
+  }
+}
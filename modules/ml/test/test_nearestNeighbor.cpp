@@ -83,3 +83,57 @@ TEST(NearestNeighbor, knn) {
     }
   }
 }
+
+/// queries the classifier from several threads at once with row-major views of the query data, both continuous rows
+/// and strided blocks of a wider matrix. The results have to be identical to the ones of predict() and
+/// getTrainingSampleIDSforPredictions().
+TEST(NearestNeighbor, concurrent_query) {
+  const int num_dim = 50;
+  const int num_training_samples = 2000;
+  const int num_query_data = 64;
+
+  v4r::NearestNeighborClassifierParameter param;
+  param.knn_ = 3;
+  v4r::NearestNeighborClassifier nn(param);
+
+  Eigen::MatrixXf training_data = Eigen::MatrixXf::Random(num_training_samples, num_dim);
+  Eigen::VectorXi training_label = Eigen::VectorXi::Random(num_training_samples);
+  nn.train(training_data, training_label);
+
+  v4r::Classifier::QueryMatrix query_data = v4r::Classifier::QueryMatrix::Random(num_query_data, num_dim);
+  Eigen::MatrixXi prediction, predicted_training_sample_indices;
+  Eigen::MatrixXf dist;
+  nn.predict(query_data, prediction);
+  nn.getTrainingSampleIDSforPredictions(predicted_training_sample_indices, dist);
+
+  // the same query data embedded in a wider matrix, such that blocks of it have an outer stride larger than num_dim
+  v4r::Classifier::QueryMatrix wide_query_data = v4r::Classifier::QueryMatrix::Random(num_query_data, num_dim + 7);
+  wide_query_data.middleCols(3, num_dim) = query_data;
+
+  std::vector<v4r::ClassificationResult> results(num_query_data), strided_results(num_query_data);
+#pragma omp parallel for schedule(dynamic)
+  for (int query_id = 0; query_id < num_query_data; query_id++) {
+    nn.query(query_data.row(query_id), results[query_id]);
+    nn.query(wide_query_data.block(query_id, 3, 1, num_dim), strided_results[query_id]);
+  }
+
+  v4r::ClassificationResult strided_result;
+  nn.query(wide_query_data.middleCols(3, num_dim), strided_result);
+
+  for (int query_id = 0; query_id < num_query_data; query_id++) {
+    for (const v4r::ClassificationResult &r : {results[query_id], strided_results[query_id]}) {
+      ASSERT_EQ(r.labels_.rows(), 1);
+      ASSERT_EQ(r.labels_.cols(), (int)param.knn_);
+      for (size_t k = 0; k < param.knn_; k++) {
+        EXPECT_EQ(r.labels_(0, k), prediction(query_id, k));
+        EXPECT_EQ(r.training_sample_ids_(0, k), predicted_training_sample_indices(query_id, k));
+        EXPECT_EQ(r.distances_(0, k), dist(query_id, k));
+      }
+    }
+    for (size_t k = 0; k < param.knn_; k++) {
+      EXPECT_EQ(strided_result.labels_(query_id, k), prediction(query_id, k));
+      EXPECT_EQ(strided_result.training_sample_ids_(query_id, k), predicted_training_sample_indices(query_id, k));
+      EXPECT_EQ(strided_result.distances_(query_id, k), dist(query_id, k));
+    }
+  }
+}
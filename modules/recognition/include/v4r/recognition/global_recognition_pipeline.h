@@ -75,8 +75,6 @@ class V4R_EXPORTS GlobalRecognitionPipeline : public RecognitionPipeline<PointT>
   bool visualize_clusters_;  ///< If set, visualizes the cluster and displays recognition information for each
   mutable std::vector<std::string> coordinate_axis_ids_global_;
 
-  //    omp_lock_t rec_lock_;
-
   typename Segmenter<PointT>::Ptr seg_;
   typename PlaneExtractor<PointT>::Ptr plane_extractor_;
   std::vector<std::vector<int>> clusters_;
@@ -90,7 +88,9 @@ class V4R_EXPORTS GlobalRecognitionPipeline : public RecognitionPipeline<PointT>
   void visualize();
 
   /**
-   * @brief recognize
+   * @brief recognize segments the scene and classifies all clusters with all global recognizers. Object hypotheses of
+   * each pair of cluster and recognizer are generated in parallel and merged in the order of the clusters and
+   * recognizers (independent of the number of threads)
    */
   void do_recognize(const std::vector<std::string> &model_ids_to_search) override;
 
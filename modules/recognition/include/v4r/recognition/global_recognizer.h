@@ -283,6 +283,27 @@ class V4R_EXPORTS GlobalRecognizer {
     typedef std::shared_ptr<Cluster const> ConstPtr;
   };
 
+  /**
+   * @brief The BatchClassification struct holds the signatures of several clusters that were described and classified
+   * together (one classifier query for all clusters)
+   */
+  struct BatchClassification {
+    std::vector<typename Cluster::Ptr> clusters_;  ///< classified clusters
+    ClassificationResult classification_;  ///< classification result of all signatures (stacked cluster by cluster)
+    std::vector<int> first_row_;  ///< first row of each cluster in classification_ (size is number of clusters + 1)
+    std::vector<std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f>>>
+        descriptor_transforms_;  ///< transforms computed together with the signatures of each cluster (e.g. OURCVFH)
+
+    /**
+     * @brief numSignatures
+     * @param cluster_id cluster index
+     * @return number of signatures (rows in classification_) of the given cluster
+     */
+    int numSignatures(size_t cluster_id) const {
+      return first_row_[cluster_id + 1] - first_row_[cluster_id];
+    }
+  };
+
  private:
   typename pcl::PointCloud<PointT>::ConstPtr scene_;      ///< Point cloud to be classified
   pcl::PointCloud<pcl::Normal>::ConstPtr scene_normals_;  ///< Point cloud to be classified
@@ -307,7 +328,14 @@ class V4R_EXPORTS GlobalRecognizer {
   typename GlobalEstimator<PointT>::Ptr estimator_;  ///< estimator used for describing the object
   Classifier::Ptr classifier_;                       ///< classifier object
 
-  void featureEncodingAndMatching(const std::vector<std::string> &model_ids_to_search);
+  /**
+   * @brief computeSignature describes a cluster of the scene with the feature estimator
+   * @param cluster cluster to be described (if empty, the whole scene is described)
+   * @param[out] signature computed signature(s), one per row
+   * @param[out] descriptor_transforms transforms computed together with the signatures (e.g. OURCVFH)
+   */
+  void computeSignature(const typename Cluster::ConstPtr &cluster, Eigen::MatrixXf &signature,
+                        std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f>> &descriptor_transforms);
 
   bool keep_all_hypotheses_;
 
@@ -438,6 +466,43 @@ class V4R_EXPORTS GlobalRecognizer {
    */
   void recognize(const std::vector<std::string> &model_ids_to_search = std::vector<std::string>());
 
+  /**
+   * @brief recognize objects in several clusters of the input cloud. The signatures of all clusters are classified in
+   * one classifier query and the object hypotheses are generated for each cluster in parallel
+   * @param clusters clusters to be classified
+   * @param model_ids_to_search object model identities to search. If empty, all object models in loaded object model
+   * database will be searched for
+   * @param[out] filtered_hypotheses generated (potentially filtered) object hypotheses for each cluster
+   * @param[out] all_hypotheses all generated object hypotheses for each cluster
+   */
+  void recognize(const std::vector<typename Cluster::Ptr> &clusters,
+                 const std::vector<std::string> &model_ids_to_search,
+                 std::vector<std::vector<ObjectHypothesis::Ptr>> &filtered_hypotheses,
+                 std::vector<std::vector<ObjectHypothesis::Ptr>> &all_hypotheses);
+
+  /**
+   * @brief classify describes all clusters of the input cloud and classifies their signatures in a single classifier
+   * query. As the feature estimator is not thread-safe, this must not be called concurrently on the same recognizer
+   * @param clusters clusters to be classified (an empty pointer describes the whole input cloud)
+   * @param[out] batch signatures' classification result
+   */
+  void classify(const std::vector<typename Cluster::Ptr> &clusters, BatchClassification &batch);
+
+  /**
+   * @brief generateHypotheses generates object hypotheses for one cluster from its classification result. Does not
+   * modify the recognizer, so hypotheses of several clusters can be generated concurrently
+   * @param batch classification result computed by classify()
+   * @param cluster_id index of the cluster in the batch
+   * @param model_ids_to_search object model identities to search. If empty, all object models in loaded object model
+   * database will be searched for
+   * @param[out] filtered_hypotheses generated (potentially filtered) object hypotheses
+   * @param[out] all_hypotheses all generated object hypotheses
+   */
+  void generateHypotheses(const BatchClassification &batch, size_t cluster_id,
+                          const std::vector<std::string> &model_ids_to_search,
+                          std::vector<ObjectHypothesis::Ptr> &filtered_hypotheses,
+                          std::vector<ObjectHypothesis::Ptr> &all_hypotheses) const;
+
   /**
    * @brief setVisualizationParameter
    * @param vis_param
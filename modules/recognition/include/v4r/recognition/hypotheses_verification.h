@@ -49,11 +49,13 @@
 
 #include <v4r/common/color_comparison.h>
 #include <v4r/common/intrinsics.h>
+#include <v4r/common/miscellaneous.h>
 #include <v4r/common/normals.h>
 #include <v4r/common/rgb2cielab.h>
 #include <v4r/core/macros.h>
 #include <v4r/recognition/hypotheses_verification_param.h>
 #include <v4r/recognition/hypotheses_verification_visualization.h>
+#include <v4r/recognition/icp_pose_refiner.h>
 #include <v4r/recognition/object_hypothesis.h>
 
 #include <pcl/common/angles.h>
@@ -70,6 +72,8 @@
 #include <boost/mpl/at.hpp>
 #include <boost/mpl/map.hpp>
 
+#include <unordered_set>
+
 namespace v4r {
 
 // forward declarations
@@ -153,6 +157,7 @@ class V4R_EXPORTS HypothesisVerification {
       octree_model_representation_;  ///< for each model we create an octree representation (used for computing visible
                                      /// points)
   typename pcl::search::KdTree<PointT>::Ptr kdtree_scene_;
+  IcpPoseRefiner<PointT> pose_refiner_;  ///< refines poses of hypotheses against the downsampled scene (shares kd-tree)
   typename v4r::NormalEstimator<PointT>::Ptr
       model_normal_estimator_;  ///< normal estimator for object models (only used
                                 /// in case not already computed in advance)
@@ -175,9 +180,68 @@ class V4R_EXPORTS HypothesisVerification {
     double cost_;
   } best_solution_;  ///< costs for each possible solution
 
-  std::set<size_t> evaluated_solutions_;
+  std::unordered_set<boost::dynamic_bitset<>, DynamicBitsetHash>
+      evaluated_solutions_;  ///< solutions already evaluated (or scheduled for evaluation) during local search
+
+  /**
+   * @brief local search over the solution space. In each iteration, all neighbors of the currently best solution
+   * (one additional hypothesis or two additional hypotheses explaining the same smooth region) are evaluated in
+   * parallel and the one with lowest cost is taken.
+   */
   void search();
 
+  /**
+   * @brief cost state of the solution the local search currently expands. For each downsampled scene point it keeps the
+   * best and second best fitness of all active hypotheses and for each smooth region the number of explained points.
+   * Switching on further hypotheses then only needs to visit the scene points explained by these hypotheses.
+   */
+  struct IncrementalCost {
+    std::vector<float> best_fit_;         ///< highest fitness of any active hypothesis for each scene point
+    std::vector<float> second_best_fit_;  ///< second highest fitness of any active hypothesis for each scene point
+    boost::dynamic_bitset<> pt_is_explained_;  ///< true if scene point is explained by at least one active hypothesis
+    std::vector<size_t> num_pts_in_region_;    ///< number of scene points for each smooth region label
+    std::vector<size_t> num_explained_pts_in_region_;  ///< number of explained scene points for each region label
+    size_t num_violated_regions_;  ///< number of smooth regions which are only partially explained
+    double scene_fit_;             ///< sum of best_fit_ over all scene points
+    double duplicity_;             ///< sum of second_best_fit_ over all scene points
+  } incremental_cost_;
+
+  /**
+   * @brief temporary buffers for evaluating a solution incrementally (one instance per thread)
+   */
+  struct IncrementalCostScratch {
+    std::vector<size_t> region_increment_;  ///< per label counter of newly explained points
+    std::vector<int> touched_regions_;      ///< labels with non-zero region_increment_
+  };
+
+  /**
+   * @brief initializes the incremental cost state from scratch for the given solution
+   * @param solution active hypotheses
+   */
+  void initializeIncrementalCost(const boost::dynamic_bitset<> &solution);
+
+  /**
+   * @brief computes the cost of the solution stored in the incremental cost state with additional hypotheses switched
+   * on. The state itself is not modified, so this can be called concurrently with separate scratch buffers.
+   * @param added_hypotheses hypotheses to be switched on (must not be active in the state)
+   * @param violates_smooth_region_check true if the resulting solution violates the smooth region check
+   * @param scratch temporary buffers of the calling thread
+   * @return cost of the resulting solution (same as evaluateSolution would return)
+   */
+  double evaluateSolutionIncrementally(const boost::dynamic_bitset<> &added_hypotheses,
+                                       bool &violates_smooth_region_check, IncrementalCostScratch &scratch) const;
+
+  /**
+   * @brief checks if a smooth region is explained only partially
+   * @param num_explained_pts_in_region number of scene points in region explained by active hypotheses
+   * @param num_pts_in_region number of scene points in region
+   * @return true if region violates smooth region check
+   */
+  bool violatesSmoothRegion(size_t num_explained_pts_in_region, size_t num_pts_in_region) const {
+    return num_explained_pts_in_region > param_.min_pts_smooth_cluster_to_be_epxlained_ &&
+           (float)(num_explained_pts_in_region) / num_pts_in_region < param_.min_ratio_cluster_explained_;
+  }
+
   Eigen::MatrixXf scene_color_channels_;  ///< converted color values where each point corresponds to a row entry
   typename pcl::octree::OctreePointCloudSearch<PointT>::Ptr octree_scene_downsampled_;
   boost::function<void(const boost::dynamic_bitset<> &, double, size_t)> visualize_cues_during_logger_;
@@ -282,7 +346,9 @@ class V4R_EXPORTS HypothesisVerification {
     scene_pt_smooth_label_id_.resize(0);
     scene_color_channels_.resize(0, 0);
     scene_pts_explained_solution_.clear();
+    incremental_cost_ = IncrementalCost();
     kdtree_scene_.reset();
+    pose_refiner_ = IcpPoseRefiner<PointT>();
   }
 
   /**
@@ -114,6 +114,9 @@ struct V4R_EXPORTS HV_Parameter {
   int max_iterations_ =
       5000;  ///< max iterations the optimization strategy explores local neighborhoods before stopping
              /// because the cost does not decrease.
+  bool incremental_evaluation_ =
+      true;  ///< if true, the local search computes the cost of neighboring solutions incrementally from the cost
+             /// state of the currently best solution instead of evaluating each solution from scratch
   float clutter_regularizer_ =
       0.1f;  ///< The penalty multiplier used to penalize unexplained scene points within the clutter
              /// influence radius <i>radius_neighborhood_clutter_</i> of an explained scene point when
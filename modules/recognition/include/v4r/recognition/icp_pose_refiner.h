@@ -0,0 +1,180 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 TU Wien, ACIN, Vision 4 Robotics (V4R) group
+** Contact: v4r.acin.tuwien.ac.at
+**
+** This file is part of V4R
+**
+** V4R is distributed under dual licenses - GPLv3 or closed source.
+**
+** GNU General Public License Usage
+** V4R is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published
+** by the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** V4R is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** Please review the following information to ensure the GNU General Public
+** License requirements will be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+**
+** Commercial License Usage
+** If GPL is not suitable for your project, you must purchase a commercial
+** license to use V4R. Licensees holding valid commercial V4R licenses may
+** use this file in accordance with the commercial license agreement
+** provided with the Software or, alternatively, in accordance with the
+** terms contained in a written agreement between you and TU Wien, ACIN, V4R.
+** For licensing terms and conditions please contact office<at>acin.tuwien.ac.at.
+**
+**
+** The copyright holder additionally grants the author(s) of the file the right
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or
+** sell copies of their contributions without any restrictions.
+**
+****************************************************************************/
+
+/**
+ * @file icp_pose_refiner.h
+ * @brief Refines the poses of a batch of object hypotheses by ICP against one scene, sharing the scene search
+ * structure (kd-tree or projective lookup for organized clouds) across all hypotheses of a frame.
+ *
+ */
+
+#pragma once
+
+#include <v4r/common/intrinsics.h>
+#include <v4r/core/macros.h>
+
+#include <pcl/correspondence.h>
+#include <pcl/point_cloud.h>
+#include <pcl/registration/correspondence_estimation.h>
+#include <pcl/search/kdtree.h>
+
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace v4r {
+
+/**
+ * @brief Correspondence estimation for organized target clouds. Each source point is projected into the image plane of
+ * the target and matched to the closest finite target point within a small pixel window around the projection. This
+ * replaces the kd-tree lookup of pcl::registration::CorrespondenceEstimation and therefore needs no search structure.
+ */
+template <typename PointT>
+class V4R_EXPORTS ProjectiveCorrespondenceEstimation
+: public pcl::registration::CorrespondenceEstimationBase<PointT, PointT, float> {
+ private:
+  using pcl::registration::CorrespondenceEstimationBase<PointT, PointT, float>::input_;
+  using pcl::registration::CorrespondenceEstimationBase<PointT, PointT, float>::indices_;
+  using pcl::registration::CorrespondenceEstimationBase<PointT, PointT, float>::target_;
+  using pcl::registration::CorrespondenceEstimationBase<PointT, PointT, float>::corr_name_;
+
+  Intrinsics cam_;   ///< camera intrinsics of the target cloud (adjusted to its resolution)
+  int window_size_;  ///< half size of the pixel window searched around the projection of a source point
+
+  /**
+   * @brief findClosest searches the pixel window around the projection of a point for the closest target point
+   * @param p query point (in the coordinate system of the target cloud)
+   * @param max_dist_sqr maximum squared distance of a valid correspondence
+   * @param[out] dist_sqr squared distance to the found target point
+   * @return index of the closest target point or -1 if there is none within the window and distance
+   */
+  int findClosest(const PointT &p, float max_dist_sqr, float &dist_sqr) const;
+
+ public:
+  typedef boost::shared_ptr<ProjectiveCorrespondenceEstimation<PointT>> Ptr;
+  typedef boost::shared_ptr<const ProjectiveCorrespondenceEstimation<PointT>> ConstPtr;
+
+  ProjectiveCorrespondenceEstimation(const Intrinsics &cam, int window_size = 2)
+  : cam_(cam), window_size_(window_size) {
+    corr_name_ = "ProjectiveCorrespondenceEstimation";
+  }
+
+  void determineCorrespondences(pcl::Correspondences &correspondences,
+                                double max_distance = std::numeric_limits<double>::max()) override;
+
+  void determineReciprocalCorrespondences(pcl::Correspondences &correspondences,
+                                          double max_distance = std::numeric_limits<double>::max()) override;
+
+  boost::shared_ptr<pcl::registration::CorrespondenceEstimationBase<PointT, PointT, float>> clone() const override {
+    return Ptr(new ProjectiveCorrespondenceEstimation<PointT>(*this));
+  }
+};
+
+/**
+ * @brief Refines poses of object hypotheses by ICP. The scene and its search structure are set once per frame and
+ * shared by all (concurrently running) refinements.
+ */
+template <typename PointT>
+class V4R_EXPORTS IcpPoseRefiner {
+ private:
+  typename pcl::PointCloud<PointT>::ConstPtr scene_;  ///< target cloud of the pose refinement
+  typename pcl::search::KdTree<PointT>::Ptr kdtree_scene_;  ///< search structure of the scene (if not projective)
+  bool use_projective_lookup_;                              ///< if true, correspondences are found by projection
+  Intrinsics cam_;                                          ///< camera intrinsics used for projective lookup
+
+  int max_iterations_;                  ///< maximum number of ICP iterations
+  double max_correspondence_distance_;  ///< maximum distance in meter of a point correspondence
+  double transformation_epsilon_;       ///< convergence threshold on the transformation change
+
+ public:
+  IcpPoseRefiner(int max_iterations = 10, double max_correspondence_distance = 0.02,
+                 double transformation_epsilon = 1e-6)
+  : use_projective_lookup_(false), max_iterations_(max_iterations),
+    max_correspondence_distance_(max_correspondence_distance), transformation_epsilon_(transformation_epsilon) {}
+
+  /**
+   * @brief setScene sets the target cloud and builds its kd-tree (unless a kd-tree built on this cloud is given)
+   * @param scene scene cloud
+   * @param kdtree_scene kd-tree already built on the scene cloud (optional)
+   */
+  void setScene(const typename pcl::PointCloud<PointT>::ConstPtr &scene,
+                const typename pcl::search::KdTree<PointT>::Ptr &kdtree_scene =
+                    typename pcl::search::KdTree<PointT>::Ptr());
+
+  /**
+   * @brief setOrganizedScene sets an organized target cloud. Correspondences are found by projecting the source points
+   * into the image plane, so no search structure needs to be built.
+   * @param scene organized scene cloud
+   * @param cam camera intrinsics of the scene
+   */
+  void setOrganizedScene(const typename pcl::PointCloud<PointT>::ConstPtr &scene, const Intrinsics &cam);
+
+  /**
+   * @brief refine aligns a cloud to the scene
+   * @param source cloud to be aligned (already in the coordinate system of the scene)
+   * @param[out] refinement transformation that aligns the source to the scene
+   * @return true if ICP converged
+   */
+  bool refine(const typename pcl::PointCloud<PointT>::ConstPtr &source, Eigen::Matrix4f &refinement) const;
+
+  /**
+   * @brief refine aligns a set of clouds to the scene in parallel
+   * @param sources clouds to be aligned (already in the coordinate system of the scene)
+   * @param[out] refinements transformation that aligns each source to the scene
+   * @return for each source, true if ICP converged
+   */
+  std::vector<bool> refine(const std::vector<typename pcl::PointCloud<PointT>::ConstPtr> &sources,
+                           std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f>> &refinements) const;
+
+  void setMaxIterations(int max_iterations) {
+    max_iterations_ = max_iterations;
+  }
+
+  void setMaxCorrespondenceDistance(double max_correspondence_distance) {
+    max_correspondence_distance_ = max_correspondence_distance;
+  }
+
+  void setTransformationEpsilon(double transformation_epsilon) {
+    transformation_epsilon_ = transformation_epsilon;
+  }
+
+  typedef std::shared_ptr<IcpPoseRefiner<PointT>> Ptr;
+  typedef std::shared_ptr<IcpPoseRefiner<PointT> const> ConstPtr;
+};
+}  // namespace v4r
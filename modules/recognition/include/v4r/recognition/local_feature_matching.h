@@ -50,6 +50,7 @@
 #include <pcl/common/common.h>
 #include <boost/archive/xml_iarchive.hpp>
 #include <boost/archive/xml_oarchive.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 #include <boost/program_options.hpp>
 #include <boost/serialization/serialization.hpp>
 #include <opencv2/features2d/features2d.hpp>
@@ -165,17 +166,57 @@ class V4R_EXPORTS LocalObjectModelDatabase {
   typedef std::shared_ptr<LocalObjectModelDatabase> Ptr;
   typedef std::shared_ptr<LocalObjectModelDatabase const> ConstPtr;
 
-  std::shared_ptr<cv::DescriptorMatcher> matcher_;
+  std::shared_ptr<cv::DescriptorMatcher> matcher_;  ///< matcher used for brute force feature matching
+  std::shared_ptr<cv::flann::Index> flann_index_;   ///< index used for approximate nearest neighbor search
+
+  cv::Mat signatures_;  ///< signatures of all object models (read-only and memory-mapped if loaded from disk)
+
+  std::vector<std::string> model_ids_;  ///< object model ids, indexed by the model index used in flann_models_
 
   /**
-   * @brief The flann_model class stores for each signature to which model and which keypoint it belongs to
+   * @brief The flann_models class stores for each signature to which model and which keypoint it belongs to (as
+   * structure of arrays, i.e. entry i of each array belongs to signature i)
    */
-  struct flann_model {
-    std::string model_id_;
-    size_t keypoint_id_;
+  struct flann_models {
+    std::vector<uint32_t> model_idx_;     ///< index of the object model in model_ids_
+    std::vector<uint32_t> keypoint_idx_;  ///< index of the keypoint within the object model
+
+    size_t size() const {
+      return model_idx_.size();
+    }
+
+    void reserve(size_t n) {
+      model_idx_.reserve(n);
+      keypoint_idx_.reserve(n);
+    }
+
+    void push_back(uint32_t model_idx, uint32_t keypoint_idx) {
+      model_idx_.push_back(model_idx);
+      keypoint_idx_.push_back(keypoint_idx);
+    }
   };
 
-  std::vector<flann_model> flann_models_;
+  flann_models flann_models_;
+
+  /**
+   * @brief save writes the signatures together with the keypoints and keypoint normals of all object models into a
+   * single versioned binary file. The file is written to a temporary file first and then renamed, so processes that
+   * have the old file mapped are not affected.
+   * @param filename output file
+   * @return true on success
+   */
+  bool save(const bf::path &filename) const;
+
+  /**
+   * @brief load maps a file written by save() read-only into memory. The signatures are not copied, i.e. several
+   * processes loading the same file share its pages.
+   * @param filename input file
+   * @return true if the file exists and has the expected format version
+   */
+  bool load(const bf::path &filename);
+
+ private:
+  std::shared_ptr<boost::interprocess::mapped_region> mapped_file_;  ///< keeps memory of mapped signatures alive
 };
 
 /**
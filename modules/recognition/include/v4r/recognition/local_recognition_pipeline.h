@@ -138,10 +138,32 @@ class V4R_EXPORTS LocalRecognitionPipeline : public RecognitionPipeline<PointT>
   LocalRecognitionPipelineParameter param_;
 
   /**
-   * @brief correspondenceGrouping
+   * @brief correspondenceGrouping clusters the keypoint correspondences of all models in parallel and generates
+   * object hypotheses (in the order of the model ids, independent of the number of threads)
    */
   void correspondenceGrouping(const std::vector<std::string> &model_ids_to_search);
 
+  /**
+   * @brief groupCorrespondences clusters the keypoint correspondences of a single model and generates object
+   * hypotheses from the clusters
+   * @param model_id object model identifier
+   * @param loh keypoint correspondences of the model
+   * @param cg_algorithm correspondence grouping algorithm used for this model
+   * @param scene_cloud_xyz scene cloud
+   * @param[out] ohgs generated object hypotheses
+   */
+  void groupCorrespondences(const std::string &model_id, const LocalObjectHypothesis<PointT> &loh,
+                            pcl::CorrespondenceGrouping<pcl::PointXYZ, pcl::PointXYZ> &cg_algorithm,
+                            const pcl::PointCloud<pcl::PointXYZ>::Ptr &scene_cloud_xyz,
+                            std::vector<ObjectHypothesesGroup> &ohgs) const;
+
+  /**
+   * @brief cloneCGAlgorithm creates an independent copy of the correspondence grouping algorithm with the same
+   * parameters so that several models can be clustered in parallel
+   * @return copy of the correspondence grouping algorithm or an empty pointer if its type can not be copied
+   */
+  std::shared_ptr<pcl::CorrespondenceGrouping<pcl::PointXYZ, pcl::PointXYZ>> cloneCGAlgorithm() const;
+
   /**
    * @brief recognize
    * @param model_ids_to_search object model ids to search for
@@ -62,6 +62,9 @@
 
 #include <v4r/core/macros.h>
 
+#include <future>
+#include <mutex>
+
 namespace bf = boost::filesystem;
 
 namespace v4r {
@@ -144,6 +147,19 @@ class V4R_EXPORTS Model {
 
   typedef typename boost::mpl::at<PointTypeAssociations, PointT>::type PointTWithNormal;
 
+  mutable std::mutex lod_mutex_;  ///< guards the level-of-detail caches (voxelized_assembled_ and
+                                  ///< normals_voxelized_assembled_)
+  bf::path model_filename_;       ///< file the assembled model was loaded from or stored to
+  bf::path lod_cache_dir_;        ///< directory to store voxelized versions of the model (not stored if empty)
+
+  /**
+   * @brief filename of a stored voxelized version of the model
+   * @param name type of cloud (e.g. points or normals)
+   * @param resolution_mm resolution of the voxel grid in millimeter
+   * @return file path (empty if the level-of-detail cache is not stored on disk)
+   */
+  bf::path getLODCacheFilename(const std::string &name, int resolution_mm) const;
+
  public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
@@ -155,8 +171,10 @@ class V4R_EXPORTS Model {
   Eigen::Vector4f maxPoint_;  ///< defines the 3D bounding box of the object model
   PointTPtr assembled_;
   pcl::PointCloud<pcl::Normal>::Ptr normals_assembled_;
-  mutable typename std::map<int, PointTPtrConst> voxelized_assembled_;
-  mutable typename std::map<int, pcl::PointCloud<pcl::Normal>::ConstPtr> normals_voxelized_assembled_;
+  mutable typename std::map<int, std::shared_future<PointTPtrConst>>
+      voxelized_assembled_;  ///< voxelized model for each resolution (computed once on first request)
+  mutable typename std::map<int, std::shared_future<pcl::PointCloud<pcl::Normal>::ConstPtr>>
+      normals_voxelized_assembled_;  ///< voxelized normals for each resolution (computed once on first request)
   Eigen::Vector4f centroid_;  ///< centre of gravity for the whole 3d model
   bool centroid_computed_;
 
@@ -184,13 +202,35 @@ class V4R_EXPORTS Model {
 
   pcl::PointCloud<pcl::PointXYZL>::Ptr getAssembledSmoothFaces(int resolution_mm);
 
+  /**
+   * @brief getAssembled returns the assembled model voxelized with the given resolution. Each resolution is computed
+   * only once, also if requested by several threads at the same time.
+   * @param resolution_mm resolution in millimeter (full resolution if <= 0)
+   * @return voxelized model
+   */
   typename pcl::PointCloud<PointT>::ConstPtr getAssembled(int resolution_mm) const;
 
+  /**
+   * @brief setLODCacheDirectory sets a directory where voxelized versions of the model (see getAssembled and
+   * getNormalsAssembled) are stored. They are loaded from there instead of computed again, as long as they are not
+   * older than the model file.
+   * @param dir directory (if empty, voxelized versions are only kept in memory)
+   */
+  void setLODCacheDirectory(const bf::path &dir) {
+    lod_cache_dir_ = dir;
+  }
+
   /**
    * @brief initialize initializes the model creating 3D models and so on
    */
   void initialize(const bf::path &model_filename = "");
 
+  /**
+   * @brief getNormalsAssembled returns the normals of the assembled model voxelized with the given resolution (thread
+   * safe, see getAssembled)
+   * @param resolution_mm resolution in millimeter (full resolution if <= 0)
+   * @return voxelized normals
+   */
   pcl::PointCloud<pcl::Normal>::ConstPtr getNormalsAssembled(int resolution_mm) const;
 
   typedef std::shared_ptr<Model<PointT>> Ptr;
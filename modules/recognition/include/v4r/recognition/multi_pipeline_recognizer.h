@@ -47,7 +47,6 @@
 
 #pragma once
 
-#include <omp.h>
 #include <v4r/recognition/recognition_pipeline.h>
 
 namespace v4r {
@@ -66,10 +65,9 @@ class V4R_EXPORTS MultiRecognitionPipeline : public RecognitionPipeline<PointT>
 
   std::vector<typename RecognitionPipeline<PointT>::Ptr> recognition_pipelines_;
 
-  omp_lock_t rec_lock_;
-
   /**
-   * @brief recognize
+   * @brief recognize runs all recognition pipelines concurrently and merges their object hypotheses and elapsed times
+   * (including the wall time of each pipeline) in the order in which the pipelines were added
    */
   void do_recognize(const std::vector<std::string> &model_ids_to_search) override;
 
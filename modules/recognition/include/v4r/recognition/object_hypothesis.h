@@ -54,6 +54,7 @@
 #include <boost/serialization/shared_ptr.hpp>
 #include <boost/serialization/split_member.hpp>
 #include <boost/serialization/vector.hpp>
+#include <atomic>
 
 #include <v4r/core/macros.h>
 #include <v4r/recognition/model.h>
@@ -71,8 +72,9 @@ class V4R_EXPORTS ObjectHypothesis {
     ar& class_id_& model_id_& transform_& pose_refinement_& confidence_& is_verified_& unique_id_;
   }
 
-  static size_t s_counter_;  /// unique identifier to avoid transferring hypotheses multiple times when using multi-view
-                             /// recognition
+  static std::atomic<size_t> s_counter_;  /// unique identifier to avoid transferring hypotheses multiple times when
+                                          /// using multi-view recognition (atomic as hypotheses are generated in
+                                          /// parallel)
 
  public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
@@ -128,6 +130,46 @@ class V4R_EXPORTS ModelSceneCorrespondence {
     color_distance_(std::numeric_limits<float>::quiet_NaN()), normals_dotp_(M_PI / 2.f), fitness_(0.f) {}
 };
 
+/**
+ * @brief binary image mask stored row by row with each row padded to full 64 bit words. It also keeps the bounding
+ * rectangle of all set pixels so that the overlap of two masks only needs to look at words inside both rectangles.
+ */
+class V4R_EXPORTS PackedImageMask {
+ private:
+  std::vector<uint64_t> words_;   ///< mask bits, row v starts at word v * words_per_row_
+  size_t width_;                  ///< image width in pixel
+  size_t height_;                 ///< image height in pixel
+  size_t words_per_row_;          ///< number of 64 bit words per image row
+  size_t row_begin_, row_end_;    ///< range of rows containing set pixels
+  size_t word_begin_, word_end_;  ///< range of words (within a row) containing set pixels
+  size_t count_;                  ///< number of set pixels
+
+ public:
+  PackedImageMask()
+  : width_(0), height_(0), words_per_row_(0), row_begin_(0), row_end_(0), word_begin_(0), word_end_(0), count_(0) {}
+
+  /**
+   * @brief packs an image mask
+   * @param mask row-major image mask (bit v * width + u represents pixel (u,v))
+   * @param width image width in pixel
+   */
+  PackedImageMask(const boost::dynamic_bitset<> &mask, size_t width);
+
+  /**
+   * @brief number of set pixels
+   */
+  size_t count() const {
+    return count_;
+  }
+
+  /**
+   * @brief counts the pixels set in both masks
+   * @param other mask of the same image size
+   * @return number of pixels set in both masks
+   */
+  size_t countIntersection(const PackedImageMask &other) const;
+};
+
 template <typename PointT>
 class V4R_EXPORTS HVRecognitionModel {
  public:
@@ -142,6 +184,7 @@ class V4R_EXPORTS HVRecognitionModel {
   std::vector<boost::dynamic_bitset<>> image_mask_;  ///< image mask per view (in single-view case, there will be only
                                                      /// one element in outer vector). Used to compute pairwise
   /// intersection
+  std::vector<PackedImageMask> packed_image_mask_;  ///< image mask per view packed for fast pairwise intersection
   std::vector<int> visible_indices_;  ///< visible indices computed by z-Buffering (for model self-occlusion) and
                                       /// occlusion reasoning with scene cloud
   std::vector<int> visible_indices_by_octree_;  ///< visible indices computed by creating an octree for the model and
@@ -192,6 +235,7 @@ class V4R_EXPORTS HVRecognitionModel {
     visible_cloud_normals_.reset();
     visible_indices_.clear();
     image_mask_.clear();
+    packed_image_mask_.clear();
     model_scene_c_.clear();
     pt_color_.resize(0, 0);
     scene_indices_in_crop_box_.clear();
@@ -85,17 +85,23 @@ class V4R_EXPORTS RecognitionPipeline {
   Eigen::Vector4f table_plane_;
   bool table_plane_set_;
 
-  static std::vector<std::pair<std::string, float>> elapsed_time_;  ///< to measure performance
+  std::vector<std::pair<std::string, float>> elapsed_time_;  ///< to measure performance
 
   virtual void doInit(const bf::path &trained_dir, bool retrain,
                       const std::vector<std::string> &object_instances_to_load) = 0;
 
+  /**
+   * @brief The StopWatch class measures the time until it goes out of scope and stores it into the elapsed times of a
+   * recognition pipeline
+   */
   class StopWatch {
     std::string desc_;
     boost::posix_time::ptime start_time_;
+    std::vector<std::pair<std::string, float>> &elapsed_time_;
 
    public:
-    StopWatch(const std::string &desc) : desc_(desc), start_time_(boost::posix_time::microsec_clock::local_time()) {}
+    StopWatch(const std::string &desc, std::vector<std::pair<std::string, float>> &elapsed_time)
+    : desc_(desc), start_time_(boost::posix_time::microsec_clock::local_time()), elapsed_time_(elapsed_time) {}
 
     ~StopWatch();
   };
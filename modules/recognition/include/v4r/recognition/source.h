@@ -61,12 +61,14 @@ class V4R_EXPORTS SourceParameter {
   std::string indices_prefix_;
   std::string view_folder_name_;  //< name of the folder containing the training views (point clouds) of the object
   std::string name_3D_model_;     //< filename of the 3D object model
+  std::string lod_folder_name_;   //< name of the folder to store voxelized versions of the 3D object model in (if
+                                  // empty, they are only kept in memory)
   bool has_categories_;  //< if true, reads a model database used for classification, i.e. there is another top-level
   // folders for each category and inside each category folder there is the same structure as for instance recognition
 
   SourceParameter()
   : view_prefix_("cloud_"), pose_prefix_("pose_"), indices_prefix_("object_indices_"), view_folder_name_("views"),
-    name_3D_model_("3D_model.pcd"), has_categories_(false) {}
+    name_3D_model_("3D_model.pcd"), lod_folder_name_(""), has_categories_(false) {}
 };
 
 /**
@@ -27,7 +27,7 @@ void GlobalRecognitionPipeline<PointT>::do_recognize(const std::vector<std::stri
   clusters_.clear();
 
   {
-    typename RecognitionPipeline<PointT>::StopWatch t("Segmentation");
+    typename RecognitionPipeline<PointT>::StopWatch t("Segmentation", elapsed_time_);
     seg_->setInputCloud(scene_);
     seg_->setNormalsCloud(scene_normals_);
     seg_->segment();
@@ -41,30 +41,51 @@ void GlobalRecognitionPipeline<PointT>::do_recognize(const std::vector<std::stri
     obj_hypotheses_wo_elongation_check_.resize(clusters_.size());
   }
 
-  typename RecognitionPipeline<PointT>::StopWatch t("Global recognition");
-  size_t kept = 0;
+  typename RecognitionPipeline<PointT>::StopWatch t("Global recognition", elapsed_time_);
+
+  std::vector<typename GlobalRecognizer<PointT>::Cluster::Ptr> clusters(clusters_.size());
+#pragma omp parallel for schedule(dynamic)
   for (size_t i = 0; i < clusters_.size(); i++) {
+    clusters[i].reset(new typename GlobalRecognizer<PointT>::Cluster(*scene_, clusters_[i]));
+    clusters[i]->setTablePlane(table_plane_);
+  }
+
+  // describe all clusters and classify them with a single query per recognizer (the feature estimators are not
+  // thread-safe, so each recognizer describes its clusters sequentially)
+  std::vector<typename GlobalRecognizer<PointT>::BatchClassification> batches(global_recognizers_.size());
+  for (size_t g_id = 0; g_id < global_recognizers_.size(); g_id++) {
+    typename GlobalRecognizer<PointT>::Ptr r = global_recognizers_[g_id];
+    r->setInputCloud(scene_);
+    r->setSceneNormals(scene_normals_);
+    r->classify(clusters, batches[g_id]);
+  }
+
+  // generate object hypotheses for each pair of cluster and recognizer in parallel
+  const size_t num_recognizers = global_recognizers_.size();
+  const size_t num_tasks = clusters.size() * num_recognizers;
+  std::vector<std::vector<ObjectHypothesis::Ptr>> filtered_hypotheses(num_tasks), all_hypotheses(num_tasks);
+
+#pragma omp parallel for schedule(dynamic)
+  for (size_t task_id = 0; task_id < num_tasks; task_id++) {
+    const size_t i = task_id / num_recognizers;
+    const size_t g_id = task_id % num_recognizers;
+    global_recognizers_[g_id]->generateHypotheses(batches[g_id], i, model_ids_to_search, filtered_hypotheses[task_id],
+                                                  all_hypotheses[task_id]);
+  }
+
+  // merge the object hypotheses in the order of the clusters and recognizers (independent of the number of threads)
+  size_t kept = 0;
+  for (size_t i = 0; i < clusters.size(); i++) {
     ObjectHypothesesGroup &ohg = obj_hypotheses_[kept];
     ohg.ohs_.clear();
     ohg.global_hypotheses_ = true;
 
-    typename GlobalRecognizer<PointT>::Cluster::Ptr cluster(
-        new typename GlobalRecognizer<PointT>::Cluster(*scene_, clusters_[i]));
-
-    cluster->setTablePlane(table_plane_);
-
-    /// TODO pragma omp parallel with lock
-    for (size_t g_id = 0; g_id < global_recognizers_.size(); g_id++) {
-      typename GlobalRecognizer<PointT>::Ptr r = global_recognizers_[g_id];
-      r->setInputCloud(scene_);
-      r->setSceneNormals(scene_normals_);
-      r->setCluster(cluster);
-      r->recognize(model_ids_to_search);
-      std::vector<ObjectHypothesis::Ptr> ohs = r->getFilteredHypotheses();
+    for (size_t g_id = 0; g_id < num_recognizers; g_id++) {
+      const std::vector<ObjectHypothesis::Ptr> &ohs = filtered_hypotheses[i * num_recognizers + g_id];
       ohg.ohs_.insert(ohg.ohs_.end(), ohs.begin(), ohs.end());
 
       if (visualize_clusters_) {
-        std::vector<ObjectHypothesis::Ptr> ohs_unfiltered = r->getAllHypotheses();
+        const std::vector<ObjectHypothesis::Ptr> &ohs_unfiltered = all_hypotheses[i * num_recognizers + g_id];
         obj_hypotheses_wo_elongation_check_[i].ohs_.insert(obj_hypotheses_wo_elongation_check_[i].ohs_.end(),
                                                            ohs_unfiltered.begin(), ohs_unfiltered.end());
         obj_hypotheses_wo_elongation_check_[i].global_hypotheses_ = true;
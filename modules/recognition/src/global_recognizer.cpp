@@ -324,31 +324,84 @@ void GlobalRecognizer<PointT>::doInit(const bf::path &trained_dir, bool retrain,
 }
 
 template <typename PointT>
-void GlobalRecognizer<PointT>::featureEncodingAndMatching(const std::vector<std::string> &model_ids_to_search) {
-  Eigen::MatrixXf query_sig;
-
+void GlobalRecognizer<PointT>::computeSignature(
+    const typename Cluster::ConstPtr &cluster, Eigen::MatrixXf &signature,
+    std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f>> &descriptor_transforms) {
   estimator_->setInputCloud(scene_);
   estimator_->setNormals(scene_normals_);
 
-  if (!cluster_->indices_.empty())
-    estimator_->setIndices(cluster_->indices_);
+  if (cluster && !cluster->indices_.empty())
+    estimator_->setIndices(cluster->indices_);
+
+  estimator_->compute(signature);
+  descriptor_transforms = estimator_->getTransforms();
+}
 
-  estimator_->compute(query_sig);
-  std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f>> descriptor_transforms =
-      estimator_->getTransforms();
+template <typename PointT>
+void GlobalRecognizer<PointT>::classify(const std::vector<typename Cluster::Ptr> &clusters,
+                                        BatchClassification &batch) {
+  batch.clusters_ = clusters;
+  batch.descriptor_transforms_.clear();
+  batch.descriptor_transforms_.resize(clusters.size());
+  batch.first_row_.resize(clusters.size() + 1);
+  batch.first_row_[0] = 0;
+
+  std::vector<Eigen::MatrixXf> signatures(clusters.size());
+  for (size_t i = 0; i < clusters.size(); i++) {
+    computeSignature(clusters[i], signatures[i], batch.descriptor_transforms_[i]);
+
+    if (signatures[i].cols() == 0 || signatures[i].rows() == 0) {
+      LOG(ERROR) << "No signature computed for input cluster!";
+      signatures[i].resize(0, 0);
+    }
+    batch.first_row_[i + 1] = batch.first_row_[i] + signatures[i].rows();
+  }
 
-  if (query_sig.cols() == 0 || query_sig.rows() == 0) {
-    LOG(ERROR) << "No signature computed for input cluster!";
+  const int num_signatures = batch.first_row_.back();
+  if (num_signatures == 0) {
+    batch.classification_.resize(0, 0);
     return;
   }
 
-  Eigen::MatrixXi predicted_label;
-  classifier_->predict(query_sig, predicted_label);
+  // stack the signatures of all clusters such that the classifier is queried only once
+  int feature_dimensions = 0;
+  for (const Eigen::MatrixXf &sig : signatures)
+    feature_dimensions = std::max<int>(feature_dimensions, sig.cols());
+
+  Classifier::QueryMatrix query_sig(num_signatures, feature_dimensions);
+  for (size_t i = 0; i < clusters.size(); i++) {
+    if (signatures[i].rows() == 0)
+      continue;
+
+    CHECK(signatures[i].cols() == feature_dimensions) << "Signatures of the clusters have different dimensions!";
+    query_sig.middleRows(batch.first_row_[i], signatures[i].rows()) = signatures[i];
+  }
+
+  classifier_->query(query_sig, batch.classification_);
+}
+
+template <typename PointT>
+void GlobalRecognizer<PointT>::generateHypotheses(const BatchClassification &batch, size_t cluster_id,
+                                                  const std::vector<std::string> &model_ids_to_search,
+                                                  std::vector<ObjectHypothesis::Ptr> &filtered_hypotheses,
+                                                  std::vector<ObjectHypothesis::Ptr> &all_hypotheses) const {
+  filtered_hypotheses.clear();
+  all_hypotheses.clear();
+
+  const int first_row = batch.first_row_[cluster_id];
+  const int last_row = batch.first_row_[cluster_id + 1];
+  if (first_row == last_row)
+    return;
+
+  const typename Cluster::ConstPtr cluster = batch.clusters_[cluster_id];
+  const std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f>> &descriptor_transforms =
+      batch.descriptor_transforms_[cluster_id];
+  const auto &predicted_label = batch.classification_.labels_;
 
   if (!param_.estimate_pose_) {
-    obj_hyps_filtered_.resize(predicted_label.rows() * predicted_label.cols());
+    filtered_hypotheses.resize(batch.numSignatures(cluster_id) * predicted_label.cols());
     size_t kept = 0;
-    for (int query_id = 0; query_id < predicted_label.rows(); query_id++) {
+    for (int query_id = first_row; query_id < last_row; query_id++) {
       for (int k = 0; k < predicted_label.cols(); k++) {
         int lbl = predicted_label(query_id, k);
         const std::string &model_name = id_to_model_name_[lbl];
@@ -363,21 +416,19 @@ void GlobalRecognizer<PointT>::featureEncodingAndMatching(const std::vector<std:
           continue;
         }
 
-        obj_hyps_filtered_[kept++] = oh;
+        filtered_hypotheses[kept++] = oh;
       }
     }
-    obj_hyps_filtered_.resize(kept);
+    filtered_hypotheses.resize(kept);
     return;
   } else if (!descriptor_transforms.empty())  // this will be true for OURCVFH - we can estimate the object pose from
                                               // the computed SGURF (semi-global unique reference frame)
   {
-    Eigen::MatrixXi knn_indices;
-    Eigen::MatrixXf knn_distances;
-    classifier_->getTrainingSampleIDSforPredictions(knn_indices, knn_distances);
+    const auto &knn_indices = batch.classification_.training_sample_ids_;
 
-    obj_hyps_filtered_.resize(predicted_label.rows() * predicted_label.cols());
+    filtered_hypotheses.resize(batch.numSignatures(cluster_id) * predicted_label.cols());
     size_t kept = 0;
-    for (int query_id = 0; query_id < predicted_label.rows(); query_id++) {
+    for (int query_id = first_row; query_id < last_row; query_id++) {
       for (int k = 0; k < predicted_label.cols(); k++) {
         const GlobalObjectModelDatabase::flann_model &f = gomdb_.flann_models_[knn_indices(query_id, k)];
         const size_t view_id = f.view_id_;
@@ -396,9 +447,9 @@ void GlobalRecognizer<PointT>::featureEncodingAndMatching(const std::vector<std:
         ObjectHypothesis::Ptr oh(new ObjectHypothesis);
         oh->model_id_ = f.instance_name_;
         oh->class_id_ = f.class_name_;
-        oh->transform_ = 1.f * descriptor_transforms[query_id].inverse() * gom->descriptor_transforms_[view_id] *
-                         gom->model_poses_[view_id].inverse();
-        obj_hyps_filtered_[kept++] = oh;
+        oh->transform_ = 1.f * descriptor_transforms[query_id - first_row].inverse() *
+                         gom->descriptor_transforms_[view_id] * gom->model_poses_[view_id].inverse();
+        filtered_hypotheses[kept++] = oh;
 
 #ifdef _VISUALIZE_
         pcl::visualization::PCLVisualizer vis;
@@ -415,15 +466,15 @@ void GlobalRecognizer<PointT>::featureEncodingAndMatching(const std::vector<std:
         vis.setBackgroundColor(vis_param_->bg_color_[0], vis_param_->bg_color_[1], vis_param_->bg_color_[2], vp4);
         vis.setBackgroundColor(vis_param_->bg_color_[0], vis_param_->bg_color_[1], vis_param_->bg_color_[2], vp5);
         vis.setBackgroundColor(vis_param_->bg_color_[0], vis_param_->bg_color_[1], vis_param_->bg_color_[2], vp6);
-        typename pcl::PointCloud<PointT>::Ptr cluster(new pcl::PointCloud<PointT>);
+        typename pcl::PointCloud<PointT>::Ptr cluster_cloud(new pcl::PointCloud<PointT>);
         typename pcl::PointCloud<PointT>::Ptr cluster_aligned(new pcl::PointCloud<PointT>);
 
         typename pcl::PointCloud<PointT>::Ptr model_view(new pcl::PointCloud<PointT>);
         typename pcl::PointCloud<PointT>::Ptr model_aligned(new pcl::PointCloud<PointT>);
-        pcl::copyPointCloud(*scene_, cluster_->indices_, *cluster);
-        vis.addPointCloud(cluster, "cluster", vp1);
+        pcl::copyPointCloud(*scene_, cluster->indices_, *cluster_cloud);
+        vis.addPointCloud(cluster_cloud, "cluster", vp1);
         vis.addCoordinateSystem(vis_param_->coordinate_axis_scale_, "cluster_co", vp1);
-        pcl::transformPointCloud(*cluster, *cluster_aligned, descriptor_transforms[query_id]);
+        pcl::transformPointCloud(*cluster_cloud, *cluster_aligned, descriptor_transforms[query_id - first_row]);
         vis.addCoordinateSystem(vis_param_->coordinate_axis_scale_, "cluster_aligned_co", vp2);
         vis.addPointCloud(cluster_aligned, "cluster_aligned", vp2);
 
@@ -442,12 +493,12 @@ void GlobalRecognizer<PointT>::featureEncodingAndMatching(const std::vector<std:
 #endif
       }
     }
-    obj_hyps_filtered_.resize(kept);
+    filtered_hypotheses.resize(kept);
     return;
   } else  // estimate pose using some prior assumptions
   {
     CHECK(!param_.use_table_plane_for_alignment_ ||
-          (param_.use_table_plane_for_alignment_ && cluster_->isTablePlaneSet()))
+          (param_.use_table_plane_for_alignment_ && cluster->isTablePlaneSet()))
         << "Selected to use table plane for pose alignment but table plane has not been set! " << std::endl;
 
     Eigen::Matrix4f tf_rot = Eigen::Matrix4f::Identity();
@@ -458,7 +509,7 @@ void GlobalRecognizer<PointT>::featureEncodingAndMatching(const std::vector<std:
     {
       // create some arbitrary coordinate system on table plane (s.t. normal corresponds to z axis, and others are
       // orthonormal)
-      Eigen::Vector3f vec_z = cluster_->table_plane_.topRows(3);
+      Eigen::Vector3f vec_z = cluster->table_plane_.topRows(3);
       vec_z.normalize();
 
       Eigen::Vector3f dummy;  /// NOTE we just need to find any other point on the plane except centroid to create a
@@ -483,20 +534,20 @@ void GlobalRecognizer<PointT>::featureEncodingAndMatching(const std::vector<std:
     }
 
     // pre-allocate memory
-    size_t max_hypotheses = predicted_label.rows() * predicted_label.cols();
+    size_t max_hypotheses = batch.numSignatures(cluster_id) * predicted_label.cols();
 
     if (param_.use_table_plane_for_alignment_)
       max_hypotheses *= (int)(360.f / param_.z_angle_sampling_density_degree_);
     else
       max_hypotheses *= 4;
 
-    obj_hyps_filtered_.resize(max_hypotheses);
+    filtered_hypotheses.resize(max_hypotheses);
 
-    for (size_t i = 0; i < obj_hyps_filtered_.size(); i++)
-      obj_hyps_filtered_[i].reset(new ObjectHypothesis);
+    for (size_t i = 0; i < filtered_hypotheses.size(); i++)
+      filtered_hypotheses[i].reset(new ObjectHypothesis);
 
     size_t kept = 0;
-    for (int query_id = 0; query_id < predicted_label.rows(); query_id++) {
+    for (int query_id = first_row; query_id < last_row; query_id++) {
       for (int k = 0; k < predicted_label.cols(); k++) {
         int lbl = predicted_label(query_id, k);
 
@@ -511,17 +562,19 @@ void GlobalRecognizer<PointT>::featureEncodingAndMatching(const std::vector<std:
         else
           class_name = id_to_model_name_[lbl];
 
-        GlobalObjectModel::ConstPtr gom = gomdb_.global_models_[model_name];
+        auto gom_it = gomdb_.global_models_.find(model_name);
+        CHECK(gom_it != gomdb_.global_models_.end()) << "could not find model " << model_name << "!";
+        GlobalObjectModel::ConstPtr gom = gom_it->second;
         const Eigen::Vector3f &elongations_model =
             gom->model_elongations_.colwise().maxCoeff();  // as we don't know the view, we just take the maximum extent
                                                            // of each axis over all training views
         //                const Eigen::Vector3f &elongations_model = gom->model_elongations_.row( view_id );
 
         if (param_.check_elongations_ &&
-            (cluster_->elongation_(2) / elongations_model(2) < param_.min_elongation_ratio_ ||
-             cluster_->elongation_(2) / elongations_model(2) > param_.max_elongation_ratio_ ||
-             cluster_->elongation_(1) / elongations_model(1) < param_.min_elongation_ratio_ ||
-             cluster_->elongation_(1) / elongations_model(1) > param_.max_elongation_ratio_)) {
+            (cluster->elongation_(2) / elongations_model(2) < param_.min_elongation_ratio_ ||
+             cluster->elongation_(2) / elongations_model(2) > param_.max_elongation_ratio_ ||
+             cluster->elongation_(1) / elongations_model(1) < param_.min_elongation_ratio_ ||
+             cluster->elongation_(1) / elongations_model(1) > param_.max_elongation_ratio_)) {
           continue;
         }
 
@@ -542,11 +595,11 @@ void GlobalRecognizer<PointT>::featureEncodingAndMatching(const std::vector<std:
           // align origin with downprojected cluster centroid
           float centroid_correction = gom->mean_distance_view_centroid_to_3d_model_centroid_;
 
-          Eigen::Vector3f centroid_normalized = cluster_->centroid_.head(3).normalized();
-          Eigen::Vector3f centroid_corrected = cluster_->centroid_.head(3) + centroid_correction * centroid_normalized;
+          Eigen::Vector3f centroid_normalized = cluster->centroid_.head(3).normalized();
+          Eigen::Vector3f centroid_corrected = cluster->centroid_.head(3) + centroid_correction * centroid_normalized;
 
           Eigen::Vector3f closest_pt_to_cluster_center =
-              getClosestPointOnPlane(centroid_corrected, cluster_->table_plane_);
+              getClosestPointOnPlane(centroid_corrected, cluster->table_plane_);
           Eigen::Matrix4f tf_cluster_shift = Eigen::Matrix4f::Identity();
           //                    tf11.block<3,1>(0,3) = -cluster_->centroid_.head(3);
           tf_cluster_shift.block<3, 1>(0, 3) = -closest_pt_to_cluster_center;
@@ -554,7 +607,7 @@ void GlobalRecognizer<PointT>::featureEncodingAndMatching(const std::vector<std:
           // align table plane surface normal with model coordinate's z-axis
           Eigen::Matrix4f tf_cluster_rot = Eigen::Matrix4f::Identity();
           tf_cluster_rot.block<3, 3>(0, 0) = computeRotationMatrixToAlignVectors(
-              cluster_->table_plane_.head(3), Eigen::Vector3f::UnitZ());  // Finv * G * F;
+              cluster->table_plane_.head(3), Eigen::Vector3f::UnitZ());  // Finv * G * F;
 
           const Eigen::Matrix4f align_cluster = tf_cluster_rot * tf_cluster_shift;
 
@@ -620,19 +673,19 @@ void GlobalRecognizer<PointT>::featureEncodingAndMatching(const std::vector<std:
           vis.addPointCloud(model_shifted2, "shifted2", vp3);
           vis.addCoordinateSystem(vis_param_->coordinate_axis_scale_, "shifted2_co", vp3);
 
-          typename pcl::PointCloud<PointT>::Ptr cluster(new pcl::PointCloud<PointT>);
+          typename pcl::PointCloud<PointT>::Ptr cluster_cloud(new pcl::PointCloud<PointT>);
           typename pcl::PointCloud<PointT>::Ptr cluster_shifted_and_aligned(new pcl::PointCloud<PointT>);
           typename pcl::PointCloud<PointT>::Ptr cluster_shifted_and_aligned_wo_correction(new pcl::PointCloud<PointT>);
           typename pcl::PointCloud<PointT>::Ptr cluster_shifter_and_aligned_not_downprojected_not_corrected(
               new pcl::PointCloud<PointT>);
 
-          pcl::copyPointCloud(*scene_, cluster_->indices_, *cluster);
-          vis.addPointCloud(cluster, "cluster", vp5);
+          pcl::copyPointCloud(*scene_, cluster->indices_, *cluster_cloud);
+          vis.addPointCloud(cluster_cloud, "cluster", vp5);
           vis.addCoordinateSystem(vis_param_->coordinate_axis_scale_, "cluster2", vp5);
 
           Eigen::Matrix4f tf_cluster_wo_downprojection = Eigen::Matrix4f::Identity();
-          tf_cluster_wo_downprojection.block<3, 1>(0, 3) = -cluster_->centroid_.head(3);
-          pcl::transformPointCloud(*cluster, *cluster_shifter_and_aligned_not_downprojected_not_corrected,
+          tf_cluster_wo_downprojection.block<3, 1>(0, 3) = -cluster->centroid_.head(3);
+          pcl::transformPointCloud(*cluster_cloud, *cluster_shifter_and_aligned_not_downprojected_not_corrected,
                                    tf_cluster_rot * tf_cluster_wo_downprojection);
           Eigen::Vector4f min3d_tmp, max3d_tmp;
           pcl::getMinMax3D(*cluster_shifter_and_aligned_not_downprojected_not_corrected, min3d_tmp,
@@ -648,18 +701,18 @@ void GlobalRecognizer<PointT>::featureEncodingAndMatching(const std::vector<std:
                                   "cluster_shifter_and_aligned_not_downprojected_not_corrected_co", vp6);
 
           Eigen::Vector3f closest_pt_to_cluster_center_wo_correction =
-              getClosestPointOnPlane(cluster_->centroid_.head(3), cluster_->table_plane_);
+              getClosestPointOnPlane(cluster->centroid_.head(3), cluster->table_plane_);
           Eigen::Matrix4f tf_cluster_shift_wo_correction = Eigen::Matrix4f::Identity();
           //                    tf11.block<3,1>(0,3) = -cluster_->centroid_.head(3);
           tf_cluster_shift_wo_correction.block<3, 1>(0, 3) = -closest_pt_to_cluster_center_wo_correction;
-          pcl::transformPointCloud(*cluster, *cluster_shifted_and_aligned_wo_correction,
+          pcl::transformPointCloud(*cluster_cloud, *cluster_shifted_and_aligned_wo_correction,
                                    tf_cluster_rot * tf_cluster_shift_wo_correction);
           vis.addPointCloud(cluster_shifted_and_aligned_wo_correction, "cluster_shifted_and_aligned_wo_correction",
                             vp7);
           vis.addCoordinateSystem(vis_param_->coordinate_axis_scale_, "cluster_shifted_and_aligned_wo_correction_co",
                                   vp7);
 
-          pcl::transformPointCloud(*cluster, *cluster_shifted_and_aligned, tf_cluster_rot * tf_cluster_shift);
+          pcl::transformPointCloud(*cluster_cloud, *cluster_shifted_and_aligned, tf_cluster_rot * tf_cluster_shift);
           vis.addPointCloud(cluster_shifted_and_aligned, "cluster_shifted_and_aligned", vp8);
           vis.addCoordinateSystem(vis_param_->coordinate_axis_scale_, "cluster_shifted_and_aligned_co", vp8);
 #endif
@@ -689,7 +742,7 @@ void GlobalRecognizer<PointT>::featureEncodingAndMatching(const std::vector<std:
               h->confidence_ = 0.f;
               h->model_id_ = model_name;
               h->class_id_ = class_name;
-              all_obj_hyps_.push_back(h);
+              all_hypotheses.push_back(h);
             }
           }
 #ifdef _VISUALIZE_
@@ -706,17 +759,16 @@ void GlobalRecognizer<PointT>::featureEncodingAndMatching(const std::vector<std:
 
             Eigen::Matrix4f alignment_tf = align_cluster.inverse() * rot_tmp * tf_om_shift2origin2 * tf_om_shift2origin;
 
-            obj_hyps_filtered_[kept]->transform_ = alignment_tf;  // tf_trans * tf_rot  * rot_tmp;
-            obj_hyps_filtered_[kept]->confidence_ = 0.f;
-            obj_hyps_filtered_[kept]->model_id_ = model_name;
-            obj_hyps_filtered_[kept]->class_id_ = class_name;
+            filtered_hypotheses[kept]->transform_ = alignment_tf;  // tf_trans * tf_rot  * rot_tmp;
+            filtered_hypotheses[kept]->confidence_ = 0.f;
+            filtered_hypotheses[kept]->model_id_ = model_name;
+            filtered_hypotheses[kept]->class_id_ = class_name;
             kept++;
           }
         } else  // align principal axis with the ones from closest view in training set
         {
-          Eigen::MatrixXi knn_indices;
-          Eigen::MatrixXf knn_distances;
-          classifier_->getTrainingSampleIDSforPredictions(knn_indices, knn_distances);
+          const auto &knn_indices = batch.classification_.training_sample_ids_;
+          const auto &knn_distances = batch.classification_.distances_;
           const GlobalObjectModelDatabase::flann_model &f = gomdb_.flann_models_[knn_indices(query_id, k)];
           const size_t view_id = f.view_id_;
           auto it = gomdb_.global_models_.find(f.instance_name_);
@@ -726,7 +778,7 @@ void GlobalRecognizer<PointT>::featureEncodingAndMatching(const std::vector<std:
           GlobalObjectModel::ConstPtr gom = it->second;
 
           Eigen::Matrix4f tf_trans = Eigen::Matrix4f::Identity();
-          tf_trans.block<3, 1>(0, 3) = cluster_->centroid_.topRows(3);
+          tf_trans.block<3, 1>(0, 3) = cluster->centroid_.topRows(3);
 
           // there are four possibilities (due to sign ambiguity of eigenvector)
           Eigen::Matrix3f eigenBasis, sign_operator;
@@ -734,74 +786,92 @@ void GlobalRecognizer<PointT>::featureEncodingAndMatching(const std::vector<std:
 
           // once take eigen vector as they are computed
           sign_operator = identity;
-          eigenBasis = cluster_->eigen_basis_ * sign_operator;
+          eigenBasis = cluster->eigen_basis_ * sign_operator;
           Eigen::Matrix4f tf_rot_inv = Eigen::Matrix4f::Identity();
           tf_rot_inv.block<3, 3>(0, 0) = eigenBasis.transpose();
           tf_rot = tf_rot_inv.inverse();
           Eigen::Matrix4f tf_m_inv = gom->model_poses_[view_id].inverse();
-          obj_hyps_filtered_[kept]->transform_ = tf_trans * tf_rot * gom->eigen_based_pose_[view_id] * tf_m_inv;
-          obj_hyps_filtered_[kept]->confidence_ = knn_distances(query_id, k);
-          obj_hyps_filtered_[kept]->model_id_ = model_name;
-          obj_hyps_filtered_[kept]->class_id_ = class_name;
+          filtered_hypotheses[kept]->transform_ = tf_trans * tf_rot * gom->eigen_based_pose_[view_id] * tf_m_inv;
+          filtered_hypotheses[kept]->confidence_ = knn_distances(query_id, k);
+          filtered_hypotheses[kept]->model_id_ = model_name;
+          filtered_hypotheses[kept]->class_id_ = class_name;
           kept++;
 
           // now take the first one negative
           sign_operator = identity;
           sign_operator(0, 0) = -1;
           sign_operator(2, 2) = -1;  // due to right-hand rule
-          eigenBasis = cluster_->eigen_basis_ * sign_operator;
+          eigenBasis = cluster->eigen_basis_ * sign_operator;
           tf_rot_inv = Eigen::Matrix4f::Identity();
           tf_rot_inv.block<3, 3>(0, 0) = eigenBasis.transpose();
           tf_rot = tf_rot_inv.inverse();
-          obj_hyps_filtered_[kept]->transform_ = tf_trans * tf_rot * gom->eigen_based_pose_[view_id] * tf_m_inv;
-          obj_hyps_filtered_[kept]->confidence_ = knn_distances(query_id, k);
-          obj_hyps_filtered_[kept]->model_id_ = model_name;
-          obj_hyps_filtered_[kept]->class_id_ = class_name;
+          filtered_hypotheses[kept]->transform_ = tf_trans * tf_rot * gom->eigen_based_pose_[view_id] * tf_m_inv;
+          filtered_hypotheses[kept]->confidence_ = knn_distances(query_id, k);
+          filtered_hypotheses[kept]->model_id_ = model_name;
+          filtered_hypotheses[kept]->class_id_ = class_name;
           kept++;
 
           // now take the second one negative
           sign_operator = identity;
           sign_operator(1, 1) = -1;
           sign_operator(2, 2) = -1;  // due to right-hand rule
-          eigenBasis = cluster_->eigen_basis_ * sign_operator;
+          eigenBasis = cluster->eigen_basis_ * sign_operator;
           tf_rot_inv = Eigen::Matrix4f::Identity();
           tf_rot_inv.block<3, 3>(0, 0) = eigenBasis.transpose();
           tf_rot = tf_rot_inv.inverse();
-          obj_hyps_filtered_[kept]->transform_ = tf_trans * tf_rot * gom->eigen_based_pose_[view_id] * tf_m_inv;
-          obj_hyps_filtered_[kept]->confidence_ = knn_distances(query_id, k);
-          obj_hyps_filtered_[kept]->model_id_ = model_name;
-          obj_hyps_filtered_[kept]->class_id_ = class_name;
+          filtered_hypotheses[kept]->transform_ = tf_trans * tf_rot * gom->eigen_based_pose_[view_id] * tf_m_inv;
+          filtered_hypotheses[kept]->confidence_ = knn_distances(query_id, k);
+          filtered_hypotheses[kept]->model_id_ = model_name;
+          filtered_hypotheses[kept]->class_id_ = class_name;
           kept++;
 
           // and last take first and second one negative
           sign_operator = identity;
           sign_operator(0, 0) = -1;
           sign_operator(1, 1) = -1;
-          eigenBasis = cluster_->eigen_basis_ * sign_operator;
+          eigenBasis = cluster->eigen_basis_ * sign_operator;
           tf_rot_inv = Eigen::Matrix4f::Identity();
           tf_rot_inv.block<3, 3>(0, 0) = eigenBasis.transpose();
           tf_rot = tf_rot_inv.inverse();
-          obj_hyps_filtered_[kept]->transform_ = tf_trans * tf_rot * gom->eigen_based_pose_[view_id] * tf_m_inv;
-          obj_hyps_filtered_[kept]->confidence_ = knn_distances(query_id, k);
-          obj_hyps_filtered_[kept]->model_id_ = model_name;
-          obj_hyps_filtered_[kept]->class_id_ = class_name;
+          filtered_hypotheses[kept]->transform_ = tf_trans * tf_rot * gom->eigen_based_pose_[view_id] * tf_m_inv;
+          filtered_hypotheses[kept]->confidence_ = knn_distances(query_id, k);
+          filtered_hypotheses[kept]->model_id_ = model_name;
+          filtered_hypotheses[kept]->class_id_ = class_name;
           kept++;
         }
       }
     }
 
-    obj_hyps_filtered_.resize(kept);
+    filtered_hypotheses.resize(kept);
   }
 }
 
+template <typename PointT>
+void GlobalRecognizer<PointT>::recognize(const std::vector<typename Cluster::Ptr> &clusters,
+                                         const std::vector<std::string> &model_ids_to_search,
+                                         std::vector<std::vector<ObjectHypothesis::Ptr>> &filtered_hypotheses,
+                                         std::vector<std::vector<ObjectHypothesis::Ptr>> &all_hypotheses) {
+  BatchClassification batch;
+  classify(clusters, batch);
+
+  filtered_hypotheses.clear();
+  filtered_hypotheses.resize(clusters.size());
+  all_hypotheses.clear();
+  all_hypotheses.resize(clusters.size());
+
+#pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < clusters.size(); i++)
+    generateHypotheses(batch, i, model_ids_to_search, filtered_hypotheses[i], all_hypotheses[i]);
+}
+
 template <typename PointT>
 void GlobalRecognizer<PointT>::recognize(const std::vector<std::string> &model_ids_to_search) {
   CHECK(!param_.estimate_pose_ || (param_.estimate_pose_ && cluster_))
       << "Cluster that needs to be classified is not set!";
 
-  obj_hyps_filtered_.clear();
-  all_obj_hyps_.clear();
-  featureEncodingAndMatching(model_ids_to_search);
+  BatchClassification batch;
+  classify({cluster_}, batch);
+  generateHypotheses(batch, 0, model_ids_to_search, obj_hyps_filtered_, all_obj_hyps_);
   cluster_.reset();
 }
 
@@ -11,7 +11,6 @@
 #include <v4r/segmentation/segmenter_conditional_euclidean.h>
 
 #include <pcl/common/time.h>
-#include <pcl/registration/icp.h>
 #include <pcl_1_8/keypoints/uniform_sampling.h>
 
 #include <omp.h>
@@ -307,21 +306,10 @@ void HypothesisVerification<PointT>::refinePose(HVRecognitionModel<PointT> &rm)
   //    cropFilter.setTransform(affine_trans);
   //    cropFilter.filter (*scene_cloud_downsampled_cropped);
 
-  pcl::IterativeClosestPoint<PointT, PointT> icp;
-  icp.setInputSource(rm.visible_cloud_);
-  icp.setInputTarget(scene_cloud_downsampled_);
-  icp.setTransformationEpsilon(1e-6);
-  icp.setMaximumIterations(param_.icp_iterations_);
-  icp.setMaxCorrespondenceDistance(param_.icp_max_correspondence_);
-  icp.setSearchMethodTarget(kdtree_scene_, true);
-  pcl::PointCloud<PointT> aligned_visible_model;
-  icp.align(aligned_visible_model);
-
   Eigen::Matrix4f pose_refinement;
-  if (icp.hasConverged()) {
-    pose_refinement = icp.getFinalTransformation();
+  if (pose_refiner_.refine(rm.visible_cloud_, pose_refinement))
     rm.oh_->pose_refinement_ = pose_refinement * rm.oh_->pose_refinement_;
-  } else
+  else
     LOG(WARNING) << "ICP did not converge" << std::endl;
 
   //    static pcl::visualization::PCLVisualizer vis_tmp;
@@ -442,9 +430,12 @@ void HypothesisVerification<PointT>::search() {
     }
   }
 
+  // the incremental evaluation does not keep the per-point explanations needed for visualizing the cues
+  const bool evaluate_incrementally = param_.incremental_evaluation_ && !vis_cues_;
+
   bool violates_smooth_region_check;
   double cost = evaluateSolution(initial_solution, violates_smooth_region_check);
-  evaluated_solutions_.insert(initial_solution.to_ulong());
+  evaluated_solutions_.insert(initial_solution);
   if (!param_.check_smooth_clusters_ || !violates_smooth_region_check) {
     best_solution_.solution_ = initial_solution;
     best_solution_.cost_ = cost;
@@ -453,55 +444,82 @@ void HypothesisVerification<PointT>::search() {
     best_solution_.cost_ = std::numeric_limits<double>::max();
   }
 
+  if (evaluate_incrementally)
+    initializeIncrementalCost(best_solution_.solution_);
+
   // now do a local search by enabling one hyphotheses at a time and also multiple hypotheses if they are on the same
   // smooth cluster
   bool everything_checked = false;
-  evaluated_solutions_.insert(initial_solution.to_ulong());
   while (!everything_checked) {
     everything_checked = true;
-    std::vector<size_t> solutions_to_be_tested;
+    const boost::dynamic_bitset<> expanded_solution = best_solution_.solution_;
+    std::vector<boost::dynamic_bitset<>> solutions_to_be_tested;
+
     // flip one bit at a time
-    for (size_t i = 0; i < best_solution_.solution_.size(); i++) {
-      boost::dynamic_bitset<> current_solution = best_solution_.solution_;
-      if (current_solution[i])
+    for (size_t i = 0; i < expanded_solution.size(); i++) {
+      if (expanded_solution[i])
         continue;
 
+      boost::dynamic_bitset<> current_solution = expanded_solution;
       current_solution.flip(i);
 
-      size_t solution_uint = current_solution.to_ulong();
-      solutions_to_be_tested.push_back(solution_uint);
+      if (evaluated_solutions_.insert(current_solution).second)
+        solutions_to_be_tested.push_back(current_solution);
 
       // also test solutions with two new hypotheses which both describe the same smooth cluster. This should avoid
       // rejection of them if the objects are e.g. stacked together and only one smooth cluster for the stack is found.
       /// TODO: also implement checks for more than two hypotheses describing the same smooth cluster!
       if (param_.check_smooth_clusters_ && smooth_region_overlap_.row(i).sum() > 0) {
-        for (size_t j = 0; j < best_solution_.solution_.size(); j++) {
-          boost::dynamic_bitset<> ss = current_solution;
+        for (size_t j = 0; j < expanded_solution.size(); j++) {
           if (smooth_region_overlap_(i, j) > 0 && !current_solution[j]) {
+            boost::dynamic_bitset<> ss = current_solution;
             ss.set(j);
-            size_t s_uint = ss.to_ulong();
-            solutions_to_be_tested.push_back(s_uint);
+            if (evaluated_solutions_.insert(ss).second)
+              solutions_to_be_tested.push_back(ss);
           }
         }
       }
     }
 
-    for (size_t s_uint : solutions_to_be_tested) {
-      // check if already evaluated
-      if (evaluated_solutions_.find(s_uint) != evaluated_solutions_.end())
-        continue;
+    std::vector<double> costs(solutions_to_be_tested.size());
+    std::vector<char> violates_smooth_region(solutions_to_be_tested.size(), 0);
+
+    if (evaluate_incrementally) {
+#pragma omp parallel
+      {
+        IncrementalCostScratch scratch;
+#pragma omp for schedule(dynamic)
+        for (size_t s_id = 0; s_id < solutions_to_be_tested.size(); s_id++) {
+          bool violates;
+          costs[s_id] =
+              evaluateSolutionIncrementally(solutions_to_be_tested[s_id] - expanded_solution, violates, scratch);
+          violates_smooth_region[s_id] = violates;
+        }
+      }
+      num_evaluations_ += solutions_to_be_tested.size();
+    } else {
+      for (size_t s_id = 0; s_id < solutions_to_be_tested.size(); s_id++) {
+        bool violates;
+        costs[s_id] = evaluateSolution(solutions_to_be_tested[s_id], violates);
+        violates_smooth_region[s_id] = violates;
+      }
+    }
 
-      boost::dynamic_bitset<> s(global_hypotheses_.size(), s_uint);
-      bool violates_smooth_region_check;
-      double cost = evaluateSolution(s, violates_smooth_region_check);
-      evaluated_solutions_.insert(s.to_ulong());
-      if (cost < best_solution_.cost_ && (!param_.check_smooth_clusters_ || !violates_smooth_region_check)) {
-        best_solution_.cost_ = cost;
-        best_solution_.solution_ = s;
+    // take the solution with lowest cost. Ties are broken by the order of generation (lowest flipped hypothesis
+    // index first) so the result does not depend on the number of threads
+    for (size_t s_id = 0; s_id < solutions_to_be_tested.size(); s_id++) {
+      if (costs[s_id] < best_solution_.cost_ && (!param_.check_smooth_clusters_ || !violates_smooth_region[s_id])) {
+        best_solution_.cost_ = costs[s_id];
+        best_solution_.solution_ = solutions_to_be_tested[s_id];
         everything_checked = false;
       }
     }
+
+    if (evaluate_incrementally && !everything_checked)
+      initializeIncrementalCost(best_solution_.solution_);
   }
+  elapsed_time_.push_back(std::pair<std::string, float>("local search of hypotheses verification", t.getTime()));
+  elapsed_time_.push_back(std::pair<std::string, float>("evaluated solutions", num_evaluations_));
   VLOG(1) << "Local search with " << num_evaluations_ << " evaluations took " << t.getTime() << " ms" << std::endl;
 }
 
@@ -549,8 +567,7 @@ double HypothesisVerification<PointT>::evaluateSolution(const boost::dynamic_bit
       size_t num_explained_pts_in_region = explained_pt_in_region.count();
       size_t num_pts_in_smooth_regions = s_pt_in_region.count();
 
-      if (num_explained_pts_in_region > param_.min_pts_smooth_cluster_to_be_epxlained_ &&
-          (float)(num_explained_pts_in_region) / num_pts_in_smooth_regions < param_.min_ratio_cluster_explained_) {
+      if (violatesSmoothRegion(num_explained_pts_in_region, num_pts_in_smooth_regions)) {
         violates_smooth_region_check = true;
       }
     }
@@ -570,6 +587,129 @@ double HypothesisVerification<PointT>::evaluateSolution(const boost::dynamic_bit
   return cost;  // return the dual to our max problem
 }
 
+template <typename PointT>
+void HypothesisVerification<PointT>::initializeIncrementalCost(const boost::dynamic_bitset<> &solution) {
+  IncrementalCost &ic = incremental_cost_;
+  const size_t num_scene_pts = scene_cloud_downsampled_->points.size();
+
+  ic.best_fit_.assign(num_scene_pts, 0.f);
+  ic.second_best_fit_.assign(num_scene_pts, 0.f);
+  ic.pt_is_explained_ = boost::dynamic_bitset<>(num_scene_pts, 0);
+
+  for (size_t i = solution.find_first(); i != boost::dynamic_bitset<>::npos; i = solution.find_next(i)) {
+    const typename HVRecognitionModel<PointT>::Ptr rm = global_hypotheses_[i];
+    for (Eigen::SparseVector<float>::InnerIterator it(rm->scene_explained_weight_); it; ++it) {
+      const int sidx = it.index();
+      const float fit = it.value();
+      if (fit > ic.best_fit_[sidx]) {
+        ic.second_best_fit_[sidx] = ic.best_fit_[sidx];
+        ic.best_fit_[sidx] = fit;
+      } else if (fit > ic.second_best_fit_[sidx])
+        ic.second_best_fit_[sidx] = fit;
+      ic.pt_is_explained_.set(sidx);
+    }
+  }
+
+  // sum up in the same order as evaluateSolution to get exactly the same cost for the same solution
+  ic.scene_fit_ = ic.duplicity_ = 0.;
+  for (size_t s_id = 0; s_id < num_scene_pts; s_id++) {
+    ic.scene_fit_ += ic.best_fit_[s_id];
+    ic.duplicity_ += ic.second_best_fit_[s_id];
+  }
+
+  ic.num_violated_regions_ = 0;
+  if (param_.check_smooth_clusters_) {
+    // labels are checked in the range [1, max_label) just like in evaluateSolution
+    const int max_label = scene_pt_smooth_label_id_.size() ? scene_pt_smooth_label_id_.maxCoeff() : 0;
+    ic.num_pts_in_region_.assign(max_label + 1, 0);
+    ic.num_explained_pts_in_region_.assign(max_label + 1, 0);
+
+    for (size_t s_id = 0; s_id < num_scene_pts; s_id++) {
+      const int label = scene_pt_smooth_label_id_(s_id);
+      ic.num_pts_in_region_[label]++;
+      if (ic.pt_is_explained_[s_id])
+        ic.num_explained_pts_in_region_[label]++;
+    }
+
+    for (int i = 1; i < max_label; i++) {
+      if (violatesSmoothRegion(ic.num_explained_pts_in_region_[i], ic.num_pts_in_region_[i]))
+        ic.num_violated_regions_++;
+    }
+  }
+}
+
+template <typename PointT>
+double HypothesisVerification<PointT>::evaluateSolutionIncrementally(const boost::dynamic_bitset<> &added_hypotheses,
+                                                                     bool &violates_smooth_region_check,
+                                                                     IncrementalCostScratch &scratch) const {
+  const IncrementalCost &ic = incremental_cost_;
+  const int max_label = static_cast<int>(ic.num_pts_in_region_.size()) - 1;
+
+  // the scene explained weights are sorted by scene point index, so merging them visits each touched point once
+  std::vector<Eigen::SparseVector<float>::InnerIterator> its;
+  for (size_t i = added_hypotheses.find_first(); i != boost::dynamic_bitset<>::npos; i = added_hypotheses.find_next(i))
+    its.push_back(Eigen::SparseVector<float>::InnerIterator(global_hypotheses_[i]->scene_explained_weight_));
+
+  double delta_scene_fit = 0., delta_duplicity = 0.;
+  while (true) {
+    int sidx = std::numeric_limits<int>::max();
+    for (const auto &it : its) {
+      if (it && it.index() < sidx)
+        sidx = it.index();
+    }
+
+    if (sidx == std::numeric_limits<int>::max())
+      break;
+
+    float best_fit = ic.best_fit_[sidx];
+    float second_best_fit = ic.second_best_fit_[sidx];
+    for (auto &it : its) {
+      if (it && it.index() == sidx) {
+        const float fit = it.value();
+        if (fit > best_fit) {
+          second_best_fit = best_fit;
+          best_fit = fit;
+        } else if (fit > second_best_fit)
+          second_best_fit = fit;
+        ++it;
+      }
+    }
+
+    delta_scene_fit += static_cast<double>(best_fit) - ic.best_fit_[sidx];
+    delta_duplicity += static_cast<double>(second_best_fit) - ic.second_best_fit_[sidx];
+
+    if (param_.check_smooth_clusters_ && !ic.pt_is_explained_[sidx]) {
+      const int label = scene_pt_smooth_label_id_(sidx);
+      if (label > 0 && label < max_label) {
+        if (scratch.region_increment_.size() < ic.num_pts_in_region_.size())
+          scratch.region_increment_.resize(ic.num_pts_in_region_.size(), 0);
+
+        if (!scratch.region_increment_[label]++)
+          scratch.touched_regions_.push_back(label);
+      }
+    }
+  }
+
+  size_t num_violated_regions = ic.num_violated_regions_;
+  for (int label : scratch.touched_regions_) {
+    const size_t num_explained_before = ic.num_explained_pts_in_region_[label];
+    const size_t num_explained_after = num_explained_before + scratch.region_increment_[label];
+    const bool violated_before = violatesSmoothRegion(num_explained_before, ic.num_pts_in_region_[label]);
+    const bool violated_after = violatesSmoothRegion(num_explained_after, ic.num_pts_in_region_[label]);
+
+    if (violated_before && !violated_after)
+      num_violated_regions--;
+    else if (!violated_before && violated_after)
+      num_violated_regions++;
+
+    scratch.region_increment_[label] = 0;
+  }
+  scratch.touched_regions_.clear();
+  violates_smooth_region_check = num_violated_regions > 0;
+
+  return -(log(ic.scene_fit_ + delta_scene_fit) - param_.clutter_regularizer_ * (ic.duplicity_ + delta_duplicity));
+}
+
 template <typename PointT>
 void HypothesisVerification<PointT>::computeSmoothRegionOverlap() {
   smooth_region_overlap_ = Eigen::MatrixXi::Zero(global_hypotheses_.size(), global_hypotheses_.size());
@@ -591,30 +731,40 @@ template <typename PointT>
 void HypothesisVerification<PointT>::computePairwiseIntersection() {
   intersection_cost_ = Eigen::MatrixXf::Zero(global_hypotheses_.size(), global_hypotheses_.size());
 
+#pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < global_hypotheses_.size(); i++) {
+    HVRecognitionModel<PointT> &rm = *global_hypotheses_[i];
+    rm.packed_image_mask_.resize(rm.image_mask_.size());
+    for (size_t view = 0; view < rm.image_mask_.size(); view++)
+      rm.packed_image_mask_[view] = PackedImageMask(rm.image_mask_[view], occlusion_clouds_[view]->width);
+
+    if (!vis_pairwise_)
+      rm.image_mask_.clear();
+  }
+
+#pragma omp parallel for schedule(dynamic)
   for (size_t i = 1; i < global_hypotheses_.size(); i++) {
-    HVRecognitionModel<PointT> &rm_a = *global_hypotheses_[i];
+    const HVRecognitionModel<PointT> &rm_a = *global_hypotheses_[i];
     for (size_t j = 0; j < i; j++) {
       const HVRecognitionModel<PointT> &rm_b = *global_hypotheses_[j];
 
       size_t num_intersections = 0, total_rendered_points = 0;
 
-      for (size_t view = 0; view < rm_a.image_mask_.size(); view++) {
-        for (size_t px = 0; px < rm_a.image_mask_[view].size(); px++) {
-          if (rm_a.image_mask_[view][px] && rm_b.image_mask_[view][px])
-            num_intersections++;
-
-          if (rm_a.image_mask_[view][px] || rm_b.image_mask_[view][px])
-            total_rendered_points++;
-        }
+      for (size_t view = 0; view < rm_a.packed_image_mask_.size(); view++) {
+        const PackedImageMask &mask_a = rm_a.packed_image_mask_[view];
+        const PackedImageMask &mask_b = rm_b.packed_image_mask_[view];
+        const size_t num_intersections_view = mask_a.countIntersection(mask_b);
+        num_intersections += num_intersections_view;
+        total_rendered_points += mask_a.count() + mask_b.count() - num_intersections_view;
       }
 
       float conflict_cost = static_cast<float>(num_intersections) / total_rendered_points;
       intersection_cost_(i, j) = intersection_cost_(j, i) = conflict_cost;
     }
-
-    if (!vis_pairwise_)
-      rm_a.image_mask_.clear();
   }
+
+  for (const typename HVRecognitionModel<PointT>::Ptr &rm : global_hypotheses_)
+    rm->packed_image_mask_.clear();
 }
 
 template <typename PointT>
@@ -833,6 +983,8 @@ void HypothesisVerification<PointT>::initialize() {
       ScopeTime t("Computing kd-tree");
       kdtree_scene_.reset(new pcl::search::KdTree<PointT>);
       kdtree_scene_->setInputCloud(scene_cloud_downsampled_);
+      pose_refiner_ = IcpPoseRefiner<PointT>(param_.icp_iterations_, param_.icp_max_correspondence_, 1e-6);
+      pose_refiner_.setScene(scene_cloud_downsampled_, kdtree_scene_);
     }
 
 #pragma omp section
@@ -120,6 +120,10 @@ void HV_Parameter::init(boost::program_options::options_description& desc, const
                      po::value<NormalEstimatorType>(&normal_method_)->default_value(normal_method_), "");
   desc.add_options()((section_name + ".max_iterations").c_str(),
                      po::value<int>(&max_iterations_)->default_value(max_iterations_), "");
+  desc.add_options()((section_name + ".incremental_evaluation").c_str(),
+                     po::value<bool>(&incremental_evaluation_)->default_value(incremental_evaluation_),
+                     "if true, computes the cost of neighboring solutions in the local search incrementally from the "
+                     "currently best solution (only touches scene points explained by the switched hypotheses)");
   desc.add_options()((section_name + ".min_points").c_str(),
                      po::value<size_t>(&min_points_)->default_value(min_points_), "");
   desc.add_options()((section_name + ".z_adaptive").c_str(), po::value<bool>(&z_adaptive_)->default_value(z_adaptive_),
@@ -0,0 +1,204 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 TU Wien, ACIN, Vision 4 Robotics (V4R) group
+** Contact: v4r.acin.tuwien.ac.at
+**
+** This file is part of V4R
+**
+** V4R is distributed under dual licenses - GPLv3 or closed source.
+**
+** GNU General Public License Usage
+** V4R is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published
+** by the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** V4R is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** Please review the following information to ensure the GNU General Public
+** License requirements will be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+**
+** Commercial License Usage
+** If GPL is not suitable for your project, you must purchase a commercial
+** license to use V4R. Licensees holding valid commercial V4R licenses may
+** use this file in accordance with the commercial license agreement
+** provided with the Software or, alternatively, in accordance with the
+** terms contained in a written agreement between you and TU Wien, ACIN, V4R.
+** For licensing terms and conditions please contact office<at>acin.tuwien.ac.at.
+**
+**
+** The copyright holder additionally grants the author(s) of the file the right
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or
+** sell copies of their contributions without any restrictions.
+**
+****************************************************************************/
+
+#include <glog/logging.h>
+#include <pcl/registration/icp.h>
+
+#include <v4r/recognition/icp_pose_refiner.h>
+
+namespace v4r {
+
+template <typename PointT>
+int ProjectiveCorrespondenceEstimation<PointT>::findClosest(const PointT &p, float max_dist_sqr,
+                                                            float &dist_sqr) const {
+  if (!pcl::isFinite(p) || p.z <= 0.f)
+    return -1;
+
+  const float u = cam_.fx * p.x / p.z + cam_.cx;
+  const float v = cam_.fy * p.y / p.z + cam_.cy;
+  const int width = static_cast<int>(target_->width);
+  const int height = static_cast<int>(target_->height);
+  if (u < -window_size_ || v < -window_size_ || u >= width + window_size_ || v >= height + window_size_)
+    return -1;
+
+  const int u_px = static_cast<int>(u + 0.5f);
+  const int v_px = static_cast<int>(v + 0.5f);
+  const int x_min = std::max(0, u_px - window_size_), x_max = std::min(width - 1, u_px + window_size_);
+  const int y_min = std::max(0, v_px - window_size_), y_max = std::min(height - 1, v_px + window_size_);
+
+  int best = -1;
+  dist_sqr = max_dist_sqr;
+  for (int y = y_min; y <= y_max; y++) {
+    for (int x = x_min; x <= x_max; x++) {
+      const int idx = y * width + x;
+      const PointT &t = target_->points[idx];
+      if (!pcl::isFinite(t))
+        continue;
+
+      const float d = (t.getVector3fMap() - p.getVector3fMap()).squaredNorm();
+      if (d < dist_sqr) {
+        dist_sqr = d;
+        best = idx;
+      }
+    }
+  }
+  return best;
+}
+
+template <typename PointT>
+void ProjectiveCorrespondenceEstimation<PointT>::determineCorrespondences(pcl::Correspondences &correspondences,
+                                                                         double max_distance) {
+  correspondences.clear();
+  if (!target_ || !pcl::PCLBase<PointT>::initCompute())
+    return;
+  CHECK(target_->isOrganized()) << "Projective correspondence estimation requires an organized target cloud!";
+
+  const float max_dist_sqr = static_cast<float>(max_distance * max_distance);
+  correspondences.resize(indices_->size());
+  size_t kept = 0;
+  for (int idx : *indices_) {
+    float dist_sqr;
+    const int match = findClosest(input_->points[idx], max_dist_sqr, dist_sqr);
+    if (match < 0)
+      continue;
+
+    pcl::Correspondence &c = correspondences[kept++];
+    c.index_query = idx;
+    c.index_match = match;
+    c.distance = dist_sqr;  // squared distance as in pcl::registration::CorrespondenceEstimation
+  }
+  correspondences.resize(kept);
+  pcl::PCLBase<PointT>::deinitCompute();
+}
+
+template <typename PointT>
+void ProjectiveCorrespondenceEstimation<PointT>::determineReciprocalCorrespondences(
+    pcl::Correspondences &correspondences, double max_distance) {
+  // there is no search structure for the source cloud, so a target point is only kept for its closest source point
+  pcl::Correspondences all;
+  determineCorrespondences(all, max_distance);
+
+  std::vector<int> closest_source(target_ ? target_->points.size() : 0, -1);
+  for (size_t i = 0; i < all.size(); i++) {
+    int &best = closest_source[all[i].index_match];
+    if (best < 0 || all[i].distance < all[best].distance)
+      best = static_cast<int>(i);
+  }
+
+  correspondences.clear();
+  for (size_t i = 0; i < all.size(); i++) {
+    if (closest_source[all[i].index_match] == static_cast<int>(i))
+      correspondences.push_back(all[i]);
+  }
+}
+
+template <typename PointT>
+void IcpPoseRefiner<PointT>::setScene(const typename pcl::PointCloud<PointT>::ConstPtr &scene,
+                                      const typename pcl::search::KdTree<PointT>::Ptr &kdtree_scene) {
+  scene_ = scene;
+  use_projective_lookup_ = false;
+
+  if (kdtree_scene)
+    kdtree_scene_ = kdtree_scene;
+  else {
+    kdtree_scene_.reset(new pcl::search::KdTree<PointT>);
+    kdtree_scene_->setInputCloud(scene_);
+  }
+}
+
+template <typename PointT>
+void IcpPoseRefiner<PointT>::setOrganizedScene(const typename pcl::PointCloud<PointT>::ConstPtr &scene,
+                                               const Intrinsics &cam) {
+  CHECK(scene->isOrganized()) << "Projective lookup requires an organized scene cloud!";
+  scene_ = scene;
+  use_projective_lookup_ = true;
+  kdtree_scene_.reset();
+
+  cam_ = cam;
+  if (cam_.w != scene_->width || cam_.h != scene_->height)
+    cam_.adjustToSize(scene_->width, scene_->height);
+}
+
+template <typename PointT>
+bool IcpPoseRefiner<PointT>::refine(const typename pcl::PointCloud<PointT>::ConstPtr &source,
+                                    Eigen::Matrix4f &refinement) const {
+  CHECK(scene_) << "Scene cloud for pose refinement is not set!";
+
+  pcl::IterativeClosestPoint<PointT, PointT> icp;
+  icp.setInputSource(source);
+  icp.setInputTarget(scene_);
+  icp.setTransformationEpsilon(transformation_epsilon_);
+  icp.setMaximumIterations(max_iterations_);
+  icp.setMaxCorrespondenceDistance(max_correspondence_distance_);
+
+  if (use_projective_lookup_) {
+    icp.setCorrespondenceEstimation(
+        typename ProjectiveCorrespondenceEstimation<PointT>::Ptr(new ProjectiveCorrespondenceEstimation<PointT>(cam_)));
+    // pass the (empty) default search tree again but prevent ICP from building it on the scene
+    icp.setSearchMethodTarget(icp.getSearchMethodTarget(), true);
+  } else
+    icp.setSearchMethodTarget(kdtree_scene_, true);
+
+  pcl::PointCloud<PointT> aligned_source;
+  icp.align(aligned_source);
+
+  if (!icp.hasConverged())
+    return false;
+
+  refinement = icp.getFinalTransformation();
+  return true;
+}
+
+template <typename PointT>
+std::vector<bool> IcpPoseRefiner<PointT>::refine(
+    const std::vector<typename pcl::PointCloud<PointT>::ConstPtr> &sources,
+    std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f>> &refinements) const {
+  refinements.resize(sources.size());
+  std::vector<int> converged(sources.size(), 0);  // std::vector<bool> can not be written concurrently
+
+#pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < sources.size(); i++)
+    converged[i] = refine(sources[i], refinements[i]);
+
+  return std::vector<bool>(converged.begin(), converged.end());
+}
+
+template class V4R_EXPORTS ProjectiveCorrespondenceEstimation<pcl::PointXYZRGB>;
+template class V4R_EXPORTS IcpPoseRefiner<pcl::PointXYZRGB>;
+}  // namespace v4r
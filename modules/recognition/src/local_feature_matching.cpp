@@ -5,6 +5,7 @@
 #include <pcl/features/integral_image_normal.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl_1_8/features/organized_edge_detection.h>
+#include <boost/interprocess/file_mapping.hpp>
 #include <v4r/common/miscellaneous.h>
 #include <v4r/io/cv.h>
 #include <v4r/io/eigen.h>
@@ -239,22 +240,51 @@ void LocalFeatureMatcher<PointT>::initialize(const bf::path &trained_dir, bool r
 
   std::vector<typename Model<PointT>::ConstPtr> models = m_db_->getModels();
 
+  std::vector<typename Model<PointT>::ConstPtr> models_to_load;
+  for (typename Model<PointT>::ConstPtr m : models) {
+    if (!object_instances_to_load.empty() &&
+        std::find(object_instances_to_load.begin(), object_instances_to_load.end(), m->id_) ==
+            object_instances_to_load.end()) {
+      LOG(INFO) << "Skipping object " << m->id_ << " because it is not in the lists of objects to load.";
+      continue;
+    }
+    models_to_load.push_back(m);
+  }
+
   for (size_t est_id = 0; est_id < estimators_.size(); est_id++) {
     LocalObjectModelDatabase::Ptr lomdb(new LocalObjectModelDatabase);
-    cv::Mat all_signatures_;  ///< all signatures from all objects in the database
 
     typename LocalEstimator<PointT>::Ptr &est = estimators_[est_id];
+    const std::string descr_id = est->getFeatureDescriptorName() + est->getUniqueId();
+    const bf::path lomdb_path = trained_dir / (descr_id + ".lomdb");
+
+    // the stored database is only used if it contains exactly the requested objects and none of them has been
+    // re-trained since the database was written
+    bool lomdb_on_disk = false;
+    if (!retrain && io::existsFile(lomdb_path) && lomdb->load(lomdb_path)) {
+      lomdb_on_disk = lomdb->l_obj_models_.size() == models_to_load.size();
+      const std::time_t lomdb_time = bf::last_write_time(lomdb_path);
+      for (size_t i = 0; i < models_to_load.size() && lomdb_on_disk; i++) {
+        const std::string &model_id = models_to_load[i]->id_;
+        const bf::path signatures_path = trained_dir / model_id / descr_id / "signatures.dat";
+        lomdb_on_disk = lomdb->l_obj_models_.count(model_id) && io::existsFile(signatures_path) &&
+                        bf::last_write_time(signatures_path) <= lomdb_time;
+      }
 
-    for (typename Model<PointT>::ConstPtr m : models) {
-      bf::path trained_path_feat =
-          trained_dir / m->id_ / bf::path(est->getFeatureDescriptorName() + est->getUniqueId());
-
-      if (!object_instances_to_load.empty() &&
-          std::find(object_instances_to_load.begin(), object_instances_to_load.end(), m->id_) ==
-              object_instances_to_load.end()) {
-        LOG(INFO) << "Skipping object " << m->id_ << " because it is not in the lists of objects to load.";
-        continue;
+      if (lomdb_on_disk)
+        LOG(INFO) << "Loaded " << lomdb->signatures_.rows << " " << descr_id << " descriptors from " << lomdb_path;
+      else {
+        LOG(INFO) << "Local object model database " << lomdb_path << " is out of date. Rebuilding it.";
+        lomdb.reset(new LocalObjectModelDatabase);
       }
+    }
+
+    bool store_index = lomdb_on_disk;  // only store an index if it belongs to the stored database
+
+    std::vector<cv::Mat> all_signatures;  ///< signatures of each object in the database
+    for (size_t i = 0; i < models_to_load.size() && !lomdb_on_disk; i++) {
+      typename Model<PointT>::ConstPtr m = models_to_load[i];
+      bf::path trained_path_feat = trained_dir / m->id_ / bf::path(descr_id);
 
       cv::Mat model_signatures;
       pcl::PointCloud<pcl::PointXYZ>::Ptr model_keypoints(new pcl::PointCloud<pcl::PointXYZ>);
@@ -446,17 +476,14 @@ void LocalFeatureMatcher<PointT>::initialize(const bf::path &trained_dir, bool r
         io::writeMatBinary(signatures_path, model_signatures);
       }
 
-      if (all_signatures_.empty())
-        all_signatures_ = model_signatures;
-      else
-        cv::vconcat(all_signatures_, model_signatures, all_signatures_);
+      if (!model_signatures.empty())
+        all_signatures.push_back(model_signatures);
 
-      std::vector<LocalObjectModelDatabase::flann_model> flann_models_tmp(model_signatures.rows);
-      for (int f = 0; f < model_signatures.rows; f++) {
-        flann_models_tmp[f].model_id_ = m->id_;
-        flann_models_tmp[f].keypoint_id_ = f;
-      }
-      lomdb->flann_models_.insert(lomdb->flann_models_.end(), flann_models_tmp.begin(), flann_models_tmp.end());
+      const uint32_t model_idx = lomdb->model_ids_.size();
+      lomdb->model_ids_.push_back(m->id_);
+      lomdb->flann_models_.reserve(lomdb->flann_models_.size() + model_signatures.rows);
+      for (int f = 0; f < model_signatures.rows; f++)
+        lomdb->flann_models_.push_back(model_idx, f);
 
       LocalObjectModel::Ptr lom(new LocalObjectModel);
       lom->keypoints_ = model_keypoints;
@@ -464,10 +491,23 @@ void LocalFeatureMatcher<PointT>::initialize(const bf::path &trained_dir, bool r
       lomdb->l_obj_models_[m->id_] = lom;
     }
 
-    CHECK((int)lomdb->flann_models_.size() == all_signatures_.rows);
+    if (!lomdb_on_disk) {
+      cv::vconcat(all_signatures, lomdb->signatures_);
+      all_signatures.clear();
+
+      store_index = lomdb->save(lomdb_path);
+      if (store_index) {
+        // indices stored for a previous version of the database are not valid anymore
+        for (bf::directory_iterator it(trained_dir); it != bf::directory_iterator(); ++it) {
+          const std::string fn = it->path().filename().string();
+          if (fn.compare(0, descr_id.size() + 1, descr_id + ".") == 0 && it->path().extension() == ".flann")
+            bf::remove(it->path());
+        }
+      } else
+        LOG(WARNING) << "Could not write local object model database to " << lomdb_path;
+    }
 
-    LOG(INFO) << "Building the kdtree index for " << est->getFeatureDescriptorName() << " (with id "
-              << est->getUniqueId() << ") for " << all_signatures_.rows << " elements.";
+    CHECK((int)lomdb->flann_models_.size() == lomdb->signatures_.rows);
 
     if (param_.use_brute_force_matching_) {
       switch (param_.distance_metric_) {
@@ -484,29 +524,66 @@ void LocalFeatureMatcher<PointT>::initialize(const bf::path &trained_dir, bool r
           LOG(ERROR) << "Distance metric " << param_.distance_metric_
                      << " is not implemented for brute force matching!";
       }
+      std::vector<cv::Mat> descriptors;
+      descriptors.push_back(lomdb->signatures_);
+      lomdb->matcher_->add(descriptors);
+      lomdb->matcher_->train();
     } else {
+      // the index file name encodes the index parameters, so changing them does not pick up a stale index
+      std::stringstream index_fn;
+      std::unique_ptr<cv::flann::IndexParams> index_param;
+      cvflann::flann_distance_t index_distance;
       switch (param_.distance_metric_) {
         case DistanceMetric::HAMMING:
-          lomdb->matcher_.reset(new cv::FlannBasedMatcher(
-              new cv::flann::LshIndexParams(param_.lsh_index_table_number_, param_.lsh_index_key_index_,
-                                            param_.lsh_index_multi_probe_level_),
-              new cv::flann::SearchParams(param_.kdtree_search_checks_, 0, true)));
+          index_param.reset(new cv::flann::LshIndexParams(
+              param_.lsh_index_table_number_, param_.lsh_index_key_index_, param_.lsh_index_multi_probe_level_));
+          index_distance = cvflann::FLANN_DIST_HAMMING;
+          index_fn << descr_id << ".lsh_" << param_.lsh_index_table_number_ << "_" << param_.lsh_index_key_index_
+                   << "_" << param_.lsh_index_multi_probe_level_ << ".flann";
           break;
         default:
-          lomdb->matcher_.reset(
-              new cv::FlannBasedMatcher(new cv::flann::KDTreeIndexParams(param_.kdtree_num_trees_),
-                                        new cv::flann::SearchParams(param_.kdtree_search_checks_, 0, true)));
+          index_param.reset(new cv::flann::KDTreeIndexParams(param_.kdtree_num_trees_));
+          index_distance = cvflann::FLANN_DIST_L2;
+          index_fn << descr_id << ".kdtree_" << param_.kdtree_num_trees_ << ".flann";
       }
+      const bf::path index_path = trained_dir / index_fn.str();
+
+      bool index_loaded = false;
+      if (lomdb_on_disk && io::existsFile(index_path)) {
+        lomdb->flann_index_.reset(new cv::flann::Index);
+        try {
+          index_loaded = lomdb->flann_index_->load(lomdb->signatures_, index_path.string());
+        } catch (const std::exception &e) {
+          LOG(WARNING) << "Could not load index " << index_path << ": " << e.what();
+        }
+      }
+
+      if (!index_loaded) {
+        LOG(INFO) << "Building the kdtree index for " << est->getFeatureDescriptorName() << " (with id "
+                  << est->getUniqueId() << ") for " << lomdb->signatures_.rows << " elements.";
+        lomdb->flann_index_.reset(new cv::flann::Index(lomdb->signatures_, *index_param, index_distance));
+
+        if (store_index) {
+          const bf::path tmp_path = index_path.string() + "." + bf::unique_path().string() + ".tmp";
+          boost::system::error_code ec;
+          try {
+            lomdb->flann_index_->save(tmp_path.string());
+            bf::rename(tmp_path, index_path, ec);
+          } catch (const std::exception &e) {
+            LOG(WARNING) << "Could not save index to " << index_path << ": " << e.what();
+          }
+          bf::remove(tmp_path, ec);
+        }
+      } else
+        LOG(INFO) << "Loaded the kdtree index for " << est->getFeatureDescriptorName() << " (with id "
+                  << est->getUniqueId() << ") from " << index_path;
     }
-    std::vector<cv::Mat> descriptors;
-    descriptors.push_back(all_signatures_);
-    lomdb->matcher_->add(descriptors);
-    lomdb->matcher_->train();
 
     lomdbs_[est_id] = lomdb;
 
-    VLOG(2) << "Initialized local recognition pipeline - Size of matcher object " << sizeof(*lomdb->matcher_)
-            << "bytes, size of flann models: " << sizeof(lomdb->flann_models_) << " bytes.";
+    VLOG(2) << "Initialized local recognition pipeline - Size of signatures: "
+            << lomdb->signatures_.total() * lomdb->signatures_.elemSize()
+            << " bytes, number of flann models: " << lomdb->flann_models_.size() << ".";
   }
 
   mergeKeypointsFromMultipleEstimators();
@@ -551,11 +628,27 @@ void LocalFeatureMatcher<PointT>::featureMatching(const std::vector<KeypointInde
                                                   size_t model_keypoint_offset) {
   CHECK(signatures.rows == (int)kp_indices.size());
 
-  cv::Mat indices;
-  cv::Mat distances;
   std::vector<std::vector<cv::DMatch>> matches;
-  lomdb->matcher_->knnMatch(signatures, matches, param_.knn_);
+  if (lomdb->flann_index_) {
+    cv::Mat indices;
+    cv::Mat distances;
+    lomdb->flann_index_->knnSearch(signatures, indices, distances, param_.knn_,
+                                   cv::flann::SearchParams(param_.kdtree_search_checks_, 0, true));
+    distances.convertTo(distances, CV_32F);  // Hamming distances are returned as integers
+
+    matches.resize(indices.rows);
+    for (int q = 0; q < indices.rows; q++) {
+      for (int k = 0; k < indices.cols; k++) {
+        const int train_idx = indices.at<int>(q, k);
+        if (train_idx >= 0)
+          matches[q].push_back(cv::DMatch(q, train_idx, distances.at<float>(q, k)));
+      }
+    }
+  } else
+    lomdb->matcher_->knnMatch(signatures, matches, param_.knn_);
 
+  // collect correspondences for each object model by its index and only resolve model ids afterwards
+  std::vector<pcl::Correspondences> model_corrs(lomdb->model_ids_.size());
   for (const auto &mm : matches) {
     for (const cv::DMatch &m : mm) {
       // if (m.distance > param_.max_descriptor_distance_){
@@ -563,30 +656,33 @@ void LocalFeatureMatcher<PointT>::featureMatching(const std::vector<KeypointInde
       //  continue;
       //}
 
-      const typename LocalObjectModelDatabase::flann_model &f = lomdb->flann_models_[m.trainIdx];
+      const uint32_t model_idx = lomdb->flann_models_.model_idx_[m.trainIdx];
       float m_dist = param_.correspondence_distance_weight_;  // * m.distance;
 
-      // typename std::map<std::string, LocalObjectModel::ConstPtr>::const_iterator it =
-      //    model_keypoints_.find(f.model_id_);
-      //            const LocalObjectModel &m_kps = *(it->second);
-
-      KeypointIndex m_idx = f.keypoint_id_ + model_keypoint_offset;
+      KeypointIndex m_idx = lomdb->flann_models_.keypoint_idx_[m.trainIdx] + model_keypoint_offset;
       KeypointIndex s_idx = kp_indices[m.queryIdx];
-      //            CHECK ( m_idx < m_kps.keypoints_->points.size() );
       //            CHECK ( kp_indices[idx] < scene_->points.size() );
 
-      typename std::map<std::string, LocalObjectHypothesis<PointT>>::iterator it_c = corrs_.find(f.model_id_);
-      if (it_c != corrs_.end()) {  // append correspondences to existing ones
-        pcl::CorrespondencesPtr &corrs = it_c->second.model_scene_corresp_;
-        corrs->push_back(pcl::Correspondence(m_idx, s_idx, m_dist));
-      } else  // create object hypothesis
-      {
-        LocalObjectHypothesis<PointT> new_loh;
-        new_loh.model_scene_corresp_.reset(new pcl::Correspondences);
-        new_loh.model_scene_corresp_->push_back(pcl::Correspondence(m_idx, s_idx, m_dist));
-        new_loh.model_id_ = f.model_id_;
-        corrs_[f.model_id_] = new_loh;
-      }
+      model_corrs[model_idx].push_back(pcl::Correspondence(m_idx, s_idx, m_dist));
+    }
+  }
+
+  for (size_t model_idx = 0; model_idx < model_corrs.size(); model_idx++) {
+    if (model_corrs[model_idx].empty())
+      continue;
+
+    const std::string &model_id = lomdb->model_ids_[model_idx];
+    typename std::map<std::string, LocalObjectHypothesis<PointT>>::iterator it_c = corrs_.find(model_id);
+    if (it_c != corrs_.end()) {  // append correspondences to existing ones
+      pcl::CorrespondencesPtr &corrs = it_c->second.model_scene_corresp_;
+      corrs->insert(corrs->end(), model_corrs[model_idx].begin(), model_corrs[model_idx].end());
+    } else  // create object hypothesis
+    {
+      LocalObjectHypothesis<PointT> new_loh;
+      new_loh.model_scene_corresp_.reset(new pcl::Correspondences);
+      new_loh.model_scene_corresp_->swap(model_corrs[model_idx]);
+      new_loh.model_id_ = model_id;
+      corrs_[model_id] = new_loh;
     }
   }
 }
@@ -675,6 +771,184 @@ void LocalFeatureMatcher<PointT>::recognize() {
   indices_.clear();
 }
 
+namespace {
+/**
+ * @brief header of a stored local object model database. It is followed by a table with the id and number of
+ * signatures of each object model, by the signatures and by the keypoints and keypoint normals (x,y,z,curvature) of
+ * all object models. All data blocks are stored in the order of the table and start at a 64 byte aligned offset.
+ */
+struct LocalObjectModelDatabaseHeader {
+  char magic_[8];
+  uint32_t version_;
+  uint32_t num_models_;
+  int32_t rows_;  ///< number of signatures
+  int32_t cols_;  ///< signature size
+  int32_t type_;  ///< OpenCV type of signatures
+  uint32_t model_table_size_;
+  uint64_t signatures_offset_;
+  uint64_t keypoints_offset_;
+  uint64_t kp_normals_offset_;
+  uint64_t file_size_;
+};
+
+const char LOMDB_MAGIC[8] = {'V', '4', 'R', 'L', 'O', 'M', 'D', 'B'};
+const uint32_t LOMDB_VERSION = 1;
+
+uint64_t alignOffset(uint64_t offset) {
+  return (offset + 63) & ~uint64_t(63);
+}
+}  // namespace
+
+bool LocalObjectModelDatabase::save(const bf::path &filename) const {
+  CHECK((int)flann_models_.size() == signatures_.rows);
+
+  // signatures of one object model are stored consecutively with increasing keypoint index and in the order of
+  // model_ids_
+  std::vector<std::pair<std::string, uint32_t>> model_table(model_ids_.size());
+  for (size_t model_idx = 0; model_idx < model_ids_.size(); model_idx++)
+    model_table[model_idx].first = model_ids_[model_idx];
+  for (size_t i = 0; i < flann_models_.size(); i++) {
+    const uint32_t model_idx = flann_models_.model_idx_[i];
+    CHECK(i == 0 || model_idx >= flann_models_.model_idx_[i - 1]);
+    CHECK(flann_models_.keypoint_idx_[i] == model_table[model_idx].second);
+    model_table[model_idx].second++;
+  }
+
+  LocalObjectModelDatabaseHeader header;
+  std::copy(LOMDB_MAGIC, LOMDB_MAGIC + 8, header.magic_);
+  header.version_ = LOMDB_VERSION;
+  header.num_models_ = model_table.size();
+  header.rows_ = signatures_.rows;
+  header.cols_ = signatures_.cols;
+  header.type_ = signatures_.type();
+  header.model_table_size_ = 0;
+  for (const auto &e : model_table)
+    header.model_table_size_ += 2 * sizeof(uint32_t) + e.first.size();
+  const uint64_t signatures_size = signatures_.total() * signatures_.elemSize();
+  const uint64_t num_signatures = signatures_.rows;
+  header.signatures_offset_ = alignOffset(sizeof(header) + header.model_table_size_);
+  header.keypoints_offset_ = alignOffset(header.signatures_offset_ + signatures_size);
+  header.kp_normals_offset_ = alignOffset(header.keypoints_offset_ + num_signatures * 3 * sizeof(float));
+  header.file_size_ = header.kp_normals_offset_ + num_signatures * 4 * sizeof(float);
+
+  std::vector<float> keypoints, kp_normals;
+  keypoints.reserve(num_signatures * 3);
+  kp_normals.reserve(num_signatures * 4);
+  for (const auto &e : model_table) {
+    const LocalObjectModel &lom = *l_obj_models_.at(e.first);
+    CHECK(lom.keypoints_->points.size() == e.second && lom.kp_normals_->points.size() == e.second);
+    for (size_t kp_id = 0; kp_id < e.second; kp_id++) {
+      const pcl::PointXYZ &p = lom.keypoints_->points[kp_id];
+      const pcl::Normal &n = lom.kp_normals_->points[kp_id];
+      keypoints.insert(keypoints.end(), {p.x, p.y, p.z});
+      kp_normals.insert(kp_normals.end(), {n.normal_x, n.normal_y, n.normal_z, n.curvature});
+    }
+  }
+
+  const bf::path tmp_filename = filename.string() + "." + bf::unique_path().string() + ".tmp";
+  io::createDirForFileIfNotExist(filename.string());
+  std::ofstream f(tmp_filename.string(), std::ofstream::binary);
+  if (!f.is_open())
+    return false;
+
+  const auto pad = [&f](uint64_t offset) {
+    while ((uint64_t)f.tellp() < offset)
+      f.put(0);
+  };
+  f.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  for (const auto &e : model_table) {
+    const uint32_t id_length = e.first.size();
+    f.write(reinterpret_cast<const char *>(&id_length), sizeof(id_length));
+    f.write(e.first.data(), id_length);
+    f.write(reinterpret_cast<const char *>(&e.second), sizeof(e.second));
+  }
+  pad(header.signatures_offset_);
+  for (int r = 0; r < signatures_.rows; r++)
+    f.write(signatures_.ptr<char>(r), signatures_.cols * signatures_.elemSize());
+  pad(header.keypoints_offset_);
+  f.write(reinterpret_cast<const char *>(keypoints.data()), keypoints.size() * sizeof(float));
+  pad(header.kp_normals_offset_);
+  f.write(reinterpret_cast<const char *>(kp_normals.data()), kp_normals.size() * sizeof(float));
+  f.close();
+
+  boost::system::error_code ec;
+  if (f)
+    bf::rename(tmp_filename, filename, ec);
+  if (!f || ec) {
+    bf::remove(tmp_filename, ec);
+    return false;
+  }
+  return true;
+}
+
+bool LocalObjectModelDatabase::load(const bf::path &filename) {
+  namespace bip = boost::interprocess;
+  std::shared_ptr<bip::mapped_region> region;
+  try {
+    bip::file_mapping file(filename.string().c_str(), bip::read_only);
+    region.reset(new bip::mapped_region(file, bip::read_only));
+  } catch (const bip::interprocess_exception &e) {
+    LOG(WARNING) << "Could not map local object model database " << filename << ": " << e.what();
+    return false;
+  }
+
+  const char *data = static_cast<const char *>(region->get_address());
+  const size_t size = region->get_size();
+  LocalObjectModelDatabaseHeader header;
+  if (size < sizeof(header))
+    return false;
+  std::copy(data, data + sizeof(header), reinterpret_cast<char *>(&header));
+  if (!std::equal(LOMDB_MAGIC, LOMDB_MAGIC + 8, header.magic_) || header.version_ != LOMDB_VERSION ||
+      header.file_size_ != size) {
+    LOG(WARNING) << "Local object model database " << filename << " has an unknown format.";
+    return false;
+  }
+
+  std::vector<std::pair<std::string, uint32_t>> model_table(header.num_models_);
+  const char *table = data + sizeof(header);
+  for (auto &e : model_table) {
+    uint32_t id_length;
+    std::copy(table, table + sizeof(id_length), reinterpret_cast<char *>(&id_length));
+    table += sizeof(id_length);
+    e.first.assign(table, id_length);
+    table += id_length;
+    std::copy(table, table + sizeof(e.second), reinterpret_cast<char *>(&e.second));
+    table += sizeof(e.second);
+  }
+
+  l_obj_models_.clear();
+  model_ids_.clear();
+  flann_models_ = flann_models();
+  flann_models_.reserve(header.rows_);
+  const float *keypoints = reinterpret_cast<const float *>(data + header.keypoints_offset_);
+  const float *kp_normals = reinterpret_cast<const float *>(data + header.kp_normals_offset_);
+  for (const auto &e : model_table) {
+    const uint32_t model_idx = model_ids_.size();
+    model_ids_.push_back(e.first);
+    LocalObjectModel::Ptr lom(new LocalObjectModel);
+    lom->keypoints_->points.resize(e.second);
+    lom->kp_normals_->points.resize(e.second);
+    for (size_t kp_id = 0; kp_id < e.second; kp_id++) {
+      lom->keypoints_->points[kp_id].getVector3fMap() = Eigen::Map<const Eigen::Vector3f>(keypoints);
+      lom->kp_normals_->points[kp_id].getNormalVector3fMap() = Eigen::Map<const Eigen::Vector3f>(kp_normals);
+      lom->kp_normals_->points[kp_id].curvature = kp_normals[3];
+      keypoints += 3;
+      kp_normals += 4;
+      flann_models_.push_back(model_idx, kp_id);
+    }
+    lom->keypoints_->width = lom->kp_normals_->width = e.second;
+    lom->keypoints_->height = lom->kp_normals_->height = 1;
+    l_obj_models_[e.first] = lom;
+  }
+  CHECK((int)flann_models_.size() == header.rows_);
+
+  // read-only mapping, the matrix must not be modified
+  signatures_ = cv::Mat(header.rows_, header.cols_, header.type_,
+                        const_cast<char *>(data + header.signatures_offset_));
+  mapped_file_ = region;
+  return true;
+}
+
 void LocalRecognizerParameter::init(boost::program_options::options_description &desc,
                                     const std::string &section_name) {
   desc.add_options()((section_name + ".kdtree_splits").c_str(),
@@ -3,8 +3,11 @@
 #include <v4r/recognition/local_recognition_pipeline.h>
 
 #include <pcl/common/time.h>
+#include <pcl/recognition/cg/geometric_consistency.h>
 #include <pcl/registration/transformation_estimation_svd.h>
 
+#include <numeric>
+
 namespace v4r {
 
 template <typename PointT>
@@ -47,152 +50,202 @@ void LocalRecognitionPipeline<PointT>::doInit(const bf::path &trained_dir, bool
 }
 
 template <typename PointT>
-void LocalRecognitionPipeline<PointT>::correspondenceGrouping(const std::vector<std::string> &model_ids_to_search) {
-  pcl::PointCloud<pcl::PointXYZ>::Ptr scene_cloud_xyz(new pcl::PointCloud<pcl::PointXYZ>);
-  pcl::copyPointCloud(*scene_, *scene_cloud_xyz);
+std::shared_ptr<pcl::CorrespondenceGrouping<pcl::PointXYZ, pcl::PointXYZ>>
+LocalRecognitionPipeline<PointT>::cloneCGAlgorithm() const {
+  typedef GraphGeometricConsistencyGrouping<pcl::PointXYZ, pcl::PointXYZ> GraphGC;
+  typedef pcl::GeometricConsistencyGrouping<pcl::PointXYZ, pcl::PointXYZ> GC;
+
+  if (const GraphGC *gcg_algorithm = dynamic_cast<const GraphGC *>(cg_algorithm_.get()))
+    return std::make_shared<GraphGC>(gcg_algorithm->param_);
+
+  if (const GC *gc_algorithm = dynamic_cast<const GC *>(cg_algorithm_.get())) {
+    std::shared_ptr<GC> copy(new GC);
+    copy->setGCSize(gc_algorithm->getGCSize());
+    copy->setGCThreshold(gc_algorithm->getGCThreshold());
+    return copy;
+  }
 
-  //#pragma omp parallel for schedule(dynamic)
-  typename std::map<std::string, LocalObjectHypothesis<PointT>>::const_iterator it;
-  for (it = local_obj_hypotheses_.begin(); it != local_obj_hypotheses_.end(); ++it) {
-    const std::string &model_id = it->first;
+  return std::shared_ptr<pcl::CorrespondenceGrouping<pcl::PointXYZ, pcl::PointXYZ>>();
+}
 
-    if (!model_ids_to_search.empty() &&
-        std::find(model_ids_to_search.begin(), model_ids_to_search.end(), model_id) == model_ids_to_search.end()) {
-      continue;
-    }
+template <typename PointT>
+void LocalRecognitionPipeline<PointT>::groupCorrespondences(
+    const std::string &model_id, const LocalObjectHypothesis<PointT> &loh,
+    pcl::CorrespondenceGrouping<pcl::PointXYZ, pcl::PointXYZ> &cg_algorithm,
+    const pcl::PointCloud<pcl::PointXYZ>::Ptr &scene_cloud_xyz, std::vector<ObjectHypothesesGroup> &ohgs) const {
+  pcl::StopWatch t;
+
+  const LocalObjectModel &lom = *model_keypoints_.at(model_id);
+  pcl::PointCloud<pcl::PointXYZ>::Ptr model_keypoints = lom.keypoints_;
+  pcl::PointCloud<pcl::Normal>::Ptr model_kp_normals = lom.kp_normals_;
+
+  std::sort(loh.model_scene_corresp_->begin(), loh.model_scene_corresp_->end(),
+            LocalObjectHypothesis<PointT>::gcGraphCorrespSorter);
+  std::vector<pcl::Correspondences> corresp_clusters;
+  cg_algorithm.setSceneCloud(scene_cloud_xyz);
+  cg_algorithm.setInputCloud(model_keypoints);
+
+  //        oh.visualize(*scene_, *scene_keypoints_);
+
+  // Graph-based correspondence grouping requires normals but interface does not exist in base class - so need to try
+  // pointer casting
+  GraphGeometricConsistencyGrouping<pcl::PointXYZ, pcl::PointXYZ> *gcg_algorithm =
+      dynamic_cast<GraphGeometricConsistencyGrouping<pcl::PointXYZ, pcl::PointXYZ> *>(&cg_algorithm);
+  if (gcg_algorithm)
+    gcg_algorithm->setInputAndSceneNormals(model_kp_normals, scene_normals_);
+
+  //        for ( const auto c : *(loh.model_scene_corresp_) )
+  //        {
+  //            CHECK( c.index_match < (int) scene_cloud_xyz->points.size() && c.index_match >= 0 );
+  //            CHECK( c.index_match < (int) scene_normals_->points.size() && c.index_match >= 0 );
+  //            CHECK( c.index_query < (int) model_keypoints->points.size() && c.index_query >= 0 );
+  //            CHECK( c.index_query < (int) model_kp_normals->points.size() && c.index_query >= 0 );
+  //        }
+
+  // we need to pass the keypoints_pointcloud and the specific object hypothesis
+  cg_algorithm.setModelSceneCorrespondences(loh.model_scene_corresp_);
+  cg_algorithm.cluster(corresp_clusters);
+
+  // sort correspondences by their cluster size
+  std::sort(corresp_clusters.begin(), corresp_clusters.end(),
+            [](const pcl::Correspondences &a, const pcl::Correspondences &b) { return a.size() > b.size(); });
+
+  size_t num_clusters = corresp_clusters.size();
+  if (param_.max_num_hypotheses_per_object_ > 0) {
+    num_clusters = std::min(corresp_clusters.size(), param_.max_num_hypotheses_per_object_);
+  }
 
-    const LocalObjectHypothesis<PointT> &loh = it->second;
+  std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f>> new_transforms(num_clusters);
+  typename pcl::registration::TransformationEstimationSVD<pcl::PointXYZ, pcl::PointXYZ> t_est;
 
-    pcl::StopWatch t;
+  for (size_t cluster_id = 0; cluster_id < num_clusters; cluster_id++)
+    t_est.estimateRigidTransformation(*model_keypoints, *scene_cloud_xyz, corresp_clusters[cluster_id],
+                                      new_transforms[cluster_id]);
 
-    pcl::PointCloud<pcl::PointXYZ>::Ptr model_keypoints = model_keypoints_[model_id]->keypoints_;
-    pcl::PointCloud<pcl::Normal>::Ptr model_kp_normals = model_keypoints_[model_id]->kp_normals_;
+  if (param_.merge_close_hypotheses_) {
+    std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f>> merged_transforms(num_clusters);
+    std::vector<bool> cluster_has_been_taken(num_clusters, false);
+    const double angle_thresh_rad = param_.merge_close_hypotheses_angle_ * M_PI / 180.f;
 
-    if (loh.model_scene_corresp_->size() < 3)
-      continue;
+    size_t kept = 0;
+    for (size_t tf_id = 0; tf_id < new_transforms.size(); tf_id++) {
+      if (cluster_has_been_taken[tf_id])
+        continue;
 
-    std::sort(loh.model_scene_corresp_->begin(), loh.model_scene_corresp_->end(),
-              LocalObjectHypothesis<PointT>::gcGraphCorrespSorter);
-    std::vector<pcl::Correspondences> corresp_clusters;
-    cg_algorithm_->setSceneCloud(scene_cloud_xyz);
-    cg_algorithm_->setInputCloud(model_keypoints);
-
-    //        oh.visualize(*scene_, *scene_keypoints_);
-
-    // Graph-based correspondence grouping requires normals but interface does not exist in base class - so need to try
-    // pointer casting
-    typename GraphGeometricConsistencyGrouping<pcl::PointXYZ, pcl::PointXYZ>::Ptr gcg_algorithm =
-        std::dynamic_pointer_cast<GraphGeometricConsistencyGrouping<pcl::PointXYZ, pcl::PointXYZ>>(cg_algorithm_);
-    if (gcg_algorithm)
-      gcg_algorithm->setInputAndSceneNormals(model_kp_normals, scene_normals_);
-
-    //        for ( const auto c : *(loh.model_scene_corresp_) )
-    //        {
-    //            CHECK( c.index_match < (int) scene_cloud_xyz->points.size() && c.index_match >= 0 );
-    //            CHECK( c.index_match < (int) scene_normals_->points.size() && c.index_match >= 0 );
-    //            CHECK( c.index_query < (int) model_keypoints->points.size() && c.index_query >= 0 );
-    //            CHECK( c.index_query < (int) model_kp_normals->points.size() && c.index_query >= 0 );
-    //        }
-
-    // we need to pass the keypoints_pointcloud and the specific object hypothesis
-    cg_algorithm_->setModelSceneCorrespondences(loh.model_scene_corresp_);
-    cg_algorithm_->cluster(corresp_clusters);
-
-    // sort correspondences by their cluster size
-    std::sort(corresp_clusters.begin(), corresp_clusters.end(),
-              [](const pcl::Correspondences &a, const pcl::Correspondences &b) { return a.size() > b.size(); });
-
-    size_t num_clusters = corresp_clusters.size();
-    if (param_.max_num_hypotheses_per_object_ > 0) {
-      num_clusters = std::min(corresp_clusters.size(), param_.max_num_hypotheses_per_object_);
-    }
+      cluster_has_been_taken[tf_id] = true;
+      const Eigen::Vector3f centroid1 = new_transforms[tf_id].block<3, 1>(0, 3);
+      const Eigen::Matrix3f rot1 = new_transforms[tf_id].block<3, 3>(0, 0);
 
-    std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f>> new_transforms(num_clusters);
-    typename pcl::registration::TransformationEstimationSVD<pcl::PointXYZ, pcl::PointXYZ> t_est;
+      pcl::Correspondences merged_corrs = corresp_clusters[tf_id];
 
-    for (size_t cluster_id = 0; cluster_id < num_clusters; cluster_id++)
-      t_est.estimateRigidTransformation(*model_keypoints, *scene_cloud_xyz, corresp_clusters[cluster_id],
-                                        new_transforms[cluster_id]);
+      for (size_t j = tf_id + 1; j < new_transforms.size(); j++) {
+        const Eigen::Vector3f centroid2 = new_transforms[j].block<3, 1>(0, 3);
+        const Eigen::Matrix3f rot2 = new_transforms[j].block<3, 3>(0, 0);
+        const Eigen::Matrix3f rot_diff = rot2 * rot1.transpose();
 
-    if (param_.merge_close_hypotheses_) {
-      std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f>> merged_transforms(num_clusters);
-      std::vector<bool> cluster_has_been_taken(num_clusters, false);
-      const double angle_thresh_rad = param_.merge_close_hypotheses_angle_ * M_PI / 180.f;
+        double rotx = std::abs(atan2(rot_diff(2, 1), rot_diff(2, 2)));
+        double roty =
+            std::abs(atan2(-rot_diff(2, 0), sqrt(rot_diff(2, 1) * rot_diff(2, 1) + rot_diff(2, 2) * rot_diff(2, 2))));
+        double rotz = std::abs(atan2(rot_diff(1, 0), rot_diff(0, 0)));
+        double dist = (centroid1 - centroid2).norm();
 
-      size_t kept = 0;
-      for (size_t tf_id = 0; tf_id < new_transforms.size(); tf_id++) {
-        if (cluster_has_been_taken[tf_id])
-          continue;
+        if ((dist < param_.merge_close_hypotheses_dist_) && (rotx < angle_thresh_rad) && (roty < angle_thresh_rad) &&
+            (rotz < angle_thresh_rad)) {
+          merged_corrs.insert(merged_corrs.end(), corresp_clusters[j].begin(), corresp_clusters[j].end());
+          cluster_has_been_taken[j] = true;
+        }
+      }
 
-        cluster_has_been_taken[tf_id] = true;
-        const Eigen::Vector3f centroid1 = new_transforms[tf_id].block<3, 1>(0, 3);
-        const Eigen::Matrix3f rot1 = new_transforms[tf_id].block<3, 3>(0, 0);
+      t_est.estimateRigidTransformation(*model_keypoints, *scene_cloud_xyz, merged_corrs, merged_transforms[kept]);
+      kept++;
+    }
+    merged_transforms.resize(kept);
+
+    for (size_t jj = 0; jj < merged_transforms.size(); jj++) {
+      ObjectHypothesis::Ptr new_oh(new ObjectHypothesis);
+      new_oh->model_id_ = model_id;
+      new_oh->class_id_ = "";
+      new_oh->transform_ = merged_transforms[jj];
+      new_oh->confidence_ = corresp_clusters[jj].size();
+      new_oh->corr_ = corresp_clusters[jj];
+
+      ObjectHypothesesGroup new_ohg;
+      new_ohg.global_hypotheses_ = false;
+      new_ohg.ohs_.push_back(new_oh);
+      ohgs.push_back(new_ohg);
+    }
+    LOG(INFO) << "Merged " << num_clusters << " clusters into " << kept
+              << " clusters. Total correspondences: " << loh.model_scene_corresp_->size() << " " << loh.model_id_;
+  } else {
+    for (size_t jj = 0; jj < new_transforms.size(); jj++) {
+      ObjectHypothesis::Ptr new_oh(new ObjectHypothesis);
+      new_oh->model_id_ = model_id;
+      new_oh->class_id_ = "";
+      new_oh->transform_ = new_transforms[jj];
+      new_oh->confidence_ = corresp_clusters[jj].size();
+      new_oh->corr_ = corresp_clusters[jj];
+
+      ObjectHypothesesGroup new_ohg;
+      new_ohg.global_hypotheses_ = false;
+      new_ohg.ohs_.push_back(new_oh);
+      ohgs.push_back(new_ohg);
+    }
+  }
 
-        pcl::Correspondences merged_corrs = corresp_clusters[tf_id];
+  VLOG(1) << "Correspondence grouping for " << model_id << " ( " << loh.model_scene_corresp_->size() << ") took "
+          << t.getTime() << " ms.";
+}
 
-        for (size_t j = tf_id + 1; j < new_transforms.size(); j++) {
-          const Eigen::Vector3f centroid2 = new_transforms[j].block<3, 1>(0, 3);
-          const Eigen::Matrix3f rot2 = new_transforms[j].block<3, 3>(0, 0);
-          const Eigen::Matrix3f rot_diff = rot2 * rot1.transpose();
+template <typename PointT>
+void LocalRecognitionPipeline<PointT>::correspondenceGrouping(const std::vector<std::string> &model_ids_to_search) {
+  pcl::PointCloud<pcl::PointXYZ>::Ptr scene_cloud_xyz(new pcl::PointCloud<pcl::PointXYZ>);
+  pcl::copyPointCloud(*scene_, *scene_cloud_xyz);
 
-          double rotx = std::abs(atan2(rot_diff(2, 1), rot_diff(2, 2)));
-          double roty =
-              std::abs(atan2(-rot_diff(2, 0), sqrt(rot_diff(2, 1) * rot_diff(2, 1) + rot_diff(2, 2) * rot_diff(2, 2))));
-          double rotz = std::abs(atan2(rot_diff(1, 0), rot_diff(0, 0)));
-          double dist = (centroid1 - centroid2).norm();
+  // flatten the models to be processed into a work list
+  std::vector<std::pair<std::string, const LocalObjectHypothesis<PointT> *>> models;
+  for (const auto &it : local_obj_hypotheses_) {
+    const std::string &model_id = it.first;
 
-          if ((dist < param_.merge_close_hypotheses_dist_) && (rotx < angle_thresh_rad) && (roty < angle_thresh_rad) &&
-              (rotz < angle_thresh_rad)) {
-            merged_corrs.insert(merged_corrs.end(), corresp_clusters[j].begin(), corresp_clusters[j].end());
-            cluster_has_been_taken[j] = true;
-          }
-        }
+    if (!model_ids_to_search.empty() &&
+        std::find(model_ids_to_search.begin(), model_ids_to_search.end(), model_id) == model_ids_to_search.end()) {
+      continue;
+    }
 
-        t_est.estimateRigidTransformation(*model_keypoints, *scene_cloud_xyz, merged_corrs, merged_transforms[kept]);
-        kept++;
-      }
-      merged_transforms.resize(kept);
+    if (it.second.model_scene_corresp_->size() < 3)
+      continue;
 
-#pragma omp critical
-      {
-        for (size_t jj = 0; jj < merged_transforms.size(); jj++) {
-          ObjectHypothesis::Ptr new_oh(new ObjectHypothesis);
-          new_oh->model_id_ = model_id;
-          new_oh->class_id_ = "";
-          new_oh->transform_ = merged_transforms[jj];
-          new_oh->confidence_ = corresp_clusters[jj].size();
-          new_oh->corr_ = corresp_clusters[jj];
-
-          ObjectHypothesesGroup new_ohg;
-          new_ohg.global_hypotheses_ = false;
-          new_ohg.ohs_.push_back(new_oh);
-          obj_hypotheses_.push_back(new_ohg);
-        }
-        LOG(INFO) << "Merged " << num_clusters << " clusters into " << kept
-                  << " clusters. Total correspondences: " << loh.model_scene_corresp_->size() << " " << loh.model_id_;
-      }
-    } else {
-#pragma omp critical
-      {
-        for (size_t jj = 0; jj < new_transforms.size(); jj++) {
-          ObjectHypothesis::Ptr new_oh(new ObjectHypothesis);
-          new_oh->model_id_ = model_id;
-          new_oh->class_id_ = "";
-          new_oh->transform_ = new_transforms[jj];
-          new_oh->confidence_ = corresp_clusters[jj].size();
-          new_oh->corr_ = corresp_clusters[jj];
-
-          ObjectHypothesesGroup new_ohg;
-          new_ohg.global_hypotheses_ = false;
-          new_ohg.ohs_.push_back(new_oh);
-          obj_hypotheses_.push_back(new_ohg);
-        }
-      }
-    }
+    models.push_back(std::make_pair(model_id, &it.second));
+  }
 
-    VLOG(1) << "Correspondence grouping for " << model_id << " ( " << loh.model_scene_corresp_->size() << ") took "
-            << t.getTime() << " ms.";
+  // process models with most correspondences first for better load balancing
+  std::vector<size_t> work_order(models.size());
+  std::iota(work_order.begin(), work_order.end(), 0);
+  std::stable_sort(work_order.begin(), work_order.end(), [&models](size_t a, size_t b) {
+    return models[a].second->model_scene_corresp_->size() > models[b].second->model_scene_corresp_->size();
+  });
+
+  // each thread needs its own instance of the correspondence grouping algorithm
+  typedef pcl::CorrespondenceGrouping<pcl::PointXYZ, pcl::PointXYZ> CorrespondenceGroupingT;
+  std::vector<std::shared_ptr<CorrespondenceGroupingT>> cg_algorithms(1, cg_algorithm_);
+  for (int i = 1; i < omp_get_max_threads() && models.size() > 1; i++) {
+    const std::shared_ptr<CorrespondenceGroupingT> copy = cloneCGAlgorithm();
+    if (!copy)
+      break;
+    cg_algorithms.push_back(copy);
   }
+
+  // hypotheses are collected for each model separately and merged in the order of the model ids to keep the result
+  // independent of the number of threads
+  std::vector<std::vector<ObjectHypothesesGroup>> ohgs_per_model(models.size());
+#pragma omp parallel for schedule(dynamic) num_threads(cg_algorithms.size())
+  for (size_t i = 0; i < work_order.size(); i++) {
+    const size_t m = work_order[i];
+    groupCorrespondences(models[m].first, *models[m].second, *cg_algorithms[omp_get_thread_num()], scene_cloud_xyz,
+                         ohgs_per_model[m]);
+  }
+
+  for (const std::vector<ObjectHypothesesGroup> &ohgs : ohgs_per_model)
+    obj_hypotheses_.insert(obj_hypotheses_.end(), ohgs.begin(), ohgs.end());
 }
 
 template <typename PointT>
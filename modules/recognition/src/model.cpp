@@ -1,3 +1,4 @@
+#include <glog/logging.h>
 #include <v4r/common/miscellaneous.h>
 #include <v4r/io/eigen.h>
 #include <v4r/io/filesystem.h>
@@ -8,29 +9,110 @@
 #include <pcl/features/integral_image_normal.h>
 #include <pcl/io/pcd_io.h>
 
+#include <functional>
+
 namespace v4r {
 
+namespace {
+/**
+ * @brief looks up a key in a cache whose values are computed once. If the key is not present, the calling thread
+ * computes the value while other threads requesting the same key wait for it. Different keys are computed
+ * concurrently.
+ */
+template <typename T>
+T getOrCompute(std::mutex &mutex, std::map<int, std::shared_future<T>> &cache, int key,
+               const std::function<T()> &compute) {
+  std::promise<T> promise;
+  std::shared_future<T> future;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto it = cache.find(key);
+    if (it != cache.end())
+      future = it->second;
+    else
+      cache[key] = promise.get_future().share();
+  }
+
+  if (future.valid())
+    return future.get();
+
+  try {
+    const T value = compute();
+    promise.set_value(value);
+    return value;
+  } catch (...) {
+    promise.set_exception(std::current_exception());
+    throw;
+  }
+}
+
+/**
+ * @brief loads a stored voxelized cloud if it exists and is not older than the model it was computed from
+ */
+template <typename CloudT>
+bool loadLOD(const bf::path &filename, const bf::path &model_filename, CloudT &cloud) {
+  if (filename.empty() || !io::existsFile(filename))
+    return false;
+
+  if (io::existsFile(model_filename) && bf::last_write_time(filename) < bf::last_write_time(model_filename))
+    return false;
+
+  return pcl::io::loadPCDFile(filename.string(), cloud) != -1;
+}
+
+/**
+ * @brief stores a voxelized cloud. The cloud is written to a temporary file first and then renamed, so concurrent
+ * processes never read a partially written file.
+ */
+template <typename CloudT>
+void saveLOD(const bf::path &filename, const CloudT &cloud) {
+  if (filename.empty())
+    return;
+
+  boost::system::error_code ec;
+  bf::create_directories(filename.parent_path(), ec);
+  const bf::path tmp_filename = filename.string() + "." + bf::unique_path().string() + ".tmp";
+  if (ec || pcl::io::savePCDFileBinary(tmp_filename.string(), cloud) != 0) {
+    LOG(WARNING) << "Could not store voxelized model to " << filename;
+    return;
+  }
+  bf::rename(tmp_filename, filename, ec);
+  if (ec) {
+    LOG(WARNING) << "Could not store voxelized model to " << filename << ": " << ec.message();
+    bf::remove(tmp_filename, ec);
+  }
+}
+}  // namespace
+
+template <typename PointT>
+bf::path Model<PointT>::getLODCacheFilename(const std::string &name, int resolution_mm) const {
+  if (lod_cache_dir_.empty())
+    return bf::path();
+
+  return lod_cache_dir_ / (name + "_" + std::to_string(resolution_mm) + "mm.pcd");
+}
+
 template <typename PointT>
 typename pcl::PointCloud<PointT>::ConstPtr Model<PointT>::getAssembled(int resolution_mm) const {
   if (resolution_mm <= 0)
     return assembled_;
 
-  const auto it = voxelized_assembled_.find(resolution_mm);
-  if (it == voxelized_assembled_.end()) {
-    double resolution = (double)resolution_mm / 1000.;
+  return getOrCompute<PointTPtrConst>(lod_mutex_, voxelized_assembled_, resolution_mm, [this, resolution_mm]() {
+    const bf::path lod_filename = getLODCacheFilename("assembled", resolution_mm);
     PointTPtr voxelized(new pcl::PointCloud<PointT>);
+    if (loadLOD(lod_filename, model_filename_, *voxelized))
+      return PointTPtrConst(voxelized);
+
+    double resolution = (double)resolution_mm / 1000.;
     pcl::VoxelGrid<PointT> grid;
     grid.setInputCloud(assembled_);
     grid.setLeafSize(resolution, resolution, resolution);
     grid.setDownsampleAllData(true);
     grid.filter(*voxelized);
 
-    PointTPtrConst voxelized_const(new pcl::PointCloud<PointT>(*voxelized));
-    voxelized_assembled_[resolution_mm] = voxelized_const;
-    return voxelized_const;
-  }
-
-  return it->second;
+    saveLOD(lod_filename, *voxelized);
+    return PointTPtrConst(voxelized);
+  });
 }
 
 template <typename PointT>
@@ -38,39 +120,42 @@ pcl::PointCloud<pcl::Normal>::ConstPtr Model<PointT>::getNormalsAssembled(int re
   if (resolution_mm <= 0)
     return normals_assembled_;
 
-  const auto it = normals_voxelized_assembled_.find(resolution_mm);
-  if (it == normals_voxelized_assembled_.end()) {
-    double resolution = resolution_mm / 1000.f;
-    pcl::PointCloud<pcl::PointNormal>::Ptr voxelized(new pcl::PointCloud<pcl::PointNormal>);
-    pcl::PointCloud<pcl::PointNormal>::Ptr assembled_with_normals(new pcl::PointCloud<pcl::PointNormal>);
-    assembled_with_normals->points.resize(assembled_->points.size());
-    assembled_with_normals->width = assembled_->width;
-    assembled_with_normals->height = assembled_->height;
-
-    for (size_t i = 0; i < assembled_->points.size(); i++) {
-      assembled_with_normals->points[i].getVector4fMap() = assembled_->points[i].getVector4fMap();
-      assembled_with_normals->points[i].getNormalVector4fMap() = normals_assembled_->points[i].getNormalVector4fMap();
-    }
-
-    pcl::VoxelGrid<pcl::PointNormal> grid;
-    grid.setInputCloud(assembled_with_normals);
-    grid.setLeafSize(resolution, resolution, resolution);
-    grid.setDownsampleAllData(true);
-    grid.filter(*voxelized);
+  return getOrCompute<pcl::PointCloud<pcl::Normal>::ConstPtr>(
+      lod_mutex_, normals_voxelized_assembled_, resolution_mm, [this, resolution_mm]() {
+        const bf::path lod_filename = getLODCacheFilename("normals", resolution_mm);
+        pcl::PointCloud<pcl::Normal>::Ptr voxelized_const(new pcl::PointCloud<pcl::Normal>());
+        if (loadLOD(lod_filename, model_filename_, *voxelized_const))
+          return pcl::PointCloud<pcl::Normal>::ConstPtr(voxelized_const);
+
+        double resolution = resolution_mm / 1000.f;
+        pcl::PointCloud<pcl::PointNormal>::Ptr voxelized(new pcl::PointCloud<pcl::PointNormal>);
+        pcl::PointCloud<pcl::PointNormal>::Ptr assembled_with_normals(new pcl::PointCloud<pcl::PointNormal>);
+        assembled_with_normals->points.resize(assembled_->points.size());
+        assembled_with_normals->width = assembled_->width;
+        assembled_with_normals->height = assembled_->height;
+
+        for (size_t i = 0; i < assembled_->points.size(); i++) {
+          assembled_with_normals->points[i].getVector4fMap() = assembled_->points[i].getVector4fMap();
+          assembled_with_normals->points[i].getNormalVector4fMap() =
+              normals_assembled_->points[i].getNormalVector4fMap();
+        }
 
-    pcl::PointCloud<pcl::Normal>::Ptr voxelized_const(new pcl::PointCloud<pcl::Normal>());
-    voxelized_const->points.resize(voxelized->points.size());
-    voxelized_const->width = voxelized->width;
-    voxelized_const->height = voxelized->height;
+        pcl::VoxelGrid<pcl::PointNormal> grid;
+        grid.setInputCloud(assembled_with_normals);
+        grid.setLeafSize(resolution, resolution, resolution);
+        grid.setDownsampleAllData(true);
+        grid.filter(*voxelized);
 
-    for (size_t i = 0; i < voxelized_const->points.size(); i++)
-      voxelized_const->points[i].getNormalVector4fMap() = voxelized->points[i].getNormalVector4fMap();
+        voxelized_const->points.resize(voxelized->points.size());
+        voxelized_const->width = voxelized->width;
+        voxelized_const->height = voxelized->height;
 
-    normals_voxelized_assembled_[resolution_mm] = voxelized_const;
-    return voxelized_const;
-  }
+        for (size_t i = 0; i < voxelized_const->points.size(); i++)
+          voxelized_const->points[i].getNormalVector4fMap() = voxelized->points[i].getNormalVector4fMap();
 
-  return it->second;
+        saveLOD(lod_filename, *voxelized_const);
+        return pcl::PointCloud<pcl::Normal>::ConstPtr(voxelized_const);
+      });
 }
 
 template <typename PointT>
@@ -97,6 +182,7 @@ pcl::PointCloud<pcl::PointXYZL>::Ptr Model<PointT>::getAssembledSmoothFaces(int
 
 template <typename PointT>
 void Model<PointT>::initialize(const bf::path &model_filename) {
+  model_filename_ = model_filename;
   typename pcl::PointCloud<PointTWithNormal>::Ptr all_assembled(new pcl::PointCloud<PointTWithNormal>);
   if (!io::existsFile(model_filename) || pcl::io::loadPCDFile(model_filename.string(), *all_assembled) == -1) {
     pcl::ScopeTime t("Creating 3D model");
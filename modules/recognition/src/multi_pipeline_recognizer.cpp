@@ -1,5 +1,8 @@
 #include <glog/logging.h>
-#include <omp.h>
+#include <pcl/common/time.h>
+#include <exception>
+#include <sstream>
+#include <thread>
 
 #include <v4r/recognition/multi_pipeline_recognizer.h>
 
@@ -18,31 +21,61 @@ void MultiRecognitionPipeline<PointT>::doInit(const bf::path &trained_dir, bool
 
 template <typename PointT>
 void MultiRecognitionPipeline<PointT>::do_recognize(const std::vector<std::string> &model_ids_to_search) {
-  omp_init_lock(&rec_lock_);
+  const size_t num_pipelines = recognition_pipelines_.size();
+  std::vector<std::vector<ObjectHypothesesGroup>> obj_hypotheses_per_pipeline(num_pipelines);
+  std::vector<std::vector<std::pair<std::string, float>>> elapsed_times_per_pipeline(num_pipelines);
+  std::vector<float> wall_time_per_pipeline(num_pipelines, 0.f);
+  std::vector<std::exception_ptr> exception_per_pipeline(num_pipelines);
 
-  //#pragma omp parallel for schedule(dynamic)
-  for (size_t r_id = 0; r_id < recognition_pipelines_.size(); r_id++) {
-    typename RecognitionPipeline<PointT>::Ptr r = recognition_pipelines_[r_id];
-    r->setInputCloud(scene_);
-    r->setSceneNormals(scene_normals_);
+  const auto run_pipeline = [&](size_t r_id) {
+    try {
+      pcl::StopWatch t;
+      typename RecognitionPipeline<PointT>::Ptr r = recognition_pipelines_[r_id];
+      r->setInputCloud(scene_);
+      r->setSceneNormals(scene_normals_);
 
-    if (table_plane_set_)
-      r->setTablePlane(table_plane_);
+      if (table_plane_set_)
+        r->setTablePlane(table_plane_);
 
-    r->recognize(model_ids_to_search);
+      r->recognize(model_ids_to_search);
 
-    std::vector<ObjectHypothesesGroup> oh_tmp = r->getObjectHypothesis();
-    omp_set_lock(&rec_lock_);
-    obj_hypotheses_.insert(obj_hypotheses_.end(), oh_tmp.begin(), oh_tmp.end());
-    omp_unset_lock(&rec_lock_);
+      obj_hypotheses_per_pipeline[r_id] = r->getObjectHypothesis();
+      elapsed_times_per_pipeline[r_id] = r->getElapsedTimes();
+      wall_time_per_pipeline[r_id] = static_cast<float>(t.getTime());
+    } catch (...) {
+      exception_per_pipeline[r_id] = std::current_exception();
+    }
+  };
 
-    std::vector<std::pair<std::string, float>> elapsed_times_tmp = r->getElapsedTimes();
-    elapsed_time_.insert(elapsed_time_.end(), elapsed_times_tmp.begin(), elapsed_times_tmp.end());
+  // Each pipeline runs in its own thread (the first one in the calling thread). Threads are used instead of an OpenMP
+  // parallel loop so that the OpenMP regions inside the pipelines still get a full team of threads.
+  std::vector<std::thread> threads;
+  for (size_t r_id = 1; r_id < num_pipelines; r_id++)
+    threads.emplace_back(run_pipeline, r_id);
+  if (num_pipelines)
+    run_pipeline(0);
+  for (std::thread &thread : threads)
+    thread.join();
+
+  table_plane_set_ = false;
+
+  for (const std::exception_ptr &e : exception_per_pipeline) {
+    if (e)
+      std::rethrow_exception(e);
   }
 
-  omp_destroy_lock(&rec_lock_);
+  // merge results in the order in which the pipelines were added
+  for (size_t r_id = 0; r_id < num_pipelines; r_id++) {
+    obj_hypotheses_.insert(obj_hypotheses_.end(), obj_hypotheses_per_pipeline[r_id].begin(),
+                           obj_hypotheses_per_pipeline[r_id].end());
 
-  table_plane_set_ = false;
+    std::stringstream desc;
+    desc << "Recognition pipeline " << r_id;
+    VLOG(1) << desc.str() << " took " << wall_time_per_pipeline[r_id] << " ms.";
+    elapsed_time_.push_back(std::pair<std::string, float>(desc.str(), wall_time_per_pipeline[r_id]));
+    elapsed_time_.insert(elapsed_time_.end(), elapsed_times_per_pipeline[r_id].begin(),
+                         elapsed_times_per_pipeline[r_id].end());
+  }
 }
 
 template class V4R_EXPORTS MultiRecognitionPipeline<pcl::PointXYZRGB>;
@@ -28,6 +28,8 @@ void MultiviewRecognizer<PointT>::do_recognize(const std::vector<std::string> &m
 
   recognition_pipeline_->recognize(model_ids_to_search);
   v.obj_hypotheses_ = recognition_pipeline_->getObjectHypothesis();
+  const std::vector<std::pair<std::string, float>> elapsed_times_tmp = recognition_pipeline_->getElapsedTimes();
+  elapsed_time_.insert(elapsed_time_.end(), elapsed_times_tmp.begin(), elapsed_times_tmp.end());
 
   table_plane_set_ = false;
 
@@ -500,7 +502,7 @@ void MultiviewRecognizer<PointT>::correspondenceGrouping(const std::vector<std::
 
     std::stringstream desc;
     desc << "Correspondence grouping for " << model_id << " ( " << loh.model_scene_corresp_->size() << ")";
-    typename RecognitionPipeline<PointT>::StopWatch t(desc.str());
+    typename RecognitionPipeline<PointT>::StopWatch t(desc.str(), elapsed_time_);
 
     pcl::PointCloud<pcl::PointXYZ>::Ptr model_keypoints = model_keypoints_[model_id]->keypoints_;
     pcl::PointCloud<pcl::Normal>::Ptr model_kp_normals = model_keypoints_[model_id]->kp_normals_;
@@ -1,5 +1,64 @@
+#include <glog/logging.h>
 #include <v4r/recognition/object_hypothesis.h>
+#include <bitset>
 
 namespace v4r {
-size_t ObjectHypothesis::s_counter_ = 0;
+namespace {
+/// number of set bits in a 64-bit word (compiles to a single instruction where the target supports it)
+inline size_t popcount(uint64_t x) {
+#ifdef __GNUC__
+  return __builtin_popcountll(x);
+#else
+  return std::bitset<64>(x).count();
+#endif
 }
+}  // namespace
+
+std::atomic<size_t> ObjectHypothesis::s_counter_(0);
+
+PackedImageMask::PackedImageMask(const boost::dynamic_bitset<> &mask, size_t width)
+: width_(width), height_(width ? mask.size() / width : 0), words_per_row_((width + 63) / 64), row_begin_(0),
+  row_end_(0), word_begin_(0), word_end_(0), count_(0) {
+  CHECK(width_ * height_ == mask.size()) << "Image mask size is not a multiple of the image width!";
+
+  words_.assign(words_per_row_ * height_, 0);
+
+  size_t row_min = height_, row_max = 0, word_min = words_per_row_, word_max = 0;
+  for (size_t px = mask.find_first(); px != boost::dynamic_bitset<>::npos; px = mask.find_next(px)) {
+    const size_t v = px / width_;
+    const size_t word = (px % width_) / 64;
+    words_[v * words_per_row_ + word] |= uint64_t(1) << ((px % width_) % 64);
+
+    row_min = std::min(row_min, v);
+    row_max = std::max(row_max, v);
+    word_min = std::min(word_min, word);
+    word_max = std::max(word_max, word);
+    count_++;
+  }
+
+  if (count_) {
+    row_begin_ = row_min;
+    row_end_ = row_max + 1;
+    word_begin_ = word_min;
+    word_end_ = word_max + 1;
+  }
+}
+
+size_t PackedImageMask::countIntersection(const PackedImageMask &other) const {
+  CHECK(width_ == other.width_ && height_ == other.height_) << "Image masks have different size!";
+
+  const size_t row_begin = std::max(row_begin_, other.row_begin_);
+  const size_t row_end = std::min(row_end_, other.row_end_);
+  const size_t word_begin = std::max(word_begin_, other.word_begin_);
+  const size_t word_end = std::min(word_end_, other.word_end_);
+
+  size_t num_intersections = 0;
+  for (size_t v = row_begin; v < row_end; v++) {
+    const uint64_t *a = &words_[v * words_per_row_];
+    const uint64_t *b = &other.words_[v * words_per_row_];
+    for (size_t w = word_begin; w < word_end; w++)
+      num_intersections += popcount(a[w] & b[w]);
+  }
+  return num_intersections;
+}
+}  // namespace v4r
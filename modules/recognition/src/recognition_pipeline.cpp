@@ -4,9 +4,6 @@
 
 namespace v4r {
 
-template <typename PointT>
-std::vector<std::pair<std::string, float>> RecognitionPipeline<PointT>::elapsed_time_;
-
 template <typename PointT>
 RecognitionPipeline<PointT>::StopWatch::~StopWatch() {
   boost::posix_time::ptime end_time = boost::posix_time::microsec_clock::local_time();
@@ -64,6 +64,9 @@ void Source<PointT>::init(const bf::path &model_database_path,
         obj->addTrainingView(v);
       }
 
+      if (!param_.lod_folder_name_.empty())
+        obj->setLODCacheDirectory(class_path / instance_name / param_.lod_folder_name_);
+
       if (!param_.has_categories_) {
         bf::path model3D_path = class_path / instance_name / param_.name_3D_model_;
         obj->initialize(model3D_path);
@@ -60,6 +60,7 @@
 #include <iostream>
 #include <opencv2/core/core.hpp>
 #include <v4r/common/impl/DataMatrix2D.hpp>
+#include <v4r/common/worker_mailbox.h>
 #include <v4r/keypoints/impl/Object.hpp>
 //#include "v4r/TomGine/tgTomGineThread.h"
 #include <v4r/core/macros.h>
@@ -148,6 +149,7 @@ class V4R_EXPORTS KeyframeManagementRGBD2 {
   // ---- end dbg ----
 
   bool run, have_thread;
+  WorkerMailbox mailbox;  // wakes up the object management thread for new keyframes and loop hypotheses
   unsigned nb_add;
   double sqr_max_dist_tracking_view;
   double sqr_dist_err_loop;
@@ -224,6 +226,14 @@ class V4R_EXPORTS KeyframeManagementRGBD2 {
     shm.unlock();
   }
 
+  /**
+   * @brief getMailboxStatistics
+   * @return queue depth and wait times of the object management thread
+   */
+  inline WorkerMailbox::Statistics getMailboxStatistics() const {
+    return mailbox.getStatistics();
+  }
+
   void addKeyframe(const cv::Mat &image, const DataMatrix2D<Eigen::Vector3f> &cloud, const Eigen::Matrix4f &pose,
                    int view_idx, const std::vector<std::pair<int, cv::Point2f>> &im_pts);
   bool getTrackingModel(ObjectView &view, Eigen::Matrix4f &view_pose, const Eigen::Matrix4f &current_pose,
@@ -386,7 +386,7 @@ void KeyframeManagementRGBD2::operate() {
     shm.unlock();
 
     if (!have_data)
-      usleep(10000);
+      mailbox.wait();
   }
 }
 
@@ -432,6 +432,7 @@ void KeyframeManagementRGBD2::start() {
     stop();
 
   run = true;
+  mailbox.open();
   th_obectmanagement = boost::thread(&KeyframeManagementRGBD2::operate, this);
   have_thread = true;
 }
@@ -441,6 +442,7 @@ void KeyframeManagementRGBD2::start() {
  */
 void KeyframeManagementRGBD2::stop() {
   run = false;
+  mailbox.close();
   th_obectmanagement.join();
   have_thread = false;
 }
@@ -451,6 +453,7 @@ void KeyframeManagementRGBD2::stop() {
 void KeyframeManagementRGBD2::addKeyframe(const cv::Mat &image, const DataMatrix2D<Eigen::Vector3f> &cloud,
                                           const Eigen::Matrix4f &pose, int view_idx,
                                           const std::vector<std::pair<int, cv::Point2f>> &_im_pts) {
+  bool added = false;
   shm.lock();
   if (!shm.process_view) {
     image.copyTo(shm.image);
@@ -459,8 +462,12 @@ void KeyframeManagementRGBD2::addKeyframe(const cv::Mat &image, const DataMatrix
     shm.view_idx = view_idx;
     shm.im_pts = _im_pts;
     shm.nb_add++;
+    added = true;
   }
   shm.unlock();
+
+  if (added)
+    mailbox.post();
 }
 
 /**
@@ -549,7 +556,8 @@ int KeyframeManagementRGBD2::addLinkHyp2(const cv::Mat &image, const DataMatrix2
   shm.unlock();
 
   shm.lock();
-  if (have_loop_data == 1 && !loop_in_progress) {
+  const bool have_loop = have_loop_data == 1 && !loop_in_progress;
+  if (have_loop) {
     have_loop_data = 2;
     new_pose[1] = pose;
     image.copyTo(loop_image[1]);
@@ -559,6 +567,9 @@ int KeyframeManagementRGBD2::addLinkHyp2(const cv::Mat &image, const DataMatrix2
     have_loop_data = 0;
   shm.unlock();
 
+  if (have_loop)
+    mailbox.post();
+
   inv_last_add_proj_pose = inv_pose;
 
   return cam_id;
@@ -17,13 +17,33 @@ class V4R_EXPORTS MvLMIcp {
   void computeAdjacencyMatrix();
   void fillViewParList();
 
+  /**
+   * @brief computeWithPlaneCorrespondences optimizes the poses with an analytic point-to-plane cost (diff type 3).
+   * Correspondences are looked up in the distance transforms once per outer iteration and kept fixed while ceres
+   * minimizes the cost.
+   */
+  void computeWithPlaneCorrespondences();
+
+  bool useDistanceTransforms() const {
+    return diff_type == 1 || diff_type == 3;
+  }
+
   int max_iterations_;
+  int max_inner_iterations_;
   int diff_type;
 
   // todo: maybe solve this by using a friend class instead of making everything public
  public:
   typedef typename pcl::PointCloud<PointT>::Ptr PointCloudTPtr;
 
+  /// correspondence between a point of view h and the tangent plane at its closest point in view k
+  struct PlaneCorrespondence {
+    Eigen::Vector3d p_;  ///< point of view h (transformed with its initial pose)
+    Eigen::Vector3d q_;  ///< closest point of view k (transformed with its initial pose)
+    Eigen::Vector3d n_;  ///< unit normal of the tangent plane at q_ (transformed with the initial pose of view k)
+    double weight_;
+  };
+
   std::vector<PointCloudTPtr> clouds_;
   std::vector<PointCloudTPtr> clouds_transformed_with_ip_;
 
@@ -58,10 +78,27 @@ class V4R_EXPORTS MvLMIcp {
     max_correspondence_distance_ = d;
   }
 
+  /**
+   * @brief setMaxIterations
+   * @param i maximum number of solver iterations (for diff type 3: maximum number of correspondence updates)
+   */
   void setMaxIterations(int i) {
     max_iterations_ = i;
   }
 
+  /**
+   * @brief setMaxInnerIterations
+   * @param i maximum number of solver iterations for a fixed set of correspondences (only used by diff type 3)
+   */
+  void setMaxInnerIterations(int i) {
+    max_inner_iterations_ = i;
+  }
+
+  /**
+   * @brief setDiffType
+   * @param i 0... numeric diff, 1... auto diff on distance transforms, 2... analytic on octree lookups,
+   * 3... analytic point-to-plane with correspondences fixed per outer iteration (distance transforms)
+   */
   void setDiffType(int i) {
     diff_type = i;
   }
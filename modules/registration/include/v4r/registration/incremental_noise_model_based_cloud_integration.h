@@ -0,0 +1,200 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 TU Wien, ACIN, Vision 4 Robotics (V4R) group
+** Contact: v4r.acin.tuwien.ac.at
+**
+** This file is part of V4R
+**
+** V4R is distributed under dual licenses - GPLv3 or closed source.
+**
+** GNU General Public License Usage
+** V4R is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published
+** by the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** V4R is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** Please review the following information to ensure the GNU General Public
+** License requirements will be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+**
+** Commercial License Usage
+** If GPL is not suitable for your project, you must purchase a commercial
+** license to use V4R. Licensees holding valid commercial V4R licenses may
+** use this file in accordance with the commercial license agreement
+** provided with the Software or, alternatively, in accordance with the
+** terms contained in a written agreement between you and TU Wien, ACIN, V4R.
+** For licensing terms and conditions please contact office<at>acin.tuwien.ac.at.
+**
+**
+** The copyright holder additionally grants the author(s) of the file the right
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or
+** sell copies of their contributions without any restrictions.
+**
+****************************************************************************/
+
+/**
+ * @file incremental_noise_model_based_cloud_integration.h
+ * @brief Noise model based integration of a sliding window of point clouds
+ *
+ */
+
+#pragma once
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+#include <v4r/core/macros.h>
+#include <v4r/registration/noise_model_based_cloud_integration.h>
+
+#include <deque>
+#include <unordered_map>
+
+namespace v4r {
+
+/**
+ * @brief Incremental version of NMBasedCloudIntegration for a sliding window of views. Points are accumulated in a
+ * hashed sparse voxel grid (resolution octree_resolution_) in which each voxel keeps the points falling into it
+ * together with their noise weight (determinant of the covariance of the Nguyen noise model), a running sum for
+ * averaging and the point with the best noise weight. Adding or removing a view therefore only touches the voxels hit
+ * by the points of this view, independent of the number of views in the window. The integrated cloud can be extracted
+ * at any time. The parameters reason_about_points_ and focal_length_ are not used.
+ */
+template <class PointT>
+class V4R_EXPORTS IncrementalNMBasedCloudIntegration {
+ private:
+  NMBasedCloudIntegrationParameter param_;
+
+  /// @brief point of an input view (in the global reference frame) falling into a voxel
+  struct VoxelPoint {
+    size_t view_id_;  ///< id of the view the point comes from
+    int pt_idx_;      ///< point index in the original cloud
+    float weight_;    ///< noise weight (the lower, the more confident)
+    PointT pt_;
+    pcl::Normal normal_;
+  };
+
+  /// @brief noise weighted accumulator of a voxel
+  struct Voxel {
+    std::vector<VoxelPoint> pts_;                     ///< points of all views falling into this voxel
+    size_t best_;                                     ///< index of the point with the lowest noise weight
+    Eigen::Vector3d sum_xyz_, sum_rgb_, sum_normal_;  ///< sums of the points for averaging
+    double sum_curvature_;                            ///< sum of the curvatures for averaging
+
+    Voxel()
+    : best_(0), sum_xyz_(Eigen::Vector3d::Zero()), sum_rgb_(Eigen::Vector3d::Zero()),
+      sum_normal_(Eigen::Vector3d::Zero()), sum_curvature_(0.) {}
+  };
+
+  /// @brief view in the sliding window
+  struct ViewInfo {
+    size_t id_;
+    uint32_t width_, height_;           ///< size of the input cloud
+    std::vector<uint64_t> voxel_keys_;  ///< voxels the points of this view were added to
+  };
+
+  std::unordered_map<uint64_t, Voxel> voxels_;  ///< sparse voxel grid
+  std::deque<ViewInfo> views_;                  ///< views in the order they were added
+  size_t next_view_id_;
+
+  uint64_t getVoxelKey(const Eigen::Vector3f &p) const;
+  void addToVoxel(Voxel &voxel, const VoxelPoint &vp) const;
+  void removeFromVoxel(Voxel &voxel, size_t view_id) const;
+  bool getVoxelOutput(const Voxel &voxel, PointT &pt, pcl::Normal &normal) const;
+
+  /// @brief adds the points of a cloud to the voxel grid and stores the occupied voxels in the view
+  void addPoints(ViewInfo &view, const pcl::PointCloud<PointT> &cloud, const pcl::PointCloud<pcl::Normal> &normals,
+                 const std::vector<std::vector<float>> &pt_properties, const Eigen::Matrix4f &transform_to_global,
+                 const std::vector<int> &indices);
+
+  /// @brief removes the points of a view from the voxel grid
+  void removePoints(const ViewInfo &view);
+
+ public:
+  IncrementalNMBasedCloudIntegration(const NMBasedCloudIntegrationParameter &p = NMBasedCloudIntegrationParameter())
+  : param_(p), next_view_id_(0) {}
+
+  /**
+   * @brief addView adds the points of a view to the integrated cloud
+   * @param cloud organized input cloud
+   * @param normals normals of the input cloud
+   * @param pt_properties for each pixel lateral [idx=0] and axial [idx=1] noise as well as distance to closest depth
+   * discontinuity [idx=2]
+   * @param transform_to_global transform aligning the input cloud to the global coordinate system
+   * @param indices indices of the points to be used (if empty, all points are used)
+   * @return id of the added view
+   */
+  size_t addView(const pcl::PointCloud<PointT> &cloud, const pcl::PointCloud<pcl::Normal> &normals,
+                 const std::vector<std::vector<float>> &pt_properties, const Eigen::Matrix4f &transform_to_global,
+                 const std::vector<int> &indices = std::vector<int>());
+
+  /**
+   * @brief removeView removes the points of a view from the integrated cloud
+   * @param view_id id of the view returned by addView
+   * @return true if the view was found
+   */
+  bool removeView(size_t view_id);
+
+  /**
+   * @brief replaceView replaces the points of an integrated view (e.g. after points were removed by change detection).
+   * The view keeps its id and its position in the order the views were added.
+   * @param view_id id of the view returned by addView
+   * @param cloud organized input cloud
+   * @param normals normals of the input cloud
+   * @param pt_properties for each pixel lateral [idx=0] and axial [idx=1] noise as well as distance to closest depth
+   * discontinuity [idx=2]
+   * @param transform_to_global transform aligning the input cloud to the global coordinate system
+   * @param indices indices of the points to be used (if empty, all points are used)
+   * @return true if the view was found
+   */
+  bool replaceView(size_t view_id, const pcl::PointCloud<PointT> &cloud, const pcl::PointCloud<pcl::Normal> &normals,
+                   const std::vector<std::vector<float>> &pt_properties, const Eigen::Matrix4f &transform_to_global,
+                   const std::vector<int> &indices = std::vector<int>());
+
+  /**
+   * @brief removeOldestView removes the view that was added first
+   */
+  void removeOldestView() {
+    if (!views_.empty())
+      removeView(views_.front().id_);
+  }
+
+  /**
+   * @brief getNumViews
+   * @return number of views currently integrated
+   */
+  size_t getNumViews() const {
+    return views_.size();
+  }
+
+  /**
+   * @brief clear removes all views
+   */
+  void clear() {
+    voxels_.clear();
+    views_.clear();
+  }
+
+  /**
+   * @brief compute extracts the integrated (unorganized) cloud in the global reference frame
+   * @param[out] output integrated cloud (newly allocated)
+   * @param[out] output_normals normals of the integrated cloud (newly allocated)
+   */
+  void compute(typename pcl::PointCloud<PointT>::Ptr &output, pcl::PointCloud<pcl::Normal>::Ptr &output_normals) const;
+
+  /**
+   * @brief getInputCloudUsed returns the points of a view used in the integrated cloud (in the global reference frame)
+   * @param view_id id of the view returned by addView
+   * @param[out] cloud organized cloud with the size of the input cloud (unused points are set to NaN)
+   * @return true if the view was found
+   */
+  bool getInputCloudUsed(size_t view_id, typename pcl::PointCloud<PointT>::Ptr &cloud) const;
+
+  typedef std::shared_ptr<IncrementalNMBasedCloudIntegration<PointT>> Ptr;
+  typedef std::shared_ptr<IncrementalNMBasedCloudIntegration<PointT> const> ConstPtr;
+};
+}  // namespace v4r
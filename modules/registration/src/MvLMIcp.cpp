@@ -1,4 +1,6 @@
 #include <ceres/rotation.h>
+#include <glog/logging.h>
+#include <omp.h>
 #include <pcl/common/transforms.h>
 #include <v4r/common/miscellaneous.h>
 #include <v4r/registration/MvLMIcp.h>
@@ -994,10 +996,82 @@ class RegistrationCostFunction : public ceres::CostFunction {
   }
 };
 
+inline Eigen::Matrix3d skewSymmetric(const Eigen::Vector3d& v) {
+  Eigen::Matrix3d S;
+  S << 0., -v.z(), v.y(), v.z(), 0., -v.x(), -v.y(), v.x(), 0.;
+  return S;
+}
+
+/// derivative of R(w) * v with respect to the angle-axis vector w, where R = R(w) (-R [v]_x J_r(w) with J_r being
+/// the right Jacobian of SO(3))
+inline Eigen::Matrix3d rotatedPointJacobian(const double* w, const Eigen::Matrix3d& R, const Eigen::Vector3d& v) {
+  const Eigen::Vector3d omega(w[0], w[1], w[2]);
+  const Eigen::Matrix3d W = skewSymmetric(omega);
+  const double theta2 = omega.squaredNorm();
+  Eigen::Matrix3d J_r = Eigen::Matrix3d::Identity();
+  if (theta2 > 1e-12) {
+    const double theta = std::sqrt(theta2);
+    J_r += -(1. - std::cos(theta)) / theta2 * W + (theta - std::sin(theta)) / (theta2 * theta) * W * W;
+  } else
+    J_r -= 0.5 * W;
+
+  return -R * skewSymmetric(v) * J_r;
+}
+
+/// analytic point-to-plane cost function for fixed correspondences
+/// acts on a pair of views (h,k), parameters are angle-axis rotation and translation applied on top of the initial
+/// poses. The residual of correspondence (p,q,n) is w * (R_k n)^T (R_h p + t_h - R_k q - t_k).
+
+template <class PointT>
+class PointToPlaneCostFunction : public ceres::CostFunction {
+ private:
+  typedef typename v4r::Registration::MvLMIcp<PointT>::PlaneCorrespondence PlaneCorrespondence;
+  const std::vector<PlaneCorrespondence>& correspondences_;
+
+ public:
+  PointToPlaneCostFunction(const std::vector<PlaneCorrespondence>& correspondences)
+  : correspondences_(correspondences) {
+    set_num_residuals(static_cast<int>(correspondences.size()));
+    mutable_parameter_block_sizes()->resize(2, 6);
+  }
+
+  virtual bool Evaluate(double const* const* parameters, double* residuals, double** jacobians) const {
+    Eigen::Matrix3d R_h, R_k;
+    ceres::AngleAxisToRotationMatrix<double>(parameters[0], R_h.data());
+    ceres::AngleAxisToRotationMatrix<double>(parameters[1], R_k.data());
+    const Eigen::Vector3d t_h(parameters[0][3], parameters[0][4], parameters[0][5]);
+    const Eigen::Vector3d t_k(parameters[1][3], parameters[1][4], parameters[1][5]);
+
+    for (size_t i = 0; i < correspondences_.size(); i++) {
+      const PlaneCorrespondence& c = correspondences_[i];
+      const Eigen::Vector3d a = R_h * c.p_ + t_h;
+      const Eigen::Vector3d n = R_k * c.n_;
+      residuals[i] = c.weight_ * n.dot(a - R_k * c.q_ - t_k);
+
+      if (!jacobians)
+        continue;
+
+      // (R_k n)^T (R_k q) does not depend on the rotation of view k, so only (R_k n)^T (a - t_k) contributes
+      if (jacobians[0]) {
+        Eigen::Map<Eigen::Matrix<double, 1, 6>> J(jacobians[0] + 6 * i);
+        J.head<3>() = c.weight_ * n.transpose() * rotatedPointJacobian(parameters[0], R_h, c.p_);
+        J.tail<3>() = c.weight_ * n.transpose();
+      }
+      if (jacobians[1]) {
+        Eigen::Map<Eigen::Matrix<double, 1, 6>> J(jacobians[1] + 6 * i);
+        J.head<3>() = c.weight_ * (a - t_k).transpose() * rotatedPointJacobian(parameters[1], R_k, c.n_);
+        J.tail<3>() = -c.weight_ * n.transpose();
+      }
+    }
+    return true;
+  }
+};
+
 template <class PointT>
 v4r::Registration::MvLMIcp<PointT>::MvLMIcp() {
   max_correspondence_distance_ = 0.01;
   max_iterations_ = 5;
+  max_inner_iterations_ = 5;
   diff_type = 2;
   normal_dot_ = 0.9f;
 }
@@ -1022,8 +1096,8 @@ void v4r::Registration::MvLMIcp<PointT>::compute() {
     }
   }
 
-  if (diff_type == 1) {
-    // using distance transforms
+  if (useDistanceTransforms()) {
+    // using distance transforms (shared by all view pairs and iterations)
     distance_transforms_.resize(clouds_.size());
 
     for (size_t i = 0; i < clouds_.size(); i++) {
@@ -1050,6 +1124,11 @@ void v4r::Registration::MvLMIcp<PointT>::compute() {
 
   std::cout << "view pairs used in registration:" << S_.size() << std::endl;
 
+  if (diff_type == 3) {
+    computeWithPlaneCorrespondences();
+    return;
+  }
+
   // optimize :)
   // note: the jacobian matrix is cardinality(S_) * [ sizeof(clouds_) * { sizeof(pose) = 6 } ]
   //      it is a block-row matrix, for a block-row s, everything is zero except the rate of change for
@@ -1252,6 +1331,134 @@ void v4r::Registration::MvLMIcp<PointT>::compute() {
   }
 }
 
+template <class PointT>
+void v4r::Registration::MvLMIcp<PointT>::computeWithPlaneCorrespondences() {
+  const int params_per_view = 6;
+  std::vector<double> parameters(params_per_view * clouds_.size(), 0.);  // (rx,ry,rz,tx,ty,tz) on top of poses_
+  std::vector<std::vector<PlaneCorrespondence>> correspondences(S_.size());
+  const bool use_normals = normals_.size() == clouds_.size();
+  const bool use_weights = weights_.size() == clouds_.size();
+
+  for (int it = 0; it < max_iterations_; it++) {
+    std::vector<Eigen::Matrix3d> R(clouds_.size());
+    std::vector<Eigen::Vector3d> t(clouds_.size());
+    for (size_t v = 0; v < clouds_.size(); v++) {
+      ceres::AngleAxisToRotationMatrix<double>(&parameters[v * params_per_view], R[v].data());
+      t[v] = Eigen::Vector3d(parameters[v * params_per_view + 3], parameters[v * params_per_view + 4],
+                             parameters[v * params_per_view + 5]);
+    }
+
+    // find the closest point in view k for each point of view h with the current poses
+#pragma omp parallel for schedule(dynamic)
+    for (size_t s = 0; s < S_.size(); s++) {
+      const int h = S_[s].first;
+      const int k = S_[s].second;
+      const Eigen::Matrix3d R_hk = R[k].transpose() * R[h];
+      const Eigen::Vector3d t_hk = R[k].transpose() * (t[h] - t[k]);
+      const pcl::PointCloud<PointT>& cloud_h = *clouds_transformed_with_ip_[h];
+      const pcl::PointCloud<PointT>& cloud_k = *clouds_transformed_with_ip_[k];
+
+      std::vector<PlaneCorrespondence>& corrs = correspondences[s];
+      corrs.clear();
+      corrs.reserve(cloud_h.points.size());
+
+      for (size_t i = 0; i < cloud_h.points.size(); i++) {
+        if (!pcl::isFinite(cloud_h.points[i]))
+          continue;
+
+        PlaneCorrespondence c;
+        c.p_ = cloud_h.points[i].getVector3fMap().template cast<double>();
+        const Eigen::Vector3d x = R_hk * c.p_ + t_hk;  // point expressed in the initial frame of view k
+
+        PointT p_at_k;
+        p_at_k.getVector3fMap() = x.cast<float>();
+        int idx;
+        float dist;
+        distance_transforms_[k]->getCorrespondence(p_at_k, &idx, &dist, 0, 0);
+        if (idx < 0 || dist > max_correspondence_distance_)
+          continue;
+
+        c.q_ = cloud_k.points[idx].getVector3fMap().template cast<double>();
+
+        if (use_normals) {
+          c.n_ = normals_transformed_with_ip_[k]->points[idx].getNormalVector3fMap().template cast<double>();
+          const Eigen::Vector3d n_h =
+              R_hk * normals_transformed_with_ip_[h]->points[i].getNormalVector3fMap().template cast<double>();
+          if (!c.n_.allFinite() || !n_h.allFinite() || n_h.dot(c.n_) < normal_dot_)
+            continue;
+        } else {
+          // without normals, the gradient of the distance field defines the tangent plane
+          Eigen::Vector3f gradient;
+          distance_transforms_[k]->getDerivatives(p_at_k, gradient);
+          if (gradient.allFinite() && gradient.norm() > std::numeric_limits<float>::epsilon())
+            c.n_ = gradient.cast<double>();
+          else if (dist > 0.f)
+            c.n_ = x - c.q_;
+          else
+            continue;
+        }
+        c.n_.normalize();
+
+        c.weight_ = use_weights ? weights_[h][i] * weights_[k][idx] : 1.;
+        corrs.push_back(c);
+      }
+    }
+
+    ceres::Problem problem;
+    bool reference_view_used = false;
+    size_t num_correspondences = 0;
+    for (size_t s = 0; s < S_.size(); s++) {
+      if (correspondences[s].empty())
+        continue;
+
+      problem.AddResidualBlock(new PointToPlaneCostFunction<PointT>(correspondences[s]),
+                               new ceres::CauchyLoss(max_correspondence_distance_ / 2.0),
+                               &parameters[S_[s].first * params_per_view], &parameters[S_[s].second * params_per_view]);
+      reference_view_used |= S_[s].first == 0 || S_[s].second == 0;
+      num_correspondences += correspondences[s].size();
+    }
+
+    if (problem.NumResidualBlocks() == 0)
+      break;
+
+    if (reference_view_used)
+      problem.SetParameterBlockConstant(&parameters[0]);
+
+    ceres::Solver::Options options;
+    options.linear_solver_type = ceres::DENSE_NORMAL_CHOLESKY;  // only 6 parameters per view
+    options.max_num_iterations = max_inner_iterations_;
+    options.function_tolerance = 1e-6;
+    options.num_threads = omp_get_max_threads();
+    options.num_linear_solver_threads = omp_get_max_threads();
+
+    const std::vector<double> parameters_before = parameters;
+    ceres::Solver::Summary summary;
+    ceres::Solve(options, &problem, &summary);
+    VLOG(1) << "Iteration " << it << " (" << num_correspondences << " correspondences): " << summary.BriefReport();
+
+    double max_update = 0.;
+    for (size_t i = 0; i < parameters.size(); i++)
+      max_update = std::max(max_update, std::abs(parameters[i] - parameters_before[i]));
+
+    if (max_update < 1e-6)
+      break;
+  }
+
+  final_poses_.clear();
+  final_poses_.resize(poses_.size());
+  for (size_t i = 0; i < clouds_.size(); i++) {
+    Eigen::Matrix3d R;
+    ceres::AngleAxisToRotationMatrix<double>(&parameters[i * params_per_view], R.data());
+
+    Eigen::Matrix4f T_h = Eigen::Matrix4f::Identity();
+    T_h.block<3, 3>(0, 0) = R.cast<float>();
+    T_h.block<3, 1>(0, 3) = Eigen::Vector3d(parameters[i * params_per_view + 3], parameters[i * params_per_view + 4],
+                                            parameters[i * params_per_view + 5])
+                                .cast<float>();
+    final_poses_[i] = T_h * poses_[i];
+  }
+}
+
 template <class PointT>
 void v4r::Registration::MvLMIcp<PointT>::computeAdjacencyMatrix() {
   adjacency_matrix_.resize(clouds_.size());
@@ -1270,7 +1477,7 @@ void v4r::Registration::MvLMIcp<PointT>::computeAdjacencyMatrix() {
         if (pcl_isnan(clouds_transformed_with_ip_[j]->points[kk].x))
           continue;
 
-        if (diff_type == 1) {
+        if (useDistanceTransforms()) {
           float dist;
           int idx;
           distance_transforms_[i]->getCorrespondence(clouds_transformed_with_ip_[j]->points[kk], &idx, &dist, 0, 0);
@@ -0,0 +1,289 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 TU Wien, ACIN, Vision 4 Robotics (V4R) group
+** Contact: v4r.acin.tuwien.ac.at
+**
+** This file is part of V4R
+**
+** V4R is distributed under dual licenses - GPLv3 or closed source.
+**
+** GNU General Public License Usage
+** V4R is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published
+** by the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** V4R is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** Please review the following information to ensure the GNU General Public
+** License requirements will be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+**
+** Commercial License Usage
+** If GPL is not suitable for your project, you must purchase a commercial
+** license to use V4R. Licensees holding valid commercial V4R licenses may
+** use this file in accordance with the commercial license agreement
+** provided with the Software or, alternatively, in accordance with the
+** terms contained in a written agreement between you and TU Wien, ACIN, V4R.
+** For licensing terms and conditions please contact office<at>acin.tuwien.ac.at.
+**
+**
+** The copyright holder additionally grants the author(s) of the file the right
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or
+** sell copies of their contributions without any restrictions.
+**
+****************************************************************************/
+
+#include <glog/logging.h>
+#include <pcl/common/io.h>
+#include <v4r/registration/incremental_noise_model_based_cloud_integration.h>
+
+#include <cmath>
+#include <limits>
+
+namespace v4r {
+
+template <typename PointT>
+uint64_t IncrementalNMBasedCloudIntegration<PointT>::getVoxelKey(const Eigen::Vector3f &p) const {
+  // 21 bits per dimension, centered around the origin of the global reference frame
+  const int64_t offset = 1 << 20;
+  const Eigen::Array3f cell = (p / param_.octree_resolution_).array().floor();
+  const uint64_t x = static_cast<uint64_t>(static_cast<int64_t>(cell(0)) + offset) & 0x1FFFFF;
+  const uint64_t y = static_cast<uint64_t>(static_cast<int64_t>(cell(1)) + offset) & 0x1FFFFF;
+  const uint64_t z = static_cast<uint64_t>(static_cast<int64_t>(cell(2)) + offset) & 0x1FFFFF;
+  return (x << 42) | (y << 21) | z;
+}
+
+template <typename PointT>
+void IncrementalNMBasedCloudIntegration<PointT>::addToVoxel(Voxel &voxel, const VoxelPoint &vp) const {
+  voxel.sum_xyz_ += vp.pt_.getVector3fMap().template cast<double>();
+  voxel.sum_rgb_ += Eigen::Vector3d(vp.pt_.r, vp.pt_.g, vp.pt_.b);
+  voxel.sum_normal_ += vp.normal_.getNormalVector3fMap().normalized().template cast<double>();
+  voxel.sum_curvature_ += vp.normal_.curvature;
+
+  if (voxel.pts_.empty() || vp.weight_ < voxel.pts_[voxel.best_].weight_)
+    voxel.best_ = voxel.pts_.size();
+  voxel.pts_.push_back(vp);
+}
+
+template <typename PointT>
+void IncrementalNMBasedCloudIntegration<PointT>::removeFromVoxel(Voxel &voxel, size_t view_id) const {
+  size_t kept = 0;
+  for (size_t i = 0; i < voxel.pts_.size(); i++) {
+    const VoxelPoint &vp = voxel.pts_[i];
+    if (vp.view_id_ == view_id) {
+      voxel.sum_xyz_ -= vp.pt_.getVector3fMap().template cast<double>();
+      voxel.sum_rgb_ -= Eigen::Vector3d(vp.pt_.r, vp.pt_.g, vp.pt_.b);
+      voxel.sum_normal_ -= vp.normal_.getNormalVector3fMap().normalized().template cast<double>();
+      voxel.sum_curvature_ -= vp.normal_.curvature;
+    } else
+      voxel.pts_[kept++] = vp;
+  }
+
+  if (kept == voxel.pts_.size())
+    return;
+
+  voxel.pts_.resize(kept);
+  voxel.best_ = 0;
+  for (size_t i = 1; i < voxel.pts_.size(); i++) {
+    if (voxel.pts_[i].weight_ < voxel.pts_[voxel.best_].weight_)
+      voxel.best_ = i;
+  }
+}
+
+template <typename PointT>
+bool IncrementalNMBasedCloudIntegration<PointT>::getVoxelOutput(const Voxel &voxel, PointT &pt,
+                                                                pcl::Normal &normal) const {
+  if (voxel.pts_.empty() || voxel.pts_.size() < param_.min_points_per_voxel_)
+    return false;
+
+  if (param_.average_) {
+    const double n = static_cast<double>(voxel.pts_.size());
+    pt = voxel.pts_[voxel.best_].pt_;
+    pt.getVector3fMap() = (voxel.sum_xyz_ / n).template cast<float>();
+    pt.r = static_cast<uint8_t>(voxel.sum_rgb_(0) / n + 0.5);
+    pt.g = static_cast<uint8_t>(voxel.sum_rgb_(1) / n + 0.5);
+    pt.b = static_cast<uint8_t>(voxel.sum_rgb_(2) / n + 0.5);
+    normal.getNormalVector3fMap() = voxel.sum_normal_.normalized().template cast<float>();
+    normal.curvature = static_cast<float>(voxel.sum_curvature_ / n);
+  } else {
+    pt = voxel.pts_[voxel.best_].pt_;
+    normal = voxel.pts_[voxel.best_].normal_;
+  }
+  return true;
+}
+
+template <typename PointT>
+void IncrementalNMBasedCloudIntegration<PointT>::addPoints(ViewInfo &view, const pcl::PointCloud<PointT> &cloud,
+                                                           const pcl::PointCloud<pcl::Normal> &normals,
+                                                           const std::vector<std::vector<float>> &pt_properties,
+                                                           const Eigen::Matrix4f &transform_to_global,
+                                                           const std::vector<int> &indices) {
+  CHECK(cloud.points.size() == normals.points.size() && cloud.points.size() == pt_properties.size());
+
+  view.width_ = cloud.width;
+  view.height_ = cloud.height;
+  view.voxel_keys_.clear();
+
+  const Eigen::Matrix3f rotation = transform_to_global.block<3, 3>(0, 0);
+  const Eigen::Vector3f translation = transform_to_global.block<3, 1>(0, 3);
+
+  const size_t num_pts = indices.empty() ? cloud.points.size() : indices.size();
+  view.voxel_keys_.reserve(num_pts);
+
+  for (size_t i = 0; i < num_pts; i++) {
+    const int idx = indices.empty() ? static_cast<int>(i) : indices[i];
+    const PointT &p = cloud.points[idx];
+    const pcl::Normal &n = normals.points[idx];
+    const std::vector<float> &props = pt_properties[idx];
+
+    if (!pcl::isFinite(p) || !pcl::isFinite(n))
+      continue;
+
+    // points close to depth discontinuities are never used for the integrated cloud
+    if (!(props[2] > param_.min_px_distance_to_depth_discontinuity_))
+      continue;
+
+    VoxelPoint vp;
+    vp.view_id_ = view.id_;
+    vp.pt_idx_ = idx;
+    vp.pt_ = p;
+    vp.pt_.getVector3fMap() = rotation * p.getVector3fMap() + translation;
+    vp.normal_ = n;
+    vp.normal_.getNormalVector3fMap() = rotation * n.getNormalVector3fMap();
+
+    // determinant of the (rotated) covariance matrix of the noise model
+    const double det = static_cast<double>(props[0]) * props[0] * props[1];
+    vp.weight_ = (std::isfinite(det) && det > 0) ? static_cast<float>(det) : std::numeric_limits<float>::max();
+
+    const uint64_t key = getVoxelKey(vp.pt_.getVector3fMap());
+    addToVoxel(voxels_[key], vp);
+    view.voxel_keys_.push_back(key);
+  }
+
+  VLOG(1) << "Added view " << view.id_ << " with " << view.voxel_keys_.size() << " points. Integrated cloud has "
+          << voxels_.size() << " occupied voxels.";
+}
+
+template <typename PointT>
+void IncrementalNMBasedCloudIntegration<PointT>::removePoints(const ViewInfo &view) {
+  for (uint64_t key : view.voxel_keys_) {
+    typename std::unordered_map<uint64_t, Voxel>::iterator voxel_it = voxels_.find(key);
+    if (voxel_it == voxels_.end())  // already removed by another point of this view
+      continue;
+
+    removeFromVoxel(voxel_it->second, view.id_);
+    if (voxel_it->second.pts_.empty())
+      voxels_.erase(voxel_it);
+  }
+}
+
+template <typename PointT>
+size_t IncrementalNMBasedCloudIntegration<PointT>::addView(const pcl::PointCloud<PointT> &cloud,
+                                                           const pcl::PointCloud<pcl::Normal> &normals,
+                                                           const std::vector<std::vector<float>> &pt_properties,
+                                                           const Eigen::Matrix4f &transform_to_global,
+                                                           const std::vector<int> &indices) {
+  ViewInfo view;
+  view.id_ = next_view_id_++;
+  addPoints(view, cloud, normals, pt_properties, transform_to_global, indices);
+  views_.push_back(view);
+  return views_.back().id_;
+}
+
+template <typename PointT>
+bool IncrementalNMBasedCloudIntegration<PointT>::replaceView(size_t view_id, const pcl::PointCloud<PointT> &cloud,
+                                                             const pcl::PointCloud<pcl::Normal> &normals,
+                                                             const std::vector<std::vector<float>> &pt_properties,
+                                                             const Eigen::Matrix4f &transform_to_global,
+                                                             const std::vector<int> &indices) {
+  typename std::deque<ViewInfo>::iterator view_it = views_.begin();
+  while (view_it != views_.end() && view_it->id_ != view_id)
+    ++view_it;
+
+  if (view_it == views_.end())
+    return false;
+
+  removePoints(*view_it);
+  addPoints(*view_it, cloud, normals, pt_properties, transform_to_global, indices);
+  return true;
+}
+
+template <typename PointT>
+bool IncrementalNMBasedCloudIntegration<PointT>::removeView(size_t view_id) {
+  typename std::deque<ViewInfo>::iterator view_it = views_.begin();
+  while (view_it != views_.end() && view_it->id_ != view_id)
+    ++view_it;
+
+  if (view_it == views_.end())
+    return false;
+
+  removePoints(*view_it);
+  views_.erase(view_it);
+  return true;
+}
+
+template <typename PointT>
+void IncrementalNMBasedCloudIntegration<PointT>::compute(typename pcl::PointCloud<PointT>::Ptr &output,
+                                                         pcl::PointCloud<pcl::Normal>::Ptr &output_normals) const {
+  output.reset(new pcl::PointCloud<PointT>);
+  output_normals.reset(new pcl::PointCloud<pcl::Normal>);
+  output->points.resize(voxels_.size());
+  output_normals->points.resize(voxels_.size());
+
+  size_t kept = 0;
+  for (const auto &v : voxels_) {
+    if (getVoxelOutput(v.second, output->points[kept], output_normals->points[kept]))
+      kept++;
+  }
+
+  output->points.resize(kept);
+  output_normals->points.resize(kept);
+  output->width = output_normals->width = kept;
+  output->height = output_normals->height = 1;
+  output->is_dense = output_normals->is_dense = true;
+
+  VLOG(1) << "Number of points in incremental noise model based integrated cloud: " << kept << " (" << views_.size()
+          << " views).";
+}
+
+template <typename PointT>
+bool IncrementalNMBasedCloudIntegration<PointT>::getInputCloudUsed(size_t view_id,
+                                                                   typename pcl::PointCloud<PointT>::Ptr &cloud) const {
+  typename std::deque<ViewInfo>::const_iterator view_it = views_.begin();
+  while (view_it != views_.end() && view_it->id_ != view_id)
+    ++view_it;
+
+  if (view_it == views_.end())
+    return false;
+
+  PointT na;
+  na.x = na.y = na.z = std::numeric_limits<float>::quiet_NaN();
+
+  cloud.reset(new pcl::PointCloud<PointT>);
+  cloud->points.resize(view_it->width_ * view_it->height_, na);
+  cloud->width = view_it->width_;
+  cloud->height = view_it->height_;
+  cloud->is_dense = false;
+
+  for (uint64_t key : view_it->voxel_keys_) {
+    const Voxel &voxel = voxels_.at(key);
+    if (voxel.pts_.size() < param_.min_points_per_voxel_)
+      continue;
+
+    if (param_.average_) {
+      for (const VoxelPoint &vp : voxel.pts_) {
+        if (vp.view_id_ == view_id)
+          cloud->points[vp.pt_idx_] = vp.pt_;
+      }
+    } else if (voxel.pts_[voxel.best_].view_id_ == view_id)
+      cloud->points[voxel.pts_[voxel.best_].pt_idx_] = voxel.pts_[voxel.best_].pt_;
+  }
+  return true;
+}
+
+template class V4R_EXPORTS IncrementalNMBasedCloudIntegration<pcl::PointXYZRGB>;
+}  // namespace v4r
@@ -68,9 +68,20 @@ const size_t maxMeshSize = 1000000;  // this will lead to a big ssbo^^ (16mb)
                                       * along a sphere. (Good for generating views to an object)
                                       */
 class V4R_EXPORTS DepthmapRenderer {
+ public:
+  /**
+   * @brief Backend used to rasterize the model
+   * OPENGL renders on the GPU and needs an X display to create the (offscreen) context.
+   * SOFTWARE is a tile-based CPU rasterizer that runs headless. Its render calls are thread-safe, so views can be
+   * rendered concurrently.
+   */
+  enum class Backend { OPENGL, SOFTWARE };
+
  private:
   static bool glfwRunning;
 
+  Backend backend;
+
   // hide the default constructor
   DepthmapRenderer();
 
@@ -118,6 +129,16 @@ class V4R_EXPORTS DepthmapRenderer {
   // Stores the camera pose:
   Eigen::Matrix4f pose;
 
+  // geometry of the current model for the software backend
+  std::vector<Eigen::Vector3f> cpuPositions;
+  std::vector<Eigen::Vector3f> cpuNormals;
+  std::vector<Eigen::Vector2f> cpuTexPos;
+  std::vector<cv::Vec4b> cpuColors;
+  std::vector<int> cpuFaceMesh;  // mesh (texture) of each triangle, -1 if there is none
+
+  cv::Mat renderDepthmapSoftware(const Eigen::Matrix4f &camPose, float &visibleSurfaceArea, cv::Mat &color,
+                                 cv::Mat &normal) const;
+
   // this here is to create points as part of a sphere
   // The next two i stole from thomas mörwald
   int search_midpoint(int &index_start, int &index_end, size_t &n_vertices, int &edge_walk, std::vector<int> &midpoint,
@@ -132,8 +153,9 @@ class V4R_EXPORTS DepthmapRenderer {
    * @brief DepthmapRenderer
    * @param resx the resolution has to be fixed at the beginning of the program
    * @param resy
+   * @param backend OpenGL or software rasterization
    */
-  DepthmapRenderer(int resx, int resy);
+  DepthmapRenderer(int resx, int resy, Backend backend = Backend::OPENGL);
 
   ~DepthmapRenderer();
 
@@ -198,6 +220,13 @@ class V4R_EXPORTS DepthmapRenderer {
    */
   cv::Mat renderDepthmap(float &visibleSurfaceArea, cv::Mat &color, cv::Mat &normal) const;
 
+  /**
+   * @brief renderDepthmap renders the model from the given camera pose instead of the one set by setCamPose.
+   * With the software backend this can be called from several threads at once (e.g. one per view of createSphere).
+   */
+  cv::Mat renderDepthmap(const Eigen::Matrix4f &camPose, float &visibleSurfaceArea, cv::Mat &color,
+                         cv::Mat &normal) const;
+
   /**
    * @brief renderPointcloud
    * @param visibleSurfaceArea: Returns an estimate of how much of the models surface area
@@ -216,6 +245,21 @@ class V4R_EXPORTS DepthmapRenderer {
 
   pcl::PointCloud<pcl::PointXYZRGBNormal> renderPointcloudColorNormal(float &visibleSurfaceArea) const;
 
+  /// renderPointcloud* from the given camera pose (thread-safe with the software backend)
+  pcl::PointCloud<pcl::PointXYZ> renderPointcloud(const Eigen::Matrix4f &camPose, float &visibleSurfaceArea) const;
+  pcl::PointCloud<pcl::PointXYZRGB> renderPointcloudColor(const Eigen::Matrix4f &camPose,
+                                                          float &visibleSurfaceArea) const;
+  pcl::PointCloud<pcl::PointXYZRGBNormal> renderPointcloudColorNormal(const Eigen::Matrix4f &camPose,
+                                                                      float &visibleSurfaceArea) const;
+
+  /**
+   * @brief getBackend
+   * @return the backend used for rendering
+   */
+  Backend getBackend() const {
+    return backend;
+  }
+
   typedef std::shared_ptr<DepthmapRenderer> Ptr;
   typedef std::shared_ptr<DepthmapRenderer const> ConstPtr;
 };
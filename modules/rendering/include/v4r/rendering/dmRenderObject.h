@@ -97,6 +97,13 @@ class V4R_EXPORTS DepthmapRendererModel {
 
   void unloadFromGPU();
 
+  /**
+   * @brief loadToCPU
+   *        Copies the vertex attributes into separate arrays for the software rasterizer of DepthmapRenderer
+   */
+  void loadToCPU(std::vector<Eigen::Vector3f> &positions, std::vector<Eigen::Vector3f> &normals,
+                 std::vector<Eigen::Vector2f> &texPos, std::vector<cv::Vec4b> &colors) const;
+
   /**
    * @brief getIndexCount
    * @return
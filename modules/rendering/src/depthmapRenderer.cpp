@@ -106,11 +106,15 @@ void DepthmapRenderer::subdivide(size_t &n_vertices, size_t &n_edges, size_t &n_
   n_faces = n_faces_new;
 }
 
-DepthmapRenderer::DepthmapRenderer(int resx, int resy) {
+DepthmapRenderer::DepthmapRenderer(int resx, int resy, Backend backend) : backend(backend), model(0) {
   // First of all: create opengl context:
   // res=glm::ivec2(resx,resy);
   res = Eigen::Vector2i(resx, resy);
 
+  // the software rasterizer neither needs a display nor an OpenGL context
+  if (backend == Backend::SOFTWARE)
+    return;
+
   if (counter == 0) {
     // BEGIN OF COPYCAT CODE
     static int visual_attribs[] = {None};
@@ -455,6 +459,9 @@ DepthmapRenderer::DepthmapRenderer(int resx, int resy) {
 }
 
 DepthmapRenderer::~DepthmapRenderer() {
+  if (backend == Backend::SOFTWARE)
+    return;
+
   // delete the framebuffer:
   glDeleteTextures(1, &depthTex);
   glDeleteTextures(1, &indexTex);
@@ -534,6 +541,20 @@ void DepthmapRenderer::setIntrinsics(float fx, float fy, float cx, float cy) {
 }
 
 void DepthmapRenderer::setModel(DepthmapRendererModel *_model) {
+  if (backend == Backend::SOFTWARE) {
+    model = _model;
+    model->loadToCPU(cpuPositions, cpuNormals, cpuTexPos, cpuColors);
+    cpuFaceMesh.assign(model->indexCount / 3, -1);
+    for (size_t i = 0; i < model->meshes.size(); i++) {
+      if (model->meshes[i].tex.empty())
+        continue;
+      const uint32_t end = std::min(model->meshes[i].beginIndex + model->meshes[i].indexCount, model->indexCount);
+      for (uint32_t j = model->meshes[i].beginIndex; j + 2 < end; j += 3)
+        cpuFaceMesh[j / 3] = i;
+    }
+    return;
+  }
+
   GLuint err;
   if ((err = glGetError()) != GL_NO_ERROR)
     std::cerr << "A terrible OpenGL error occurred before uploading the model (" << err << ")" << std::endl;
@@ -623,6 +644,14 @@ void DepthmapRenderer::setCamPose(const Eigen::Matrix4f &_pose) {
 }
 
 cv::Mat DepthmapRenderer::renderDepthmap(float &visible, cv::Mat &color, cv::Mat &normal) const {
+  return renderDepthmap(pose, visible, color, normal);
+}
+
+cv::Mat DepthmapRenderer::renderDepthmap(const Eigen::Matrix4f &camPose, float &visible, cv::Mat &color,
+                                         cv::Mat &normal) const {
+  if (backend == Backend::SOFTWARE)
+    return renderDepthmapSoftware(camPose, visible, color, normal);
+
   GLuint err;
   if ((err = glGetError()) != GL_NO_ERROR)
     std::cerr << "A terrible OpenGL error occurred before setting up the rendering (" << err << " / "
@@ -653,7 +682,7 @@ cv::Mat DepthmapRenderer::renderDepthmap(float &visible, cv::Mat &color, cv::Mat
   proj = proj2 * proj1;
   Matrix4f _proj = proj.inverse();
   // set the uniforms
-  glUniformMatrix4fv(poseUniform, 1, GL_FALSE, (float *)&pose);
+  glUniformMatrix4fv(poseUniform, 1, GL_FALSE, camPose.data());
   glUniformMatrix4fv(projectionUniform, 1, GL_FALSE, (float *)&proj);
   glUniformMatrix4fv(_projectionUniform, 1, GL_FALSE, (float *)&_proj);
   // glUniform4f(projectionUniform,fxycxy[0]/(float)res[0],fxycxy[1]/(float)res[1],fxycxy[2]/(float)res[0],fxycxy[3]/(float)res[1]);
@@ -790,7 +819,314 @@ cv::Mat DepthmapRenderer::renderDepthmap(float &visible, cv::Mat &color, cv::Mat
   return depthmap;
 }
 
+namespace {
+// The software rasterizer works on tiles of tileSize x tileSize pixels which are processed in parallel.
+const int tileSize = 32;
+// vertex positions are snapped to 1/16 pixel, edge functions are evaluated exactly in 64 bit integers
+const int subPixelBits = 4;
+const float subPixelScale = float(1 << subPixelBits);
+// vertices projecting further away than this are not rasterized (keeps the edge functions from overflowing)
+const float guardBand = float(1 << 22);
+
+struct RasterTriangle {
+  uint32_t face;           // index of the triangle in the index buffer (divided by 3)
+  uint32_t vertex[3];      // vertex indices, ordered such that the projected triangle has positive area
+  int32_t x[3], y[3];      // projected vertex positions in fixed point
+  int32_t bias[3];         // top-left fill rule: -1 if pixels exactly on the edge do not belong to the triangle
+  float invZ[3];           // inverse depth of the vertices for perspective correct interpolation
+  float invArea2;          // inverse of twice the (fixed point) area
+  int umin, umax, vmin, vmax;  // pixel bounding box clipped to the image
+  bool flipped;            // true if vertex 1 and 2 were swapped
+};
+
+// edge function of the edge opposite to vertex i evaluated at fixed point position (px,py)
+inline int64_t edgeFunction(const RasterTriangle &t, int i, int64_t px, int64_t py) {
+  const int a = (i + 1) % 3;
+  const int b = (i + 2) % 3;
+  return int64_t(t.x[b] - t.x[a]) * (py - t.y[a]) - int64_t(t.y[b] - t.y[a]) * (px - t.x[a]);
+}
+
+// bilinear texture lookup with a red border like the OpenGL backend (GL_CLAMP_TO_BORDER)
+cv::Vec4b sampleTexture(const cv::Mat &tex, float s, float t) {
+  const float x = s * tex.cols - 0.5f;
+  const float y = t * tex.rows - 0.5f;
+  const int x0 = (int)std::floor(x);
+  const int y0 = (int)std::floor(y);
+  const float wx = x - x0;
+  const float wy = y - y0;
+  float c[4] = {0.f, 0.f, 0.f, 0.f};
+  for (int dy = 0; dy < 2; dy++) {
+    for (int dx = 0; dx < 2; dx++) {
+      const float w = (dx ? wx : 1.f - wx) * (dy ? wy : 1.f - wy);
+      const int u = x0 + dx;
+      const int v = y0 + dy;
+      if (u < 0 || v < 0 || u >= tex.cols || v >= tex.rows) {
+        c[0] += w * 255.f;
+        c[3] += w * 255.f;
+      } else {
+        const cv::Vec3b &texel = tex.at<cv::Vec3b>(v, u);
+        c[0] += w * texel[0];
+        c[1] += w * texel[1];
+        c[2] += w * texel[2];
+        c[3] += w * 255.f;
+      }
+    }
+  }
+  return cv::Vec4b(cv::saturate_cast<uchar>(c[0]), cv::saturate_cast<uchar>(c[1]), cv::saturate_cast<uchar>(c[2]),
+                   cv::saturate_cast<uchar>(c[3]));
+}
+}  // namespace
+
+cv::Mat DepthmapRenderer::renderDepthmapSoftware(const Eigen::Matrix4f &camPose, float &visible, cv::Mat &color,
+                                                 cv::Mat &normal) const {
+  const int w = res[0];
+  const int h = res[1];
+  // same clipping planes as the projection matrix of the OpenGL backend
+  const float zmin = 0.1f;
+  const float zmax = 30.0f;
+
+  cv::Mat depthmap(h, w, CV_32FC1, cv::Scalar(0));
+  color = cv::Mat(h, w, CV_8UC4, cv::Scalar(0, 0, 0, 255));
+  normal = cv::Mat(h, w, CV_32FC4, cv::Scalar(0, 0, 0, 1));
+  visible = 0.f;
+  if (!model)
+    return depthmap;
+
+  const Eigen::Matrix3f R = camPose.topLeftCorner<3, 3>();
+  const Eigen::Vector3f t = camPose.topRightCorner<3, 1>();
+  const int nVertices = cpuPositions.size();
+  const int nFaces = model->indexCount / 3;
+
+  // transform and project the vertices (the pixel centers are at integer coordinates)
+  std::vector<Eigen::Vector3f> camPositions(nVertices);
+  std::vector<Eigen::Vector2f> projected(nVertices);
+#pragma omp parallel for schedule(static)
+  for (int i = 0; i < nVertices; i++) {
+    const Eigen::Vector3f p = R * cpuPositions[i] + t;
+    camPositions[i] = p;
+    projected[i] = Eigen::Vector2f(fxycxy[0] * p[0] / p[2] + fxycxy[2], fxycxy[1] * p[1] / p[2] + fxycxy[3]);
+  }
+
+  // triangle setup: surface area, projected pixel area and edge functions
+  std::vector<float> faceArea(nFaces, 0.f);
+  std::vector<float> facePixelArea(nFaces, 0.f);
+  std::vector<RasterTriangle> triangles(nFaces);
+  std::vector<char> rasterize(nFaces, 0);
+#pragma omp parallel for schedule(static)
+  for (int f = 0; f < nFaces; f++) {
+    RasterTriangle &tri = triangles[f];
+    tri.face = f;
+    for (int k = 0; k < 3; k++)
+      tri.vertex[k] = model->indices[3 * f + k];
+
+    const Eigen::Vector3f &p0 = camPositions[tri.vertex[0]];
+    const Eigen::Vector3f &p1 = camPositions[tri.vertex[1]];
+    const Eigen::Vector3f &p2 = camPositions[tri.vertex[2]];
+    faceArea[f] = 0.5f * (p1 - p0).cross(p2 - p0).norm();
+
+    // triangles crossing the near plane are not clipped but discarded
+    if (p0[2] < zmin || p1[2] < zmin || p2[2] < zmin)
+      continue;
+    if (p0[2] > zmax && p1[2] > zmax && p2[2] > zmax)
+      continue;
+
+    bool insideGuardBand = true;
+    for (int k = 0; k < 3; k++) {
+      const Eigen::Vector2f &q = projected[tri.vertex[k]];
+      insideGuardBand &= std::abs(q[0]) < guardBand && std::abs(q[1]) < guardBand;
+      if (!insideGuardBand)
+        break;
+      tri.x[k] = (int32_t)std::round(q[0] * subPixelScale);
+      tri.y[k] = (int32_t)std::round(q[1] * subPixelScale);
+    }
+    if (!insideGuardBand)
+      continue;
+
+    int64_t area2 = edgeFunction(tri, 2, tri.x[2], tri.y[2]);
+    if (area2 == 0)
+      continue;
+    tri.flipped = area2 < 0;
+    if (tri.flipped) {  // no backface culling, just flip the winding
+      std::swap(tri.vertex[1], tri.vertex[2]);
+      std::swap(tri.x[1], tri.x[2]);
+      std::swap(tri.y[1], tri.y[2]);
+      area2 = -area2;
+    }
+    facePixelArea[f] = 0.5f * area2 / (subPixelScale * subPixelScale);
+    tri.invArea2 = 1.f / area2;
+
+    int32_t xmin = tri.x[0], xmax = tri.x[0], ymin = tri.y[0], ymax = tri.y[0];
+    for (int k = 0; k < 3; k++) {
+      tri.invZ[k] = 1.f / camPositions[tri.vertex[k]][2];
+      xmin = std::min(xmin, tri.x[k]);
+      xmax = std::max(xmax, tri.x[k]);
+      ymin = std::min(ymin, tri.y[k]);
+      ymax = std::max(ymax, tri.y[k]);
+
+      // an edge owns the pixels lying exactly on it if it is a top or left edge. Shared edges are traversed in
+      // opposite directions by the two adjacent triangles, so such pixels are drawn exactly once.
+      const int32_t dx = tri.x[(k + 2) % 3] - tri.x[(k + 1) % 3];
+      const int32_t dy = tri.y[(k + 2) % 3] - tri.y[(k + 1) % 3];
+      tri.bias[k] = (dy > 0 || (dy == 0 && dx > 0)) ? 0 : -1;
+    }
+    tri.umin = std::max(0, (int)std::ceil(xmin / subPixelScale));
+    tri.umax = std::min(w - 1, (int)std::floor(xmax / subPixelScale));
+    tri.vmin = std::max(0, (int)std::ceil(ymin / subPixelScale));
+    tri.vmax = std::min(h - 1, (int)std::floor(ymax / subPixelScale));
+    rasterize[f] = tri.umin <= tri.umax && tri.vmin <= tri.vmax;
+  }
+
+  // bin the triangles into tiles (in drawing order, so that equal depths are resolved like in OpenGL)
+  const int tilesX = (w + tileSize - 1) / tileSize;
+  const int tilesY = (h + tileSize - 1) / tileSize;
+  std::vector<size_t> tileBegin(tilesX * tilesY + 1, 0);
+  for (int f = 0; f < nFaces; f++) {
+    if (!rasterize[f])
+      continue;
+    const RasterTriangle &tri = triangles[f];
+    for (int ty = tri.vmin / tileSize; ty <= tri.vmax / tileSize; ty++)
+      for (int tx = tri.umin / tileSize; tx <= tri.umax / tileSize; tx++)
+        tileBegin[ty * tilesX + tx + 1]++;
+  }
+  for (size_t i = 1; i < tileBegin.size(); i++)
+    tileBegin[i] += tileBegin[i - 1];
+  std::vector<uint32_t> tileTriangles(tileBegin.back());
+  {
+    std::vector<size_t> fill(tileBegin.begin(), tileBegin.end() - 1);
+    for (int f = 0; f < nFaces; f++) {
+      if (!rasterize[f])
+        continue;
+      const RasterTriangle &tri = triangles[f];
+      for (int ty = tri.vmin / tileSize; ty <= tri.vmax / tileSize; ty++)
+        for (int tx = tri.umin / tileSize; tx <= tri.umax / tileSize; tx++)
+          tileTriangles[fill[ty * tilesX + tx]++] = f;
+    }
+  }
+
+  // rasterize: every tile owns its part of the depth, index and barycentric buffers, so no locking is needed
+  cv::Mat indexMap(h, w, CV_32SC1, cv::Scalar(0));
+  cv::Mat barycentric(h, w, CV_32FC2);
+#pragma omp parallel for schedule(dynamic)
+  for (int tile = 0; tile < tilesX * tilesY; tile++) {
+    const int tu0 = (tile % tilesX) * tileSize;
+    const int tv0 = (tile / tilesX) * tileSize;
+    const int tu1 = std::min(tu0 + tileSize, w) - 1;
+    const int tv1 = std::min(tv0 + tileSize, h) - 1;
+    int64_t e0[tileSize], e1[tileSize], e2[tileSize];
+    bool covered[tileSize];
+
+    for (size_t k = tileBegin[tile]; k < tileBegin[tile + 1]; k++) {
+      const RasterTriangle &tri = triangles[tileTriangles[k]];
+      const int u0 = std::max(tri.umin, tu0);
+      const int u1 = std::min(tri.umax, tu1);
+      const int v0 = std::max(tri.vmin, tv0);
+      const int v1 = std::min(tri.vmax, tv1);
+      const int n = u1 - u0 + 1;
+      // increments of the edge functions for one pixel step in u direction
+      const int64_t step0 = int64_t(tri.y[1] - tri.y[2]) * (1 << subPixelBits);
+      const int64_t step1 = int64_t(tri.y[2] - tri.y[0]) * (1 << subPixelBits);
+      const int64_t step2 = int64_t(tri.y[0] - tri.y[1]) * (1 << subPixelBits);
+
+      for (int v = v0; v <= v1; v++) {
+        const int64_t px = int64_t(u0) * (1 << subPixelBits);
+        const int64_t py = int64_t(v) * (1 << subPixelBits);
+        const int64_t row0 = edgeFunction(tri, 0, px, py) + tri.bias[0];
+        const int64_t row1 = edgeFunction(tri, 1, px, py) + tri.bias[1];
+        const int64_t row2 = edgeFunction(tri, 2, px, py) + tri.bias[2];
+
+        // coverage test of the whole span (branch-free so the compiler can vectorize it)
+        for (int i = 0; i < n; i++) {
+          e0[i] = row0 + i * step0;
+          e1[i] = row1 + i * step1;
+          e2[i] = row2 + i * step2;
+          covered[i] = (e0[i] | e1[i] | e2[i]) >= 0;
+        }
+
+        float *depthRow = depthmap.ptr<float>(v);
+        int *indexRow = indexMap.ptr<int>(v);
+        cv::Vec2f *baryRow = barycentric.ptr<cv::Vec2f>(v);
+        for (int i = 0; i < n; i++) {
+          if (!covered[i])
+            continue;
+          const float b0 = (e0[i] - tri.bias[0]) * tri.invArea2;
+          const float b1 = (e1[i] - tri.bias[1]) * tri.invArea2;
+          const float b2 = (e2[i] - tri.bias[2]) * tri.invArea2;
+          const float invZ = b0 * tri.invZ[0] + b1 * tri.invZ[1] + b2 * tri.invZ[2];
+          const float z = 1.f / invZ;
+          const int u = u0 + i;
+          if (z < zmin || z > zmax || (depthRow[u] != 0 && depthRow[u] <= z))
+            continue;
+          depthRow[u] = z;
+          indexRow[u] = tri.face + 1;
+          // perspective correct barycentric coordinates of the first two vertices (in the order of the model)
+          const float pc1 = (tri.flipped ? b2 * tri.invZ[2] : b1 * tri.invZ[1]) * z;
+          baryRow[u] = cv::Vec2f(b0 * tri.invZ[0] * z, pc1);
+        }
+      }
+    }
+  }
+
+  // shade the visible surface
+#pragma omp parallel for schedule(dynamic)
+  for (int v = 0; v < h; v++) {
+    const int *indexRow = indexMap.ptr<int>(v);
+    const cv::Vec2f *baryRow = barycentric.ptr<cv::Vec2f>(v);
+    cv::Vec4b *colorRow = color.ptr<cv::Vec4b>(v);
+    cv::Vec4f *normalRow = normal.ptr<cv::Vec4f>(v);
+    for (int u = 0; u < w; u++) {
+      if (!indexRow[u])
+        continue;
+      const int f = indexRow[u] - 1;
+      const uint32_t *idx = &model->indices[3 * f];
+      const float b[3] = {baryRow[u][0], baryRow[u][1], 1.f - baryRow[u][0] - baryRow[u][1]};
+
+      Eigen::Vector3f n;
+      if (!model->normal || cpuNormals[idx[0]][0] == -10.f) {
+        n = R * (cpuPositions[idx[1]] - cpuPositions[idx[0]]).cross(cpuPositions[idx[2]] - cpuPositions[idx[0]]);
+      } else {
+        n = R * (b[0] * cpuNormals[idx[0]] + b[1] * cpuNormals[idx[1]] + b[2] * cpuNormals[idx[2]]);
+      }
+      n.normalize();
+      normalRow[u] = cv::Vec4f(n[0], n[1], n[2], 0.f);
+
+      const Eigen::Vector2f texPos = b[0] * cpuTexPos[idx[0]] + b[1] * cpuTexPos[idx[1]] + b[2] * cpuTexPos[idx[2]];
+      if (cpuFaceMesh[f] >= 0 && texPos[0] > -9.f) {
+        colorRow[u] = sampleTexture(model->meshes[cpuFaceMesh[f]].tex, texPos[0], texPos[1]);
+      } else {
+        for (int c = 0; c < 4; c++)
+          colorRow[u][c] = cv::saturate_cast<uchar>(b[0] * cpuColors[idx[0]][c] + b[1] * cpuColors[idx[1]][c] +
+                                                    b[2] * cpuColors[idx[2]][c]);
+      }
+    }
+  }
+
+  // estimate the visible surface area like the OpenGL backend
+  std::vector<int> facePixelCount(nFaces, 0);
+  for (int v = 0; v < h; v++) {
+    const int *indexRow = indexMap.ptr<int>(v);
+    for (int u = 0; u < w; u++) {
+      if (indexRow[u])
+        facePixelCount[indexRow[u] - 1]++;
+    }
+  }
+  float visibleArea = 0;
+  float fullArea = 0;
+  for (int f = 0; f < nFaces; f++) {
+    fullArea += faceArea[f];
+    if (facePixelArea[f] != 0)
+      visibleArea += faceArea[f] * float(facePixelCount[f]) / facePixelArea[f];
+  }
+  visible = visibleArea / fullArea;
+
+  return depthmap;
+}
+
 pcl::PointCloud<pcl::PointXYZ> DepthmapRenderer::renderPointcloud(float &visibleSurfaceArea) const {
+  return renderPointcloud(pose, visibleSurfaceArea);
+}
+
+pcl::PointCloud<pcl::PointXYZ> DepthmapRenderer::renderPointcloud(const Eigen::Matrix4f &camPose,
+                                                                  float &visibleSurfaceArea) const {
   const float bad_point = std::numeric_limits<float>::quiet_NaN();
   pcl::PointCloud<pcl::PointXYZ> cloud;
   cloud.width = res[0];
@@ -798,14 +1134,14 @@ pcl::PointCloud<pcl::PointXYZ> DepthmapRenderer::renderPointcloud(float &visible
   cloud.is_dense = false;
   cloud.points.resize(cloud.width * cloud.height);
 
-  cloud.sensor_orientation_ = Eigen::Quaternionf(Eigen::Matrix3f(pose.block(0, 0, 3, 3)).transpose());
-  Eigen::Vector3f trans =
-      Eigen::Matrix3f(pose.block(0, 0, 3, 3)).transpose() * Eigen::Vector3f(pose(0, 3), pose(1, 3), pose(2, 3));
+  cloud.sensor_orientation_ = Eigen::Quaternionf(Eigen::Matrix3f(camPose.block(0, 0, 3, 3)).transpose());
+  Eigen::Vector3f trans = Eigen::Matrix3f(camPose.block(0, 0, 3, 3)).transpose() *
+                          Eigen::Vector3f(camPose(0, 3), camPose(1, 3), camPose(2, 3));
   cloud.sensor_origin_ = Eigen::Vector4f(-trans(0), -trans(1), -trans(2), 1.0f);
 
   cv::Mat color;
   cv::Mat normal;
-  cv::Mat depth = renderDepthmap(visibleSurfaceArea, color, normal);
+  cv::Mat depth = renderDepthmap(camPose, visibleSurfaceArea, color, normal);
   for (size_t k = 0; k < cloud.height; k++) {
     for (size_t j = 0; j < cloud.width; j++) {
       float d = depth.at<float>(k, j);
@@ -826,6 +1162,11 @@ pcl::PointCloud<pcl::PointXYZ> DepthmapRenderer::renderPointcloud(float &visible
 }
 
 pcl::PointCloud<pcl::PointXYZRGB> DepthmapRenderer::renderPointcloudColor(float &visibleSurfaceArea) const {
+  return renderPointcloudColor(pose, visibleSurfaceArea);
+}
+
+pcl::PointCloud<pcl::PointXYZRGB> DepthmapRenderer::renderPointcloudColor(const Eigen::Matrix4f &camPose,
+                                                                          float &visibleSurfaceArea) const {
   const float bad_point = std::numeric_limits<float>::quiet_NaN();
   pcl::PointCloud<pcl::PointXYZRGB> cloud;
   cloud.width = res[0];
@@ -833,14 +1174,14 @@ pcl::PointCloud<pcl::PointXYZRGB> DepthmapRenderer::renderPointcloudColor(float
   cloud.is_dense = false;
   cloud.points.resize(cloud.width * cloud.height);
 
-  cloud.sensor_orientation_ = Eigen::Quaternionf(Eigen::Matrix3f(pose.block(0, 0, 3, 3)).transpose());
-  const Eigen::Vector3f trans =
-      Eigen::Matrix3f(pose.block(0, 0, 3, 3)).transpose() * Eigen::Vector3f(pose(0, 3), pose(1, 3), pose(2, 3));
+  cloud.sensor_orientation_ = Eigen::Quaternionf(Eigen::Matrix3f(camPose.block(0, 0, 3, 3)).transpose());
+  const Eigen::Vector3f trans = Eigen::Matrix3f(camPose.block(0, 0, 3, 3)).transpose() *
+                                Eigen::Vector3f(camPose(0, 3), camPose(1, 3), camPose(2, 3));
   cloud.sensor_origin_ = Eigen::Vector4f(-trans(0), -trans(1), -trans(2), 1.0f);
 
   cv::Mat color;
   cv::Mat normal;
-  cv::Mat depth = renderDepthmap(visibleSurfaceArea, color, normal);
+  cv::Mat depth = renderDepthmap(camPose, visibleSurfaceArea, color, normal);
   std::vector<cv::Mat> color_channels(3);
   cv::split(color, color_channels);
   cv::Mat b, g, r;
@@ -872,6 +1213,11 @@ pcl::PointCloud<pcl::PointXYZRGB> DepthmapRenderer::renderPointcloudColor(float
 }
 
 pcl::PointCloud<pcl::PointXYZRGBNormal> DepthmapRenderer::renderPointcloudColorNormal(float &visibleSurfaceArea) const {
+  return renderPointcloudColorNormal(pose, visibleSurfaceArea);
+}
+
+pcl::PointCloud<pcl::PointXYZRGBNormal> DepthmapRenderer::renderPointcloudColorNormal(const Eigen::Matrix4f &camPose,
+                                                                                      float &visibleSurfaceArea) const {
   const float bad_point = std::numeric_limits<float>::quiet_NaN();
   pcl::PointCloud<pcl::PointXYZRGBNormal> cloud;
   cloud.width = res[0];
@@ -879,14 +1225,14 @@ pcl::PointCloud<pcl::PointXYZRGBNormal> DepthmapRenderer::renderPointcloudColorN
   cloud.is_dense = false;
   cloud.points.resize(cloud.width * cloud.height);
 
-  cloud.sensor_orientation_ = Eigen::Quaternionf(Eigen::Matrix3f(pose.block(0, 0, 3, 3)).transpose());
-  const Eigen::Vector3f trans =
-      Eigen::Matrix3f(pose.block(0, 0, 3, 3)).transpose() * Eigen::Vector3f(pose(0, 3), pose(1, 3), pose(2, 3));
+  cloud.sensor_orientation_ = Eigen::Quaternionf(Eigen::Matrix3f(camPose.block(0, 0, 3, 3)).transpose());
+  const Eigen::Vector3f trans = Eigen::Matrix3f(camPose.block(0, 0, 3, 3)).transpose() *
+                                Eigen::Vector3f(camPose(0, 3), camPose(1, 3), camPose(2, 3));
   cloud.sensor_origin_ = Eigen::Vector4f(-trans(0), -trans(1), -trans(2), 1.0f);
 
   cv::Mat color;
   cv::Mat normal;
-  cv::Mat depth = renderDepthmap(visibleSurfaceArea, color, normal);
+  cv::Mat depth = renderDepthmap(camPose, visibleSurfaceArea, color, normal);
 
   std::vector<cv::Mat> color_channels(3);
   cv::split(color, color_channels);
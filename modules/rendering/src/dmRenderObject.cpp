@@ -327,6 +327,21 @@ void DepthmapRendererModel::unloadFromGPU() {
   }
 }
 
+void DepthmapRendererModel::loadToCPU(std::vector<Eigen::Vector3f> &positions, std::vector<Eigen::Vector3f> &normals,
+                                      std::vector<Eigen::Vector2f> &texPos, std::vector<cv::Vec4b> &colors) const {
+  positions.resize(vertexCount);
+  normals.resize(vertexCount);
+  texPos.resize(vertexCount);
+  colors.resize(vertexCount);
+  for (uint32_t i = 0; i < vertexCount; i++) {
+    const Vertex &v = vertices[i];
+    positions[i] = Eigen::Vector3f(v.pos.x, v.pos.y, v.pos.z);
+    normals[i] = Eigen::Vector3f(v.normal.x, v.normal.y, v.normal.z);
+    texPos[i] = Eigen::Vector2f(v.texPos.x, v.texPos.y);
+    colors[i] = cv::Vec4b(v.rgba.r, v.rgba.g, v.rgba.b, v.rgba.a);
+  }
+}
+
 unsigned int DepthmapRendererModel::getIndexCount() {
   return indexCount;
 }
@@ -186,6 +186,11 @@ class V4R_EXPORTS EntangledForestFeatureExtraction {
   void CalculatePairwiseFeaturesOctree(std::vector<Eigen::Vector3f>& centroids, std::vector<Eigen::Vector3f>& normals,
                                        std::vector<double>& verticalAngles);
 
+  void InitPairwiseFeatures();
+  void SetPairwiseFeatures(int segidx1, int segidx2, double minEDist, double minPtPlDist1, double minPtPlDist2,
+                           double hordiff, double verdiff);
+  void SortPairwiseFeatures();
+
   static bool PairwiseComparator(const std::pair<double, int>& l, const std::pair<double, int> r);
 
  protected:
@@ -111,6 +111,9 @@ class V4R_EXPORTS EntangledForest {
   // trees only down to a certain depth for classification
   bool mSplitNodesStoreLabelDistribution;
 
+  // classify trees concurrently instead of parallelizing the levels within each tree (not serialized)
+  bool mParallelTreeInference;
+
   int mNLabels;
   std::map<int, int> mLabelMap;
   std::vector<std::string> mLabelNames;
@@ -130,6 +133,13 @@ class V4R_EXPORTS EntangledForest {
   void SoftClassify(EntangledForestData *data, std::vector<std::vector<double>> &result, int maxDepth = -1,
                     int useNTrees = -1);  //, bool reweightLeafDistributions = false);   // new version)
 
+  inline void SetParallelTreeInference(bool enable) {
+    mParallelTreeInference = enable;
+  }
+  inline bool GetParallelTreeInference() {
+    return mParallelTreeInference;
+  }
+
   void SaveToFile(std::string filename);
   void SaveToBinaryFile(std::string filename);
   static void LoadFromFile(std::string filename, EntangledForest &f);
@@ -0,0 +1,132 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 TU Wien, ACIN, Vision 4 Robotics (V4R) group
+** Contact: v4r.acin.tuwien.ac.at
+**
+** This file is part of V4R
+**
+** V4R is distributed under dual licenses - GPLv3 or closed source.
+**
+** GNU General Public License Usage
+** V4R is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published
+** by the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** V4R is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** Please review the following information to ensure the GNU General Public
+** License requirements will be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+**
+** Commercial License Usage
+** If GPL is not suitable for your project, you must purchase a commercial
+** license to use V4R. Licensees holding valid commercial V4R licenses may
+** use this file in accordance with the commercial license agreement
+** provided with the Software or, alternatively, in accordance with the
+** terms contained in a written agreement between you and TU Wien, ACIN, V4R.
+** For licensing terms and conditions please contact office<at>acin.tuwien.ac.at.
+**
+**
+** The copyright holder additionally grants the author(s) of the file the right
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or
+** sell copies of their contributions without any restrictions.
+**
+****************************************************************************/
+
+/**
+ * @file   entangled_forest_inference.h
+ * @brief  Flat, inference-only representation of a trained entangled forest.
+ *
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <v4r/core/macros.h>
+#include <v4r/semantic_segmentation/entangled_data.h>
+#include <v4r/semantic_segmentation/entangled_forest.h>
+
+namespace v4r {
+
+/**
+ * Compiled form of an EntangledForest for classification only. The nodes of each tree are stored breadth-first in
+ * contiguous arrays (one array per node attribute) and split functions are packed into a type tag and a few
+ * parameters, so traversal does not touch node objects or virtual feature calls. All trees are evaluated level by
+ * level in parallel. The classification result is identical to EntangledForest::SoftClassify.
+ */
+class V4R_EXPORTS EntangledForestInference {
+ public:
+  enum SplitType : unsigned char {
+    LEAF = 0,
+    UNARY,
+    CLUSTER_EXISTS,
+    TOP_N,
+    INVERSE_TOP_N,
+    COMMON_ANCESTOR,
+    NODE_DESCENDANT
+  };
+
+ private:
+  static const int NUM_SPLIT_VALUES = 5;  // threshold (unary) or min/max angle, min/max point-plane distance and
+                                          // max euclidean distance (pairwise)
+
+  struct FlatTree {
+    std::vector<int> mParent;  // -1 for root node
+    std::vector<int> mDepth;
+    std::vector<int> mLeftChild;
+    std::vector<int> mRightChild;
+    std::vector<unsigned char> mSplitType;
+    std::vector<unsigned char> mHorizontal;
+    std::vector<int> mParamA;            // unary feature idx, label, max steps or ancestor node (depending on type)
+    std::vector<int> mParamB;            // N of top N features
+    std::vector<double> mSplitValues;    // NUM_SPLIT_VALUES per node
+    std::vector<double> mLabelDist;      // mNLabels per node
+    std::vector<unsigned short> mRanks;  // mNLabels per node, number of labels with higher probability
+
+    bool IsDescendantOf(int node, int ancestor) const;
+    bool ShareAncestor(int node1, int node2, int maxSteps) const;
+  };
+
+  std::vector<FlatTree> mTrees;
+  int mNLabels;
+  std::map<int, int> mLabelMap;
+  std::vector<std::string> mLabelNames;
+
+  void CompileTree(EntangledForestTree *tree, FlatTree &flat);
+  bool EvaluateSplit(const FlatTree &tree, int node, EntangledForestData *data, int clusterIdx,
+                     const int *clusterNodeIdxs, std::vector<int> &remaining) const;
+
+ public:
+  EntangledForestInference();
+  EntangledForestInference(EntangledForest &forest);
+
+  void Classify(EntangledForestData *data, std::vector<int> &result, int maxDepth = -1, int useNTrees = -1) const;
+  void SoftClassify(EntangledForestData *data, std::vector<std::vector<double>> &result, int maxDepth = -1,
+                    int useNTrees = -1) const;
+  void GetHardClassificationResult(const std::vector<std::vector<double>> &softResult, std::vector<int> &result) const;
+
+  // flat binary format (native byte order), much faster to load than the serialized EntangledForest
+  void SaveToBinaryFile(std::string filename) const;
+  static bool LoadFromBinaryFile(std::string filename, EntangledForestInference &f);  // false if not a flat file
+
+  inline int GetNrOfTrees() const {
+    return mTrees.size();
+  }
+  inline int GetNrOfLabels() const {
+    return mNLabels;
+  }
+  inline const std::map<int, int> &GetLabelMap() const {
+    return mLabelMap;
+  }
+  inline const std::vector<std::string> &GetLabelNames() const {
+    return mLabelNames;
+  }
+};
+}  // namespace v4r
@@ -130,6 +130,9 @@ class V4R_EXPORTS EntangledForestSplitFeature {
   int GetMaxParameterSamples();
   std::string GetName();
   void SetThreshold(double t);
+  double GetThreshold() const {
+    return mThreshold;
+  }
   void SetRandomGenerator(std::mt19937* randomGenerator);  // necessary after load from file
 
   // to be overridden
@@ -108,9 +108,31 @@ void EntangledForestFeatureExtraction::setCameraExtrinsics(double height, Eigen:
   mCameraHeight = height;
 }
 
-void EntangledForestFeatureExtraction::CalculatePairwiseFeatures(std::vector<Eigen::Vector3f> &centroids,
-                                                                 std::vector<Eigen::Vector3f> &normals,
-                                                                 std::vector<double> &verticalAngles) {
+namespace {
+// safety margin for bounding sphere lower bounds, so rounding can never skip the true minimum
+const float BOUNDS_MARGIN = 1e-4f;
+
+// bounding sphere of a set of points (center of bounding box), used as early-out for minimum distance searches
+template <typename PointIterator>
+void ComputeBoundingSphere(PointIterator begin, PointIterator end, Eigen::Vector3f &center, float &radius) {
+  Eigen::Vector3f minPt = Eigen::Vector3f::Constant(std::numeric_limits<float>::max());
+  Eigen::Vector3f maxPt = Eigen::Vector3f::Constant(-std::numeric_limits<float>::max());
+
+  for (PointIterator it = begin; it != end; ++it) {
+    minPt = minPt.cwiseMin(it->getVector3fMap());
+    maxPt = maxPt.cwiseMax(it->getVector3fMap());
+  }
+
+  center = 0.5f * (minPt + maxPt);
+  radius = 0.0f;
+
+  for (PointIterator it = begin; it != end; ++it) {
+    radius = std::max(radius, (it->getVector3fMap() - center).norm());
+  }
+}
+}  // namespace
+
+void EntangledForestFeatureExtraction::InitPairwiseFeatures() {
   mPairwiseEuclid.clear();
   mPairwiseEuclid.resize(mNrOfSegments, std::vector<std::pair<double, int>>(mNrOfSegments - 1));
   mPairwisePtPl.clear();
@@ -121,11 +143,69 @@ void EntangledForestFeatureExtraction::CalculatePairwiseFeatures(std::vector<Eig
   mPairwiseVAngle.resize(mNrOfSegments, std::vector<std::pair<double, int>>(mNrOfSegments - 1));
   mPairwiseHAngle.clear();
   mPairwiseHAngle.resize(mNrOfSegments, std::vector<std::pair<double, int>>(mNrOfSegments - 1));
+}
+
+void EntangledForestFeatureExtraction::SetPairwiseFeatures(int segidx1, int segidx2, double minEDist,
+                                                           double minPtPlDist1, double minPtPlDist2, double hordiff,
+                                                           double verdiff) {
+  // every segment pair writes its own entries, so this is safe to call for different pairs in parallel
+  mPairwiseEuclid[segidx1][segidx2 - 1].first = minEDist;
+  mPairwiseEuclid[segidx1][segidx2 - 1].second = segidx2;
+  mPairwiseEuclid[segidx2][segidx1].first = minEDist;
+  mPairwiseEuclid[segidx2][segidx1].second = segidx1;
+
+  mPairwisePtPl[segidx1][segidx2 - 1].first = minPtPlDist1;
+  mPairwisePtPl[segidx1][segidx2 - 1].second = segidx2;
+  mPairwisePtPl[segidx2][segidx1].first = minPtPlDist2;
+  mPairwisePtPl[segidx2][segidx1].second = segidx1;
+
+  mPairwiseIPtPl[segidx1][segidx2 - 1].first = minPtPlDist2;
+  mPairwiseIPtPl[segidx1][segidx2 - 1].second = segidx2;
+  mPairwiseIPtPl[segidx2][segidx1].first = minPtPlDist1;
+  mPairwiseIPtPl[segidx2][segidx1].second = segidx1;
+
+  mPairwiseHAngle[segidx1][segidx2 - 1].first = hordiff;
+  mPairwiseHAngle[segidx1][segidx2 - 1].second = segidx2;
+  mPairwiseHAngle[segidx2][segidx1].first = -hordiff;
+  mPairwiseHAngle[segidx2][segidx1].second = segidx1;
+
+  mPairwiseVAngle[segidx1][segidx2 - 1].first = verdiff;
+  mPairwiseVAngle[segidx1][segidx2 - 1].second = segidx2;
+  mPairwiseVAngle[segidx2][segidx1].first = -verdiff;
+  mPairwiseVAngle[segidx2][segidx1].second = segidx1;
+}
+
+void EntangledForestFeatureExtraction::SortPairwiseFeatures() {
+#pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < mNrOfSegments; ++i) {
+    std::sort(mPairwiseEuclid[i].begin(), mPairwiseEuclid[i].end(), PairwiseComparator);
+    std::sort(mPairwisePtPl[i].begin(), mPairwisePtPl[i].end(), PairwiseComparator);
+    std::sort(mPairwiseIPtPl[i].begin(), mPairwiseIPtPl[i].end(), PairwiseComparator);
+    std::sort(mPairwiseHAngle[i].begin(), mPairwiseHAngle[i].end(), PairwiseComparator);
+    std::sort(mPairwiseVAngle[i].begin(), mPairwiseVAngle[i].end(), PairwiseComparator);
+  }
+}
+
+void EntangledForestFeatureExtraction::CalculatePairwiseFeatures(std::vector<Eigen::Vector3f> &centroids,
+                                                                 std::vector<Eigen::Vector3f> &normals,
+                                                                 std::vector<double> &verticalAngles) {
+  InitPairwiseFeatures();
 
+  // build search structures once per frame: a kd-tree and a bounding sphere for each segment
+  std::vector<pcl::KdTreeFLANN<pcl::PointXYZRGB>> trees(mNrOfSegments);
+  std::vector<Eigen::Vector3f> sphereCenters(mNrOfSegments);
+  std::vector<float> sphereRadii(mNrOfSegments);
+
+#pragma omp parallel for schedule(dynamic)
+  for (int s = 0; s < mNrOfSegments; ++s) {
+    ComputeBoundingSphere(mSegments[s]->points.begin(), mSegments[s]->points.end(), sphereCenters[s], sphereRadii[s]);
+    if (!mSegments[s]->points.empty())
+      trees[s].setInputCloud(mSegments[s]);
+  }
+
+#pragma omp parallel for schedule(dynamic)
   for (int segidx1 = 0; segidx1 < mNrOfSegments - 1; ++segidx1) {
     pcl::PointCloud<pcl::PointXYZRGB>::Ptr seg1 = mSegments[segidx1];
-    pcl::KdTreeFLANN<pcl::PointXYZRGB> tree;
-    tree.setInputCloud(seg1);
 
     // for ptpl
     Eigen::Vector3f c1 = centroids[segidx1];
@@ -136,6 +216,10 @@ void EntangledForestFeatureExtraction::CalculatePairwiseFeatures(std::vector<Eig
     Eigen::Vector2d h1;
     h1 << n1[0], n1[2];
 
+    std::vector<int> eidx(1);
+    std::vector<float> edist(1);
+    std::vector<float> lowerBounds;
+
     for (int segidx2 = segidx1 + 1; segidx2 < mNrOfSegments; ++segidx2) {
       pcl::PointCloud<pcl::PointXYZRGB>::Ptr seg2 = mSegments[segidx2];
 
@@ -152,19 +236,44 @@ void EntangledForestFeatureExtraction::CalculatePairwiseFeatures(std::vector<Eig
       float minPtPlDist1 = std::numeric_limits<float>::max();
       float minPtPlDist2 = std::numeric_limits<float>::max();
 
-      // TODO: This is going to be much slower now, since we compute distances of all POINTS and not
-      // centroids of SVs any more!!!
-      // calculate min distance between segment1 and segment2
-      std::vector<int> eidx(1);
-      std::vector<float> edist(1);
+      // calculate min distance between segment1 and segment2: query the points of the smaller segment in the tree
+      // of the larger one. Points that are farther away from the bounding sphere of the larger segment than the
+      // current minimum cannot be closer and are skipped. Start with the point closest to the sphere to get a tight
+      // bound early.
+      const bool querySeg2 = seg2->points.size() <= seg1->points.size();
+      const pcl::PointCloud<pcl::PointXYZRGB> &query = querySeg2 ? *seg2 : *seg1;
+      const int target = querySeg2 ? segidx1 : segidx2;
+
+      if (!query.points.empty() && !mSegments[target]->points.empty()) {
+        lowerBounds.resize(query.points.size());
+        size_t closest = 0;
+        for (size_t ptidx = 0; ptidx < query.points.size(); ++ptidx) {
+          lowerBounds[ptidx] =
+              (query.points[ptidx].getVector3fMap() - sphereCenters[target]).norm() - sphereRadii[target] -
+              BOUNDS_MARGIN;
+          if (lowerBounds[ptidx] < lowerBounds[closest])
+            closest = ptidx;
+        }
 
-      for (unsigned int ptidx2 = 0; ptidx2 < seg2->points.size(); ++ptidx2) {
-        tree.nearestKSearch(seg2->at(ptidx2), 1, eidx, edist);
+        trees[target].nearestKSearch(query.points[closest], 1, eidx, edist);
+        minEDist = edist[0];
+
+        for (size_t ptidx = 0; ptidx < query.points.size(); ++ptidx) {
+          const float lb = lowerBounds[ptidx];
+          if (ptidx == closest || (lb > 0 && lb * lb >= minEDist))
+            continue;
 
-        if (edist[0] < minEDist) {
-          minEDist = edist[0];
+          trees[target].nearestKSearch(query.points[ptidx], 1, eidx, edist);
+
+          if (edist[0] < minEDist) {
+            minEDist = edist[0];
+          }
         }
+      }
 
+      minEDist = sqrt(minEDist);
+
+      for (unsigned int ptidx2 = 0; ptidx2 < seg2->points.size(); ++ptidx2) {
         // also calc. ptpl
         Eigen::Vector3f pt2 = seg2->at(ptidx2).getVector3fMap();
         float d = std::abs(n1.dot(pt2 - c1));
@@ -174,8 +283,6 @@ void EntangledForestFeatureExtraction::CalculatePairwiseFeatures(std::vector<Eig
         }
       }
 
-      minEDist = sqrt(minEDist);
-
       for (unsigned int ptidx1 = 0; ptidx1 < seg1->points.size(); ++ptidx1) {
         // also calc. ptpl
         Eigen::Vector3f pt1 = seg1->at(ptidx1).getVector3fMap();
@@ -191,58 +298,24 @@ void EntangledForestFeatureExtraction::CalculatePairwiseFeatures(std::vector<Eig
       double hordiff = acos(std::max(-1.0, std::min(1.0, h2.dot(h1) / (h2.norm() * h1.norm()))));
       double verdiff = v2 - v1;
 
-      mPairwiseEuclid[segidx1][segidx2 - 1].first = minEDist;
-      mPairwiseEuclid[segidx1][segidx2 - 1].second = segidx2;
-      mPairwiseEuclid[segidx2][segidx1].first = minEDist;
-      mPairwiseEuclid[segidx2][segidx1].second = segidx1;
-
-      mPairwisePtPl[segidx1][segidx2 - 1].first = minPtPlDist1;
-      mPairwisePtPl[segidx1][segidx2 - 1].second = segidx2;
-      mPairwisePtPl[segidx2][segidx1].first = minPtPlDist2;
-      mPairwisePtPl[segidx2][segidx1].second = segidx1;
-
-      mPairwiseIPtPl[segidx1][segidx2 - 1].first = minPtPlDist2;
-      mPairwiseIPtPl[segidx1][segidx2 - 1].second = segidx2;
-      mPairwiseIPtPl[segidx2][segidx1].first = minPtPlDist1;
-      mPairwiseIPtPl[segidx2][segidx1].second = segidx1;
-
-      mPairwiseHAngle[segidx1][segidx2 - 1].first = hordiff;
-      mPairwiseHAngle[segidx1][segidx2 - 1].second = segidx2;
-      mPairwiseHAngle[segidx2][segidx1].first = -hordiff;
-      mPairwiseHAngle[segidx2][segidx1].second = segidx1;
-
-      mPairwiseVAngle[segidx1][segidx2 - 1].first = verdiff;
-      mPairwiseVAngle[segidx1][segidx2 - 1].second = segidx2;
-      mPairwiseVAngle[segidx2][segidx1].first = -verdiff;
-      mPairwiseVAngle[segidx2][segidx1].second = segidx1;
+      SetPairwiseFeatures(segidx1, segidx2, minEDist, minPtPlDist1, minPtPlDist2, hordiff, verdiff);
     }
   }
 
-  for (int i = 0; i < mNrOfSegments; ++i) {
-    std::sort(mPairwiseEuclid[i].begin(), mPairwiseEuclid[i].end(), PairwiseComparator);
-    std::sort(mPairwisePtPl[i].begin(), mPairwisePtPl[i].end(), PairwiseComparator);
-    std::sort(mPairwiseIPtPl[i].begin(), mPairwiseIPtPl[i].end(), PairwiseComparator);
-    std::sort(mPairwiseHAngle[i].begin(), mPairwiseHAngle[i].end(), PairwiseComparator);
-    std::sort(mPairwiseVAngle[i].begin(), mPairwiseVAngle[i].end(), PairwiseComparator);
-  }
+  SortPairwiseFeatures();
 }
 
 void EntangledForestFeatureExtraction::CalculatePairwiseFeaturesOctree(std::vector<Eigen::Vector3f> &centroids,
                                                                        std::vector<Eigen::Vector3f> &normals,
                                                                        std::vector<double> &verticalAngles) {
-  mPairwiseEuclid.clear();
-  mPairwiseEuclid.resize(mNrOfSegments, std::vector<std::pair<double, int>>(mNrOfSegments - 1));
-  mPairwisePtPl.clear();
-  mPairwisePtPl.resize(mNrOfSegments, std::vector<std::pair<double, int>>(mNrOfSegments - 1));
-  mPairwiseIPtPl.clear();
-  mPairwiseIPtPl.resize(mNrOfSegments, std::vector<std::pair<double, int>>(mNrOfSegments - 1));
-  mPairwiseVAngle.clear();
-  mPairwiseVAngle.resize(mNrOfSegments, std::vector<std::pair<double, int>>(mNrOfSegments - 1));
-  mPairwiseHAngle.clear();
-  mPairwiseHAngle.resize(mNrOfSegments, std::vector<std::pair<double, int>>(mNrOfSegments - 1));
+  InitPairwiseFeatures();
 
   std::vector<pcl::octree::OctreePointCloudVoxelCentroid<pcl::PointXYZ>::AlignedPointTVector> vectorOfSeeds(
       mNrOfSegments);
+  std::vector<Eigen::Vector3f> sphereCenters(mNrOfSegments);
+  std::vector<float> sphereRadii(mNrOfSegments);
+
+#pragma omp parallel for schedule(dynamic)
   for (int s = 0; s < mNrOfSegments; ++s) {
     pcl::PointCloud<pcl::PointXYZ>::Ptr tmp(new pcl::PointCloud<pcl::PointXYZ>);
     pcl::copyPointCloud(*mSegments[s], *tmp);
@@ -250,11 +323,11 @@ void EntangledForestFeatureExtraction::CalculatePairwiseFeaturesOctree(std::vect
     octree.setInputCloud(tmp);
     octree.addPointsFromInputCloud();
     octree.getVoxelCentroids(vectorOfSeeds[s]);
+    ComputeBoundingSphere(vectorOfSeeds[s].begin(), vectorOfSeeds[s].end(), sphereCenters[s], sphereRadii[s]);
   }
 
+#pragma omp parallel for schedule(dynamic)
   for (int segidx1 = 0; segidx1 < mNrOfSegments - 1; ++segidx1) {
-    //        pcl::PointCloud<pcl::PointXYZRGBNormal>::Ptr seg1 = segments[segidx1];
-
     // for ptpl
     Eigen::Vector3f c1 = centroids[segidx1];
     Eigen::Vector3f n1 = normals[segidx1];
@@ -265,8 +338,6 @@ void EntangledForestFeatureExtraction::CalculatePairwiseFeaturesOctree(std::vect
     h1 << n1[0], n1[2];
 
     for (int segidx2 = segidx1 + 1; segidx2 < mNrOfSegments; ++segidx2) {
-      //            pcl::PointCloud<pcl::PointXYZRGBNormal>::Ptr seg2 = segments[segidx2];
-
       // for ptpl
       Eigen::Vector3f c2 = centroids[segidx2];
       Eigen::Vector3f n2 = normals[segidx2];
@@ -280,16 +351,21 @@ void EntangledForestFeatureExtraction::CalculatePairwiseFeaturesOctree(std::vect
       float minPtPlDist1 = std::numeric_limits<float>::max();
       float minPtPlDist2 = std::numeric_limits<float>::max();
 
-      // TODO: This is going to be much slower now, since we compute distances of all POINTS and not
-      // centroids of SVs any more!!!
-      // calculate min distance between segment1 and segment2
-      std::vector<int> eidx(1);
-      std::vector<float> edist(1);
-
-      //            for(int ptidx2=0; ptidx2 < seg2->points.size(); ++ptidx2)
+      // calculate min distance between the voxel centroids of segment1 and segment2, skipping centroids of
+      // segment1 which are farther away from the bounding sphere of segment2 than the current minimum
       for (unsigned int ptidx1 = 0; ptidx1 < vectorOfSeeds[segidx1].size(); ++ptidx1) {
         Eigen::Vector3f pt1 = vectorOfSeeds[segidx1][ptidx1].getVector3fMap();
 
+        // also calc. ptpl
+        float d2 = std::abs(n2.dot(pt1 - c2));
+
+        if (d2 < minPtPlDist2) {
+          minPtPlDist2 = d2;
+        }
+
+        if ((pt1 - sphereCenters[segidx2]).norm() - sphereRadii[segidx2] - BOUNDS_MARGIN >= minEDist)
+          continue;
+
         for (unsigned int ptidx2 = 0; ptidx2 < vectorOfSeeds[segidx2].size(); ++ptidx2) {
           Eigen::Vector3f pt2 = vectorOfSeeds[segidx2][ptidx2].getVector3fMap();
           float dist = (pt1 - pt2).norm();
@@ -297,20 +373,16 @@ void EntangledForestFeatureExtraction::CalculatePairwiseFeaturesOctree(std::vect
           if (dist < minEDist) {
             minEDist = dist;
           }
-
-          // also calc. ptpl
-          float d = std::abs(n1.dot(pt2 - c1));
-
-          if (d < minPtPlDist1) {
-            minPtPlDist1 = d;
-          }
         }
+      }
 
+      for (unsigned int ptidx2 = 0; ptidx2 < vectorOfSeeds[segidx2].size(); ++ptidx2) {
         // also calc. ptpl
-        float d2 = std::abs(n2.dot(pt1 - c2));
+        Eigen::Vector3f pt2 = vectorOfSeeds[segidx2][ptidx2].getVector3fMap();
+        float d = std::abs(n1.dot(pt2 - c1));
 
-        if (d2 < minPtPlDist2) {
-          minPtPlDist2 = d2;
+        if (d < minPtPlDist1) {
+          minPtPlDist1 = d;
         }
       }
 
@@ -319,40 +391,11 @@ void EntangledForestFeatureExtraction::CalculatePairwiseFeaturesOctree(std::vect
       double hordiff = acos(std::max(-1.0, std::min(1.0, h2.dot(h1) / (h2.norm() * h1.norm()))));
       double verdiff = v2 - v1;
 
-      mPairwiseEuclid[segidx1][segidx2 - 1].first = minEDist;
-      mPairwiseEuclid[segidx1][segidx2 - 1].second = segidx2;
-      mPairwiseEuclid[segidx2][segidx1].first = minEDist;
-      mPairwiseEuclid[segidx2][segidx1].second = segidx1;
-
-      mPairwisePtPl[segidx1][segidx2 - 1].first = minPtPlDist1;
-      mPairwisePtPl[segidx1][segidx2 - 1].second = segidx2;
-      mPairwisePtPl[segidx2][segidx1].first = minPtPlDist2;
-      mPairwisePtPl[segidx2][segidx1].second = segidx1;
-
-      mPairwiseIPtPl[segidx1][segidx2 - 1].first = minPtPlDist2;
-      mPairwiseIPtPl[segidx1][segidx2 - 1].second = segidx2;
-      mPairwiseIPtPl[segidx2][segidx1].first = minPtPlDist1;
-      mPairwiseIPtPl[segidx2][segidx1].second = segidx1;
-
-      mPairwiseHAngle[segidx1][segidx2 - 1].first = hordiff;
-      mPairwiseHAngle[segidx1][segidx2 - 1].second = segidx2;
-      mPairwiseHAngle[segidx2][segidx1].first = -hordiff;
-      mPairwiseHAngle[segidx2][segidx1].second = segidx1;
-
-      mPairwiseVAngle[segidx1][segidx2 - 1].first = verdiff;
-      mPairwiseVAngle[segidx1][segidx2 - 1].second = segidx2;
-      mPairwiseVAngle[segidx2][segidx1].first = -verdiff;
-      mPairwiseVAngle[segidx2][segidx1].second = segidx1;
+      SetPairwiseFeatures(segidx1, segidx2, minEDist, minPtPlDist1, minPtPlDist2, hordiff, verdiff);
     }
   }
 
-  for (int i = 0; i < mNrOfSegments; ++i) {
-    std::sort(mPairwiseEuclid[i].begin(), mPairwiseEuclid[i].end(), PairwiseComparator);
-    std::sort(mPairwisePtPl[i].begin(), mPairwisePtPl[i].end(), PairwiseComparator);
-    std::sort(mPairwiseIPtPl[i].begin(), mPairwiseIPtPl[i].end(), PairwiseComparator);
-    std::sort(mPairwiseHAngle[i].begin(), mPairwiseHAngle[i].end(), PairwiseComparator);
-    std::sort(mPairwiseVAngle[i].begin(), mPairwiseVAngle[i].end(), PairwiseComparator);
-  }
+  SortPairwiseFeatures();
 }
 
 void EntangledForestFeatureExtraction::extract() {
@@ -60,6 +60,7 @@ EntangledForest::EntangledForest() {
   mMinInformationGain = 0.02;
   mMinPointsForSplit = 5;
   mBaggingRatio = 0.5;
+  mParallelTreeInference = false;
 
   std::random_device rd;
   mRandomGenerator = std::mt19937(rd());
@@ -75,6 +76,7 @@ EntangledForest::EntangledForest(int nTrees, int maxDepth, float baggingRatio, i
   this->mMinInformationGain = minInformationGain;
   this->mMinPointsForSplit = minPointsForSplit;
   this->mBaggingRatio = baggingRatio;
+  this->mParallelTreeInference = false;
 
   std::random_device rd;
   mRandomGenerator = std::mt19937(rd());
@@ -93,14 +95,34 @@ void EntangledForest::SoftClassify(EntangledForestData *data, std::vector<std::v
   // initialize cluster node index arrays
   data->AddTreesToClusterNodeIdx(useNTrees);
 
-  // get label distribution for every tree
-  for (int i = 0; i < useNTrees; ++i) {
-    std::vector<std::vector<double>> treeResult;
-    mTrees[i]->Classify(data, treeResult, maxDepth);
+  if (mParallelTreeInference) {
+    // trees only depend on their own cluster node indices, so they can be classified concurrently (the level loops
+    // inside each tree then run single-threaded, as nested parallelism is disabled)
+    std::vector<std::vector<std::vector<double>>> treeResults(useNTrees);
 
+#pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < useNTrees; ++i) {
+      mTrees[i]->Classify(data, treeResults[i], maxDepth);
+    }
+
+    // accumulate per cluster in tree order, so the result does not depend on the number of threads
+#pragma omp parallel for
     for (int j = 0; j < nclusters; ++j) {
-      std::transform(treeResult[j].begin(), treeResult[j].end(), result[j].begin(), result[j].begin(),
-                     std::plus<double>());
+      for (int i = 0; i < useNTrees; ++i) {
+        std::transform(treeResults[i][j].begin(), treeResults[i][j].end(), result[j].begin(), result[j].begin(),
+                       std::plus<double>());
+      }
+    }
+  } else {
+    // get label distribution for every tree
+    for (int i = 0; i < useNTrees; ++i) {
+      std::vector<std::vector<double>> treeResult;
+      mTrees[i]->Classify(data, treeResult, maxDepth);
+
+      for (int j = 0; j < nclusters; ++j) {
+        std::transform(treeResult[j].begin(), treeResult[j].end(), result[j].begin(), result[j].begin(),
+                       std::plus<double>());
+      }
     }
   }
 
@@ -0,0 +1,472 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 TU Wien, ACIN, Vision 4 Robotics (V4R) group
+** Contact: v4r.acin.tuwien.ac.at
+**
+** This file is part of V4R
+**
+** V4R is distributed under dual licenses - GPLv3 or closed source.
+**
+** GNU General Public License Usage
+** V4R is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published
+** by the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** V4R is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** Please review the following information to ensure the GNU General Public
+** License requirements will be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+**
+** Commercial License Usage
+** If GPL is not suitable for your project, you must purchase a commercial
+** license to use V4R. Licensees holding valid commercial V4R licenses may
+** use this file in accordance with the commercial license agreement
+** provided with the Software or, alternatively, in accordance with the
+** terms contained in a written agreement between you and TU Wien, ACIN, V4R.
+** For licensing terms and conditions please contact office<at>acin.tuwien.ac.at.
+**
+**
+** The copyright holder additionally grants the author(s) of the file the right
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or
+** sell copies of their contributions without any restrictions.
+**
+****************************************************************************/
+
+/**
+ * @file   entangled_forest_inference.cpp
+ * @brief  Flat, inference-only representation of a trained entangled forest.
+ *
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <limits>
+
+#include <v4r/semantic_segmentation/entangled_forest_inference.h>
+#include <v4r/semantic_segmentation/entangled_node.h>
+#include <v4r/semantic_segmentation/entangled_split_feature.h>
+#include <v4r/semantic_segmentation/entangled_tree.h>
+
+namespace v4r {
+
+namespace {
+const char FLAT_FOREST_MAGIC[8] = {'V', '4', 'R', 'E', 'F', 'F', 'L', 'T'};
+const unsigned int FLAT_FOREST_VERSION = 1;
+
+template <typename T>
+void WriteValue(std::ofstream &ofs, const T &value) {
+  ofs.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T>
+void WriteVector(std::ofstream &ofs, const std::vector<T> &v) {
+  WriteValue(ofs, (unsigned long long)v.size());
+  if (!v.empty())
+    ofs.write(reinterpret_cast<const char *>(v.data()), v.size() * sizeof(T));
+}
+
+template <typename T>
+bool ReadValue(std::ifstream &ifs, T &value) {
+  return static_cast<bool>(ifs.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+
+template <typename T>
+bool ReadVector(std::ifstream &ifs, std::vector<T> &v) {
+  unsigned long long size;
+  if (!ReadValue(ifs, size))
+    return false;
+  v.resize(size);
+  return size == 0 || static_cast<bool>(ifs.read(reinterpret_cast<char *>(v.data()), size * sizeof(T)));
+}
+}  // namespace
+
+EntangledForestInference::EntangledForestInference() : mNLabels(0) {}
+
+EntangledForestInference::EntangledForestInference(EntangledForest &forest)
+: mLabelMap(forest.GetLabelMap()), mLabelNames(forest.GetLabelNames()) {
+  mNLabels = mLabelMap.size();
+  mTrees.resize(forest.GetNrOfTrees());
+
+  for (int t = 0; t < forest.GetNrOfTrees(); ++t) {
+    CompileTree(forest.GetTree(t), mTrees[t]);
+  }
+}
+
+void EntangledForestInference::CompileTree(EntangledForestTree *tree, FlatTree &flat) {
+  const int nnodes = tree->GetNrOfNodes();
+
+  // breadth-first order (trained trees are already stored this way, but merged or updated ones might not)
+  std::vector<int> order;
+  std::vector<int> newIdx(nnodes, -1);
+  std::deque<int> queue(1, 0);
+  order.reserve(nnodes);
+
+  while (!queue.empty()) {
+    int n = queue.front();
+    queue.pop_front();
+    newIdx[n] = order.size();
+    order.push_back(n);
+
+    EntangledForestNode *node = tree->GetNode(n);
+    if (node->IsSplitNode()) {
+      queue.push_back(node->GetLeftChildIdx());
+      queue.push_back(node->GetRightChildIdx());
+    }
+  }
+
+  const int nflat = order.size();
+  flat.mParent.assign(nflat, -1);
+  flat.mDepth.assign(nflat, 0);
+  flat.mLeftChild.assign(nflat, -1);
+  flat.mRightChild.assign(nflat, -1);
+  flat.mSplitType.assign(nflat, LEAF);
+  flat.mHorizontal.assign(nflat, 0);
+  flat.mParamA.assign(nflat, 0);
+  flat.mParamB.assign(nflat, 0);
+  flat.mSplitValues.assign(nflat * NUM_SPLIT_VALUES, 0.0);
+  flat.mLabelDist.assign(nflat * mNLabels, 0.0);
+  flat.mRanks.assign(nflat * mNLabels, std::numeric_limits<unsigned short>::max());
+
+  for (int i = 0; i < nflat; ++i) {
+    EntangledForestNode *node = tree->GetNode(order[i]);
+    flat.mDepth[i] = node->GetDepth();
+
+    // label distribution and rank of each label within it (for top N features)
+    std::vector<double> &dist = node->GetLabelDistribution();
+    const int nlabels = std::min<int>(dist.size(), mNLabels);
+    std::copy(dist.begin(), dist.begin() + nlabels, flat.mLabelDist.begin() + i * mNLabels);
+
+    if (!dist.empty()) {
+      for (int l = 0; l < mNLabels && l < (int)dist.size(); ++l) {
+        unsigned short larger = 0;
+        for (int k = 0; k < (int)dist.size(); ++k) {
+          if (k != l && dist[k] > dist[l])
+            larger++;
+        }
+        flat.mRanks[i * mNLabels + l] = larger;
+      }
+    }
+
+    if (!node->IsSplitNode())
+      continue;
+
+    flat.mLeftChild[i] = newIdx[node->GetLeftChildIdx()];
+    flat.mRightChild[i] = newIdx[node->GetRightChildIdx()];
+    flat.mParent[flat.mLeftChild[i]] = i;
+    flat.mParent[flat.mRightChild[i]] = i;
+
+    EntangledForestSplitFeature *f = node->GetSplitFeature();
+    double *values = &flat.mSplitValues[i * NUM_SPLIT_VALUES];
+    std::vector<double> geometry;
+
+    if (EntangledForestUnaryFeature *uf = dynamic_cast<EntangledForestUnaryFeature *>(f)) {
+      flat.mSplitType[i] = UNARY;
+      flat.mParamA[i] = uf->GetFeatureIdx();
+      values[0] = uf->GetThreshold();
+    } else if (EntangledForestClusterExistsFeature *ef = dynamic_cast<EntangledForestClusterExistsFeature *>(f)) {
+      flat.mSplitType[i] = CLUSTER_EXISTS;
+      flat.mHorizontal[i] = ef->IsHorizontal();
+      geometry = ef->GetGeometryParameters();
+    } else if (EntangledForestTopNFeature *tf = dynamic_cast<EntangledForestTopNFeature *>(f)) {
+      flat.mSplitType[i] = TOP_N;
+      flat.mHorizontal[i] = tf->IsHorizontal();
+      flat.mParamA[i] = tf->GetLabel();
+      flat.mParamB[i] = tf->GetN();
+      geometry = tf->GetGeometryParameters();
+    } else if (EntangledForestInverseTopNFeature *itf = dynamic_cast<EntangledForestInverseTopNFeature *>(f)) {
+      flat.mSplitType[i] = INVERSE_TOP_N;
+      flat.mParamA[i] = itf->GetLabel();
+      flat.mParamB[i] = itf->GetN();
+      geometry = itf->GetGeometryParameters();
+    } else if (EntangledForestCommonAncestorFeature *af = dynamic_cast<EntangledForestCommonAncestorFeature *>(f)) {
+      flat.mSplitType[i] = COMMON_ANCESTOR;
+      flat.mHorizontal[i] = af->IsHorizontal();
+      flat.mParamA[i] = af->GetMaxSteps();
+      geometry = af->GetGeometryParameters();
+    } else if (EntangledForestNodeDescendantFeature *df = dynamic_cast<EntangledForestNodeDescendantFeature *>(f)) {
+      flat.mSplitType[i] = NODE_DESCENDANT;
+      flat.mHorizontal[i] = df->IsHorizontal();
+      int ancestor = df->GetAncestorNodeID();
+      flat.mParamA[i] = (ancestor >= 0 && ancestor < nnodes) ? newIdx[ancestor] : -1;
+      geometry = df->GetGeometryParameters();
+    } else {
+      LOG_ERROR("Unknown split feature " << f->GetName() << " in tree " << tree->GetIndex()
+                                         << ". Node is treated as leaf.");
+      flat.mLeftChild[i] = flat.mRightChild[i] = -1;
+      continue;
+    }
+
+    std::copy(geometry.begin(), geometry.end(), values);
+  }
+}
+
+bool EntangledForestInference::FlatTree::IsDescendantOf(int node, int ancestor) const {
+  if (node == ancestor || ancestor < 0) {
+    return false;
+  }
+
+  for (int i = mDepth[node]; i > mDepth[ancestor]; --i) {
+    node = mParent[node];
+  }
+
+  return node == ancestor;
+}
+
+bool EntangledForestInference::FlatTree::ShareAncestor(int node1, int node2, int maxSteps) const {
+  // bring deeper node up to the depth level of the other one
+  for (int i = mDepth[node1]; i > mDepth[node2]; --i) {
+    node1 = mParent[node1];
+  }
+  for (int i = mDepth[node2]; i > mDepth[node1]; --i) {
+    node2 = mParent[node2];
+  }
+
+  node1 = mParent[node1];
+  node2 = mParent[node2];
+
+  for (int steps = 1; steps <= maxSteps && node1 >= 0 && node2 >= 0; ++steps) {
+    if (node1 == node2) {
+      return true;
+    }
+
+    node1 = mParent[node1];
+    node2 = mParent[node2];
+  }
+
+  return false;
+}
+
+bool EntangledForestInference::EvaluateSplit(const FlatTree &tree, int node, EntangledForestData *data, int clusterIdx,
+                                             const int *clusterNodeIdxs, std::vector<int> &remaining) const {
+  const unsigned char type = tree.mSplitType[node];
+  const double *v = &tree.mSplitValues[node * NUM_SPLIT_VALUES];
+
+  if (type == UNARY) {
+    return data->GetUnaryFeature(0, clusterIdx, tree.mParamA[node]) > v[0];
+  }
+
+  // pairwise features: first filter clusters by geometric constraints
+  remaining.clear();
+  if (type == INVERSE_TOP_N) {
+    data->FilterClustersByInversePtPl(0, clusterIdx, v[0], v[1], v[2], v[3], v[4], remaining);
+  } else {
+    data->FilterClustersByGeometry(0, clusterIdx, tree.mHorizontal[node], v[0], v[1], v[2], v[3], v[4], remaining);
+  }
+
+  if (type == CLUSTER_EXISTS) {
+    return !remaining.empty();
+  }
+
+  // then check if at least 1 remaining cluster (which has left the root node) fulfills the entangled criterion
+  const int a = tree.mParamA[node];
+  for (int r : remaining) {
+    const int other = clusterNodeIdxs[r];
+    if (other == 0) {
+      continue;
+    }
+
+    switch (type) {
+      case TOP_N:
+      case INVERSE_TOP_N:
+        if (tree.mRanks[other * mNLabels + a] < tree.mParamB[node])
+          return true;
+        break;
+      case COMMON_ANCESTOR:
+        if (tree.ShareAncestor(clusterNodeIdxs[clusterIdx], other, a))
+          return true;
+        break;
+      case NODE_DESCENDANT:
+        if (tree.IsDescendantOf(other, a))
+          return true;
+        break;
+      default:
+        break;
+    }
+  }
+
+  return false;
+}
+
+void EntangledForestInference::SoftClassify(EntangledForestData *data, std::vector<std::vector<double>> &result,
+                                            int maxDepth, int useNTrees) const {
+  std::map<int, int> labelMap = mLabelMap;
+  data->SetLabelMap(labelMap);
+
+  const int nclusters = data->GetNrOfClusters(0);
+  result.assign(nclusters, std::vector<double>(mNLabels, 0.0));
+
+  if (useNTrees <= 0 || useNTrees > (int)mTrees.size())
+    useNTrees = mTrees.size();
+
+  if (maxDepth <= 0)
+    maxDepth = std::numeric_limits<int>::max();
+
+  // current node of each cluster in each tree (tree idx -> cluster idx), all clusters start at the root
+  const int nitems = useNTrees * nclusters;
+  std::vector<int> nodeIdxs(nitems, 0);
+  std::vector<int> nextNodeIdxs(nitems, 0);
+
+  // expand nodes of all trees in parallel level by level. Entangled features of a cluster depend on the nodes the
+  // other clusters reached in the previous level of the same tree, so levels have to be synchronized.
+  bool done = false;
+  for (int d = 0; d < maxDepth && !done; ++d) {
+    done = true;
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+      std::vector<int> remaining;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 64) reduction(& : done)
+#endif
+      for (int i = 0; i < nitems; ++i) {
+        const int t = i / nclusters;
+        const FlatTree &tree = mTrees[t];
+        const int node = nodeIdxs[i];
+
+        if (tree.mSplitType[node] == LEAF) {
+          nextNodeIdxs[i] = node;
+        } else {
+          const bool right = EvaluateSplit(tree, node, data, i - t * nclusters, &nodeIdxs[t * nclusters], remaining);
+          nextNodeIdxs[i] = right ? tree.mRightChild[node] : tree.mLeftChild[node];
+          done = false;
+        }
+      }
+    }
+
+    nodeIdxs.swap(nextNodeIdxs);
+  }
+
+// average label distributions of the reached nodes over all trees
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (int c = 0; c < nclusters; ++c) {
+    std::vector<double> &r = result[c];
+
+    for (int t = 0; t < useNTrees; ++t) {
+      const double *dist = &mTrees[t].mLabelDist[nodeIdxs[t * nclusters + c] * mNLabels];
+      for (int l = 0; l < mNLabels; ++l) {
+        r[l] += dist[l];
+      }
+    }
+
+    for (int l = 0; l < mNLabels; ++l) {
+      r[l] /= useNTrees;
+    }
+  }
+}
+
+void EntangledForestInference::Classify(EntangledForestData *data, std::vector<int> &result, int maxDepth,
+                                        int useNTrees) const {
+  std::vector<std::vector<double>> softResult;
+  SoftClassify(data, softResult, maxDepth, useNTrees);
+  GetHardClassificationResult(softResult, result);
+}
+
+void EntangledForestInference::GetHardClassificationResult(const std::vector<std::vector<double>> &softResult,
+                                                           std::vector<int> &result) const {
+  std::vector<int> labelList;
+  for (std::map<int, int>::const_iterator it = mLabelMap.begin(); it != mLabelMap.end(); ++it) {
+    labelList.push_back(it->first);
+  }
+
+  result.resize(softResult.size(), 0);
+  for (size_t i = 0; i < softResult.size(); ++i) {
+    std::vector<double>::const_iterator max_prob = std::max_element(softResult[i].begin(), softResult[i].end());
+    result[i] = labelList[std::distance(softResult[i].begin(), max_prob)];
+  }
+}
+
+void EntangledForestInference::SaveToBinaryFile(std::string filename) const {
+  std::ofstream ofs(filename.c_str(), std::ios::binary);
+  ofs.write(FLAT_FOREST_MAGIC, sizeof(FLAT_FOREST_MAGIC));
+  WriteValue(ofs, FLAT_FOREST_VERSION);
+  WriteValue(ofs, mNLabels);
+
+  std::vector<int> labelMap;
+  for (std::map<int, int>::const_iterator it = mLabelMap.begin(); it != mLabelMap.end(); ++it) {
+    labelMap.push_back(it->first);
+    labelMap.push_back(it->second);
+  }
+  WriteVector(ofs, labelMap);
+
+  WriteValue(ofs, (unsigned long long)mLabelNames.size());
+  for (const std::string &name : mLabelNames) {
+    WriteVector(ofs, std::vector<char>(name.begin(), name.end()));
+  }
+
+  WriteValue(ofs, (unsigned long long)mTrees.size());
+  for (const FlatTree &t : mTrees) {
+    WriteVector(ofs, t.mParent);
+    WriteVector(ofs, t.mDepth);
+    WriteVector(ofs, t.mLeftChild);
+    WriteVector(ofs, t.mRightChild);
+    WriteVector(ofs, t.mSplitType);
+    WriteVector(ofs, t.mHorizontal);
+    WriteVector(ofs, t.mParamA);
+    WriteVector(ofs, t.mParamB);
+    WriteVector(ofs, t.mSplitValues);
+    WriteVector(ofs, t.mLabelDist);
+    WriteVector(ofs, t.mRanks);
+  }
+
+  ofs.close();
+}
+
+bool EntangledForestInference::LoadFromBinaryFile(std::string filename, EntangledForestInference &f) {
+  std::ifstream ifs(filename.c_str(), std::ios::binary);
+  char magic[sizeof(FLAT_FOREST_MAGIC)];
+  unsigned int version;
+
+  if (!ifs.read(magic, sizeof(magic)) || memcmp(magic, FLAT_FOREST_MAGIC, sizeof(magic)) != 0 ||
+      !ReadValue(ifs, version) || version != FLAT_FOREST_VERSION) {
+    return false;
+  }
+
+  std::vector<int> labelMap;
+  unsigned long long nnames, ntrees;
+  bool ok = ReadValue(ifs, f.mNLabels) && ReadVector(ifs, labelMap) && ReadValue(ifs, nnames);
+
+  f.mLabelMap.clear();
+  for (size_t i = 0; ok && i + 1 < labelMap.size(); i += 2) {
+    f.mLabelMap[labelMap[i]] = labelMap[i + 1];
+  }
+
+  f.mLabelNames.clear();
+  for (unsigned long long i = 0; ok && i < nnames; ++i) {
+    std::vector<char> name;
+    ok = ReadVector(ifs, name);
+    f.mLabelNames.push_back(std::string(name.begin(), name.end()));
+  }
+
+  ok = ok && ReadValue(ifs, ntrees);
+  f.mTrees.clear();
+  if (ok)
+    f.mTrees.resize(ntrees);
+
+  for (size_t i = 0; ok && i < f.mTrees.size(); ++i) {
+    FlatTree &t = f.mTrees[i];
+    ok = ReadVector(ifs, t.mParent) && ReadVector(ifs, t.mDepth) && ReadVector(ifs, t.mLeftChild) &&
+         ReadVector(ifs, t.mRightChild) && ReadVector(ifs, t.mSplitType) && ReadVector(ifs, t.mHorizontal) &&
+         ReadVector(ifs, t.mParamA) && ReadVector(ifs, t.mParamB) && ReadVector(ifs, t.mSplitValues) &&
+         ReadVector(ifs, t.mLabelDist) && ReadVector(ifs, t.mRanks);
+  }
+
+  if (!ok) {
+    LOG_ERROR("Flat forest file " << filename << " is truncated!");
+    f = EntangledForestInference();
+  }
+
+  return ok;
+}
+}  // namespace v4r
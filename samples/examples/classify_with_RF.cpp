@@ -33,6 +33,9 @@ IMPORTANT: Values separated by spaces, vectors separated by newline.
            COLUMNS MUST ALL HAVE THE SAME CONSTANT WIDTH!!! CODE IS ASSUMING THAT FOR SPEED UP!
            (here width is 12)
 
+For large training sets, the data files can be converted once into a binary, memory-mapped store
+(-binary_store <file>). Training then reads the features directly from the store without parsing.
+
 The file categories.txt is necessary to define the label names and has a simple format like this:
 1	floor
 2	wall
@@ -43,10 +46,10 @@ The file categories.txt is necessary to define the label names and has a simple
 7	object
 */
 
-bool trainRF(const std::string &training_dir, v4r::RandomForest::Forest &rf);
+bool trainRF(const std::string &training_dir, const std::string &binary_store, v4r::RandomForest::Forest &rf);
 bool testRF(const std::string &test_dir, v4r::RandomForest::Forest &rf);
 
-bool trainRF(const std::string &training_dir, v4r::RandomForest::Forest &rf) {
+bool trainRF(const std::string &training_dir, const std::string &binary_store, v4r::RandomForest::Forest &rf) {
   std::vector<std::string> files_intern = v4r::io::getFilesInDirectory(training_dir, ".*.data", true);
   if (files_intern.empty()) {
     std::cerr << "Folder " << training_dir << " does not exist. " << std::endl;
@@ -66,7 +69,15 @@ bool trainRF(const std::string &training_dir, v4r::RandomForest::Forest &rf) {
 
   // load training data from files
   v4r::RandomForest::ClassificationData trainingData;
-  trainingData.LoadFromDirectory(training_dir, labels);
+  if (binary_store.empty()) {
+    trainingData.LoadFromDirectory(training_dir, labels);
+  } else {
+    if (!v4r::io::existsFile(binary_store) &&
+        !v4r::RandomForest::ClassificationData::ConvertDirectoryToBinary(training_dir, labels, binary_store))
+      return false;
+
+    trainingData.LoadFromBinary(binary_store);
+  }
 
   // train forest
   //   parameters:
@@ -129,8 +140,9 @@ bool testRF(const std::string &test_dir, v4r::RandomForest::Forest &rf) {
 }
 
 int main(int argc, char **argv) {
-  std::string training_dir, test_dir;
+  std::string training_dir, test_dir, binary_store;
   pcl::console::parse_argument(argc, argv, "-training_dir", training_dir);
+  pcl::console::parse_argument(argc, argv, "-binary_store", binary_store);
   pcl::console::parse_argument(argc, argv, "-test", test_dir);
 
   // define Random Forest
@@ -143,6 +155,6 @@ int main(int argc, char **argv) {
   //   int nMinNumberOfPointsToSplit
   v4r::RandomForest::Forest rf(2, -1, 0.5, 200, 0.02, 5);
 
-  trainRF(training_dir, rf);
+  trainRF(training_dir, binary_store, rf);
   testRF(test_dir, rf);
 }
@@ -35,6 +35,7 @@ int main(int argc, const char *argv[]) {
   bool upperHemisphere = false;
   bool autoscale = false;
   bool createNormals = false;
+  bool software = false;
   size_t subdivisions = 0, width = 640, height = 480;
   float radius = 3.f, fx = 535.4f, fy = 539.2f, cx = 320.1f, cy = 247.6f;
 
@@ -68,6 +69,8 @@ int main(int argc, const char *argv[]) {
   desc.add_options()("cy", po::value<float>(&cy)->default_value(cy, boost::str(boost::format("%.2e") % cy)),
                      "defines the central point of projection in y direction used for rendering");
   desc.add_options()("visualize,v", po::bool_switch(&visualize), "visualize the rendered depth and color map");
+  desc.add_options()("software", po::bool_switch(&software),
+                     "renders the views in parallel on the CPU instead of using OpenGL (no display or GPU required)");
 
   po::positional_options_description p;
   p.add("input", 1);
@@ -88,7 +91,8 @@ int main(int argc, const char *argv[]) {
 
   CHECK((cx < width) && (cy < height) && (cx > 0) && (cy > 0)) << "Parameters not valid!";
 
-  v4r::DepthmapRenderer renderer(width, height);
+  v4r::DepthmapRenderer renderer(
+      width, height, software ? v4r::DepthmapRenderer::Backend::SOFTWARE : v4r::DepthmapRenderer::Backend::OPENGL);
   renderer.setIntrinsics(fx, fy, cx, cy);
 
   v4r::DepthmapRendererModel model(input.string(), "", autoscale);
@@ -116,18 +120,20 @@ int main(int argc, const char *argv[]) {
   if (!sphere.empty())
     v4r::io::createDirIfNotExist(out_dir);
 
+  // the software rasterizer is thread-safe, so views are rendered in parallel (unless they are shown one by one)
+#pragma omp parallel for schedule(dynamic) if (software && !visualize)
   for (size_t i = 0; i < sphere.size(); i++) {
     // get point from list
     const Eigen::Vector3f &point = sphere[i];
     // get a camera pose looking at the center:
-    const Eigen::Matrix4f &orientation = renderer.getPoseLookingToCenterFrom(point);
-
-    renderer.setCamPose(orientation);
+    const Eigen::Matrix4f orientation = renderer.getPoseLookingToCenterFrom(point);
 
     float visible;
     cv::Mat color;
     cv::Mat normal;
-    cv::Mat depthmap = renderer.renderDepthmap(visible, color, normal);
+    cv::Mat depthmap;
+    if (visualize)
+      depthmap = renderer.renderDepthmap(orientation, visible, color, normal);
 
     // create and save the according pcd files
     std::stringstream ss;
@@ -136,17 +142,18 @@ int main(int argc, const char *argv[]) {
     bf::path output_fn = out_dir / ss.str();
     if (model.hasColor() || model.hasTexture()) {
       if (createNormals) {
-        const pcl::PointCloud<pcl::PointXYZRGBNormal> cloud = renderer.renderPointcloudColorNormal(visible);
+        const pcl::PointCloud<pcl::PointXYZRGBNormal> cloud =
+            renderer.renderPointcloudColorNormal(orientation, visible);
         pcl::io::savePCDFileBinaryCompressed(output_fn.string(), cloud);
       } else {
-        const pcl::PointCloud<pcl::PointXYZRGB> cloud = renderer.renderPointcloudColor(visible);
+        const pcl::PointCloud<pcl::PointXYZRGB> cloud = renderer.renderPointcloudColor(orientation, visible);
         pcl::io::savePCDFileBinaryCompressed(output_fn.string(), cloud);
       }
 
       if (visualize)
         cv::imshow("color", color);
     } else {
-      const pcl::PointCloud<pcl::PointXYZ> cloud = renderer.renderPointcloud(visible);
+      const pcl::PointCloud<pcl::PointXYZ> cloud = renderer.renderPointcloud(orientation, visible);
       pcl::io::savePCDFileBinaryCompressed(output_fn.string(), cloud);
     }
 
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <memory>
 
 #include <boost/format.hpp>
 #include <boost/program_options.hpp>
@@ -8,7 +9,11 @@
 #include <opencv2/imgproc/imgproc.hpp>
 
 #include <v4r/common/unprojection.h>
+#include <v4r/config.h>
 #include <v4r/io/grabber.h>
+#if HAVE_V4R_IO_RECORDING_GRABBER
+#include <v4r/io/recording_grabber.h>
+#endif
 
 #include <pcl/io/pcd_io.h>
 #include <pcl/visualization/pcl_visualizer.h>
@@ -20,6 +25,8 @@ struct ProgramOptions : public ProgramOptionsBase {
   bool print_info = false;
   bool three_dee = false;
   bool overlay = false;
+  std::string record = "";
+  bool record_raw = false;
 
   void printDescription() override {
     std::cout << "Grab RGB-D stream from a given source (camera or file) and visualize." << std::endl;
@@ -42,6 +49,12 @@ struct ProgramOptions : public ProgramOptionsBase {
     desc.add_options()("print-info,i", po::bool_switch(&print_info), "Print information about created grabber");
     desc.add_options()("3d", po::bool_switch(&three_dee), "Unproject RGB-D frames and visualize point cloud");
     desc.add_options()("overlay", po::bool_switch(&overlay), "Overlay depth image on color image");
+#if HAVE_V4R_IO_RECORDING_GRABBER
+    desc.add_options()("record,r", po::value<std::string>(&record),
+                       "Store grabbed frames in a recording file (can be replayed by passing it as source URI)");
+    desc.add_options()("record-raw", po::bool_switch(&record_raw),
+                       "Store uncompressed images in the recording (faster, but larger files)");
+#endif
   }
 
   void addPositional(po::options_description& desc, po::positional_options_description& positional) override {
@@ -81,6 +94,21 @@ int main(int argc, const char** argv) {
     return 5;
   }
 
+#if HAVE_V4R_IO_RECORDING_GRABBER
+  std::unique_ptr<v4r::io::RecordingWriter> writer;
+  if (!options.record.empty()) {
+    const auto encoding =
+        options.record_raw ? v4r::io::RecordingWriter::Encoding::RAW : v4r::io::RecordingWriter::Encoding::PNG;
+    writer.reset(new v4r::io::RecordingWriter(options.record, grabber->getCameraIntrinsics(), encoding, encoding));
+  }
+  auto recordFrame = [&](v4r::io::Grabber::Timestamp ts, const cv::Mat& color, const cv::Mat& depth) {
+    if (writer)
+      writer->write(ts, color, depth);
+  };
+#else
+  auto recordFrame = [](v4r::io::Grabber::Timestamp, const cv::Mat&, const cv::Mat&) {};
+#endif
+
   cv::Mat color, depth;
   v4r::io::Grabber::Timestamp timestamp;
 
@@ -99,6 +127,7 @@ int main(int argc, const char** argv) {
     visualizer.registerKeyboardCallback(keyboardCallback);
     while (grabber->hasMoreFrames() && !visualizer.wasStopped()) {
       timestamp = grabber->grabFrame(color, depth);
+      recordFrame(timestamp, color, depth);
       v4r::unproject(color, depth, grabber->getCameraIntrinsics(), *cloud);
       pcl::visualization::PointCloudColorHandlerRGBField<pcl::PointXYZRGB> handler(cloud);
       visualizer.updatePointCloud<pcl::PointXYZRGB>(cloud, handler);
@@ -115,6 +144,7 @@ int main(int argc, const char** argv) {
         timestamp = grabber->grabFrame(color, depth);
       else
         continue;
+      recordFrame(timestamp, color, depth);
       if (!color.empty())
         if (!options.overlay)
           cv::imshow("Color", color);